@@ -433,6 +433,22 @@ MACRO(ADD_COVISE_MODULE category targetname)
   SET_TARGET_PROPERTIES(${targetname} PROPERTIES LABELS "${category}")
   
   # SET_TARGET_PROPERTIES(${targetname} PROPERTIES DEBUG_OUTPUT_NAME "${targetname}${CMAKE_DEBUG_POSTFIX}")
+
+  # library twin in lib/modules/<category>, loaded by the module hosts of the CRB
+  # only for the modules listed in COVISE_MODULE_LIBRARIES, as its sources are compiled a second time
+  LIST(FIND COVISE_MODULE_LIBRARIES ${targetname} COVISE_MODULE_LIBRARY_INDEX)
+  IF(NOT COVISE_MODULE_LIBRARY_INDEX EQUAL -1 AND NOT CMAKE_VERSION VERSION_LESS 2.8.12)
+    ADD_LIBRARY(${targetname}_module MODULE ${ARGN} ${SOURCES} ${HEADERS})
+    SET_TARGET_PROPERTIES(${targetname}_module PROPERTIES OUTPUT_NAME "${targetname}")
+    set_target_properties(${targetname}_module PROPERTIES FOLDER "Modules/${category}")
+    COVISE_ADJUST_OUTPUT_DIR(${targetname}_module "modules/${category}")
+    SET_TARGET_PROPERTIES(${targetname}_module PROPERTIES COMPILE_FLAGS "${COVISE_COMPILE_FLAGS}")
+    SET_TARGET_PROPERTIES(${targetname}_module PROPERTIES COMPILE_DEFINITIONS "COVISE_MODULE_LIBRARY")
+    SET_TARGET_PROPERTIES(${targetname}_module PROPERTIES LINK_FLAGS "${COVISE_LINK_FLAGS}")
+    # same libraries as the executable, including those added after this macro
+    TARGET_LINK_LIBRARIES(${targetname}_module $<TARGET_PROPERTY:${targetname},LINK_LIBRARIES>)
+  ENDIF()
+
   UNSET(SOURCES)
   UNSET(HEADERS)
 ENDMACRO(ADD_COVISE_MODULE)
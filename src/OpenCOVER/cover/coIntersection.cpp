@@ -61,6 +61,11 @@ coIntersection::coIntersection()
     std::string openmpThreads = coCoviseConfig::getEntry("value", "COVER.OMPThreads", "auto");
     useOmp = openmpThreads != "off";
 
+    // off until it has been exercised in more scenes
+    bvhCache = NULL;
+    if (coCoviseConfig::isOn("COVER.IntersectionBVH", false))
+        bvhCache = new opencover::Private::IntersectionCache;
+
     //VRUILOG("coIntersection::<init> info: creating");
 
     if (myFrameIndex < 0)
@@ -86,6 +91,7 @@ bool coIntersection::isVerboseIntersection()
 coIntersection::~coIntersection()
 {
     //VRUILOG("coIntersection::<dest> info: destroying");
+    delete bvhCache;
     intersector = NULL;
 }
 
@@ -105,6 +111,9 @@ void coIntersection::intersect()
 
     cover->intersectedNode = 0;
 
+    if (bvhCache)
+        bvhCache->frame();
+
     // for debug only
     //coVRMSController::instance()->syncInt(2000);
     if (Input::instance()->isTrackingOn())
@@ -162,20 +171,28 @@ void coIntersection::intersect()
 
 void coIntersection::intersect(const osg::Matrix &handMat, bool mouseHit)
 {
+    if (bvhCache)
+    {
+        opencover::Private::coIntersectionVisitor visitor(bvhCache);
+        intersectTemp(visitor, handMat, mouseHit);
+    }
+    else
 #ifdef _OPENMP
     if (useOmp)
     {
-	intersectTemp<opencover::Private::coIntersectionVisitor>(handMat, mouseHit);
+        opencover::Private::coIntersectionVisitor visitor;
+        intersectTemp(visitor, handMat, mouseHit);
     }
     else
 #endif
     {
-	intersectTemp<IntersectVisitor>(handMat, mouseHit);
+        IntersectVisitor visitor;
+        intersectTemp(visitor, handMat, mouseHit);
     }
 }
 
 template<class IsectVisitor>
-void coIntersection::intersectTemp(const osg::Matrix &handMat, bool mouseHit)
+void coIntersection::intersectTemp(IsectVisitor &visitor, const osg::Matrix &handMat, bool mouseHit)
 {
 
     //VRUILOG("coIntersection::intersect info: called");
@@ -198,7 +215,6 @@ void coIntersection::intersectTemp(const osg::Matrix &handMat, bool mouseHit)
 
     if (q0 != q1)
     {
-        IsectVisitor visitor;
         if (numIsectAllNodes > 0)
         {
             visitor.setTraversalMask(Isect::Pick);
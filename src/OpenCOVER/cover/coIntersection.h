@@ -26,6 +26,11 @@
 #include <osgUtil/IntersectVisitor>
 namespace opencover
 {
+namespace Private
+{
+    class IntersectionCache;
+}
+
 class COVEREXPORT coIntersection : public virtual vrui::vruiIntersection
 {
     static coIntersection *intersector;
@@ -50,7 +55,7 @@ protected:
     // do the intersection
     void intersect(const osg::Matrix &mat, bool mouseHit);
     template<class IsectVisitor>
-    void intersectTemp(const osg::Matrix &mat, bool mouseHit);
+    void intersectTemp(IsectVisitor &visitor, const osg::Matrix &mat, bool mouseHit);
 
     /// value of the PointerAppearance.Intersection config var
     float intersectionDist;
@@ -61,6 +66,8 @@ protected:
 private:
     std::vector<std::vector<float> > elapsedTimes;
     bool useOmp;
+    // hierarchies over large drawables and geodes, NULL if disabled
+    Private::IntersectionCache *bvhCache;
 };
 }
 #endif
@@ -0,0 +1,517 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coIntersectionBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <util/unixcompat.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// building subtrees in parallel needs OpenMP 3.0 tasks
+#if defined(_OPENMP) && _OPENMP >= 200805
+#define HAVE_OMP_TASKS
+#endif
+
+using namespace osg;
+
+namespace opencover
+{
+namespace Private
+{
+
+    namespace
+    {
+
+        typedef BoxHierarchy::Node Node;
+
+        const unsigned int TriangleLeafSize = 8;
+        // below this depth nodes are split in the middle, further down at the median
+        const int MaxMidpointDepth = 48;
+        // bounds the depth of the hierarchies for less than 2^80 items
+        const int MaxStackDepth = 128;
+#ifdef HAVE_OMP_TASKS
+        // larger subtrees are built as separate tasks
+        const size_t TaskSize = 1 << 16;
+#endif
+
+        // an item while building: its centroid (scaled by a constant) and its index
+        struct BuildItem
+        {
+            Vec3 centroid;
+            unsigned int index;
+        };
+
+        struct TriangleItems
+        {
+            const Vec3 *vertices;
+            const unsigned int *triangles;
+
+            void expand(unsigned int i, Vec3 &min, Vec3 &max) const
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    const Vec3 &v = vertices[triangles[3 * i + k]];
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        min[a] = std::min(min[a], v[a]);
+                        max[a] = std::max(max[a], v[a]);
+                    }
+                }
+            }
+
+            // three times the centroid
+            Vec3 centroid(unsigned int i) const
+            {
+                return vertices[triangles[3 * i]] + vertices[triangles[3 * i + 1]] + vertices[triangles[3 * i + 2]];
+            }
+        };
+
+        struct BoxItems
+        {
+            const BoundingBox *boxes;
+
+            void expand(unsigned int i, Vec3 &min, Vec3 &max) const
+            {
+                for (int a = 0; a < 3; ++a)
+                {
+                    min[a] = std::min(min[a], boxes[i]._min[a]);
+                    max[a] = std::max(max[a], boxes[i]._max[a]);
+                }
+            }
+
+            // two times the center
+            Vec3 centroid(unsigned int i) const
+            {
+                return boxes[i]._min + boxes[i]._max;
+            }
+        };
+
+        struct CentroidBelow
+        {
+            CentroidBelow(int axis, float split)
+                : axis(axis)
+                , split(split)
+            {
+            }
+            bool operator()(const BuildItem &item) const
+            {
+                return item.centroid[axis] < split;
+            }
+            int axis;
+            float split;
+        };
+
+        struct CentroidLess
+        {
+            CentroidLess(int axis)
+                : axis(axis)
+            {
+            }
+            bool operator()(const BuildItem &i, const BuildItem &j) const
+            {
+                return i.centroid[axis] < j.centroid[axis];
+            }
+            int axis;
+        };
+
+        void append(std::vector<Node> &nodes, const std::vector<Node> &subtree)
+        {
+            const unsigned int offset = nodes.size();
+            for (size_t i = 0; i < subtree.size(); ++i)
+            {
+                nodes.push_back(subtree[i]);
+                if (subtree[i].count == 0)
+                    nodes.back().right += offset;
+            }
+        }
+
+        // the split only looks at the centroids, which are partitioned in
+        // place, the bounds of inner nodes are merged from their children
+        template <class Items>
+        class Builder
+        {
+        public:
+            Builder(const Items &items, unsigned int leafSize, std::vector<BuildItem> &order)
+                : items_(items)
+                , leafSize_(leafSize)
+                , order_(order)
+            {
+            }
+
+            // appends the hierarchy of order_[first..last) to nodes
+            void build(size_t first, size_t last, std::vector<Node> &nodes, int depth)
+            {
+                Node node;
+                node.min.set(FLT_MAX, FLT_MAX, FLT_MAX);
+                node.max.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+                const size_t self = nodes.size();
+                if (last - first <= leafSize_)
+                {
+                    for (size_t i = first; i < last; ++i)
+                        items_.expand(order_[i].index, node.min, node.max);
+                    node.right = first;
+                    node.count = last - first;
+                    nodes.push_back(node);
+                    return;
+                }
+                node.right = 0;
+                node.count = 0;
+                nodes.push_back(node);
+
+                Vec3 cmin(node.min), cmax(node.max);
+                for (size_t i = first; i < last; ++i)
+                {
+                    const Vec3 &c = order_[i].centroid;
+                    for (int a = 0; a < 3; ++a)
+                    {
+                        cmin[a] = std::min(cmin[a], c[a]);
+                        cmax[a] = std::max(cmax[a], c[a]);
+                    }
+                }
+
+                // split the longest extent of the centroids in the middle,
+                // or at the median if that does not separate the items
+                Vec3 extent(cmax - cmin);
+                int axis = 0;
+                if (extent[1] > extent[axis])
+                    axis = 1;
+                if (extent[2] > extent[axis])
+                    axis = 2;
+                size_t mid = first;
+                if (depth < MaxMidpointDepth)
+                {
+                    CentroidBelow below(axis, 0.5f * (cmin[axis] + cmax[axis]));
+                    mid = std::partition(order_.begin() + first, order_.begin() + last, below) - order_.begin();
+                }
+                if (mid == first || mid == last)
+                {
+                    mid = first + (last - first) / 2;
+                    std::nth_element(order_.begin() + first, order_.begin() + mid, order_.begin() + last, CentroidLess(axis));
+                }
+
+#ifdef HAVE_OMP_TASKS
+                if (last - first > TaskSize)
+                {
+                    std::vector<Node> left, right;
+#pragma omp task shared(left)
+                    build(first, mid, left, depth + 1);
+#pragma omp task shared(right)
+                    build(mid, last, right, depth + 1);
+#pragma omp taskwait
+                    append(nodes, left);
+                    nodes[self].right = nodes.size();
+                    append(nodes, right);
+                }
+                else
+#endif
+                {
+                    build(first, mid, nodes, depth + 1);
+                    nodes[self].right = nodes.size();
+                    build(mid, last, nodes, depth + 1);
+                }
+
+                Node &inner = nodes[self];
+                const Node &l = nodes[self + 1], &r = nodes[inner.right];
+                for (int a = 0; a < 3; ++a)
+                {
+                    inner.min[a] = std::min(l.min[a], r.min[a]);
+                    inner.max[a] = std::max(l.max[a], r.max[a]);
+                }
+            }
+
+        private:
+            const Items &items_;
+            unsigned int leafSize_;
+            std::vector<BuildItem> &order_;
+        };
+
+        // builds the hierarchy over items, replacing their indices by leaf order
+        template <class Items>
+        void buildHierarchy(const Items &items, unsigned int leafSize, std::vector<unsigned int> &indices, std::vector<Node> &nodes)
+        {
+            if (indices.empty())
+                return;
+
+            std::vector<BuildItem> order(indices.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (ssize_t i = 0; i < (ssize_t)order.size(); ++i)
+            {
+                order[i].index = indices[i];
+                order[i].centroid = items.centroid(indices[i]);
+            }
+
+            Builder<Items> builder(items, leafSize, order);
+#ifdef HAVE_OMP_TASKS
+            if (order.size() > TaskSize)
+            {
+#pragma omp parallel
+#pragma omp single
+                builder.build(0, order.size(), nodes, 0);
+            }
+            else
+#endif
+            {
+                builder.build(0, order.size(), nodes, 0);
+            }
+
+            for (size_t i = 0; i < order.size(); ++i)
+                indices[i] = order[i].index;
+        }
+
+        // ratio at which the segment enters the box, false if it misses it before maxRatio
+        inline bool enter(const Node &node, const Vec3 &start, const Vec3 &invDir, float maxRatio, float &ratio)
+        {
+            float t0 = 0.f, t1 = maxRatio;
+            for (int a = 0; a < 3; ++a)
+            {
+                float tn = (node.min[a] - start[a]) * invDir[a];
+                float tf = (node.max[a] - start[a]) * invDir[a];
+                if (tn > tf)
+                    std::swap(tn, tf);
+                t0 = std::max(t0, tn);
+                t1 = std::min(t1, tf);
+            }
+            ratio = t0;
+            return t0 <= t1;
+        }
+    }
+
+    TriangleBVH::TriangleBVH(const Vec3 *vertices, unsigned int numVertices, const std::vector<unsigned int> &triangles)
+        : vertices_(vertices)
+    {
+        const size_t n = triangles.size() / 3;
+        items_.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const unsigned int *t = &triangles[3 * i];
+            if (t[0] < numVertices && t[1] < numVertices && t[2] < numVertices
+                && vertices[t[0]].valid() && vertices[t[1]].valid() && vertices[t[2]].valid())
+                items_.push_back(i);
+        }
+
+        TriangleItems items = { vertices, n ? &triangles[0] : NULL };
+        buildHierarchy(items, TriangleLeafSize, items_, nodes_);
+
+        triangles_.resize(3 * items_.size());
+        for (size_t i = 0; i < items_.size(); ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+                triangles_[3 * i + k] = triangles[3 * items_[i] + k];
+        }
+    }
+
+    bool TriangleBVH::intersect(const Vec3 &start, const Vec3 &end, Hit &hit) const
+    {
+        if (nodes_.empty())
+            return false;
+
+        const Vec3 dir(end - start);
+        const Vec3 invDir(1.f / dir[0], 1.f / dir[1], 1.f / dir[2]);
+        // accept hits at the end of the segment
+        float ratio = 1.f + FLT_EPSILON;
+        unsigned int nearest = ~0u;
+
+        unsigned int stack[MaxStackDepth];
+        float stackRatio[MaxStackDepth];
+        int sp = 0;
+        float t;
+        if (!enter(nodes_[0], start, invDir, ratio, t))
+            return false;
+        stack[sp] = 0;
+        stackRatio[sp++] = t;
+        while (sp > 0)
+        {
+            --sp;
+            if (stackRatio[sp] > ratio)
+                continue;
+            const Node &node = nodes_[stack[sp]];
+            if (node.count > 0)
+            {
+                for (unsigned int i = 0; i < node.count; i += 4)
+                    intersectLeaf(node.right + i, std::min(4u, node.count - i), start, dir, ratio, nearest);
+                continue;
+            }
+
+            // visit the nearer child first
+            unsigned int l = stack[sp] + 1, r = node.right;
+            float tl, tr;
+            bool hl = enter(nodes_[l], start, invDir, ratio, tl);
+            bool hr = enter(nodes_[r], start, invDir, ratio, tr);
+            if (hl && hr && tl > tr)
+            {
+                std::swap(l, r);
+                std::swap(tl, tr);
+            }
+            if (hr)
+            {
+                stack[sp] = r;
+                stackRatio[sp++] = tr;
+            }
+            if (hl)
+            {
+                stack[sp] = l;
+                stackRatio[sp++] = tl;
+            }
+        }
+
+        if (nearest == ~0u)
+            return false;
+
+        const unsigned int *tri = &triangles_[3 * nearest];
+        const Vec3 &v1 = vertices_[tri[0]], &v2 = vertices_[tri[1]], &v3 = vertices_[tri[2]];
+        hit.ratio = ratio;
+        hit.index = items_[nearest];
+        hit.normal = (v2 - v1) ^ (v3 - v2);
+        hit.normal.normalize();
+        return true;
+    }
+
+    // Moeller-Trumbore test of the segment start + t * dir, 0 <= t < ratio, against
+    // the triangles first to first+count-1 of a leaf, four at a time
+    void TriangleBVH::intersectLeaf(unsigned int first, unsigned int count, const Vec3 &start, const Vec3 &dir,
+                                    float &ratio, unsigned int &nearest) const
+    {
+#ifdef HAVE_SSE2
+        // lanes without a triangle repeat the last one
+        float v0[3][4], e1[3][4], e2[3][4];
+        for (unsigned int l = 0; l < 4; ++l)
+        {
+            const unsigned int *tri = &triangles_[3 * (first + std::min(l, count - 1))];
+            const Vec3 &a = vertices_[tri[0]], &b = vertices_[tri[1]], &c = vertices_[tri[2]];
+            for (int k = 0; k < 3; ++k)
+            {
+                v0[k][l] = a[k];
+                e1[k][l] = b[k] - a[k];
+                e2[k][l] = c[k] - a[k];
+            }
+        }
+        const __m128 e1x = _mm_loadu_ps(e1[0]), e1y = _mm_loadu_ps(e1[1]), e1z = _mm_loadu_ps(e1[2]);
+        const __m128 e2x = _mm_loadu_ps(e2[0]), e2y = _mm_loadu_ps(e2[1]), e2z = _mm_loadu_ps(e2[2]);
+        const __m128 dx = _mm_set1_ps(dir[0]), dy = _mm_set1_ps(dir[1]), dz = _mm_set1_ps(dir[2]);
+
+        // p = dir x e2
+        const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+        const __m128 inv = _mm_div_ps(_mm_set1_ps(1.f), det);
+
+        // s = start - v0
+        const __m128 sx = _mm_sub_ps(_mm_set1_ps(start[0]), _mm_loadu_ps(v0[0]));
+        const __m128 sy = _mm_sub_ps(_mm_set1_ps(start[1]), _mm_loadu_ps(v0[1]));
+        const __m128 sz = _mm_sub_ps(_mm_set1_ps(start[2]), _mm_loadu_ps(v0[2]));
+        const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+        // q = s x e1
+        const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+        const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+        // comparisons with NaN from degenerate triangles fail
+        const __m128 zero = _mm_setzero_ps();
+        __m128 mask = _mm_cmpneq_ps(det, zero);
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+        mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f)));
+        mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+        mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(ratio)));
+        const int lanes = _mm_movemask_ps(mask);
+        if (!lanes)
+            return;
+
+        float tt[4];
+        _mm_storeu_ps(tt, t);
+        for (unsigned int l = 0; l < count; ++l)
+        {
+            if ((lanes & (1 << l)) && tt[l] < ratio)
+            {
+                ratio = tt[l];
+                nearest = first + l;
+            }
+        }
+#else
+        for (unsigned int l = 0; l < count; ++l)
+        {
+            const unsigned int *tri = &triangles_[3 * (first + l)];
+            const Vec3 &a = vertices_[tri[0]];
+            const Vec3 e1(vertices_[tri[1]] - a), e2(vertices_[tri[2]] - a);
+            const Vec3 p(dir ^ e2);
+            const float det = e1 * p;
+            if (det == 0.f)
+                continue;
+            const float inv = 1.f / det;
+            const Vec3 s(start - a);
+            const float u = (s * p) * inv;
+            if (!(u >= 0.f && u <= 1.f))
+                continue;
+            const Vec3 q(s ^ e1);
+            const float v = (dir * q) * inv;
+            if (!(v >= 0.f && u + v <= 1.f))
+                continue;
+            const float t = (e2 * q) * inv;
+            if (t >= 0.f && t < ratio)
+            {
+                ratio = t;
+                nearest = first + l;
+            }
+        }
+#endif
+    }
+
+    BoxBVH::BoxBVH(const std::vector<BoundingBox> &boxes)
+    {
+        // empty boxes are never hit
+        items_.reserve(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            if (boxes[i].valid())
+                items_.push_back(i);
+        }
+        BoxItems items = { boxes.empty() ? NULL : &boxes[0] };
+        buildHierarchy(items, 1, items_, nodes_);
+    }
+
+    void BoxBVH::intersect(const Vec3 &start, const Vec3 &end, std::vector<unsigned int> &boxes) const
+    {
+        if (nodes_.empty())
+            return;
+
+        const Vec3 dir(end - start);
+        const Vec3 invDir(1.f / dir[0], 1.f / dir[1], 1.f / dir[2]);
+        unsigned int stack[MaxStackDepth];
+        int sp = 0;
+        float t;
+        if (enter(nodes_[0], start, invDir, 1.f, t))
+            stack[sp++] = 0;
+        while (sp > 0)
+        {
+            const unsigned int n = stack[--sp];
+            const Node &node = nodes_[n];
+            if (node.count > 0)
+            {
+                for (unsigned int i = 0; i < node.count; ++i)
+                    boxes.push_back(items_[node.right + i]);
+                continue;
+            }
+            if (enter(nodes_[node.right], start, invDir, 1.f, t))
+                stack[sp++] = node.right;
+            if (enter(nodes_[n + 1], start, invDir, 1.f, t))
+                stack[sp++] = n + 1;
+        }
+    }
+}
+}
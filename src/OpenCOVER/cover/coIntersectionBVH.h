@@ -0,0 +1,101 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COINTERSECTIONBVH_H
+#define COINTERSECTIONBVH_H
+
+#include <util/coExport.h>
+
+#include <osg/BoundingBox>
+#include <osg/Referenced>
+#include <osg/Vec3>
+
+#include <vector>
+
+namespace opencover
+{
+namespace Private
+{
+
+    // bounding volume hierarchy, nodes are stored depth first: the left
+    // child of an inner node follows it, the right child is referenced
+    class COVEREXPORT BoxHierarchy
+    {
+    public:
+        struct Node
+        {
+            osg::Vec3 min;
+            // inner node: index of right child, leaf: first entry of items_
+            unsigned int right;
+            osg::Vec3 max;
+            // number of items of a leaf, 0 for inner nodes
+            unsigned int count;
+        };
+
+        size_t numNodes() const
+        {
+            return nodes_.size();
+        }
+        size_t numItems() const
+        {
+            return items_.size();
+        }
+
+    protected:
+        std::vector<Node> nodes_;
+        // item indices in leaf order
+        std::vector<unsigned int> items_;
+    };
+
+    // hierarchy over the triangles of a drawable, in drawable coordinates
+    class COVEREXPORT TriangleBVH : public osg::Referenced, public BoxHierarchy
+    {
+    public:
+        struct Hit
+        {
+            // position on the segment, 0 at start and 1 at end
+            float ratio;
+            // index of the triangle in drawing order
+            unsigned int index;
+            osg::Vec3 normal;
+        };
+
+        // triangles are index triples into vertices, which have to stay
+        // valid as long as the hierarchy is used
+        TriangleBVH(const osg::Vec3 *vertices, unsigned int numVertices, const std::vector<unsigned int> &triangles);
+
+        // nearest intersection with the segment from start to end
+        bool intersect(const osg::Vec3 &start, const osg::Vec3 &end, Hit &hit) const;
+
+        size_t numTriangles() const
+        {
+            return items_.size();
+        }
+
+    private:
+        // test up to 4 triangles of a leaf starting at triangles_[3*first]
+        void intersectLeaf(unsigned int first, unsigned int count, const osg::Vec3 &start, const osg::Vec3 &dir,
+                           float &ratio, unsigned int &nearest) const;
+
+        const osg::Vec3 *vertices_;
+        // vertex index triples in leaf order
+        std::vector<unsigned int> triangles_;
+    };
+
+    // hierarchy over bounding boxes, e.g. those of the drawables of a geode
+    class COVEREXPORT BoxBVH : public osg::Referenced, public BoxHierarchy
+    {
+    public:
+        BoxBVH(const std::vector<osg::BoundingBox> &boxes);
+
+        // appends the indices of all boxes the segment from start to end passes through
+        void intersect(const osg::Vec3 &start, const osg::Vec3 &end, std::vector<unsigned int> &boxes) const;
+    };
+}
+}
+
+#endif // COINTERSECTIONBVH_H
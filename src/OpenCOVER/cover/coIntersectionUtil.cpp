@@ -10,13 +10,17 @@
 #include "coIntersection.h"
 #include <osg/Version>
 #include <osg/io_utils>
+#include <osg/TriangleIndexFunctor>
 #if OSG_VERSION_GREATER_OR_EQUAL(3, 3, 2)
 #define getBound getBoundingBox
 #endif
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <util/unixcompat.h>
+#include <util/coWristWatch.h>
+#include <stdint.h>
 
 using namespace osg;
 using namespace osgUtil;
@@ -267,7 +271,231 @@ namespace Private
             }
         }
     };
+
+    struct TriangleIndexCollector
+    {
+        std::vector<unsigned int> indices;
+
+        void operator()(unsigned int i1, unsigned int i2, unsigned int i3)
+        {
+            indices.push_back(i1);
+            indices.push_back(i2);
+            indices.push_back(i3);
+        }
+    };
+
+    // geometries with fewer indices are intersected triangle by triangle
+    const unsigned int MinTriangleIndices = 3 * 256;
+    // geodes with fewer drawables test each of them
+    const unsigned int MinDrawables = 16;
+    // deleted geometries and geodes are forgotten after this many frames
+    const unsigned int PruneFrames = 1000;
+
+    static unsigned long long hashFloat(unsigned long long signature, float f)
+    {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return signature * 1000003ULL ^ bits;
+    }
+
+    // changes when vertices or primitive sets are replaced or dirtied, or
+    // when the bounding box changes: plugins editing vertices in place
+    // often only call dirtyBound()
+    static unsigned long long geometrySignature(const osg::Geometry *geo)
+    {
+        const osg::Array *vertices = geo->getVertexArray();
+        unsigned long long signature = (uintptr_t)vertices->getDataPointer() ^ vertices->getNumElements() ^ ((unsigned long long)vertices->getModifiedCount() << 32);
+        const osg::Geometry::PrimitiveSetList &pList = geo->getPrimitiveSetList();
+        for (size_t i = 0; i < pList.size(); ++i)
+            signature = signature * 1000003ULL ^ (uintptr_t)pList[i].get() ^ ((unsigned long long)pList[i]->getModifiedCount() << 32);
+        const osg::BoundingBox &box = geo->getBound();
+        for (int i = 0; i < 3; ++i)
+        {
+            signature = hashFloat(signature, box._min[i]);
+            signature = hashFloat(signature, box._max[i]);
+        }
+        return signature;
+    }
+}
+}
+
+opencover::Private::IntersectionCache::Builder::Builder(IntersectionCache *cache)
+    : cache(cache)
+{
+}
+
+void opencover::Private::IntersectionCache::Builder::run()
+{
+    cache->build();
+}
+
+opencover::Private::IntersectionCache::IntersectionCache()
+    : frames_(0)
+    , quit_(false)
+{
+    builder_ = new Builder(this);
+    builder_->start();
+}
+
+opencover::Private::IntersectionCache::~IntersectionCache()
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        quit_ = true;
+        cond_.broadcast();
+    }
+    builder_->join();
+    delete builder_;
+
+    for (std::list<BuildJob *>::iterator it = queued_.begin(); it != queued_.end(); ++it)
+        delete *it;
+    for (std::list<BuildJob *>::iterator it = done_.begin(); it != done_.end(); ++it)
+        delete *it;
+}
+
+// builder thread: only reads the referenced vertices and primitive sets,
+// as the draw threads of osg do
+void opencover::Private::IntersectionCache::build()
+{
+    for (;;)
+    {
+        BuildJob *job = NULL;
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+            while (!quit_ && queued_.empty())
+                cond_.wait(&mutex_);
+            if (quit_)
+                return;
+            job = queued_.front();
+            queued_.pop_front();
+        }
+
+        covise::coWristWatch watch;
+        osg::TriangleIndexFunctor<TriangleIndexCollector> collector;
+        for (size_t i = 0; i < job->primitives.size(); ++i)
+            job->primitives[i]->accept(collector);
+        job->bvh = new TriangleBVH(static_cast<const Vec3 *>(job->vertices->getDataPointer()), job->vertices->getNumElements(), collector.indices);
+        if (opencover::coIntersection::isVerboseIntersection())
+            std::cerr << "hierarchy over " << job->bvh->numTriangles() << " triangles built in " << watch.elapsed() << "s" << std::endl;
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        done_.push_back(job);
+    }
 }
+
+opencover::Private::TriangleBVH *opencover::Private::IntersectionCache::triangles(osg::Geometry *geo)
+{
+    const osg::Array *vertices = geo->getVertexArray();
+    if (!vertices || vertices->getType() != osg::Array::Vec3ArrayType || vertices->getNumElements() == 0)
+        return NULL;
+
+    // small geometries are intersected faster than their hierarchy is built
+    unsigned int numIndices = 0;
+    const osg::Geometry::PrimitiveSetList &pList = geo->getPrimitiveSetList();
+    for (size_t i = 0; i < pList.size(); ++i)
+        numIndices += pList[i]->getNumIndices();
+    if (numIndices < MinTriangleIndices)
+        return NULL;
+
+    const unsigned long long signature = geometrySignature(geo);
+    TriangleEntry &entry = triangles_[geo];
+    if (entry.geometry.get() != geo || entry.vertices.get() != vertices || entry.signature != signature)
+    {
+        entry.geometry = geo;
+        entry.vertices = vertices;
+        entry.signature = signature;
+        entry.bvh = NULL;
+    }
+
+    // a hierarchy for an outdated signature is dropped when it is done and
+    // then requested again
+    if (!entry.bvh && !entry.building)
+    {
+        BuildJob *job = new BuildJob;
+        job->geometry = geo;
+        job->vertices = vertices;
+        job->primitives = pList;
+        job->signature = signature;
+        entry.building = true;
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        queued_.push_back(job);
+        cond_.signal();
+    }
+    return entry.bvh.get();
+}
+
+opencover::Private::BoxBVH *opencover::Private::IntersectionCache::drawables(osg::Geode &geode)
+{
+    const unsigned int n = geode.getNumDrawables();
+    if (n < MinDrawables)
+        return NULL;
+
+    DrawableEntry &entry = drawables_[&geode];
+    bool valid = entry.geode.get() == &geode && entry.drawables.size() == n;
+    for (unsigned int i = 0; valid && i < n; ++i)
+    {
+        const osg::Drawable *d = geode.getDrawable(i);
+        valid = d == entry.drawables[i] && (!d || (d->getBound()._min == entry.boxes[i]._min && d->getBound()._max == entry.boxes[i]._max));
+    }
+    if (valid)
+        return entry.bvh.get();
+
+    entry.geode = &geode;
+    entry.drawables.resize(n);
+    entry.boxes.resize(n);
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        const osg::Drawable *d = geode.getDrawable(i);
+        entry.drawables[i] = d;
+        entry.boxes[i] = d ? d->getBound() : BoundingBox();
+    }
+    entry.bvh = new BoxBVH(entry.boxes);
+    return entry.bvh.get();
+}
+
+void opencover::Private::IntersectionCache::frame()
+{
+    std::list<BuildJob *> done;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex_);
+        done.swap(done_);
+    }
+    for (std::list<BuildJob *>::iterator it = done.begin(); it != done.end(); ++it)
+    {
+        BuildJob *job = *it;
+        std::map<const osg::Geometry *, TriangleEntry>::iterator entry = triangles_.find(job->geometry.get());
+        if (entry != triangles_.end() && entry->second.geometry.get() == job->geometry.get())
+        {
+            entry->second.building = false;
+            if (entry->second.vertices.get() == job->vertices.get() && entry->second.signature == job->signature)
+                entry->second.bvh = job->bvh;
+        }
+        delete job;
+    }
+
+    if (++frames_ % PruneFrames)
+        return;
+
+    for (std::map<const osg::Geometry *, TriangleEntry>::iterator it = triangles_.begin(); it != triangles_.end();)
+    {
+        if (it->second.geometry.valid())
+            ++it;
+        else
+            triangles_.erase(it++);
+    }
+    for (std::map<const osg::Geode *, DrawableEntry>::iterator it = drawables_.begin(); it != drawables_.end();)
+    {
+        if (it->second.geode.valid())
+            ++it;
+        else
+            drawables_.erase(it++);
+    }
+}
+
+opencover::Private::coIntersectionVisitor::coIntersectionVisitor(IntersectionCache *cache)
+    : cache(cache)
+{
 }
 
 void opencover::Private::coIntersectionVisitor::intersect(osg::Geometry *geo, osg::PrimitiveFunctor &functor)
@@ -355,6 +583,9 @@ bool opencover::Private::coIntersectionVisitor::intersect(Drawable &drawable)
 
     const BoundingBox &bb = drawable.getBound();
 
+    osg::Geometry *geo = dynamic_cast<osg::Geometry *>(&drawable);
+    TriangleBVH *bvh = (cache && geo) ? cache->triangles(geo) : NULL;
+
     for (IntersectState::LineSegmentList::iterator sitr = cis->_segList.begin();
          sitr != cis->_segList.end();
          ++sitr)
@@ -362,9 +593,20 @@ bool opencover::Private::coIntersectionVisitor::intersect(Drawable &drawable)
         if (sitr->second->intersect(bb))
         {
 
+            if (bvh)
+            {
+                // only the nearest hit of a drawable can be the first visible one
+                TriangleBVH::Hit triHit;
+                if (bvh->intersect(sitr->second->start(), sitr->second->end(), triHit))
+                {
+                    addHit(drawable, sitr->first, sitr->second, triHit.ratio, triHit.index, triHit.normal);
+                    hitFlag = true;
+                }
+                continue;
+            }
+
             ParallelTriangleFunctor<TriangleIntersect> ti;
             ti.set(*sitr->second);
-            osg::Geometry *geo = dynamic_cast<osg::Geometry *>(&drawable);
             if (geo)
                 intersect(geo, ti);
             else
@@ -382,44 +624,9 @@ bool opencover::Private::coIntersectionVisitor::intersect(Drawable &drawable)
                      thitr != ti._thl.end();
                      ++thitr)
                 {
-
-                    Hit hit;
-                    hit._nodePath = _nodePath;
-                    hit._matrix = cis->_model_matrix;
-                    hit._inverse = cis->_model_inverse;
-                    hit._drawable = &drawable;
-                    if (_nodePath.empty())
-                        hit._geode = NULL;
-                    else
-                        hit._geode = dynamic_cast<Geode *>(_nodePath.back());
-
                     TriangleHit &triHit = thitr->second;
-
-                    hit._ratio = thitr->first;
-                    hit._primitiveIndex = triHit._index; // TODO Not really.... index is undefined
-                    hit._originalLineSegment = sitr->first;
-                    hit._localLineSegment = sitr->second;
-
-                    hit._intersectPoint = sitr->second->start() * (1.0f - hit._ratio) + sitr->second->end() * hit._ratio;
-
-                    hit._intersectNormal = triHit._normal;
-
-                    //               if (geometry)
-                    //               {
-                    //                  osg::Vec3Array* vertices = dynamic_cast<osg::Vec3Array*>(geometry->getVertexArray());
-                    //                  if (vertices)
-                    //                  {
-                    //                     osg::Vec3 first = vertices->front();
-                    //                     hit._vecIndexList.push_back(triHit._v1-first);
-                    //                     hit._vecIndexList.push_back(triHit._v2-first);
-                    //                     hit._vecIndexList.push_back(triHit._v3-first);
-                    //                  }
-                    //               }
-
-                    _segHitList[sitr->first.get()].push_back(hit);
-
-                    std::sort(_segHitList[sitr->first.get()].begin(), _segHitList[sitr->first.get()].end());
-
+                    // TODO Not really.... index is undefined
+                    addHit(drawable, sitr->first, sitr->second, thitr->first, triHit._index, triHit._normal);
                     hitFlag = true;
                 }
             }
@@ -429,6 +636,47 @@ bool opencover::Private::coIntersectionVisitor::intersect(Drawable &drawable)
     return hitFlag;
 }
 
+void opencover::Private::coIntersectionVisitor::addHit(osg::Drawable &drawable, const osg::ref_ptr<osg::LineSegment> &original, const osg::ref_ptr<osg::LineSegment> &local,
+                                                       float ratio, unsigned int index, const osg::Vec3 &normal)
+{
+    IntersectState *cis = _intersectStateStack.back().get();
+
+    Hit hit;
+    hit._nodePath = _nodePath;
+    hit._matrix = cis->_model_matrix;
+    hit._inverse = cis->_model_inverse;
+    hit._drawable = &drawable;
+    if (_nodePath.empty())
+        hit._geode = NULL;
+    else
+        hit._geode = dynamic_cast<Geode *>(_nodePath.back());
+
+    hit._ratio = ratio;
+    hit._primitiveIndex = index;
+    hit._originalLineSegment = original;
+    hit._localLineSegment = local;
+
+    hit._intersectPoint = local->start() * (1.0f - hit._ratio) + local->end() * hit._ratio;
+
+    hit._intersectNormal = normal;
+
+    //               if (geometry)
+    //               {
+    //                  osg::Vec3Array* vertices = dynamic_cast<osg::Vec3Array*>(geometry->getVertexArray());
+    //                  if (vertices)
+    //                  {
+    //                     osg::Vec3 first = vertices->front();
+    //                     hit._vecIndexList.push_back(triHit._v1-first);
+    //                     hit._vecIndexList.push_back(triHit._v2-first);
+    //                     hit._vecIndexList.push_back(triHit._v3-first);
+    //                  }
+    //               }
+
+    _segHitList[original.get()].push_back(hit);
+
+    std::sort(_segHitList[original.get()].begin(), _segHitList[original.get()].end());
+}
+
 #if 0
 void opencover::Private::coIntersectionVisitor::apply(osg::Geode& geode)
 {
@@ -502,12 +750,38 @@ void opencover::Private::coIntersectionVisitor::apply(osg::Geode &geode)
 {
     if (enterNode(geode))
     {
-        for (unsigned int i = 0; i < geode.getNumDrawables(); i++)
+        BoxBVH *bvh = cache ? cache->drawables(geode) : NULL;
+        if (bvh)
         {
-            osg::Drawable *d = geode.getDrawable(i);
-            if (d)
+            // only the drawables whose bounds are passed by a segment
+            std::vector<unsigned int> candidates;
+            IntersectState *cis = _intersectStateStack.back().get();
+            for (IntersectState::LineSegmentList::iterator sitr = cis->_segList.begin();
+                 sitr != cis->_segList.end();
+                 ++sitr)
+            {
+                bvh->intersect(sitr->second->start(), sitr->second->end(), candidates);
+            }
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (size_t i = 0; i < candidates.size(); i++)
             {
-                intersect(*d);
+                osg::Drawable *d = geode.getDrawable(candidates[i]);
+                if (d)
+                {
+                    intersect(*d);
+                }
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < geode.getNumDrawables(); i++)
+            {
+                osg::Drawable *d = geode.getDrawable(i);
+                if (d)
+                {
+                    intersect(*d);
+                }
             }
         }
 
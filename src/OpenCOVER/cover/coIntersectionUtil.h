@@ -10,7 +10,17 @@
 
 #include <osg/TriangleFunctor>
 #include <osg/Geometry>
+#include <osg/Geode>
+#include <osg/observer_ptr>
 #include <osgUtil/IntersectVisitor>
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+
+#include "coIntersectionBVH.h"
+
+#include <list>
+#include <map>
 
 namespace opencover
 {
@@ -130,17 +140,103 @@ namespace Private
         }
     };
 
+    // hierarchies over the triangles of geometries and over the drawables
+    // of geodes, built when first intersected and rebuilt after changes;
+    // triangle hierarchies are built by a background thread
+    class IntersectionCache
+    {
+    public:
+        IntersectionCache();
+        ~IntersectionCache();
+
+        // NULL if the geometry is better intersected triangle by triangle
+        // or its hierarchy is still being built
+        TriangleBVH *triangles(osg::Geometry *geo);
+        // NULL if the drawables of the geode are better tested one by one
+        BoxBVH *drawables(osg::Geode &geode);
+
+        // call once per frame: takes over finished hierarchies and
+        // forgets deleted geometries and geodes from time to time
+        void frame();
+
+    private:
+        class Builder : public OpenThreads::Thread
+        {
+        public:
+            Builder(IntersectionCache *cache);
+            virtual void run();
+
+        private:
+            IntersectionCache *cache;
+        };
+
+        // everything the builder reads, referenced so that it stays valid
+        // even if the geometry is changed meanwhile
+        struct BuildJob
+        {
+            osg::ref_ptr<osg::Geometry> geometry;
+            osg::ref_ptr<const osg::Array> vertices;
+            osg::Geometry::PrimitiveSetList primitives;
+            unsigned long long signature;
+            osg::ref_ptr<TriangleBVH> bvh;
+        };
+
+        struct TriangleEntry
+        {
+            osg::observer_ptr<osg::Geometry> geometry;
+            osg::ref_ptr<const osg::Array> vertices;
+            unsigned long long signature;
+            osg::ref_ptr<TriangleBVH> bvh;
+            bool building;
+
+            TriangleEntry()
+                : signature(0)
+                , building(false)
+            {
+            }
+        };
+        struct DrawableEntry
+        {
+            osg::observer_ptr<osg::Geode> geode;
+            // only compared, never dereferenced
+            std::vector<const osg::Drawable *> drawables;
+            std::vector<osg::BoundingBox> boxes;
+            osg::ref_ptr<BoxBVH> bvh;
+        };
+
+        void build();
+
+        std::map<const osg::Geometry *, TriangleEntry> triangles_;
+        std::map<const osg::Geode *, DrawableEntry> drawables_;
+        unsigned int frames_;
+
+        // jobs are created and deleted on the thread calling triangles() and
+        // frame(), so that osg objects are never released by the builder
+        Builder *builder_;
+        OpenThreads::Mutex mutex_;
+        OpenThreads::Condition cond_;
+        bool quit_;
+        std::list<BuildJob *> queued_, done_;
+    };
+
     class coIntersectionSubVisitor;
 
     class coIntersectionVisitor : public osgUtil::IntersectVisitor
     {
 
     public:
+        // without cache all drawables and triangles are tested
+        coIntersectionVisitor(IntersectionCache *cache = NULL);
+
         virtual void apply(osg::Geode &geode);
         virtual bool intersect(osg::Drawable &drawable);
         virtual void intersect(osg::Geometry *drawable, osg::PrimitiveFunctor &functor);
 
     private:
+        void addHit(osg::Drawable &drawable, const osg::ref_ptr<osg::LineSegment> &original, const osg::ref_ptr<osg::LineSegment> &local,
+                    float ratio, unsigned int index, const osg::Vec3 &normal);
+
+        IntersectionCache *cache;
         //   std::vector<coIntersectionSubVisitor> subVisitors;
     };
 
@@ -110,6 +110,13 @@ void CoviseSG::deleteNode(const char *nodeName, bool isGroup)
     }
 }
 
+void CoviseSG::notifyPlugins(const std::string &name, RenderObject *ro)
+{
+    osg::Node *node = findNode(name);
+    if (node && node->getNumParents() > 0)
+        coVRPluginList::instance()->addNode(node->getParent(0), ro);
+}
+
 osg::Node *CoviseSG::findNode(const std::string &name)
 {
     NodeList::iterator it = m_addedNodeList.find(name);
@@ -158,7 +165,7 @@ void CoviseSG::addNode(osg::Node *node, const char *parentName, RenderObject *ro
     addNode(node, parentGroup, ro);
 }
 
-void CoviseSG::addNode(osg::Node *node, osg::Group *parent, RenderObject *ro)
+void CoviseSG::addNode(osg::Node *node, osg::Group *parent, RenderObject *ro, bool notifyPlugins)
 {
 
     if (sgDebug_)
@@ -187,7 +194,8 @@ void CoviseSG::addNode(osg::Node *node, osg::Group *parent, RenderObject *ro)
         if (sgDebug_)
             fprintf(stderr, "CoviseSG(%s)::addNode2 adding node to objectsRoot\n", hostName_);
 
-        coVRPluginList::instance()->addNode(dcs, ro);
+        if (notifyPlugins)
+            coVRPluginList::instance()->addNode(dcs, ro);
     }
     else
     {
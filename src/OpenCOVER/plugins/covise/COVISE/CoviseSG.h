@@ -31,8 +31,11 @@ class CoviseSG
     typedef std::map<std::string, osg::Node *> NodeList;
     typedef std::map<std::string, opencover::coVRLabel *> LabelList;
 
-    void addNode(osg::Node *node, osg::Group *parent, opencover::RenderObject *ro);
+    // plugins are told about nodes without parent unless notifyPlugins is false
+    void addNode(osg::Node *node, osg::Group *parent, opencover::RenderObject *ro, bool notifyPlugins = true);
     void addNode(osg::Node *node, const char *parentName, opencover::RenderObject *ro);
+    // tell plugins about a node added with notifyPlugins == false
+    void notifyPlugins(const std::string &name, opencover::RenderObject *ro);
     void deleteNode(const char *nodeName, bool isGroup);
     osg::Node *findNode(const std::string &name);
 
@@ -60,6 +60,7 @@
 
 #include <config/CoviseConfig.h>
 #include <util/coLog.h>
+#include <util/coTrace.h>
 #include <do/coDistributedObject.h>
 #include <appl/RenderInterface.h>
 
@@ -143,6 +144,9 @@ ObjectManager *ObjectManager::instance()
 ObjectManager::ObjectManager()
     : materialList(NULL)
     , coviseSG(new CoviseSG)
+    , converter(new coVRGeometryConverter)
+    , deferConversion(false)
+    , pendingJob(NULL)
 {
     if (cover->debugLevel(2))
         fprintf(stderr, "new ObjectManager\n");
@@ -157,6 +161,7 @@ ObjectManager::ObjectManager()
 
     anzset = 0;
     depthPeeling = coCoviseConfig::isOn("COVER.DepthPeeling", false);
+    coTrace::setProcessName("OpenCOVER");
 }
 
 void
@@ -198,6 +203,7 @@ ObjectManager::removeButtonsForContainer(const char *container)
 
 ObjectManager::~ObjectManager()
 {
+    delete converter;
     delete coviseSG;
     if (cover->debugLevel(2))
         fprintf(stderr, "delete ObjectManager\n");
@@ -211,6 +217,19 @@ ObjectManager::~ObjectManager()
 void
 ObjectManager::update(void)
 {
+    converter->attach();
+    for (std::map<std::string, CoviseRenderObject *>::iterator it = m_pluginNotificationPending.begin();
+         it != m_pluginNotificationPending.end();)
+    {
+        if (converter->numPending(it->first) > 0)
+        {
+            ++it;
+            continue;
+        }
+        coviseSG->notifyPlugins(it->first, it->second);
+        m_pluginNotificationPending.erase(it++);
+    }
+    coTrace::flush();
 
     // newCode
     osg::Matrix invBase = cover->getInvBaseMat();
@@ -445,6 +464,7 @@ void ObjectManager::addObject(const char *object, const coDistributedObject *dat
 
     if (cover->debugLevel(4))
         fprintf(stderr, "--ObjectManager (%s)::addObject %s\n", getenv("HOST") ? getenv("HOST") : "unknown", object);
+    coTraceSpan span("render", object);
     if ((!data_obj) && (coVRMSController::instance()->isMaster()))
     {
         data_obj = coDistributedObject::createFromShm(object);
@@ -469,7 +489,11 @@ void ObjectManager::addObject(const char *object, const coDistributedObject *dat
             // also send container object 'ro' for plugin usage
             if (osg::Node *n = addGeometry(object, NULL, ro, NULL, NULL, NULL, NULL, ro, NULL))
             {
-                coviseSG->addNode(n, (osg::Group *)NULL, ro);
+                // plugins would only see the empty groups of elements still being built
+                bool building = converter->numPending(object) > 0;
+                coviseSG->addNode(n, (osg::Group *)NULL, ro, !building);
+                if (building)
+                    m_pluginNotificationPending[object] = ro;
             }
         }
     }
@@ -545,6 +569,10 @@ void ObjectManager::deleteObject(const char *name, bool groupobject)
     //printf("ObjectManager::deleteObject\n");
     //printf("\t object = %s\n", name);
 
+    // render objects of this object must not be used by the converter any longer
+    converter->cancel(name);
+    m_pluginNotificationPending.erase(name);
+
     int i, n;
     for (i = 0; i < anzset; i++)
     {
@@ -760,7 +788,7 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
     char buf[300];
     const char *tstep_attrib = NULL;
     const char *feedback_info = NULL;
-    unsigned int rgba;
+    unsigned int rgba = 0;
     curset = anzset;
     osg::Texture::WrapMode wrapMode = osg::Texture::CLAMP_TO_EDGE;
     osg::Texture::FilterMode minfm = osg::Texture::NEAREST;
@@ -1271,6 +1299,10 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             }
         }
         anzset++;
+        // build the geometry of the elements in the background, nested sets inherit this
+        bool deferredBefore = deferConversion;
+        if (groupNode && no_elems > 1 && converter->isEnabled())
+            deferConversion = true;
         for (int i = 0; i < no_elems; i++)
         {
             strcpy(buf, dobjsg[i]->getName());
@@ -1290,6 +1322,24 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             else
                 std::cerr << "ignoring Set element: no group node" << std::endl;
 
+            if (pendingJob)
+            {
+                // the converter deletes the elements when it is done with their data
+                coVRGeometryConverter::Job *job = pendingJob;
+                pendingJob = NULL;
+                job->owned.push_back(dobjsg[i]);
+                if (dobjsn && i < no_n)
+                    job->owned.push_back(dobjsn[i]);
+                if (dobjsc && i < no_c)
+                    job->owned.push_back(dobjsc[i]);
+                if (dobjst && i < no_t)
+                    job->owned.push_back(dobjst[i]);
+                if (dobjsva && i < no_va)
+                    job->owned.push_back(dobjsva[i]);
+                converter->submit(job);
+                continue;
+            }
+
             if (dobjsg)
                 delete dobjsg[i];
             if (dobjsn && i < no_n)
@@ -1301,6 +1351,7 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
             if (dobjsva && i < no_va)
                 delete dobjsva[i];
         }
+        deferConversion = deferredBefore;
 
         const char *polyOffset = geometry->getAttribute("POLYGON_OFFSET");
         if (polyOffset && geometry->isAssignedToMe())
@@ -1609,6 +1660,65 @@ osg::Node *ObjectManager::addGeometry(const char *object, osg::Group *root, Covi
 
         bool skipGeometryCreation = false;
 
+        // shaders can only be applied once the node has been built, see below
+        bool needsShader = geometry->getAttribute("SHADER") || geometry->getAttribute("UNIFORMS")
+                           || (texture && (texture->getAttribute("SHADER") || texture->getAttribute("UNIFORMS")))
+                           || (container && container->getAttribute("SHADER"))
+                           || colorpacking == Pack::Float;
+
+        if (deferConversion && !pendingJob && !needsShader
+            && (strcmp(gtype, "POLYGN") == 0 || strcmp(gtype, "TRIANG") == 0
+                || strcmp(gtype, "TRITRI") == 0 || strcmp(gtype, "QUADS") == 0))
+        {
+            // build the geometry in a worker thread into an empty group, the
+            // set loop hands the render objects holding the data to the converter
+            std::string type = gtype, name = object;
+            bool namedColor = pc == (int *)&rgba;
+            float *t_c0 = t_c[0], *t_c1 = t_c[1];
+            GeometryManager *gm = GeometryManager::instance();
+            coVRGeometryConverter::Builder build = [=]() mutable -> osg::Node *
+            {
+                int *colors = namedColor ? (int *)&rgba : pc;
+                if (type == "POLYGN")
+                    return gm->addPolygon(name.c_str(), no_poly, no_vert,
+                                          no_points, x_c, y_c, z_c,
+                                          v_l, l_l,
+                                          no_c, colorbinding, colorpacking, rc, gc, bc, colors,
+                                          no_n, normalbinding, xn, yn, zn, transparency,
+                                          vertexOrder, material,
+                                          texW, texH, pixS, texImage,
+                                          no_t, t_c0, t_c1, wrapMode, minfm, magfm, no_va, xva, yva, zva, cullBackfaces);
+                if (type == "TRIANG")
+                    return gm->addTriangleStrip(name.c_str(), no_strip, no_vert,
+                                                no_points, x_c, y_c, z_c,
+                                                v_l, l_l,
+                                                no_c, colorbinding, colorpacking, rc, gc, bc, colors,
+                                                no_n, normalbinding, xn, yn, zn, transparency,
+                                                vertexOrder, material,
+                                                texW, texH, pixS, texImage,
+                                                no_t, t_c0, t_c1, wrapMode, minfm, magfm, no_va, xva, yva, zva, cullBackfaces);
+                return gm->addTriangles(name.c_str(), no_vert,
+                                        no_points, x_c, y_c, z_c,
+                                        v_l,
+                                        no_c, colorbinding, colorpacking, rc, gc, bc, colors,
+                                        no_n, normalbinding, xn, yn, zn, transparency,
+                                        vertexOrder, material,
+                                        texW, texH, pixS, texImage,
+                                        no_t, t_c0, t_c1, wrapMode, minfm, magfm, no_va, xva, yva, zva, cullBackfaces);
+            };
+
+            osg::Group *placeholder = new osg::Group;
+            placeholder->setName(object);
+            pendingJob = new coVRGeometryConverter::Job;
+            pendingJob->container = container->getName();
+            pendingJob->placeholder = placeholder;
+            // coordinates, normals, colors and texture coordinates per corner
+            pendingJob->bytes = (size_t)no_vert * (3 + 3 + 4 + 2) * sizeof(float);
+            pendingJob->build = build;
+            newNode = placeholder;
+            skipGeometryCreation = true;
+        }
+
         if (!skipGeometryCreation)
         {
             if (strcmp(gtype, "UNIGRD") == 0)
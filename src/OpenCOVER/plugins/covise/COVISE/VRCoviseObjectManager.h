@@ -30,6 +30,8 @@
 #include <util/coMaterial.h>
 #include <map>
 
+#include "coVRGeometryConverter.h"
+
 #define MAXSETS 8000
 
 namespace osg
@@ -132,6 +134,12 @@ private:
     typedef std::map<std::string, CoviseRenderObject *> RenderObjectMap;
     RenderObjectMap m_roMap;
 
+    coVRGeometryConverter *converter;
+    bool deferConversion; // set elements are built by converter
+    coVRGeometryConverter::Job *pendingJob; // prepared for the current set element
+    // objects whose plugins are told about them once all their elements are built
+    std::map<std::string, CoviseRenderObject *> m_pluginNotificationPending;
+
 public:
     static ObjectManager *instance();
 
@@ -0,0 +1,236 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coVRGeometryConverter.h"
+
+#include <cover/RenderObject.h>
+#include <cover/coVRMSController.h>
+#include <cover/coVRPluginSupport.h>
+#include <config/CoviseConfig.h>
+#include <util/coTrace.h>
+
+#include <OpenThreads/ScopedLock>
+
+#include <cstdio>
+
+using namespace opencover;
+using namespace covise;
+
+coVRGeometryConverter::Worker::Worker(coVRGeometryConverter *converter)
+    : converter(converter)
+{
+}
+
+void coVRGeometryConverter::Worker::run()
+{
+    converter->work();
+}
+
+coVRGeometryConverter::coVRGeometryConverter()
+    : enabled(false)
+    , budget(0)
+    , quit(false)
+    , inFlight(0)
+{
+    // master and slaves would attach nodes in different frames
+    if (coVRMSController::instance()->isCluster())
+        return;
+
+    if (!coCoviseConfig::isOn("COVER.AsyncConversion", true))
+        return;
+
+    int numProcessors = OpenThreads::GetNumberOfProcessors();
+    int numThreads = coCoviseConfig::getInt("threads", "COVER.AsyncConversion", numProcessors > 1 ? numProcessors - 1 : 1);
+    budget = (size_t)coCoviseConfig::getInt("memory", "COVER.AsyncConversion", 512) * 1024 * 1024;
+    if (numThreads < 1)
+        return;
+
+    enabled = true;
+    for (int i = 0; i < numThreads; i++)
+    {
+        Worker *w = new Worker(this);
+        w->start();
+        workers.push_back(w);
+    }
+    if (cover->debugLevel(2))
+        fprintf(stderr, "coVRGeometryConverter: %d threads, %d MB\n", numThreads, (int)(budget / 1024 / 1024));
+}
+
+coVRGeometryConverter::~coVRGeometryConverter()
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        quit = true;
+        cond.broadcast();
+    }
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        delete workers[i];
+    }
+
+    for (std::list<Job *>::iterator it = queued.begin(); it != queued.end(); ++it)
+        discard(*it);
+    for (std::list<Job *>::iterator it = done.begin(); it != done.end(); ++it)
+        discard(*it);
+}
+
+bool coVRGeometryConverter::isEnabled() const
+{
+    return enabled;
+}
+
+void coVRGeometryConverter::submit(Job *job)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    queued.push_back(job);
+    cond.signal();
+}
+
+void coVRGeometryConverter::work()
+{
+    for (;;)
+    {
+        Job *job = NULL;
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+            // let a job start if nothing is pending, even if it exceeds the budget on its own
+            while (!quit && (queued.empty() || (inFlight > 0 && inFlight + queued.front()->bytes > budget)))
+                cond.wait(&mutex);
+            if (quit)
+                return;
+
+            job = queued.front();
+            queued.pop_front();
+            running.push_back(job);
+            inFlight += job->bytes;
+        }
+
+        osg::ref_ptr<osg::Node> node;
+        {
+            coTraceSpan span("render", "convert " + job->container);
+            node = job->build();
+        }
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        job->result = node;
+        running.remove(job);
+        done.push_back(job);
+        cond.broadcast();
+    }
+}
+
+int coVRGeometryConverter::attach()
+{
+    std::list<Job *> finished;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        if (done.empty())
+            return 0;
+        finished.swap(done);
+    }
+
+    int n = 0;
+    size_t bytes = 0;
+    for (std::list<Job *>::iterator it = finished.begin(); it != finished.end(); ++it)
+    {
+        Job *job = *it;
+        if (job->result.valid())
+        {
+            job->placeholder->addChild(job->result.get());
+            ++n;
+        }
+        bytes += job->bytes;
+        discard(job);
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    inFlight -= bytes;
+    cond.broadcast();
+    return n;
+}
+
+void coVRGeometryConverter::cancel(const std::string &container)
+{
+    std::list<Job *> dropped;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+        for (std::list<Job *>::iterator it = queued.begin(); it != queued.end();)
+        {
+            if ((*it)->container == container)
+            {
+                dropped.push_back(*it);
+                it = queued.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // the data of the render objects is still used by running jobs
+        for (;;)
+        {
+            bool busy = false;
+            for (std::list<Job *>::iterator it = running.begin(); it != running.end(); ++it)
+            {
+                if ((*it)->container == container)
+                    busy = true;
+            }
+            if (!busy)
+                break;
+            cond.wait(&mutex);
+        }
+
+        for (std::list<Job *>::iterator it = done.begin(); it != done.end();)
+        {
+            if ((*it)->container == container)
+            {
+                inFlight -= (*it)->bytes;
+                dropped.push_back(*it);
+                it = done.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        cond.broadcast();
+    }
+
+    for (std::list<Job *>::iterator it = dropped.begin(); it != dropped.end(); ++it)
+        discard(*it);
+}
+
+int coVRGeometryConverter::numPending() const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    return (int)(queued.size() + running.size() + done.size());
+}
+
+int coVRGeometryConverter::numPending(const std::string &container) const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mutex);
+    const std::list<Job *> *lists[] = { &queued, &running, &done };
+    int n = 0;
+    for (int l = 0; l < 3; l++)
+    {
+        for (std::list<Job *>::const_iterator it = lists[l]->begin(); it != lists[l]->end(); ++it)
+        {
+            if ((*it)->container == container)
+                ++n;
+        }
+    }
+    return n;
+}
+
+void coVRGeometryConverter::discard(Job *job)
+{
+    for (size_t i = 0; i < job->owned.size(); i++)
+        delete job->owned[i];
+    delete job;
+}
@@ -0,0 +1,101 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COVRGEOMETRYCONVERTER_H
+#define COVRGEOMETRYCONVERTER_H
+
+/*! \file
+ \brief  build scene graph nodes for COVISE set elements in background threads
+
+ Set elements are replaced by empty groups in the scene graph at once, their
+ geometry is built by worker threads and attached to these groups from the
+ render thread, so that large transient sets are displayed progressively
+ instead of blocking the session until all elements are converted.
+ */
+
+#include <OpenThreads/Thread>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
+#include <osg/Group>
+#include <osg/ref_ptr>
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <list>
+
+namespace opencover
+{
+
+class RenderObject;
+
+class coVRGeometryConverter
+{
+public:
+    typedef std::function<osg::Node *()> Builder;
+
+    struct Job
+    {
+        std::string container; // name of the object the element belongs to
+        osg::ref_ptr<osg::Group> placeholder; // the built node is added here
+        size_t bytes; // estimated size of the built node
+        Builder build; // called in a worker thread
+        std::vector<RenderObject *> owned; // deleted after attaching
+        osg::ref_ptr<osg::Node> result;
+
+        Job()
+            : bytes(0)
+        {
+        }
+    };
+
+    coVRGeometryConverter();
+    ~coVRGeometryConverter();
+
+    /// true if elements should be converted in background threads
+    bool isEnabled() const;
+
+    /// hand job over to the worker threads
+    void submit(Job *job);
+
+    /// add finished nodes to their placeholders, called once per frame
+    int attach();
+
+    /// forget all jobs of container, waits for the ones being built
+    void cancel(const std::string &container);
+
+    /// number of jobs not yet attached
+    int numPending() const;
+    /// number of jobs of container not yet attached
+    int numPending(const std::string &container) const;
+
+private:
+    class Worker : public OpenThreads::Thread
+    {
+    public:
+        Worker(coVRGeometryConverter *converter);
+        virtual void run();
+
+    private:
+        coVRGeometryConverter *converter;
+    };
+
+    void work();
+    void discard(Job *job);
+
+    bool enabled;
+    size_t budget; // bytes of nodes built but not yet attached
+    std::vector<Worker *> workers;
+
+    mutable OpenThreads::Mutex mutex;
+    OpenThreads::Condition cond;
+    bool quit;
+    size_t inFlight; // bytes of jobs running or waiting to be attached
+    std::list<Job *> queued, running, done;
+};
+}
+#endif
@@ -51,6 +51,7 @@
 #include <osg/ColorMask>
 #include <osg/PolygonOffset>
 #include <osgUtil/TriStripVisitor>
+#include <osgUtil/MeshOptimizers>
 #include <cover/coVRFileManager.h>
 #include "VRCoviseGeometryManager.h"
 #include <cover/coVRLighting.h>
@@ -84,13 +85,23 @@ GeometryManager::GeometryManager()
 {
     backfaceCulling = coCoviseConfig::isOn("COVER.BackfaceCulling", false);
 
-    d_stripper = new osgUtil::TriStripVisitor;
     genStrips = coCoviseConfig::isOn("COVER.GenStrips", false);
+    indexedGeometry = coCoviseConfig::isOn("COVER.IndexedGeometry", true);
+    optimizeVertexCache = coCoviseConfig::isOn("COVER.OptimizeVertexCache", false);
 
     float r = coCoviseConfig::getFloat("r", "COVER.CoviseGeometryDefaultColor", 1.0f);
     float g = coCoviseConfig::getFloat("g", "COVER.CoviseGeometryDefaultColor", 1.0f);
     float b = coCoviseConfig::getFloat("b", "COVER.CoviseGeometryDefaultColor", 1.0f);
     coviseGeometryDefaultColor = osg::Vec4(r, g, b, 1.0f);
+
+    // created here, as geometry may be built in several threads
+    globalDefaultMaterial = new osg::Material;
+    globalDefaultMaterial->setColorMode(osg::Material::AMBIENT_AND_DIFFUSE);
+    globalDefaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0));
+    globalDefaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0));
+    globalDefaultMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.4f, 0.4f, 0.4f, 1.0));
+    globalDefaultMaterial->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(0.0f, 0.0f, 0.0f, 1.0));
+    globalDefaultMaterial->setShininess(osg::Material::FRONT_AND_BACK, 16.0f);
 }
 GeometryManager::~GeometryManager()
 {
@@ -677,17 +688,6 @@ GeometryManager::addSGrid(const char *object,
 
 void GeometryManager::setDefaultMaterial(osg::StateSet *geoState, bool transparent, coMaterial *material, bool isLightingOn)
 {
-    if (globalDefaultMaterial.get() == NULL)
-    {
-        globalDefaultMaterial = new osg::Material;
-        globalDefaultMaterial->setColorMode(osg::Material::AMBIENT_AND_DIFFUSE);
-        globalDefaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0));
-        globalDefaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0));
-        globalDefaultMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.4f, 0.4f, 0.4f, 1.0));
-        globalDefaultMaterial->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(0.0f, 0.0f, 0.0f, 1.0));
-        globalDefaultMaterial->setShininess(osg::Material::FRONT_AND_BACK, 16.0f);
-    }
-
     if (material)
     {
         osg::Material *mymtl = new osg::Material;
@@ -727,28 +727,123 @@ void GeometryManager::setDefaultMaterial(osg::StateSet *geoState, bool transpare
     }
 }
 //--------------------------------------------------------------------------------------
-// create a new geode contraining polygons and add it to the scene
+// create a new geode containing polygons, triangles or quads
 //--------------------------------------------------------------------------------------
 
+// number of corners of polygon i: from the index list i_l or, if it is NULL,
+// fixed to corners
+static inline int numCorners(int i, int no_of_polygons, int no_of_vertices, const int *i_l, int corners)
+{
+    if (!i_l)
+        return corners;
+    if (i == no_of_polygons - 1)
+        return no_of_vertices - i_l[i];
+    return i_l[i + 1] - i_l[i];
+}
+
+// normal of a polygon with numv corners: general polygons skip degenerate
+// edges, triangles and quads use their first two edges
+static osg::Vec3 polygonNormal(const int *corner, int numv, bool general,
+                               const float *x_c, const float *y_c, const float *z_c)
+{
+    int v = corner[0];
+    osg::Vec3 p0 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+    v = corner[1];
+    osg::Vec3 p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+    if (!general)
+    {
+        v = corner[2];
+        osg::Vec3 p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+        osg::Vec3 vn = (p1 - p0) ^ (p2 - p1);
+        vn.normalize();
+        return vn;
+    }
+
+    osg::Vec3 v1 = p1 - p0;
+    int vert = 2;
+    while (v1.length2() < 1E-16 && vert < numv - 1)
+    {
+        v = corner[vert];
+        p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+        v1 = p1 - p0;
+        vert++;
+    }
+    v = corner[vert];
+    osg::Vec3 p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+    osg::Vec3 v2 = p2 - p0;
+    while (v2.length2() < 1E-16 && vert < numv)
+    {
+        v = corner[vert];
+        p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+        v2 = p2 - p0;
+        vert++;
+    }
+    v1.normalize();
+    v2.normalize();
+    osg::Vec3 vn = v1 ^ v2;
+    while (vn.length2() < 1E-2 && vert < numv)
+    {
+        v = corner[vert];
+        p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
+        v2 = p2 - p0;
+        vert++;
+        if (v2.length2() < 1E-16 && vert < numv)
+        {
+            continue;
+        }
+        v2.normalize();
+        vn = v1 ^ v2;
+    }
+    vn.normalize();
+    return vn;
+}
+
+// Polygons are given by i_l, triangles and quads by corners and a NULL i_l.
+// If colors, normals, texture coordinates and vertex attributes are given
+// per coordinate or for the whole object, the coordinate list is used as
+// vertex array as it is and the polygons are split into fans of triangles
+// in one index list. Otherwise the coordinates and attributes of every
+// corner are copied, as per face bindings and the normals made up per
+// polygon without normals require separate corners.
 osg::Node *
-GeometryManager::addPolygon(const char *object_name,
-                            int no_of_polygons, int no_of_vertices, int no_of_coords,
+GeometryManager::addSurface(const char *object_name,
+                            int no_of_polygons, int corners, int no_of_vertices, int no_of_coords,
                             float *x_c, float *y_c, float *z_c,
                             int *v_l, int *i_l,
                             int no_of_colors, int colorbinding, int colorpacking,
                             float *r, float *g, float *b, int *pc,
                             int no_of_normals, int normalbinding,
                             float *nx, float *ny, float *nz,
-                            float &transparency, int, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
+                            float &transparency, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
                             int no_of_texCoords, float *tx, float *ty, osg::Texture::WrapMode wm, osg::Texture::FilterMode minfm, osg::Texture::FilterMode magfm,
                             int no_of_vertexAttributes,
-                            float *vax, float *vay, float *vaz, bool cullBackfaces)
+                            float *vax, float *vay, float *vaz, bool cullBackfaces, bool isLightingOn)
 {
-    if ((no_of_polygons == 0) || (no_of_coords == 0) || (no_of_vertices == 0))
+    // material should overwrite object colors, so ignore them if a material is present
+    bool useColors = no_of_colors && material == NULL && image == NULL;
+
+    bool shared = indexedGeometry;
+    if (useColors && !(colorbinding == Bind::OverAll || (colorbinding == Bind::PerVertex && no_of_colors >= no_of_coords)))
+        shared = false;
+    if (!(normalbinding == Bind::OverAll && no_of_normals > 0)
+        && !(normalbinding == Bind::PerVertex && no_of_normals >= no_of_coords))
+        shared = false;
+    if (no_of_texCoords && no_of_texCoords < no_of_coords)
+        shared = false;
+    if (no_of_vertexAttributes > 0 && no_of_vertexAttributes < no_of_coords)
+        shared = false;
+
+    int no_of_indices = 0;
+    if (shared)
     {
-        osg::Group *g = new osg::Group(); // add a dummy object so that we don`t have missing timesteps if object is empty
-        g->setName(object_name);
-        return g;
+        for (int i = 0; i < no_of_polygons; i++)
+        {
+            int numv = numCorners(i, no_of_polygons, no_of_vertices, i_l, corners);
+            if (numv >= 3)
+                no_of_indices += 3 * (numv - 2);
+        }
+        if (no_of_indices == 0)
+            shared = false;
     }
 
     osg::Geode *geode = new osg::Geode();
@@ -757,66 +852,81 @@ GeometryManager::addPolygon(const char *object_name,
     geom->setUseDisplayList(coVRConfig::instance()->useDisplayLists());
     geom->setUseVertexBufferObjects(coVRConfig::instance()->useVBOs());
 
-    // set up geometry
-    int numv;
-    osg::Vec3Array *vert = new osg::Vec3Array;
-    osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::POLYGON);
-    for (int i = 0; i < no_of_polygons; i++)
+    // set up geometry: vertex v is coordinate index[v] or, if index is NULL, v
+    const int *index = NULL;
+    int no_of_points = no_of_coords;
+    if (shared)
     {
-        if (i == no_of_polygons - 1)
-            numv = no_of_vertices - i_l[i];
-        else
-            numv = i_l[i + 1] - i_l[i];
-        primitives->push_back(numv);
-        for (int n = 0; n < numv; n++)
+        osg::DrawElementsUInt *primitives = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES, no_of_indices);
+        int idx = 0;
+        for (int i = 0; i < no_of_polygons; i++)
         {
-            int v = v_l[i_l[i] + n];
-            vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
+            int numv = numCorners(i, no_of_polygons, no_of_vertices, i_l, corners);
+            const int *corner = v_l + (i_l ? i_l[i] : corners * i);
+            for (int n = 2; n < numv; n++)
+            {
+                (*primitives)[idx++] = corner[0];
+                (*primitives)[idx++] = corner[n - 1];
+                (*primitives)[idx++] = corner[n];
+            }
         }
+        geom->addPrimitiveSet(primitives);
+    }
+    else if (i_l)
+    {
+        // the corners of the polygons follow each other in the vertex list
+        index = v_l + i_l[0];
+        no_of_points = no_of_vertices - i_l[0];
+        osg::DrawArrayLengths *primitives = new osg::DrawArrayLengths(osg::PrimitiveSet::POLYGON);
+        primitives->reserve(no_of_polygons);
+        for (int i = 0; i < no_of_polygons; i++)
+            primitives->push_back(numCorners(i, no_of_polygons, no_of_vertices, i_l, corners));
+        geom->addPrimitiveSet(primitives);
+    }
+    else
+    {
+        index = v_l;
+        no_of_points = corners * no_of_polygons;
+        geom->addPrimitiveSet(new osg::DrawArrays(corners == 3 ? osg::PrimitiveSet::TRIANGLES : osg::PrimitiveSet::QUADS, 0, no_of_points));
+    }
+
+    osg::Vec3Array *vert = new osg::Vec3Array(no_of_points);
+    for (int v = 0; v < no_of_points; v++)
+    {
+        int c = index ? index[v] : v;
+        (*vert)[v].set(x_c[c], y_c[c], z_c[c]);
     }
     geom->setVertexArray(vert);
-    geom->addPrimitiveSet(primitives);
 
     // associate colors
     bool transparent = false;
-    if (no_of_colors && material == NULL && image == NULL) // material should overwrite object colors, so ignore them if a material is present
+    if (useColors)
     {
-
         switch (colorbinding)
         {
         case Bind::PerVertex:
         {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-
-            for (int i = 0; i < no_of_polygons; i++)
+            osg::Vec4Array *colArr = new osg::Vec4Array(no_of_points);
+            for (int v = 0; v < no_of_points; v++)
             {
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int n = 0; n < numv; n++)
+                int c = index ? index[v] : v;
+                if (colorpacking == Pack::RGBA)
                 {
-                    int v = v_l[i_l[i] + n];
-                    if (colorpacking == Pack::RGBA)
-                    {
-                        float r, g, b, a;
-                        unpackRGBA(pc, v, &r, &g, &b, &a);
-                        if (a < 1.0)
-                        {
-                            transparent = true;
-                        }
-                        colArr->push_back(osg::Vec4(r, g, b, a));
-                    }
-                    else
+                    float r, g, b, a;
+                    unpackRGBA(pc, c, &r, &g, &b, &a);
+                    if (a < 1.0)
                     {
-                        if (transparency > 0.f)
-                            transparent = true;
-                        colArr->push_back(osg::Vec4(r[v], g ? g[v] : r[v], b ? b[v] : r[v], 1.0f - transparency));
+                        transparent = true;
                     }
+                    (*colArr)[v].set(r, g, b, a);
+                }
+                else
+                {
+                    (*colArr)[v].set(r[c], g ? g[c] : r[c], b ? b[c] : r[c], 1.0f - transparency);
                 }
             }
+            if (colorpacking != Pack::RGBA && transparency > 0.f)
+                transparent = true;
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
         }
@@ -824,9 +934,9 @@ GeometryManager::addPolygon(const char *object_name,
 
         case Bind::OverAll:
         {
+            osg::Vec4Array *colArr = new osg::Vec4Array();
             if (colorpacking == Pack::RGBA)
             {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
                 float r, g, b, a;
                 unpackRGBA(pc, 0, &r, &g, &b, &a);
                 if (a < 1.0)
@@ -834,17 +944,14 @@ GeometryManager::addPolygon(const char *object_name,
                     transparent = true;
                 }
                 colArr->push_back(osg::Vec4(r, g, b, a));
-
-                geom->setColorArray(colArr);
             }
             else
             {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
                 if (transparency > 0.f)
                     transparent = true;
                 colArr->push_back(osg::Vec4(r[0], g ? g[0] : r[0], b ? b[0] : r[0], 1.0f - transparency));
-                geom->setColorArray(colArr);
             }
+            geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_OVERALL);
         }
         break;
@@ -852,9 +959,11 @@ GeometryManager::addPolygon(const char *object_name,
         case Bind::PerFace:
         {
             osg::Vec4Array *colArr = new osg::Vec4Array();
-            if (colorpacking == Pack::RGBA)
+            colArr->reserve(no_of_points);
+            for (int i = 0; i < no_of_polygons; i++)
             {
-                for (int i = 0; i < no_of_polygons; i++)
+                osg::Vec4 color;
+                if (colorpacking == Pack::RGBA)
                 {
                     float r, g, b, a;
                     unpackRGBA(pc, i, &r, &g, &b, &a);
@@ -862,30 +971,17 @@ GeometryManager::addPolygon(const char *object_name,
                     {
                         transparent = true;
                     }
-                    int numv;
-                    if (i == no_of_polygons - 1)
-                        numv = no_of_vertices - i_l[i];
-                    else
-                        numv = i_l[i + 1] - i_l[i];
-                    for (int j = 0; j < numv; ++j)
-                        colArr->push_back(osg::Vec4(r, g, b, a));
+                    color.set(r, g, b, a);
                 }
-            }
-            else
-            {
-                for (int i = 0; i < no_of_polygons; i++)
+                else
                 {
                     if (transparency > 0.f)
                         transparent = true;
-
-                    int numv;
-                    if (i == no_of_polygons - 1)
-                        numv = no_of_vertices - i_l[i];
-                    else
-                        numv = i_l[i + 1] - i_l[i];
-                    for (int j = 0; j < numv; ++j)
-                        colArr->push_back(osg::Vec4(r[i], g ? g[i] : r[i], b ? b[i] : r[i], 1.0f - transparency));
+                    color.set(r[i], g ? g[i] : r[i], b ? b[i] : r[i], 1.0f - transparency);
                 }
+                int numv = numCorners(i, no_of_polygons, no_of_vertices, i_l, corners);
+                for (int j = 0; j < numv; ++j)
+                    colArr->push_back(color);
             }
             geom->setColorArray(colArr);
             geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
@@ -893,20 +989,17 @@ GeometryManager::addPolygon(const char *object_name,
         break;
         }
     }
+    else if (material != NULL)
+    {
+        geom->setColorBinding(osg::Geometry::BIND_OFF);
+    }
     else
     {
-        if (material != NULL)
-        {
-            geom->setColorBinding(osg::Geometry::BIND_OFF);
-        }
-        else
-        {
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            colArr->push_back(coviseGeometryDefaultColor);
+        osg::Vec4Array *colArr = new osg::Vec4Array();
+        colArr->push_back(coviseGeometryDefaultColor);
 
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-        }
+        geom->setColorArray(colArr);
+        geom->setColorBinding(osg::Geometry::BIND_OVERALL);
     }
 
     if (no_of_normals)
@@ -915,23 +1008,12 @@ GeometryManager::addPolygon(const char *object_name,
         {
         case Bind::PerVertex:
         {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-
-            for (int i = 0; i < no_of_polygons; i++)
+            osg::Vec3Array *normalArray = new osg::Vec3Array(no_of_points);
+            for (int v = 0; v < no_of_points; v++)
             {
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
-                for (int n = 0; n < numv; n++)
-                {
-                    int v = v_l[i_l[i] + n];
-                    osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
+                int c = index ? index[v] : v;
+                (*normalArray)[v].set(nx[c], ny[c], nz[c]);
+                (*normalArray)[v].normalize();
             }
             geom->setNormalArray(normalArray);
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
@@ -953,19 +1035,15 @@ GeometryManager::addPolygon(const char *object_name,
         case Bind::PerFace:
         {
             osg::Vec3Array *normalArray = new osg::Vec3Array();
+            normalArray->reserve(no_of_points);
             for (int i = 0; i < no_of_polygons; i++)
             {
                 osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
                 n.normalize();
 
-                if (i == no_of_polygons - 1)
-                    numv = no_of_vertices - i_l[i];
-                else
-                    numv = i_l[i + 1] - i_l[i];
+                int numv = numCorners(i, no_of_polygons, no_of_vertices, i_l, corners);
                 for (int j = 0; j < numv; ++j)
-                {
                     normalArray->push_back(n);
-                }
             }
             geom->setNormalArray(normalArray);
             geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
@@ -976,59 +1054,16 @@ GeometryManager::addPolygon(const char *object_name,
     else
     {
         osg::Vec3Array *normalArray = new osg::Vec3Array();
+        normalArray->reserve(no_of_points);
 
         // create one normal per polygon and use it for all vertices
         for (int i = 0; i < no_of_polygons; i++)
         {
-            if (i == no_of_polygons - 1)
-                numv = no_of_vertices - i_l[i];
-            else
-                numv = i_l[i + 1] - i_l[i];
-
-            int v = v_l[i_l[i] + 0];
-            osg::Vec3 p0 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            v = v_l[i_l[i] + 1];
-            osg::Vec3 p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            osg::Vec3 v1 = p1 - p0;
-            int vert = 2;
-            while (v1.length2() < 1E-16 && vert < numv - 1)
-            {
-                v = v_l[i_l[i] + vert];
-                p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-                v1 = p1 - p0;
-                vert++;
-            }
-            v = v_l[i_l[i] + vert];
-            osg::Vec3 p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            osg::Vec3 v2 = p2 - p0;
-            while (v2.length2() < 1E-16 && vert < numv)
-            {
-                v = v_l[i_l[i] + vert];
-                p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-                v2 = p2 - p0;
-                vert++;
-            }
-            v1.normalize();
-            v2.normalize();
-            osg::Vec3 vn = v1 ^ v2;
-            while (vn.length2() < 1E-2 && vert < numv)
-            {
-                v = v_l[i_l[i] + vert];
-                p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-                v2 = p2 - p0;
-                vert++;
-                if (v2.length2() < 1E-16 && vert < numv)
-                {
-                    continue;
-                }
-                v2.normalize();
-                vn = v1 ^ v2;
-            }
-            vn.normalize();
+            int numv = numCorners(i, no_of_polygons, no_of_vertices, i_l, corners);
+            const int *corner = v_l + (i_l ? i_l[i] : corners * i);
+            osg::Vec3 vn = polygonNormal(corner, numv, i_l != NULL, x_c, y_c, z_c);
             for (int n = 0; n < numv; n++)
-            {
                 normalArray->push_back(vn);
-            }
         }
 
         geom->setNormalArray(normalArray);
@@ -1037,19 +1072,11 @@ GeometryManager::addPolygon(const char *object_name,
 
     if (no_of_texCoords)
     {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-
-        for (int i = 0; i < no_of_polygons; i++)
+        osg::Vec2Array *tcArray = new osg::Vec2Array(no_of_points);
+        for (int v = 0; v < no_of_points; v++)
         {
-            if (i == no_of_polygons - 1)
-                numv = no_of_vertices - i_l[i];
-            else
-                numv = i_l[i + 1] - i_l[i];
-            for (int n = 0; n < numv; n++)
-            {
-                int v = v_l[i_l[i] + n];
-                tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-            }
+            int c = index ? index[v] : v;
+            (*tcArray)[v].set(tx[c], ty[c]);
         }
         geom->setTexCoordArray(0, tcArray);
     }
@@ -1058,27 +1085,19 @@ GeometryManager::addPolygon(const char *object_name,
 
     if (no_of_vertexAttributes > 0)
     {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
-        for (int i = 0; i < no_of_polygons; i++)
+        osg::Vec3Array *vertArray = new osg::Vec3Array(no_of_points);
+        for (int v = 0; v < no_of_points; v++)
         {
-            if (i == no_of_polygons - 1)
-                numv = no_of_vertices - i_l[i];
-            else
-                numv = i_l[i + 1] - i_l[i];
-            for (int n = 0; n < numv; n++)
-            {
-                int v = v_l[i_l[i] + n];
-                vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-            }
+            int c = index ? index[v] : v;
+            (*vertArray)[v].set(vax[c], vay[c], vaz[c]);
         }
         geom->setVertexAttribArray(6, vertArray);
     }
-    // geoState->setGlobalDefaults();
 
     if (pixelSize == 4)
         transparent = true;
 
-    setDefaultMaterial(geoState, transparent, material);
+    setDefaultMaterial(geoState, transparent, material, isLightingOn);
 
     if (backfaceCulling || cullBackfaces) // backfaceCulling nur dann, wenn es im CoviseConfig enabled ist
     {
@@ -1095,7 +1114,6 @@ GeometryManager::addPolygon(const char *object_name,
     geoState->setAttributeAndModes(blendFunc, osg::StateAttribute::ON);
     osg::AlphaFunc *alphaFunc = new osg::AlphaFunc();
     alphaFunc->setFunction(osg::AlphaFunc::ALWAYS, 1.0);
-    //blendFunc->setFunction(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA);
     geoState->setAttributeAndModes(alphaFunc, osg::StateAttribute::OFF);
 
     setTexture(image, pixelSize, texWidth, texHeight, geoState, wm, minfm, magfm);
@@ -1104,7 +1122,15 @@ GeometryManager::addPolygon(const char *object_name,
 
     if (genStrips)
     {
-        d_stripper->stripify(*geom);
+        // one visitor per geometry, as geometry may be built in several threads
+        osgUtil::TriStripVisitor stripper;
+        stripper.stripify(*geom);
+    }
+    else if (shared && optimizeVertexCache)
+    {
+        // reorder the triangles for the post-transform vertex cache
+        osgUtil::VertexCacheVisitor cacheOptimizer;
+        cacheOptimizer.optimizeVertices(*geom);
     }
 
     geode->addDrawable(geom);
@@ -1112,6 +1138,40 @@ GeometryManager::addPolygon(const char *object_name,
     return ((osg::Node *)geode);
 }
 
+//--------------------------------------------------------------------------------------
+// create a new geode contraining polygons and add it to the scene
+//--------------------------------------------------------------------------------------
+
+osg::Node *
+GeometryManager::addPolygon(const char *object_name,
+                            int no_of_polygons, int no_of_vertices, int no_of_coords,
+                            float *x_c, float *y_c, float *z_c,
+                            int *v_l, int *i_l,
+                            int no_of_colors, int colorbinding, int colorpacking,
+                            float *r, float *g, float *b, int *pc,
+                            int no_of_normals, int normalbinding,
+                            float *nx, float *ny, float *nz,
+                            float &transparency, int, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
+                            int no_of_texCoords, float *tx, float *ty, osg::Texture::WrapMode wm, osg::Texture::FilterMode minfm, osg::Texture::FilterMode magfm,
+                            int no_of_vertexAttributes,
+                            float *vax, float *vay, float *vaz, bool cullBackfaces)
+{
+    if ((no_of_polygons == 0) || (no_of_coords == 0) || (no_of_vertices == 0))
+    {
+        osg::Group *g = new osg::Group(); // add a dummy object so that we don`t have missing timesteps if object is empty
+        g->setName(object_name);
+        return g;
+    }
+
+    return addSurface(object_name, no_of_polygons, 0, no_of_vertices, no_of_coords,
+                      x_c, y_c, z_c, v_l, i_l,
+                      no_of_colors, colorbinding, colorpacking, r, g, b, pc,
+                      no_of_normals, normalbinding, nx, ny, nz,
+                      transparency, material, texWidth, texHeight, pixelSize, image,
+                      no_of_texCoords, tx, ty, wm, minfm, magfm,
+                      no_of_vertexAttributes, vax, vay, vaz, cullBackfaces, true);
+}
+
 //--------------------------------------------------------------------------------------
 // create a new geode contraining triangles
 //--------------------------------------------------------------------------------------
@@ -1138,620 +1198,48 @@ GeometryManager::addTriangles(const char *object_name,
         return g;
     }
 
-    osg::Geode *geode = new osg::Geode();
-    geode->setName(object_name);
-    osg::Geometry *geom = new osg::Geometry();
-    geom->setUseDisplayList(coVRConfig::instance()->useDisplayLists());
-    geom->setUseVertexBufferObjects(coVRConfig::instance()->useVBOs());
+    return addSurface(object_name, no_of_triangles, 3, no_of_vertices, no_of_coords,
+                      x_c, y_c, z_c, v_l, NULL,
+                      no_of_colors, colorbinding, colorpacking, r, g, b, pc,
+                      no_of_normals, normalbinding, nx, ny, nz,
+                      transparency, material, texWidth, texHeight, pixelSize, image,
+                      no_of_texCoords, tx, ty, wm, minfm, magfm,
+                      no_of_vertexAttributes, vax, vay, vaz, cullBackfaces, true);
+}
 
-    // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
-    osg::DrawArrays *primitives = new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, no_of_vertices);
-    int vn = 0;
-    for (int i = 0; i < no_of_triangles; i++)
-    {
-        for (int n = 0; n < 3; n++)
-        {
-            int v = v_l[vn];
-            vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-            vn++;
-        }
-    }
-    geom->setVertexArray(vert);
-    geom->addPrimitiveSet(primitives);
+//--------------------------------------------------------------------------------------
+// create a new geode contraining quads
+//--------------------------------------------------------------------------------------
 
-    // associate colors
-    bool transparent = false;
-    if (no_of_colors && material == NULL && image == NULL) // material should overwrite object colors, so ignore them if a material is present
+osg::Node *
+GeometryManager::addQuads(const char *object_name,
+                          int no_of_vertices, int no_of_coords,
+                          float *x_c, float *y_c, float *z_c,
+                          int *v_l,
+                          int no_of_colors, int colorbinding, int colorpacking,
+                          float *r, float *g, float *b, int *pc,
+                          int no_of_normals, int normalbinding,
+                          float *nx, float *ny, float *nz,
+                          float &transparency, int, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
+                          int no_of_texCoords, float *tx, float *ty, osg::Texture::WrapMode wm, osg::Texture::FilterMode minfm, osg::Texture::FilterMode magfm,
+                          int no_of_vertexAttributes,
+                          float *vax, float *vay, float *vaz, bool cullBackfaces)
+{
+    int no_of_quads = no_of_vertices / 4;
+    if ((no_of_quads == 0) || (no_of_coords == 0) || (no_of_vertices == 0))
     {
+        osg::Group *g = new osg::Group(); // add a dummy object so that we don`t have missing timesteps if object is empty
+        g->setName(object_name);
+        return g;
+    }
 
-        switch (colorbinding)
-        {
-        case Bind::PerVertex:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            vn = 0;
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                for (int n = 0; n < 3; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    if (colorpacking == Pack::RGBA)
-                    {
-                        float r, g, b, a;
-                        unpackRGBA(pc, v, &r, &g, &b, &a);
-                        if (a < 1.0)
-                        {
-                            transparent = true;
-                        }
-                        colArr->push_back(osg::Vec4(r, g, b, a));
-                    }
-                    else
-                    {
-                        if (transparency > 0.f)
-                            transparent = true;
-                        colArr->push_back(osg::Vec4(r[v], g ? g[v] : r[v], b ? b[v] : r[v], 1.0f - transparency));
-                    }
-                }
-            }
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-
-        case Bind::OverAll:
-        {
-            if (colorpacking == Pack::RGBA)
-            {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-                float r, g, b, a;
-                unpackRGBA(pc, 0, &r, &g, &b, &a);
-                if (a < 1.0)
-                {
-                    transparent = true;
-                }
-                colArr->push_back(osg::Vec4(r, g, b, a));
-
-                geom->setColorArray(colArr);
-            }
-            else
-            {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-                if (transparency > 0.f)
-                    transparent = true;
-                colArr->push_back(osg::Vec4(r[0], g ? g[0] : r[0], b ? b[0] : r[0], 1.0f - transparency));
-                geom->setColorArray(colArr);
-            }
-            geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-        }
-        break;
-
-        case Bind::PerFace:
-        {
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            if (colorpacking == Pack::RGBA)
-            {
-                for (int i = 0; i < no_of_triangles; i++)
-                {
-                    float r, g, b, a;
-                    unpackRGBA(pc, i, &r, &g, &b, &a);
-                    if (a < 1.0)
-                    {
-                        transparent = true;
-                    }
-                    for (int j = 0; j < 3; ++j)
-                        colArr->push_back(osg::Vec4(r, g, b, a));
-                }
-            }
-            else
-            {
-                for (int i = 0; i < no_of_triangles; i++)
-                {
-                    if (transparency > 0.f)
-                        transparent = true;
-
-                    for (int j = 0; j < 3; ++j)
-                        colArr->push_back(osg::Vec4(r[i], g ? g[i] : r[i], b ? b[i] : r[i], 1.0f - transparency));
-                }
-            }
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-        }
-    }
-    else
-    {
-        if (material != NULL)
-        {
-            geom->setColorBinding(osg::Geometry::BIND_OFF);
-        }
-        else
-        {
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            colArr->push_back(coviseGeometryDefaultColor);
-
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-        }
-    }
-
-    if (no_of_normals)
-    {
-        switch (normalbinding)
-        {
-        case Bind::PerVertex:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            vn = 0;
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                for (int n = 0; n < 3; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
-            }
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-
-        case Bind::OverAll:
-        {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-
-            osg::Vec3 n = osg::Vec3(nx[0], ny[0], nz[0]);
-            n.normalize();
-            normalArray->push_back(n);
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_OVERALL);
-        }
-        break;
-
-        case Bind::PerFace:
-        {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            for (int i = 0; i < no_of_triangles; i++)
-            {
-                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
-                n.normalize();
-
-                for (int j = 0; j < 3; ++j)
-                    normalArray->push_back(n);
-            }
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-        }
-    }
-    else
-    {
-        osg::Vec3Array *normalArray = new osg::Vec3Array();
-        vn = 0;
-        for (int i = 0; i < no_of_triangles; i++)
-        {
-            int v = v_l[vn];
-            vn++;
-            osg::Vec3 p0 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            v = v_l[vn];
-            vn++;
-            osg::Vec3 p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            v = v_l[vn];
-            vn++;
-            osg::Vec3 p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            osg::Vec3 v1 = p1 - p0;
-            osg::Vec3 v2 = p2 - p1;
-            osg::Vec3 vn = v1 ^ v2;
-            vn.normalize();
-            for (int j = 0; j < 3; ++j)
-                normalArray->push_back(vn);
-        }
-        geom->setNormalArray(normalArray);
-        geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-    }
-
-    if (no_of_texCoords)
-    {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-        vn = 0;
-        for (int i = 0; i < no_of_triangles; i++)
-        {
-            for (int n = 0; n < 3; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-            }
-        }
-        geom->setTexCoordArray(0, tcArray);
-    }
-
-    osg::StateSet *geoState = geode->getOrCreateStateSet();
-
-    if (no_of_vertexAttributes > 0)
-    {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
-        vn = 0;
-        for (int i = 0; i < no_of_triangles; i++)
-        {
-            for (int n = 0; n < 3; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-            }
-        }
-        geom->setVertexAttribArray(6, vertArray);
-    }
-    // geoState->setGlobalDefaults();
-    if (pixelSize == 4)
-        transparent = true;
-    setDefaultMaterial(geoState, transparent, material);
-
-    if (backfaceCulling || cullBackfaces) // backfaceCulling nur dann, wenn es im CoviseConfig enabled ist
-    {
-        osg::CullFace *cullFace = new osg::CullFace();
-        cullFace->setMode(osg::CullFace::BACK);
-        geoState->setAttributeAndModes(cullFace, osg::StateAttribute::ON);
-    }
-
-    osg::PolygonOffset *po = new osg::PolygonOffset(1., 1.);
-    geoState->setAttributeAndModes(po, osg::StateAttribute::ON);
-
-    osg::BlendFunc *blendFunc = new osg::BlendFunc();
-    blendFunc->setFunction(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA);
-    geoState->setAttributeAndModes(blendFunc, osg::StateAttribute::ON);
-    osg::AlphaFunc *alphaFunc = new osg::AlphaFunc();
-    alphaFunc->setFunction(osg::AlphaFunc::ALWAYS, 1.0);
-    //blendFunc->setFunction(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA);
-    geoState->setAttributeAndModes(alphaFunc, osg::StateAttribute::OFF);
-
-    setTexture(image, pixelSize, texWidth, texHeight, geoState, wm, minfm, magfm);
-
-    geode->setStateSet(geoState);
-
-    if (genStrips)
-    {
-        d_stripper->stripify(*geom);
-    }
-
-    geode->addDrawable(geom);
-
-    return ((osg::Node *)geode);
-}
-
-//--------------------------------------------------------------------------------------
-// create a new geode contraining quads
-//--------------------------------------------------------------------------------------
-
-osg::Node *
-GeometryManager::addQuads(const char *object_name,
-                          int no_of_vertices, int no_of_coords,
-                          float *x_c, float *y_c, float *z_c,
-                          int *v_l,
-                          int no_of_colors, int colorbinding, int colorpacking,
-                          float *r, float *g, float *b, int *pc,
-                          int no_of_normals, int normalbinding,
-                          float *nx, float *ny, float *nz,
-                          float &transparency, int, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
-                          int no_of_texCoords, float *tx, float *ty, osg::Texture::WrapMode wm, osg::Texture::FilterMode minfm, osg::Texture::FilterMode magfm,
-                          int no_of_vertexAttributes,
-                          float *vax, float *vay, float *vaz, bool cullBackfaces)
-{
-    int no_of_quads = no_of_vertices / 4;
-    if ((no_of_quads == 0) || (no_of_coords == 0) || (no_of_vertices == 0))
-    {
-        osg::Group *g = new osg::Group(); // add a dummy object so that we don`t have missing timesteps if object is empty
-        g->setName(object_name);
-        return g;
-    }
-
-    osg::Geode *geode = new osg::Geode();
-    geode->setName(object_name);
-    osg::Geometry *geom = new osg::Geometry();
-    geom->setUseDisplayList(coVRConfig::instance()->useDisplayLists());
-    geom->setUseVertexBufferObjects(coVRConfig::instance()->useVBOs());
-
-    // set up geometry
-    osg::Vec3Array *vert = new osg::Vec3Array;
-    osg::DrawArrays *primitives = new osg::DrawArrays(osg::PrimitiveSet::QUADS, 0, no_of_vertices);
-    int vn = 0;
-    for (int i = 0; i < no_of_quads; i++)
-    {
-        for (int n = 0; n < 4; n++)
-        {
-            int v = v_l[vn];
-            vert->push_back(osg::Vec3(x_c[v], y_c[v], z_c[v]));
-            vn++;
-        }
-    }
-    geom->setVertexArray(vert);
-    geom->addPrimitiveSet(primitives);
-
-    // associate colors
-    bool transparent = false;
-    if (no_of_colors && material == NULL && image == NULL) // material should overwrite object colors, so ignore them if a material is present
-    {
-
-        switch (colorbinding)
-        {
-        case Bind::PerVertex:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            vn = 0;
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    if (colorpacking == Pack::RGBA)
-                    {
-                        float r, g, b, a;
-                        unpackRGBA(pc, v, &r, &g, &b, &a);
-                        if (a < 1.0)
-                        {
-                            transparent = true;
-                        }
-                        colArr->push_back(osg::Vec4(r, g, b, a));
-                    }
-                    else
-                    {
-                        if (transparency > 0.f)
-                            transparent = true;
-                        colArr->push_back(osg::Vec4(r[v], g ? g[v] : r[v], b ? b[v] : r[v], 1.0f - transparency));
-                    }
-                }
-            }
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-
-        case Bind::OverAll:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding over all\n");
-
-            if (colorpacking == Pack::RGBA)
-            {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-                float r, g, b, a;
-                unpackRGBA(pc, 0, &r, &g, &b, &a);
-                if (a < 1.0)
-                {
-                    transparent = true;
-                }
-                colArr->push_back(osg::Vec4(r, g, b, a));
-
-                geom->setColorArray(colArr);
-            }
-            else
-            {
-                osg::Vec4Array *colArr = new osg::Vec4Array();
-                if (transparency > 0.f)
-                    transparent = true;
-                colArr->push_back(osg::Vec4(r[0], g ? g[0] : r[0], b ? b[0] : r[0], 1.0f - transparency));
-                geom->setColorArray(colArr);
-            }
-            geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-        }
-        break;
-
-        case Bind::PerFace:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding per face\n");
-
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            if (colorpacking == Pack::RGBA)
-            {
-                for (int i = 0; i < no_of_quads; i++)
-                {
-                    float r, g, b, a;
-                    unpackRGBA(pc, i, &r, &g, &b, &a);
-                    if (a < 1.0)
-                    {
-                        transparent = true;
-                    }
-                    for (int j = 0; j < 4; ++j)
-                        colArr->push_back(osg::Vec4(r, g, b, a));
-                }
-            }
-            else
-            {
-                for (int i = 0; i < no_of_quads; i++)
-                {
-                    if (transparency > 0.f)
-                        transparent = true;
-
-                    for (int j = 0; j < 4; ++j)
-                        colArr->push_back(osg::Vec4(r[i], g ? g[i] : r[i], b ? b[i] : r[i], 1.0f - transparency));
-                }
-            }
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-        }
-    }
-    else
-    {
-        if (material != NULL)
-        {
-            geom->setColorBinding(osg::Geometry::BIND_OFF);
-        }
-        else
-        {
-            osg::Vec4Array *colArr = new osg::Vec4Array();
-            colArr->push_back(coviseGeometryDefaultColor);
-
-            geom->setColorArray(colArr);
-            geom->setColorBinding(osg::Geometry::BIND_OVERALL);
-        }
-    }
-
-    if (no_of_normals)
-    {
-        switch (normalbinding)
-        {
-        case Bind::PerVertex:
-        {
-            //fprintf(stderr,"COVER INFO: colorbinding per vertex\n");
-
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            vn = 0;
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    int v = v_l[vn];
-                    vn++;
-                    osg::Vec3 norm = osg::Vec3(nx[v], ny[v], nz[v]);
-                    norm.normalize();
-                    normalArray->push_back(norm);
-                }
-            }
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-
-        case Bind::OverAll:
-        {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-
-            osg::Vec3 n = osg::Vec3(nx[0], ny[0], nz[0]);
-            n.normalize();
-            normalArray->push_back(n);
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_OVERALL);
-        }
-        break;
-
-        case Bind::PerFace:
-        {
-            osg::Vec3Array *normalArray = new osg::Vec3Array();
-            for (int i = 0; i < no_of_quads; i++)
-            {
-                osg::Vec3 n = osg::Vec3(nx[i], ny[i], nz[i]);
-                n.normalize();
-
-                for (int j = 0; j < 4; ++j)
-                    normalArray->push_back(n);
-            }
-            geom->setNormalArray(normalArray);
-            geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-        }
-        break;
-        }
-    }
-    else
-    {
-        osg::Vec3Array *normalArray = new osg::Vec3Array();
-        vn = 0;
-        // create one normal per polygon and use it for all vertices
-        for (int i = 0; i < no_of_quads; i++)
-        {
-            int v = v_l[vn];
-            vn++;
-            osg::Vec3 p0 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            v = v_l[vn];
-            vn++;
-            osg::Vec3 p1 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            v = v_l[vn];
-            vn++;
-            osg::Vec3 p2 = osg::Vec3(x_c[v], y_c[v], z_c[v]);
-            osg::Vec3 v1 = p1 - p0;
-            osg::Vec3 v2 = p2 - p1;
-            osg::Vec3 vn = v1 ^ v2;
-            vn.normalize();
-            for (int j = 0; j < 4; ++j)
-                normalArray->push_back(vn);
-        }
-
-        geom->setNormalArray(normalArray);
-        geom->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-    }
-
-    if (no_of_texCoords)
-    {
-        osg::Vec2Array *tcArray = new osg::Vec2Array();
-        vn = 0;
-        for (int i = 0; i < no_of_quads; i++)
-        {
-            for (int n = 0; n < 4; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                tcArray->push_back(osg::Vec2(tx[v], ty[v]));
-            }
-        }
-        geom->setTexCoordArray(0, tcArray);
-    }
-
-    osg::StateSet *geoState = geode->getOrCreateStateSet();
-
-    if (no_of_vertexAttributes > 0)
-    {
-        osg::Vec3Array *vertArray = new osg::Vec3Array;
-        vn = 0;
-        for (int i = 0; i < no_of_quads; i++)
-        {
-            for (int n = 0; n < 4; n++)
-            {
-                int v = v_l[vn];
-                vn++;
-                vertArray->push_back(osg::Vec3(vax[v], vay[v], vaz[v]));
-            }
-        }
-        geom->setVertexAttribArray(6, vertArray);
-    }
-    // geoState->setGlobalDefaults();
-    if (pixelSize == 4)
-        transparent = true;
-    setDefaultMaterial(geoState, transparent, material, false);
-
-    if (backfaceCulling || cullBackfaces) // backfaceCulling nur dann, wenn es im CoviseConfig enabled ist
-    {
-        osg::CullFace *cullFace = new osg::CullFace();
-        cullFace->setMode(osg::CullFace::BACK);
-        geoState->setAttributeAndModes(cullFace, osg::StateAttribute::ON);
-    }
-
-    osg::PolygonOffset *po = new osg::PolygonOffset(1., 1.);
-    geoState->setAttributeAndModes(po, osg::StateAttribute::ON);
-
-    osg::BlendFunc *blendFunc = new osg::BlendFunc();
-    blendFunc->setFunction(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA);
-    geoState->setAttributeAndModes(blendFunc, osg::StateAttribute::ON);
-    osg::AlphaFunc *alphaFunc = new osg::AlphaFunc();
-    alphaFunc->setFunction(osg::AlphaFunc::ALWAYS, 1.0);
-    //blendFunc->setFunction(osg::BlendFunc::SRC_ALPHA, osg::BlendFunc::ONE_MINUS_SRC_ALPHA);
-    geoState->setAttributeAndModes(alphaFunc, osg::StateAttribute::OFF);
-
-    setTexture(image, pixelSize, texWidth, texHeight, geoState, wm, minfm, magfm);
-
-    geode->setStateSet(geoState);
-
-    if (genStrips)
-    {
-        d_stripper->stripify(*geom);
-    }
-
-    geode->addDrawable(geom);
-
-    return ((osg::Node *)geode);
+    return addSurface(object_name, no_of_quads, 4, no_of_vertices, no_of_coords,
+                      x_c, y_c, z_c, v_l, NULL,
+                      no_of_colors, colorbinding, colorpacking, r, g, b, pc,
+                      no_of_normals, normalbinding, nx, ny, nz,
+                      transparency, material, texWidth, texHeight, pixelSize, image,
+                      no_of_texCoords, tx, ty, wm, minfm, magfm,
+                      no_of_vertexAttributes, vax, vay, vaz, cullBackfaces, false);
 }
 
 void
@@ -28,11 +28,6 @@ using covise::coMaterial;
 #include <osg/Material>
 #include <osg/ref_ptr>
 
-namespace osgUtil
-{
-class TriStripVisitor;
-}
-
 namespace osg
 {
 class DrawElementsUShort;
@@ -51,7 +46,8 @@ class COVISEPLUGINEXPORT GeometryManager
 private:
     bool backfaceCulling;
     bool genStrips;
-    osgUtil::TriStripVisitor *d_stripper;
+    bool indexedGeometry; // share vertices between polygons where possible
+    bool optimizeVertexCache; // reorder triangles of shared vertex geometry
 
     int sequential;
 
@@ -63,6 +59,21 @@ private:
 
     osg::Vec4 coviseGeometryDefaultColor;
 
+    // geometry of polygons (i_l) or of triangles or quads (corners), shares
+    // the coordinates as vertex array unless the bindings require separate corners
+    osg::Node *addSurface(const char *object_name,
+                          int no_of_polygons, int corners, int no_of_vertices, int no_of_coords,
+                          float *x_c, float *y_c, float *z_c,
+                          int *v_l, int *i_l,
+                          int no_of_colors, int colorbinding, int colorpacking,
+                          float *r, float *g, float *b, int *pc,
+                          int no_of_normals, int normalbinding,
+                          float *nx, float *ny, float *nz,
+                          float &transparency, coMaterial *material, int texWidth, int texHeight, int pixelSize, unsigned char *image,
+                          int no_of_texCoords, float *tx, float *ty, osg::Texture::WrapMode wm, osg::Texture::FilterMode minfm, osg::Texture::FilterMode magfm,
+                          int no_of_vertexAttributes,
+                          float *vax, float *vay, float *vaz, bool cullBackfaces, bool isLightingOn);
+
 public:
     static GeometryManager *instance();
     GeometryManager();
@@ -0,0 +1,128 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_CHUNKED_EXTRACTION_H
+#define CO_CHUNKED_EXTRACTION_H
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/***********************************************************************\
+ **                                                                     **
+ **   Parallel surface extraction in chunks                             **
+ **                                                                     **
+ **   Description  : The outermost loop of an extraction (elements,     **
+ **                  active cells or x layers) is split into chunks,    **
+ **                  which are cut by workers in parallel. Workers do   **
+ **                  not create vertices, they record the cut edges     **
+ **                  and refer to them by index. The recorded edges     **
+ **                  are then turned into vertices in chunk order, so   **
+ **                  the result is identical to a single threaded run.  **
+ **                                                                     **
+ **                  Used by IsoPlane and Plane, which befriend it. An  **
+ **                  Extractor has to provide                           **
+ **                    createWorker(std::vector<Edge> *, int units),    **
+ **                    extract(begin, end), maxVerticesPerUnit(),       **
+ **                    vertice_list, vertex and num_triangles,          **
+ **                    addRecordedVertex(const Edge &): replay an edge, **
+ **                    addWorkerResults(const Extractor &worker).       **
+ **                                                                     **
+ **   Classes      : coChunkedExtraction                                **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+template <class Extractor, class Edge>
+class coChunkedExtraction
+{
+public:
+    // extract [0, units) of target with up to threads threads,
+    // false if target runs out of vertex memory
+    static bool extract(Extractor &target, int units, int threads)
+    {
+        // elements resp. x layers handed to a worker at once
+        int block = std::max(1, 4096 / target.maxVerticesPerUnit());
+        if (threads <= 1 || units < 4 * block || (long)units * target.maxVerticesPerUnit() < 500000)
+        {
+            return target.extract(0, units);
+        }
+
+        // more chunks than threads for load balancing
+        int num_chunks = std::min(units / block, 8 * threads);
+        std::vector<Chunk> chunks(num_chunks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+        for (int c = 0; c < num_chunks; c++)
+        {
+            Chunk &chunk = chunks[c];
+            int begin = (int)((long)units * c / num_chunks);
+            int end = (int)((long)units * (c + 1) / num_chunks);
+            Extractor *worker = target.createWorker(&chunk.edges, block);
+            for (int b = begin; b < end; b += block)
+            {
+                worker->extract(b, std::min(b + block, end));
+                chunk.vertices.insert(chunk.vertices.end(), worker->vertice_list, worker->vertex);
+                worker->vertex = worker->vertice_list;
+            }
+            chunk.worker = worker;
+        }
+
+        // create the vertices in the order a single thread would have done,
+        // the extractor writes the index of each edge into vertex_index
+        bool ok = true;
+        std::vector<int> vertex_index;
+        for (int c = 0; c < num_chunks; c++)
+        {
+            Chunk &chunk = chunks[c];
+            if (ok)
+            {
+                int *out = target.vertex;
+                vertex_index.resize(chunk.edges.size());
+                for (size_t e = 0; ok && e < chunk.edges.size(); e++)
+                {
+                    target.vertex = &vertex_index[e];
+                    ok = target.addRecordedVertex(chunk.edges[e]);
+                }
+                target.vertex = out;
+                if (ok)
+                {
+                    for (size_t i = 0; i < chunk.vertices.size(); i++)
+                        *target.vertex++ = vertex_index[chunk.vertices[i]];
+                    target.num_triangles += chunk.worker->num_triangles;
+                    target.addWorkerResults(*chunk.worker);
+                }
+            }
+            delete chunk.worker;
+            std::vector<int>().swap(chunk.vertices);
+            std::vector<Edge>().swap(chunk.edges);
+        }
+        return ok;
+    }
+
+private:
+    // result of a worker for a chunk
+    struct Chunk
+    {
+        std::vector<int> vertices; // indices into edges
+        std::vector<Edge> edges;
+        Extractor *worker;
+
+        Chunk()
+            : worker(NULL)
+        {
+        }
+    };
+};
+}
+#endif
@@ -8,6 +8,7 @@
 #include <appl/ApplInterface.h>
 #include "coCuttingSurface.h"
 #include "CuttingTables.h"
+#include "coChunkedExtraction.h"
 #include <do/coDistributedObject.h>
 #include <do/coDoUnstructuredGrid.h>
 #include <do/coDoUniformGrid.h>
@@ -19,7 +20,12 @@
 #include <do/coDoSet.h>
 
 #include <covise/covise.h>
+#include <config/CoviseConfig.h>
 #include <float.h>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef _WIN32
 #include <math.h>
@@ -106,6 +112,9 @@ void AttributeContainer::addAttributes(coDistributedObject *p_obj, const char *p
 
 //========================= Plane ====================================
 
+// lazy eval: set from covise.config upon 1st usage. default=0 (all processors)
+int Plane::numThreads = -1;
+
 Plane::Plane()
 {
     initialize();
@@ -137,7 +146,6 @@ Plane::Plane(int n_elem, int n_nodes, int Type, int *p_el,
 
     unstr_ = true;
     maxPolyPerVertex = maxPoly;
-    NodeInfo *node;
     int i;
     iblank = ib;
     el = p_el;
@@ -161,72 +169,87 @@ Plane::Plane(int n_elem, int n_nodes, int Type, int *p_el,
     num_elem = n_elem;
     //    node_table   = (NodeInfo *)malloc(n_nodes*sizeof(NodeInfo));
     node_table = new NodeInfo[num_nodes];
-    node = node_table;
-    float tmpi, tmpj, tmpk;
     cur_line_elem = 0;
+    // classify the nodes in blocks per thread, the loops are
+    // simple enough to be vectorized by the compiler
     if (option == 0)
     {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
         for (i = 0; i < n_nodes; i++)
         {
+            NodeInfo *node = node_table + i;
             node->targets[0] = 0;
             // Calculate the myDistance of each node
             // to the Cuttingplane
             node->dist = (planei * x_in[i] + planej * y_in[i] + planek * z_in[i] - myDistance);
             node->side = (node->dist >= 0 ? 1 : 0);
-            node++;
         }
     }
     else if (option == 1) //sphere
     {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
         for (i = 0; i < n_nodes; i++)
         {
+            NodeInfo *node = node_table + i;
             node->targets[0] = 0; // Calculate the myDistance of each node
             // to the Cuttingsphere
-            tmpi = planei - x_in[i];
-            tmpj = planej - y_in[i];
-            tmpk = planek - z_in[i];
+            float tmpi = planei - x_in[i];
+            float tmpj = planej - y_in[i];
+            float tmpk = planek - z_in[i];
             node->dist = sqrt(tmpi * tmpi + tmpj * tmpj + tmpk * tmpk) - radius;
             node->side = (node->dist >= 0 ? 1 : 0);
-            node++;
         }
     }
     else if (option == 2) //cylinder-X
     {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
         for (i = 0; i < n_nodes; i++)
         {
+            NodeInfo *node = node_table + i;
             node->targets[0] = 0; // Calculate the myDistance of each node
             // to the Cuttingsphere
-            tmpj = planej - y_in[i]; // start <-> plane
-            tmpk = planek - z_in[i];
+            float tmpj = planej - y_in[i]; // start <-> plane
+            float tmpk = planek - z_in[i];
             node->dist = sqrt(tmpk * tmpk + tmpj * tmpj) - radius;
             node->side = (node->dist >= 0 ? 1 : 0);
-            node++;
         }
     }
     else if (option == 3) //cylinder-Y
     {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
         for (i = 0; i < n_nodes; i++)
         {
+            NodeInfo *node = node_table + i;
             node->targets[0] = 0; // Calculate the myDistance of each node
             // to the Cuttingsphere
-            tmpi = planei - x_in[i]; // start <-> plane
-            tmpk = planek - z_in[i];
+            float tmpi = planei - x_in[i]; // start <-> plane
+            float tmpk = planek - z_in[i];
             node->dist = sqrt(tmpi * tmpi + tmpk * tmpk) - radius;
             node->side = (node->dist >= 0 ? 1 : 0);
-            node++;
         }
     }
     else if (option == 4) //cylinder-Z
     {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
         for (i = 0; i < n_nodes; i++)
         {
+            NodeInfo *node = node_table + i;
             node->targets[0] = 0; // Calcuulate the myDistance of each node
             // to the Cuttingsphere
-            tmpi = planei - x_in[i]; // start <-> plane
-            tmpj = planej - y_in[i];
+            float tmpi = planei - x_in[i]; // start <-> plane
+            float tmpj = planej - y_in[i];
             node->dist = sqrt(tmpi * tmpi + tmpj * tmpj) - radius;
             node->side = (node->dist >= 0 ? 1 : 0);
-            node++;
         }
     }
     num_triangles = num_vertices = num_coords = 0;
@@ -321,6 +344,43 @@ void Plane::initialize()
     I_Data_p = NULL;
     node_table = NULL;
     iblank = NULL;
+    recorded_edges = NULL;
+}
+
+Plane::Plane(const Plane &parent, std::vector<CutEdge> *edges, int capacity)
+    : unstr_(parent.unstr_)
+    , planei(parent.planei)
+    , planej(parent.planej)
+    , planek(parent.planek)
+    , startx(parent.startx)
+    , starty(parent.starty)
+    , startz(parent.startz)
+    , myDistance(parent.myDistance)
+    , radius(parent.radius)
+    , gennormals(parent.gennormals)
+    , option(parent.option)
+    , genstrips(parent.genstrips)
+{
+    initialize();
+    el = parent.el;
+    cl = parent.cl;
+    tl = parent.tl;
+    x_in = parent.x_in;
+    y_in = parent.y_in;
+    z_in = parent.z_in;
+    num_nodes = parent.num_nodes;
+    num_elem = parent.num_elem;
+    x_size = parent.x_size;
+    y_size = parent.y_size;
+    z_size = parent.z_size;
+    node_table = parent.node_table;
+    Datatype = parent.Datatype;
+    iblank = parent.iblank;
+    recorded_edges = edges;
+    num_triangles = num_vertices = num_coords = max_coords = 0;
+    cur_line_elem = 0;
+    vertice_list = new int[capacity];
+    vertex = vertice_list;
 }
 
 Plane::~Plane()
@@ -331,7 +391,9 @@ Plane::~Plane()
         delete[] y_in;
         delete[] z_in;
     }
-    delete[] node_table;
+    // workers share the node table of their parent
+    if (!recorded_edges)
+        delete[] node_table;
     delete[] vertice_list;
     delete[] coords_x;
     delete[] coords_y;
@@ -358,9 +420,27 @@ Plane::~Plane()
 }
 
 bool Plane::createPlane()
+{
+    if (!extractParallel(num_elem))
+        return false;
+
+    if (getenv("CUTTINGSURFACE_STATISTICS"))
+    {
+        Covise::sendInfo("Used %d of %d vertices: Usage=%f%%",
+                         num_coords, max_coords, ((float)num_coords) / max_coords);
+    }
+    return true;
+}
+
+int Plane::maxVerticesPerUnit()
+{
+    return 12;
+}
+
+bool Plane::extract(int begin, int end)
 {
     // 1 = above; 0 = below
-    for (int element = 0; element < num_elem; element++)
+    for (int element = begin; element < end; element++)
     {
         if (iblank == NULL || iblank[element] != '\0')
         {
@@ -409,11 +489,6 @@ bool Plane::createPlane()
             }
         }
     }
-    if (getenv("CUTTINGSURFACE_STATISTICS"))
-    {
-        Covise::sendInfo("Used %d of %d vertices: Usage=%f%%",
-                         num_coords, max_coords, ((float)num_coords) / max_coords);
-    }
     return true;
 }
 
@@ -424,6 +499,14 @@ bool Plane::add_vertex(int n1, int n2)
     int *targets, *indices; // Pointers into the node_info structure
     float w2, w1;
 
+    if (recorded_edges)
+    {
+        CutEdge edge = { n1, n2 };
+        *vertex++ = (int)recorded_edges->size();
+        recorded_edges->push_back(edge);
+        return true;
+    }
+
     targets = node_table[n1].targets;
     indices = node_table[n1].vertice_list;
 
@@ -533,6 +616,39 @@ void Plane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int w)
     num_coords++;
 }
 
+int Plane::getNumThreads()
+{
+#ifdef _OPENMP
+    if (numThreads < 0)
+        numThreads = coCoviseConfig::getInt("Module.CuttingSurface.Threads", 0);
+    if (numThreads == 0)
+        return omp_get_num_procs();
+    return numThreads;
+#else
+    return 1;
+#endif
+}
+
+void Plane::setNumThreads(int n)
+{
+    numThreads = n;
+}
+
+Plane *Plane::createWorker(std::vector<CutEdge> *edges, int units)
+{
+    return new Plane(*this, edges, units * maxVerticesPerUnit());
+}
+
+bool Plane::extractParallel(int units)
+{
+    return coChunkedExtraction<Plane, CutEdge>::extract(*this, units, getNumThreads());
+}
+
+bool Plane::addRecordedVertex(const CutEdge &edge)
+{
+    return add_vertex(edge.n1, edge.n2);
+}
+
 void Plane::border_proj(float *px, float *py, float *pz,
                         float xminb,
                         float xmaxb,
@@ -4976,6 +5092,21 @@ void POLYHEDRON_Plane::create_contour(float *x_coord_in, float *y_coord_in, floa
 //=============================== STR_Plane ===============================
 
 bool STR_Plane::createPlane()
+{
+    return extractParallel(x_size - 1);
+}
+
+Plane *STR_Plane::createWorker(std::vector<CutEdge> *edges, int units)
+{
+    return new STR_Plane(*this, edges, units * maxVerticesPerUnit());
+}
+
+int STR_Plane::maxVerticesPerUnit()
+{
+    return (y_size - 1) * (z_size - 1) * 12;
+}
+
+bool STR_Plane::extract(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -4985,10 +5116,10 @@ bool STR_Plane::createPlane()
     int *polygon_nodes;
     int n1, n2, ii, jj, kk;
     int *n_1 = node_list, *n_2 = node_list + 1, *n_3 = node_list + 2, *n_4 = node_list + 3, *n_5 = node_list + 4, *n_6 = node_list + 5, *n_7 = node_list + 6, *n_8 = node_list + 7;
-    *n_1 = 0;
-    *n_2 = z_size;
-    *n_3 = z_size * (y_size + 1);
-    *n_4 = y_size * z_size;
+    *n_1 = begin * y_size * z_size;
+    *n_2 = (*n_1) + z_size;
+    *n_3 = (*n_1) + z_size * (y_size + 1);
+    *n_4 = (*n_1) + y_size * z_size;
     *n_5 = (*n_1) + 1;
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
@@ -4996,7 +5127,7 @@ bool STR_Plane::createPlane()
     int *firstvertex;
     cutting_info *C_Info;
 
-    for (ii = 0; ii < x_size - 1; ii++)
+    for (ii = begin; ii < end; ii++)
     {
         for (jj = 0; jj < y_size - 1; jj++)
         {
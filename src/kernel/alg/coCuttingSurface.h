@@ -9,6 +9,7 @@
 #define CO_CUTTINGSURFACE_H
 
 #include <map>
+#include <vector>
 
 #include "CuttingSurfaceGPMUtil.h"
 
@@ -48,6 +49,12 @@ typedef struct cutting_info_s
     int nvert;
 } cutting_info;
 
+// cut edge recorded by a worker of a parallel extraction
+typedef struct CutEdge_s
+{
+    int n1, n2;
+} CutEdge;
+
 typedef struct border_s
 {
     int upper;
@@ -69,8 +76,12 @@ public:
     void addAttributes(coDistributedObject *p_obj, const char *probeAttr);
 };
 
+template <class Extractor, class Edge>
+class coChunkedExtraction;
+
 class ALGEXPORT Plane
 {
+    friend class coChunkedExtraction<Plane, CutEdge>;
     friend class Isoline;
     friend class STR_Plane;
     friend class UNI_Plane;
@@ -152,6 +163,14 @@ private:
 
     float x_minb, y_minb, z_minb, x_maxb, y_maxb, z_maxb;
 
+    // number of threads for extraction, Module.CuttingSurface.Threads,
+    // 0: as many as processors
+    static int numThreads;
+
+    // set for workers of a parallel extraction: cut edges are only
+    // recorded, vertex entries are indices into this list
+    std::vector<CutEdge> *recorded_edges;
+
     static float gsin(float angle);
     static float gcos(float angle);
     static int trs2pol(int nb_con, int nb_tr, int *trv, int *tr_list, int *plv, int *pol_list);
@@ -179,6 +198,25 @@ private:
                             float zmaxb,
                             float pli, float plj, float plk, float distance);
 
+protected:
+    // worker sharing the input and node table of parent, with room for
+    // capacity vertex entries
+    Plane(const Plane &parent, std::vector<CutEdge> *edges, int capacity);
+    virtual Plane *createWorker(std::vector<CutEdge> *edges, int units);
+    // cut the part of the grid in [begin, end) of the outermost loop
+    // (elements or x layers), false if out of vertex memory
+    virtual bool extract(int begin, int end);
+    // vertex entries a unit of the outermost loop can produce at most
+    virtual int maxVerticesPerUnit();
+    // extract [0, units) with several threads, see coChunkedExtraction
+    bool extractParallel(int units);
+    // create the vertex for an edge recorded by a worker
+    bool addRecordedVertex(const CutEdge &edge);
+    // nothing besides vertices and triangles
+    void addWorkerResults(const Plane &)
+    {
+    }
+
 public:
     static coDoTriangleStrips *dummy_tr_strips(const char *name,
                                                float x_minb,
@@ -224,6 +262,9 @@ public:
     virtual bool createPlane();
     virtual void createStrips();
 
+    static int getNumThreads();
+    static void setNumThreads(int n);
+
     virtual void createcoDistributedObjects(const char *Data_name_scal, const char *Data_name_vect,
                                             const char *Normal_name, const char *Triangle_name,
                                             AttributeContainer &gridAttrs, AttributeContainer &dataAttrs);
@@ -347,6 +388,15 @@ public:
         z_size = p_z_size;
     }
     bool createPlane();
+
+protected:
+    STR_Plane(const STR_Plane &parent, std::vector<CutEdge> *edges, int capacity)
+        : Plane(parent, edges, capacity)
+    {
+    }
+    virtual Plane *createWorker(std::vector<CutEdge> *edges, int units);
+    virtual bool extract(int begin, int end);
+    virtual int maxVerticesPerUnit();
 };
 
 class ALGEXPORT UNI_Plane : public Plane
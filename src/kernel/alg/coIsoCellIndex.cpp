@@ -0,0 +1,232 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coIsoCellIndex.h"
+#include <config/CoviseConfig.h>
+#include <do/coDoUnstructuredGrid.h>
+#include <string>
+#include <float.h>
+
+using namespace covise;
+
+namespace covise
+{
+struct coIsoCellIndexEntry
+{
+    std::string key;
+    coIsoCellIndex *index;
+    unsigned long lastUse;
+};
+
+static std::vector<coIsoCellIndexEntry> cellIndexCache;
+static unsigned long cellIndexUses = 0;
+// lazy eval: set from covise.config upon 1st usage
+static int cellIndexCacheSize = -1;
+}
+
+coIsoCellIndex::coIsoCellIndex(int n_elem, int n_nodes, const int *el, const int *cl, const int *tl,
+                               const float *i_in)
+    : num_elem(n_elem)
+    , num_nodes(n_nodes)
+    , standard_cells(false)
+    , polyhedral_cells(false)
+    , val_min(FLT_MAX)
+    , val_max(-FLT_MAX)
+    , scale(0.f)
+{
+    std::vector<float> mins(n_elem), maxs(n_elem);
+    std::vector<char> indexed(n_elem, 0);
+    for (int element = 0; element < n_elem; element++)
+    {
+        int n = UnstructuredGrid_Num_Nodes[tl[element]];
+        if (n == -1)
+        {
+            polyhedral_cells = true;
+            continue;
+        }
+        standard_cells = true;
+
+        // nodes with NaN values are below every isovalue
+        const int *node = cl + el[element];
+        float mn = FLT_MAX, mx = -FLT_MAX;
+        bool nan = false;
+        for (int i = 0; i < n; i++)
+        {
+            float v = i_in[node[i]];
+            if (v < mn)
+                mn = v;
+            if (v > mx)
+                mx = v;
+            if (v != v)
+                nan = true;
+        }
+        if (nan)
+            mn = -FLT_MAX;
+        if (n < 2 || mx < mn || (mn == mx && !nan))
+            continue; // can never be cut
+
+        mins[element] = mn;
+        maxs[element] = mx;
+        indexed[element] = 1;
+        if (mn < val_min)
+            val_min = mn;
+        if (mx > val_max)
+            val_max = mx;
+    }
+    if (val_max > val_min)
+    {
+        scale = NUM_BINS / (val_max - val_min);
+        if (!(scale < FLT_MAX))
+            scale = 0.f;
+    }
+
+    // counting sort by bucket keeps the cells of a bucket in ascending order
+    bucket_start.assign(NUM_BINS * NUM_BINS + 1, 0);
+    for (int element = 0; element < n_elem; element++)
+    {
+        if (indexed[element])
+            bucket_start[bin(mins[element]) * NUM_BINS + bin(maxs[element]) + 1]++;
+    }
+    for (int b = 0; b < NUM_BINS * NUM_BINS; b++)
+        bucket_start[b + 1] += bucket_start[b];
+
+    int num = bucket_start[NUM_BINS * NUM_BINS];
+    cells.resize(num);
+    cell_min.resize(num);
+    cell_max.resize(num);
+    std::vector<int> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (int element = 0; element < n_elem; element++)
+    {
+        if (!indexed[element])
+            continue;
+        int pos = fill[bin(mins[element]) * NUM_BINS + bin(maxs[element])]++;
+        cells[pos] = element;
+        cell_min[pos] = mins[element];
+        cell_max[pos] = maxs[element];
+    }
+}
+
+int coIsoCellIndex::bin(float v) const
+{
+    // monotonic in v, so that whole buckets can be accepted without tests
+    if (!(v > val_min))
+        return 0;
+    if (v >= val_max)
+        return NUM_BINS - 1;
+    int b = (int)((v - val_min) * scale);
+    return b < NUM_BINS ? b : NUM_BINS - 1;
+}
+
+void coIsoCellIndex::activeCells(float isovalue, std::vector<int> &result) const
+{
+    result.clear();
+    if (cells.empty())
+        return;
+
+    // mark active cells in a bit field, so that they come out in the
+    // same order as from a full scan
+    std::vector<unsigned int> mark((num_elem + 31) / 32, 0);
+    size_t count = 0;
+    int b = bin(isovalue);
+    for (int i = 0; i <= b; i++)
+    {
+        for (int j = b; j < NUM_BINS; j++)
+        {
+            int begin = bucket_start[i * NUM_BINS + j];
+            int end = bucket_start[i * NUM_BINS + j + 1];
+            if (i < b && j > b)
+            {
+                for (int c = begin; c < end; c++)
+                    mark[cells[c] >> 5] |= 1u << (cells[c] & 31);
+                count += end - begin;
+            }
+            else
+            {
+                // same test as for the sides of the nodes in IsoPlane
+                for (int c = begin; c < end; c++)
+                {
+                    if (!(cell_min[c] - isovalue >= 0) && cell_max[c] - isovalue >= 0)
+                    {
+                        mark[cells[c] >> 5] |= 1u << (cells[c] & 31);
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+
+    result.reserve(count);
+    for (size_t w = 0; w < mark.size() && result.size() < count; w++)
+    {
+        unsigned int bits = mark[w];
+        for (int k = 0; bits; k++, bits >>= 1)
+        {
+            if (bits & 1)
+                result.push_back((int)(w * 32 + k));
+        }
+    }
+}
+
+const coIsoCellIndex *coIsoCellIndex::get(const char *gridName, const char *dataName,
+                                          int n_elem, int n_nodes,
+                                          const int *el, const int *cl, const int *tl,
+                                          const float *i_in)
+{
+    if (cellIndexCacheSize < 0)
+        cellIndexCacheSize = coCoviseConfig::getInt("Module.IsoSurface.SpanSpace", 0);
+    if (cellIndexCacheSize == 0 || !gridName || !dataName)
+        return NULL;
+
+    std::string key = std::string(gridName) + "\n" + dataName;
+    cellIndexUses++;
+    for (size_t i = 0; i < cellIndexCache.size(); i++)
+    {
+        coIsoCellIndexEntry &entry = cellIndexCache[i];
+        if (entry.key == key && entry.index->getNumElem() == n_elem && entry.index->getNumNodes() == n_nodes)
+        {
+            entry.lastUse = cellIndexUses;
+            return entry.index;
+        }
+    }
+
+    // replace the least recently used index
+    if (cellIndexCache.size() >= (size_t)cellIndexCacheSize)
+    {
+        size_t oldest = 0;
+        for (size_t i = 1; i < cellIndexCache.size(); i++)
+        {
+            if (cellIndexCache[i].lastUse < cellIndexCache[oldest].lastUse)
+                oldest = i;
+        }
+        delete cellIndexCache[oldest].index;
+        cellIndexCache.erase(cellIndexCache.begin() + oldest);
+    }
+
+    coIsoCellIndexEntry entry;
+    entry.key = key;
+    entry.index = new coIsoCellIndex(n_elem, n_nodes, el, cl, tl, i_in);
+    entry.lastUse = cellIndexUses;
+    cellIndexCache.push_back(entry);
+    return entry.index;
+}
+
+void coIsoCellIndex::setCacheSize(int n)
+{
+    cellIndexCacheSize = n;
+    while (cellIndexCache.size() > (size_t)(n > 0 ? n : 0))
+    {
+        delete cellIndexCache.front().index;
+        cellIndexCache.erase(cellIndexCache.begin());
+    }
+}
+
+void coIsoCellIndex::clearCache()
+{
+    for (size_t i = 0; i < cellIndexCache.size(); i++)
+        delete cellIndexCache[i].index;
+    cellIndexCache.clear();
+}
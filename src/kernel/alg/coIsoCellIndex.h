@@ -0,0 +1,93 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_ISO_CELL_INDEX_H
+#define CO_ISO_CELL_INDEX_H
+
+#include <util/coTypes.h>
+#include <vector>
+
+/***********************************************************************\
+ **                                                                     **
+ **   Span space index for repeated isosurface queries                  **
+ **                                                                     **
+ **   Description  : The (min, max) pairs of the isodata over the       **
+ **                  nodes of each cell of an unstructured grid are     **
+ **                  sorted into a regular grid of buckets in span      **
+ **                  space. A query for an isovalue only visits the     **
+ **                  buckets with min <= isovalue <= max and has to     **
+ **                  check single cells only in the buckets on the      **
+ **                  border, so repeated extractions on the same data   **
+ **                  only touch the cells actually cut by the surface.  **
+ **                  Indices are cached by the names of the grid and    **
+ **                  data objects.                                      **
+ **                                                                     **
+ **   Classes      : coIsoCellIndex                                     **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+class ALGEXPORT coIsoCellIndex
+{
+public:
+    coIsoCellIndex(int n_elem, int n_nodes, const int *el, const int *cl, const int *tl,
+                   const float *i_in);
+
+    // cached index for the grid and isodata objects, built on first use,
+    // NULL if caching is disabled (Module.IsoSurface.SpanSpace, number of
+    // indices to keep, default 0)
+    static const coIsoCellIndex *get(const char *gridName, const char *dataName,
+                                     int n_elem, int n_nodes,
+                                     const int *el, const int *cl, const int *tl,
+                                     const float *i_in);
+    static void setCacheSize(int n);
+    static void clearCache();
+
+    // ascending list of the cells with a node below and a node not
+    // below isovalue, i.e. the cells cut by the surface
+    void activeCells(float isovalue, std::vector<int> &cells) const;
+
+    int getNumElem() const
+    {
+        return num_elem;
+    }
+    int getNumNodes() const
+    {
+        return num_nodes;
+    }
+    bool hasStandardCells() const
+    {
+        return standard_cells;
+    }
+    bool hasPolyhedralCells() const
+    {
+        return polyhedral_cells;
+    }
+
+private:
+    enum
+    {
+        NUM_BINS = 128
+    };
+    int bin(float v) const;
+
+    int num_elem;
+    int num_nodes;
+    bool standard_cells;
+    bool polyhedral_cells;
+    float val_min, val_max, scale;
+    // cells of bucket (bin of min) * NUM_BINS + (bin of max) are
+    // cells[bucket_start[bucket]] ... cells[bucket_start[bucket + 1] - 1]
+    std::vector<int> bucket_start;
+    std::vector<int> cells;
+    std::vector<float> cell_min;
+    std::vector<float> cell_max;
+};
+}
+#endif
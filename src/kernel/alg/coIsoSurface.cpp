@@ -6,6 +6,8 @@
  * License: LGPL 2+ */
 
 #include "coIsoSurface.h"
+#include "coIsoCellIndex.h"
+#include "coChunkedExtraction.h"
 #include <config/CoviseConfig.h>
 #include "IsoCuttingTables.h"
 #include <do/coDoUnstructuredGrid.h>
@@ -14,6 +16,10 @@
 #include <do/coDoTriangleStrips.h>
 #include <api/coOutputPort.h>
 #include <api/coModule.h>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace covise;
 
@@ -62,6 +68,8 @@ using namespace covise;
 
 // lazy eval: set from covise.config upon 1st usage. default=17
 int IsoPlane::maxTriPerVertex = -1;
+// lazy eval: set from covise.config upon 1st usage. default=0 (all processors)
+int IsoPlane::numThreads = -1;
 
 namespace covise
 {
@@ -82,6 +90,9 @@ IsoPlane::IsoPlane()
     , V_Data_W(NULL)
     , S_Data(NULL)
     , node_table(NULL)
+    , recorded_edges(NULL)
+    , cell_index(NULL)
+    , active_cells(NULL)
 {
     if (maxTriPerVertex < 0)
         maxTriPerVertex = readConfig("Module.IsoSurface.MaxTrianglesPerVertex", 17);
@@ -92,7 +103,7 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, float cutVertexRatio,
                    const float *xin, const float *yin, const float *zin,
                    const float *sin, const float *iin,
                    const float *uin, const float *vin, const float *win, float isovalue,
-                   bool isConnected, char *ib)
+                   bool isConnected, char *ib, const coIsoCellIndex *cellIndex)
     :
 
     el(ell)
@@ -117,27 +128,54 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, float cutVertexRatio,
     , node_table(NULL)
     , _isovalue(isovalue)
     , _isConnected(isConnected)
+    , recorded_edges(NULL)
+    , cell_index(NULL)
+    , active_cells(NULL)
 {
     iblank = ib;
     if (maxTriPerVertex < 0)
         maxTriPerVertex = readConfig("Module.IsoSurface.MaxTrianglesPerVertex", 17);
 
-    NodeInfo *node;
     int i;
     Datatype = Type;
     num_nodes = n_nodes;
     num_elem = n_elem;
     //node_table   = (NodeInfo *)malloc(n_nodes*sizeof(NodeInfo));
     node_table = new NodeInfo[n_nodes];
-    node = node_table;
-    for (i = 0; i < n_nodes; i++)
+    // the index knows nothing about blanked cells
+    if (cellIndex && !iblank && cellIndex->getNumElem() == n_elem && cellIndex->getNumNodes() == n_nodes)
+    {
+        // only the nodes of cells cut by the surface are ever looked at
+        cell_index = cellIndex;
+        cell_index->activeCells(isovalue, active_list);
+        if (!active_list.empty())
+            active_cells = &active_list[0];
+        for (size_t c = 0; c < active_list.size(); c++)
+        {
+            const int *node_list = cl + el[active_list[c]];
+            for (int n = UnstructuredGrid_Num_Nodes[tl[active_list[c]]] - 1; n >= 0; n--)
+            {
+                NodeInfo *node = node_table + node_list[n];
+                node->targets[0] = 0;
+                node->dist = (i_in[node_list[n]] - isovalue);
+                node->side = (node->dist >= 0 ? 1 : 0);
+            }
+        }
+    }
+    else
     {
-        node->targets[0] = 0;
-        // Calculate the distance of each node
-        // to the Isovalue
-        node->dist = (i_in[i] - isovalue);
-        node->side = (node->dist >= 0 ? 1 : 0);
-        node++;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(getNumThreads()) if (n_nodes > 100000)
+#endif
+        for (i = 0; i < n_nodes; i++)
+        {
+            NodeInfo *node = node_table + i;
+            node->targets[0] = 0;
+            // Calculate the distance of each node
+            // to the Isovalue
+            node->dist = (i_in[i] - isovalue);
+            node->side = (node->dist >= 0 ? 1 : 0);
+        }
     }
     num_triangles = num_vertices = num_coords = 0;
 
@@ -204,6 +242,9 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, /*float cutVertexRatio,*/
     , node_table(NULL)
     , _isovalue(isovalue)
     , _isConnected(isConnected)
+    , recorded_edges(NULL)
+    , cell_index(NULL)
+    , active_cells(NULL)
 {
     iblank = ib;
 
@@ -217,9 +258,51 @@ IsoPlane::IsoPlane(int n_elem, int n_nodes, int Type, /*float cutVertexRatio,*/
     num_elem = n_elem;
 }
 
+IsoPlane::IsoPlane(const IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity)
+    : el(parent.el)
+    , cl(parent.cl)
+    , tl(parent.tl)
+    , x_in(parent.x_in)
+    , y_in(parent.y_in)
+    , z_in(parent.z_in)
+    , s_in(parent.s_in)
+    , i_in(parent.i_in)
+    , u_in(parent.u_in)
+    , v_in(parent.v_in)
+    , w_in(parent.w_in)
+    , num_nodes(parent.num_nodes)
+    , num_elem(parent.num_elem)
+    , num_triangles(0)
+    , num_vertices(0)
+    , num_coords(0)
+    , max_coords(0)
+    , coords_x(NULL)
+    , coords_y(NULL)
+    , coords_z(NULL)
+    , V_Data_U(NULL)
+    , V_Data_V(NULL)
+    , V_Data_W(NULL)
+    , S_Data(NULL)
+    , node_table(parent.node_table)
+    , Datatype(parent.Datatype)
+    , _isovalue(parent._isovalue)
+    , _isConnected(parent._isConnected)
+    , iblank(parent.iblank)
+    , recorded_edges(edges)
+    , standard_cells_found(false)
+    , cell_index(parent.cell_index)
+    , active_cells(parent.active_cells)
+    , polyhedral_cells_found(false)
+{
+    vertice_list = new int[capacity];
+    vertex = vertice_list;
+}
+
 IsoPlane::~IsoPlane()
 {
-    delete[] node_table;
+    // workers share the node table of their parent
+    if (!recorded_edges)
+        delete[] node_table;
     node_table = NULL;
     delete[] coords_x;
     delete[] coords_y;
@@ -281,11 +364,21 @@ POLYHEDRON_IsoPlane::~POLYHEDRON_IsoPlane()
 
 UNI_IsoPlane::~UNI_IsoPlane()
 {
+    if (recorded_edges)
+        return; // coordinates belong to the parent
     delete[] x_in;
     delete[] y_in;
     delete[] z_in;
 }
 
+UNI_IsoPlane::UNI_IsoPlane(const UNI_IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity)
+    : IsoPlane(parent, edges, capacity)
+    , x_size(parent.x_size)
+    , y_size(parent.y_size)
+    , z_size(parent.z_size)
+{
+}
+
 UNI_IsoPlane::UNI_IsoPlane(int n_elem, int n_nodes, int Type,
                            float x_min, float x_max, float y_min,
                            float y_max, float z_min, float z_max,
@@ -335,8 +428,35 @@ RECT_IsoPlane::RECT_IsoPlane(int n_elem, int n_nodes, int Type,
 
 bool IsoPlane::createIsoPlane()
 {
-    bool standard_cells_found;
-    int element;
+    standard_cells_found = false;
+    polyhedral_cells_found = false;
+
+    if (cell_index)
+    {
+        if (!extractParallel((int)active_list.size()))
+            return false;
+        standard_cells_found = cell_index->hasStandardCells();
+        polyhedral_cells_found = cell_index->hasPolyhedralCells();
+    }
+    else if (!extractParallel(num_elem))
+        return false;
+
+    // No standard cells found in the dataset
+    if (standard_cells_found == false)
+    {
+        return false;
+    }
+    return true;
+}
+
+int IsoPlane::maxVerticesPerUnit()
+{
+    return 12;
+}
+
+bool IsoPlane::extract(int begin, int end)
+{
+    int unit, element;
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
     int i;
@@ -354,11 +474,10 @@ bool IsoPlane::createIsoPlane()
     for (i = 0; i < 256; i++)
         cases[i] = 0;
 #endif
-    standard_cells_found = false;
-    polyhedral_cells_found = false;
 
-    for (element = 0; element < num_elem; element++)
+    for (unit = begin; unit < end; unit++)
     {
+        element = active_cells ? active_cells[unit] : unit;
         if (iblank == NULL || iblank[element] != '\0')
         {
             elementtype = tl[element];
@@ -920,15 +1039,20 @@ bool IsoPlane::createIsoPlane()
     for (i = 0; i < 256; i++)
         fprintf(stderr, " %d : %d\n", i, cases[i]);
 #endif
-    // No standard cells found in the dataset
-    if (standard_cells_found == false)
-    {
-        return false;
-    }
     return true;
 }
 
 void UNI_IsoPlane::createIsoPlane()
+{
+    extractParallel(x_size - 1);
+}
+
+int UNI_IsoPlane::maxVerticesPerUnit()
+{
+    return (y_size - 1) * (z_size - 1) * 12;
+}
+
+bool UNI_IsoPlane::extract(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -942,17 +1066,17 @@ void UNI_IsoPlane::createIsoPlane()
     int no1, no2, no3, no4, no5, no6;
     int *vertex1, *vertex2;
     int *n_1 = node_list, *n_2 = node_list + 1, *n_3 = node_list + 2, *n_4 = node_list + 3, *n_5 = node_list + 4, *n_6 = node_list + 5, *n_7 = node_list + 6, *n_8 = node_list + 7;
-    *n_1 = 0;
-    *n_2 = z_size;
-    *n_3 = z_size * (y_size + 1);
-    *n_4 = y_size * z_size;
+    *n_1 = begin * y_size * z_size;
+    *n_2 = (*n_1) + z_size;
+    *n_3 = (*n_1) + z_size * (y_size + 1);
+    *n_4 = (*n_1) + y_size * z_size;
     *n_5 = (*n_1) + 1;
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
     cutting_info *C_Info;
 
-    for (ii = 0; ii < x_size - 1; ii++)
+    for (ii = begin; ii < end; ii++)
     {
         for (jj = 0; jj < y_size - 1; jj++)
         {
@@ -1539,9 +1663,20 @@ void UNI_IsoPlane::createIsoPlane()
         (*n_7) += z_size;
         (*n_8) += z_size;
     }
+    return true;
 }
 
 void RECT_IsoPlane::createIsoPlane()
+{
+    extractParallel(x_size - 1);
+}
+
+int RECT_IsoPlane::maxVerticesPerUnit()
+{
+    return (y_size - 1) * (z_size - 1) * 12;
+}
+
+bool RECT_IsoPlane::extract(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -1555,18 +1690,18 @@ void RECT_IsoPlane::createIsoPlane()
     int no1, no2, no3, no4, no5, no6;
     int *vertex1, *vertex2;
     int *n_1 = node_list, *n_2 = node_list + 1, *n_3 = node_list + 2, *n_4 = node_list + 3, *n_5 = node_list + 4, *n_6 = node_list + 5, *n_7 = node_list + 6, *n_8 = node_list + 7;
-    *n_1 = 0;
-    *n_2 = z_size;
-    *n_3 = z_size * (y_size + 1);
-    *n_4 = y_size * z_size;
+    *n_1 = begin * y_size * z_size;
+    *n_2 = (*n_1) + z_size;
+    *n_3 = (*n_1) + z_size * (y_size + 1);
+    *n_4 = (*n_1) + y_size * z_size;
     *n_5 = (*n_1) + 1;
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
     cutting_info *C_Info;
 
-    int cell = 0;
-    for (ii = 0; ii < x_size - 1; ++ii)
+    int cell = begin * (y_size - 1) * (z_size - 1);
+    for (ii = begin; ii < end; ++ii)
     {
         for (jj = 0; jj < y_size - 1; ++jj)
         {
@@ -2155,9 +2290,20 @@ void RECT_IsoPlane::createIsoPlane()
         (*n_7) += z_size;
         (*n_8) += z_size;
     }
+    return true;
 }
 
 bool STR_IsoPlane::createIsoPlane()
+{
+    return extractParallel(x_size - 1);
+}
+
+int STR_IsoPlane::maxVerticesPerUnit()
+{
+    return (y_size - 1) * (z_size - 1) * 12;
+}
+
+bool STR_IsoPlane::extract(int begin, int end)
 {
     int bitmap; // index in the MarchingCubes table
     // 1 = above; 0 = below
@@ -2168,17 +2314,17 @@ bool STR_IsoPlane::createIsoPlane()
     int no1, no2, no3, no4, no5, no6;
     int *vertex1, *vertex2;
     int *n_1 = node_list, *n_2 = node_list + 1, *n_3 = node_list + 2, *n_4 = node_list + 3, *n_5 = node_list + 4, *n_6 = node_list + 5, *n_7 = node_list + 6, *n_8 = node_list + 7;
-    *n_1 = 0;
-    *n_2 = z_size;
-    *n_3 = z_size * (y_size + 1);
-    *n_4 = y_size * z_size;
+    *n_1 = begin * y_size * z_size;
+    *n_2 = (*n_1) + z_size;
+    *n_3 = (*n_1) + z_size * (y_size + 1);
+    *n_4 = (*n_1) + y_size * z_size;
     *n_5 = (*n_1) + 1;
     *n_6 = (*n_2) + 1;
     *n_7 = (*n_3) + 1;
     *n_8 = (*n_4) + 1;
     cutting_info *C_Info;
 
-    for (ii = 0; ii < x_size - 1; ii++)
+    for (ii = begin; ii < end; ii++)
     {
         for (jj = 0; jj < y_size - 1; jj++)
         {
@@ -3768,6 +3914,14 @@ bool IsoPlane::add_vertex(int n1, int n2)
     int *targets, *indices; // Pointers into the node_info structure
     float w2, w1;
 
+    if (recorded_edges)
+    {
+        IsoEdge edge = { n1, n2, -1, -1, -1, -1, -1, -1 };
+        *vertex++ = (int)recorded_edges->size();
+        recorded_edges->push_back(edge);
+        return true;
+    }
+
     targets = node_table[n1].targets;
     indices = node_table[n1].vertice_list;
 
@@ -3845,6 +3999,14 @@ void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int
     int *targets, *indices; // Pointers into the node_info structure
     float w2, w1;
 
+    if (recorded_edges)
+    {
+        IsoEdge edge = { n1, n2, x, y, z, u, v, w };
+        *vertex++ = (int)recorded_edges->size();
+        recorded_edges->push_back(edge);
+        return;
+    }
+
     targets = node_table[n1].targets;
     indices = node_table[n1].vertice_list;
 
@@ -3911,6 +4073,63 @@ void IsoPlane::add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int
     num_coords++;
 }
 
+int IsoPlane::getNumThreads()
+{
+#ifdef _OPENMP
+    if (numThreads < 0)
+        numThreads = readConfig("Module.IsoSurface.Threads", 0);
+    if (numThreads == 0)
+        return omp_get_num_procs();
+    return numThreads;
+#else
+    return 1;
+#endif
+}
+
+void IsoPlane::setNumThreads(int n)
+{
+    numThreads = n;
+}
+
+IsoPlane *IsoPlane::createWorker(std::vector<IsoEdge> *edges, int units)
+{
+    return new IsoPlane(*this, edges, units * maxVerticesPerUnit());
+}
+
+IsoPlane *UNI_IsoPlane::createWorker(std::vector<IsoEdge> *edges, int units)
+{
+    return new UNI_IsoPlane(*this, edges, units * maxVerticesPerUnit());
+}
+
+IsoPlane *RECT_IsoPlane::createWorker(std::vector<IsoEdge> *edges, int units)
+{
+    return new RECT_IsoPlane(*this, edges, units * maxVerticesPerUnit());
+}
+
+IsoPlane *STR_IsoPlane::createWorker(std::vector<IsoEdge> *edges, int units)
+{
+    return new STR_IsoPlane(*this, edges, units * maxVerticesPerUnit());
+}
+
+bool IsoPlane::extractParallel(int units)
+{
+    return coChunkedExtraction<IsoPlane, IsoEdge>::extract(*this, units, getNumThreads());
+}
+
+bool IsoPlane::addRecordedVertex(const IsoEdge &edge)
+{
+    if (edge.x < 0)
+        return add_vertex(edge.n1, edge.n2);
+    add_vertex(edge.n1, edge.n2, edge.x, edge.y, edge.z, edge.u, edge.v, edge.w);
+    return true;
+}
+
+void IsoPlane::addWorkerResults(const IsoPlane &worker)
+{
+    standard_cells_found |= worker.standard_cells_found;
+    polyhedral_cells_found |= worker.polyhedral_cells_found;
+}
+
 void IsoPlane::createNeighbourList()
 {
     triPerVertex = maxTriPerVertex;
@@ -10,12 +10,14 @@
 
 #include <util/coTypes.h>
 #include <cstdlib>
+#include <vector>
 #include <alg/IsoSurfaceGPMUtil.h>
 
 namespace covise
 {
 
 class coOutputPort;
+class coIsoCellIndex;
 
 typedef struct NodeInfo_s
 {
@@ -31,8 +33,20 @@ typedef struct cutting_info_s
     int nvert;
 } cutting_info;
 
+// cut edge recorded by a worker of a parallel extraction:
+// arguments of the add_vertex call, x < 0 for add_vertex(n1, n2)
+typedef struct IsoEdge_s
+{
+    int n1, n2;
+    int x, y, z, u, v, w;
+} IsoEdge;
+
+template <class Extractor, class Edge>
+class coChunkedExtraction;
+
 class ALGEXPORT IsoPlane
 {
+    friend class coChunkedExtraction<IsoPlane, IsoEdge>;
     friend class STR_IsoPlane;
     friend class UNI_IsoPlane;
     friend class RECT_IsoPlane;
@@ -95,10 +109,40 @@ private:
     // list was not built successfully with the given default
     int triPerVertex;
 
+    // number of threads for extraction, Module.IsoSurface.Threads,
+    // 0: as many as processors
+    static int numThreads;
+
+    // set for workers of a parallel extraction: cut edges are only
+    // recorded, vertex entries are indices into this list
+    std::vector<IsoEdge> *recorded_edges;
+    bool standard_cells_found;
+
+    // span space index: only the cells in active_cells are visited
+    const coIsoCellIndex *cell_index;
+    std::vector<int> active_list;
+    const int *active_cells;
+
 protected:
     bool add_vertex(int n1, int n2);
     void add_vertex(int n1, int n2, int x, int y, int z, int u, int v, int w);
 
+    // worker sharing the input and node table of parent, with room for
+    // capacity vertex entries
+    IsoPlane(const IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity);
+    virtual IsoPlane *createWorker(std::vector<IsoEdge> *edges, int units);
+    // extract the part of the surface in [begin, end) of the outermost
+    // loop (elements, active cells or x layers), false if out of vertex memory
+    virtual bool extract(int begin, int end);
+    // vertex entries a unit of the outermost loop can produce at most
+    virtual int maxVerticesPerUnit();
+    // extract [0, units) with several threads, see coChunkedExtraction
+    bool extractParallel(int units);
+    // create the vertex for an edge recorded by a worker
+    bool addRecordedVertex(const IsoEdge &edge);
+    // accumulate what a worker found about the cells besides vertices and triangles
+    void addWorkerResults(const IsoPlane &worker);
+
 public:
     bool polyhedral_cells_found;
 
@@ -108,7 +152,7 @@ public:
              const float *x_in, const float *y_in, const float *z_in,
              const float *s_in, const float *i_in,
              const float *u_in, const float *v_in, const float *w_in, float isovalue,
-             bool isConnected, char *ib);
+             bool isConnected, char *ib, const coIsoCellIndex *cellIndex = NULL);
     IsoPlane(int n_elem, int n_nodes, int Type, /*float cutVertexRatio,*/
              const int *el, const int *cl, const int *tl,
              const float *x_in, const float *y_in, const float *z_in,
@@ -124,6 +168,9 @@ public:
     bool createIsoPlane();
     void createNeighbourList();
 
+    static int getNumThreads();
+    static void setNumThreads(int n);
+
     // access to output fields
     int getNumCoords()
     {
@@ -174,6 +221,18 @@ public:
     }
     bool createIsoPlane();
 
+protected:
+    STR_IsoPlane(const STR_IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity)
+        : IsoPlane(parent, edges, capacity)
+        , x_size(parent.x_size)
+        , y_size(parent.y_size)
+        , z_size(parent.z_size)
+    {
+    }
+    virtual IsoPlane *createWorker(std::vector<IsoEdge> *edges, int units);
+    virtual bool extract(int begin, int end);
+    virtual int maxVerticesPerUnit();
+
 private:
     int x_size;
     int y_size;
@@ -194,6 +253,12 @@ public:
     virtual ~UNI_IsoPlane();
     void createIsoPlane();
 
+protected:
+    UNI_IsoPlane(const UNI_IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity);
+    virtual IsoPlane *createWorker(std::vector<IsoEdge> *edges, int units);
+    virtual bool extract(int begin, int end);
+    virtual int maxVerticesPerUnit();
+
 private:
     int x_size;
     int y_size;
@@ -212,6 +277,18 @@ public:
                   bool isConnected, char *ib);
     void createIsoPlane();
 
+protected:
+    RECT_IsoPlane(const RECT_IsoPlane &parent, std::vector<IsoEdge> *edges, int capacity)
+        : IsoPlane(parent, edges, capacity)
+        , x_size(parent.x_size)
+        , y_size(parent.y_size)
+        , z_size(parent.z_size)
+    {
+    }
+    virtual IsoPlane *createWorker(std::vector<IsoEdge> *edges, int units);
+    virtual bool extract(int begin, int end);
+    virtual int maxVerticesPerUnit();
+
 private:
     int x_size;
     int y_size;
@@ -0,0 +1,214 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coTaskPool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+
+using namespace covise;
+
+namespace covise
+{
+// units still to be done by a thread: the owner takes batches from the
+// front, thieves shrink it from the back
+struct coTaskPoolRange
+{
+    std::mutex mutex;
+    int begin;
+    int end;
+    char pad[64]; // keep ranges of different threads in separate cache lines
+};
+
+static coTaskPool *sharedPool = NULL;
+}
+
+struct coTaskPool::Data
+{
+    int numThreads;
+    std::vector<std::thread> threads; // all but thread 0, the caller of run()
+    coTaskPoolRange *ranges;
+
+    std::mutex mutex;
+    std::condition_variable go;
+    std::condition_variable done;
+    unsigned long generation; // number of jobs started
+    int running; // threads still working on the current job
+    bool quit;
+
+    RangeFunc func;
+    void *data;
+    int grain;
+};
+
+coTaskPool::coTaskPool(int numThreads)
+    : d(new Data)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    d->numThreads = numThreads;
+    d->ranges = new coTaskPoolRange[numThreads];
+    d->generation = 0;
+    d->running = 0;
+    d->quit = false;
+    d->func = NULL;
+    d->data = NULL;
+    d->grain = 1;
+    for (int t = 1; t < numThreads; t++)
+        d->threads.push_back(std::thread(&coTaskPool::loop, this, t));
+}
+
+coTaskPool::~coTaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        d->quit = true;
+    }
+    d->go.notify_all();
+    for (size_t i = 0; i < d->threads.size(); i++)
+        d->threads[i].join();
+    delete[] d->ranges;
+    delete d;
+}
+
+int coTaskPool::getNumThreads() const
+{
+    return d->numThreads;
+}
+
+void coTaskPool::run(int n, int grain, RangeFunc func, void *data)
+{
+    if (n <= 0)
+        return;
+    if (grain <= 0)
+        grain = std::max(1, std::min(16, n / (d->numThreads * 64)));
+    if (d->numThreads == 1 || n <= grain)
+    {
+        func(data, 0, n, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        for (int t = 0; t < d->numThreads; t++)
+        {
+            d->ranges[t].begin = (int)((long long)n * t / d->numThreads);
+            d->ranges[t].end = (int)((long long)n * (t + 1) / d->numThreads);
+        }
+        d->func = func;
+        d->data = data;
+        d->grain = grain;
+        d->running = d->numThreads - 1;
+        d->generation++;
+    }
+    d->go.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(d->mutex);
+    while (d->running > 0)
+        d->done.wait(lock);
+}
+
+void coTaskPool::loop(int thread)
+{
+    unsigned long seen = 0;
+    std::unique_lock<std::mutex> lock(d->mutex);
+    for (;;)
+    {
+        while (!d->quit && d->generation == seen)
+            d->go.wait(lock);
+        if (d->quit)
+            return;
+        seen = d->generation;
+
+        lock.unlock();
+        work(thread);
+        lock.lock();
+
+        if (--d->running == 0)
+            d->done.notify_all();
+    }
+}
+
+void coTaskPool::work(int thread)
+{
+    coTaskPoolRange &own = d->ranges[thread];
+    for (;;)
+    {
+        own.mutex.lock();
+        int begin = own.begin;
+        int end = std::min(own.end, begin + d->grain);
+        own.begin = end;
+        own.mutex.unlock();
+
+        if (begin < end)
+            d->func(d->data, begin, end, thread);
+        else if (!steal(thread))
+            return;
+    }
+}
+
+// move the upper half of the largest range left into the range of thread,
+// false if there is no work left
+bool coTaskPool::steal(int thread)
+{
+    for (;;)
+    {
+        int victim = -1, most = 0;
+        for (int t = 0; t < d->numThreads; t++)
+        {
+            if (t == thread)
+                continue;
+            std::lock_guard<std::mutex> lock(d->ranges[t].mutex);
+            int left = d->ranges[t].end - d->ranges[t].begin;
+            if (left > most)
+            {
+                most = left;
+                victim = t;
+            }
+        }
+        if (victim < 0)
+            return false;
+
+        coTaskPoolRange &other = d->ranges[victim];
+        other.mutex.lock();
+        int left = other.end - other.begin;
+        if (left <= 0)
+        {
+            // the owner or another thief was faster
+            other.mutex.unlock();
+            continue;
+        }
+        int end = other.end;
+        int begin = end - (left + 1) / 2;
+        other.end = begin;
+        other.mutex.unlock();
+
+        coTaskPoolRange &own = d->ranges[thread];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+}
+
+coTaskPool *coTaskPool::shared(int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    if (sharedPool && sharedPool->getNumThreads() != numThreads)
+    {
+        delete sharedPool;
+        sharedPool = NULL;
+    }
+    if (!sharedPool)
+        sharedPool = new coTaskPool(numThreads);
+    return sharedPool;
+}
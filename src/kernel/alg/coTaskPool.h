@@ -0,0 +1,67 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_TASK_POOL_H
+#define CO_TASK_POOL_H
+
+#include <util/coTypes.h>
+
+/***********************************************************************\
+ **                                                                     **
+ **   Work stealing thread pool                                         **
+ **                                                                     **
+ **   Description  : Processes the units 0 ... n-1 of a job with a      **
+ **                  fixed set of threads. Every thread starts on an    **
+ **                  equal share of the units and works through it in   **
+ **                  small batches. A thread running out of work steals **
+ **                  the upper half of the largest share left, so that  **
+ **                  units of very different cost keep all threads      **
+ **                  busy. The threads are kept for further jobs.       **
+ **                                                                     **
+ **   Classes      : coTaskPool                                         **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+class ALGEXPORT coTaskPool
+{
+public:
+    // work on the units begin ... end-1, thread is in 0 ... getNumThreads()-1
+    typedef void (*RangeFunc)(void *data, int begin, int end, int thread);
+
+    // numThreads <= 0: one thread per core,
+    // the thread calling run() counts as one of them
+    coTaskPool(int numThreads = 0);
+    ~coTaskPool();
+
+    int getNumThreads() const;
+
+    // process units 0 ... n-1 and return when all of them are done,
+    // units are taken in batches of grain (<= 0: chosen automatically).
+    // Which thread does which unit is not deterministic, so results have
+    // to be stored per unit.
+    void run(int n, int grain, RangeFunc func, void *data);
+
+    // pool shared by all users within a process, re-created if
+    // the number of threads changes - not to be called concurrently
+    static coTaskPool *shared(int numThreads = 0);
+
+private:
+    coTaskPool(const coTaskPool &);
+    coTaskPool &operator=(const coTaskPool &);
+
+    void loop(int thread);
+    void work(int thread);
+    bool steal(int thread);
+
+    struct Data;
+    Data *d;
+};
+}
+#endif
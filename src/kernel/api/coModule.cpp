@@ -13,6 +13,8 @@
 #include <do/coDoPolygons.h>
 #include <do/coDoOctTree.h>
 #include <do/coDoOctTreeP.h>
+#include <do/coDoCellBVH.h>
+#include <util/coTrace.h>
 #include "coModule.h"
 #include "coPort.h"
 #include "coUifSwitchCase.h"
@@ -194,7 +196,7 @@ bool coModule::GoodOctTrees(const coDistributedObject *grid, const coDistributed
     }
     else if (dynamic_cast<const coDoUnstructuredGrid *>(grid))
     {
-        if (dynamic_cast<const coDoOctTree *>(otree))
+        if (dynamic_cast<const coDoOctTree *>(otree) || dynamic_cast<const coDoCellBVH *>(otree))
         {
             return true;
         }
@@ -679,8 +681,13 @@ void coModule::localCompute(void *)
             return;
 
     // call user's compute function, stop pipeline if not successful
-    if (compute(NULL) == STOP_PIPELINE)
-        stopPipeline();
+    if (coTrace::enabled())
+        coTrace::setProcessName(std::string(get_module()) + "_" + get_instance() + "@" + get_host());
+    {
+        coTraceSpan span("module", "compute");
+        if (compute(NULL) == STOP_PIPELINE)
+            stopPipeline();
+    }
     //Add OBJECTNAME-Attribute to
     //the data
     for (i = 0; i < d_numElem; i++)
@@ -704,6 +711,7 @@ void coModule::localCompute(void *)
     }
     for (i = 0; i < d_numElem; i++)
         elemList[i]->postCompute();
+    coTrace::flush();
 }
 
 void
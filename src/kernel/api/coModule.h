@@ -315,12 +315,23 @@ public:
     }
 };
 
+#ifdef COVISE_MODULE_LIBRARY
+// module built as loadable library for the module hosts of the CRB
+#define MODULE_MAIN(Category, Module)                                         \
+    extern "C" COEXPORT int covise_module_main(int argc, char *argv[])        \
+    {                                                                         \
+        coModule *app = new Module(argc, argv);                               \
+        app->start(argc, argv);                                               \
+        return 0;                                                             \
+    }
+#else
 #define MODULE_MAIN(Category, Module)           \
     int main(int argc, char *argv[])            \
     {                                           \
         coModule *app = new Module(argc, argv); \
         app->start(argc, argv);                 \
     }
+#endif
 
 #define COMODULE
 }
@@ -776,6 +776,12 @@ Process::~Process()
 #endif
 }
 
+void Process::init_batching()
+{
+    if (coCoviseConfig::isOn("batching", "System.Network", true))
+        list_of_connections->set_batching(true);
+}
+
 Message *Process::wait_for_msg()
 {
     Message *msg;
@@ -784,6 +790,9 @@ Message *Process::wait_for_msg()
     char tmp_str[255];
 #endif
 
+    // messages sent while handling the previous one
+    Connection::flush_all_batches();
+
     msg_queue->reset();
     msg = msg_queue->next();
     if (msg)
@@ -134,6 +134,9 @@ public:
     {
         send_type = st;
     };
+    // batch small messages sent while handling a message, they are written
+    // when waiting for the next one (System.Network batching, default on)
+    void init_batching();
     Message *wait_for_msg(); // wait for a message
     Message *check_queue();
     Message *check_for_msg(float time = 0.0); // wait for a message
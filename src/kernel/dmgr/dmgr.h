@@ -55,6 +55,7 @@ namespace covise
 {
 
 class DMEntry;
+class MemChunk;
 
 class DMGREXPORT ObjectEntry
 {
@@ -127,7 +128,10 @@ private:
     Connection *data_conn;
     AVLTree<ObjectEntry> *objects;
     int transfermgr;
+    int local_copy; // same host: -1 not yet known, 0 segments not accessible
+    ForeignSharedMemory *foreign_shm; // its segments, mapped read-only
     DMEntry(int i, char *h, Connection *c);
+    ~DMEntry();
     const char *get_hostname(void);
     Connection *get_conn(void)
     {
@@ -181,6 +185,8 @@ public:
 
 class AddressOrderedTree;
 class SizeOrderedTree;
+class coShmSlabAlloc;
+class coShmDirectory;
 
 class DMGREXPORT coShmAlloc : public ShmAccess
 {
@@ -188,6 +194,11 @@ class DMGREXPORT coShmAlloc : public ShmAccess
     static class AddressOrderedTree *used_list;
     static class AddressOrderedTree *free_list;
     static class SizeOrderedTree *free_size_list;
+    coShmSlabAlloc *slabs; // small blocks, NULL if disabled
+    bool use_slabs;
+    coShmDirectory *directory; // object names for the modules, NULL if disabled
+    coShmPtr *tree_malloc(shmSizeType size); // allocation from the AVL trees
+    MemChunk *first_chunk(int seq_no, shmSizeType size); // keeps control blocks out of the trees
 
 public:
     coShmAlloc(int *key, DataManagerProcess *d);
@@ -196,6 +207,15 @@ public:
         delete shm;
     };
     coShmPtr *malloc(shmSizeType size);
+    // switch between size class slabs and AVL trees for small blocks
+    void enable_slabs(bool on)
+    {
+        use_slabs = on;
+    };
+    coShmDirectory *get_directory()
+    {
+        return directory;
+    };
     void get_shmlist(char *ptr)
     {
         shm->get_shmlist((int *)ptr);
@@ -300,6 +320,10 @@ public:
     int handle_msg(Message *msg, bool &localAlloc);
     void deleteMessageData(Message *msg);
     void ask_for_object(Message *msg); // answer requests immediately
+    // answer requests from data managers on the same host immediately
+    void ask_for_local_object(Message *msg);
+    // copy object from the segments of a data manager on the same host
+    int get_local_copy(char *n, DMEntry *dme, ObjectEntry **oe);
     void has_object_changed(Message *msg); // answer requests immediately
     char *get_all_hosts_for_object(char *); // looks for all hosts that have object
     // add new object in database
@@ -307,6 +331,10 @@ public:
     // add new object in database
     int add_object(char *n, int otype, int no, int o, Connection *c);
     int add_object(ObjectEntry *oe); // add new object in database
+    // insert into database and the object directory of the modules
+    int insert_object(ObjectEntry *oe);
+    // remove from the object directory, before the object is freed
+    void unlist_object(const char *n);
     ObjectEntry *get_object(char *n); // get object from database
     // get object from database and take care that the
     // accesses are updated correctly:
@@ -314,6 +342,7 @@ public:
     ObjectEntry *get_local_object(char *n); // get object only from local database
     int delete_object(char *n); // delete object from database
     int destroy_object(char *n, Connection *c); // remove obj from sharedmem.
+    long get_object_size(char *n); // bytes of sharedmem used by obj, -1 if unknown
     // create transferred object
     ObjectEntry *create_object_from_msg(Message *msg, DMEntry *dme);
     // update from transferred object
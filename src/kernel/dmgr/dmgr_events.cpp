@@ -87,6 +87,13 @@ int DataManagerProcess::handle_msg(Message *msg, bool &localAlloc)
         retval = 1;
         break;
     //-------------------------------------------------------------------------
+    case COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT:
+        //-------------------------------------------------------------------------
+        // message from other datamanager on the same host, no conversion
+        ask_for_local_object(msg);
+        retval = 1;
+        break;
+    //-------------------------------------------------------------------------
     case COVISE_MESSAGE_HAS_OBJECT_CHANGED:
 //-------------------------------------------------------------------------
 // message from other datamanager, conversion may be necessary
@@ -186,6 +193,18 @@ int DataManagerProcess::handle_msg(Message *msg, bool &localAlloc)
         localAlloc = true;
         break;
     //-------------------------------------------------------------------------
+    case COVISE_MESSAGE_OBJECT_ACCESSED:
+//-------------------------------------------------------------------------
+// message from local application which found the object in the shared
+// memory directory, only the access is recorded, e.g. for NEW_PART_AVAILABLE
+#ifdef DEBUG
+        sprintf(tmp_str, "OBJECT_ACCESSED %s", msg->data);
+        print_comment(__LINE__, __FILE__, tmp_str);
+#endif
+        get_object(msg->data, msg->conn);
+        retval = 1;
+        break;
+    //-------------------------------------------------------------------------
     case COVISE_MESSAGE_NEW_OBJECT_SHM_MALLOC_LIST:
     {
 //-------------------------------------------------------------------------
@@ -464,6 +483,27 @@ int DataManagerProcess::handle_msg(Message *msg, bool &localAlloc)
         }
         break;
     //-------------------------------------------------------------------------
+    case COVISE_MESSAGE_CTRL_OBJECT_SIZE:
+    {
+        //-------------------------------------------------------------------------
+        // no data that needs to be converted, the answer is a decimal number
+        long size = get_object_size(msg->data);
+        msg->delete_data();
+        if (size >= 0)
+        {
+            msg->type = COVISE_MESSAGE_MSG_OK;
+            msg->data = new char[32];
+            sprintf(msg->data, "%ld", size);
+            msg->length = (int)strlen(msg->data) + 1;
+        }
+        else
+        {
+            msg->type = COVISE_MESSAGE_MSG_FAILED;
+            msg->length = 0;
+        }
+        break;
+    }
+    //-------------------------------------------------------------------------
     case COVISE_MESSAGE_OBJECT_NO_LONGER_USED:
 //-------------------------------------------------------------------------
 // message contains only character data, no conversion necessary
@@ -0,0 +1,377 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include <covise/covise.h>
+#include <do/coDistributedObject.h>
+#include <net/covise_host.h>
+#include <shm/covise_shmslab.h>
+
+#include "dmgr_packer.h"
+
+#undef DEBUG
+
+/***********************************************************************\
+ **                                                                     **
+ **   Object transfer between data managers on the same host            **
+ **                                                                     **
+ **   Description  : Instead of packing an object into OBJECT_FOLLOWS   **
+ **                  messages, the sending data manager only tells the  **
+ **                  position of the object and its list of segments.   **
+ **                  The receiver maps these segments read-only and     **
+ **                  copies the object tree directly into its own       **
+ **                  shared memory (one memcpy per array). Object       **
+ **                  pointers are (segment, offset) pairs relative to   **
+ **                  the data manager owning the segments, so the       **
+ **                  foreign segments cannot be used in place.          **
+ **                  If the segments cannot be mapped (different host   **
+ **                  or namespace), ASK_FOR_OBJECT is used as before.   **
+ **                                                                     **
+ **   Classes      : ShmObjectCopier                                    **
+ **                                                                     **
+\***********************************************************************/
+
+using namespace covise;
+
+// guards against corrupt pointers forming cycles
+static const int MAX_OBJECT_DEPTH = 1000;
+
+static int rngbuf_type = coDistributedObject::calcType("RNGBUF");
+
+const int *ShmObjectCopier::get_source(int seq_no, shmSizeType offset, shmSizeType len)
+{
+    return (const int *)source->get_pointer(seq_no, offset, len);
+}
+
+// number of ints used by header and elements, 0 for an invalid object
+int ShmObjectCopier::object_length(const int *src, int seq_no, shmSizeType offset)
+{
+    int pos = coDoHeader::getIntHeaderSize();
+    int no_of_els = src[6];
+    if (no_of_els < 0)
+        return 0;
+    for (int i = 0; i < no_of_els; i++)
+    {
+        // largest element is SHMPTR/NULLPTR or a double with its type
+        if (!get_source(seq_no, offset, (pos + 1 + MAX_INT_PER_DATA) * sizeof(int)))
+            return 0;
+        switch (src[pos])
+        {
+        case CHARSHM:
+        case SHORTSHM:
+        case INTSHM:
+        case FLOATSHM:
+            pos += 2;
+            break;
+        case LONGSHM:
+            pos += 1 + sizeof(long) / sizeof(int) + (sizeof(long) % sizeof(int) != 0);
+            break;
+        case DOUBLESHM:
+            pos += 1 + sizeof(double) / sizeof(int) + (sizeof(double) % sizeof(int) != 0);
+            break;
+        case SHMPTR:
+        case COVISE_NULLPTR:
+            pos += 1 + (1 + sizeof(shmSizeType) / sizeof(int));
+            break;
+        default:
+            return 0;
+        }
+    }
+    return pos;
+}
+
+// verify that the complete tree below (seq_no, offset) is mapped,
+// so that the copy cannot fail half way
+int ShmObjectCopier::check_item(int seq_no, shmSizeType offset, int depth)
+{
+    if (depth > MAX_OBJECT_DEPTH)
+        return 0;
+    const int *src = get_source(seq_no, offset, 2 * sizeof(int));
+    if (!src)
+        return 0;
+
+    int length = src[1];
+    switch (src[0])
+    {
+    case CHARSHMARRAY:
+    case SHORTSHMARRAY:
+    case INTSHMARRAY:
+    case LONGSHMARRAY:
+    case FLOATSHMARRAY:
+    case DOUBLESHMARRAY:
+        return length >= 0 && get_source(seq_no, offset, coShmSlabAlloc::allocSize(src[0], length)) != NULL;
+    case STRINGSHMARRAY:
+        if (length < 0 || !get_source(seq_no, offset, coShmSlabAlloc::allocSize(src[0], length)))
+            return 0;
+        for (int i = 0; i < length; i++)
+        {
+            if (src[2 + 2 * i] != 0 && !check_item(src[2 + 2 * i], src[3 + 2 * i], depth + 1))
+                return 0;
+        }
+        return 1;
+    case SHMPTRARRAY:
+        if (length < 0 || !get_source(seq_no, offset, coShmSlabAlloc::allocSize(src[0], length)))
+            return 0;
+        for (int i = 0; i < length && src[2 + 2 * i] != 0; i++)
+        {
+            if (!check_item(src[2 + 2 * i], src[3 + 2 * i], depth + 1))
+                return 0;
+        }
+        return 1;
+    }
+
+    // presumably complete data object
+    if (!get_source(seq_no, offset, coDoHeader::getHeaderSize()))
+        return 0;
+    int len = object_length(src, seq_no, offset);
+    if (len == 0 || src[11] != SHMPTR)
+        return 0;
+    for (int pos = 11; pos < len;)
+    {
+        switch (src[pos])
+        {
+        case SHMPTR:
+            if (!check_item(src[pos + 1], src[pos + 2], depth + 1))
+                return 0;
+            pos += 3;
+            break;
+        case COVISE_NULLPTR:
+            pos += 3;
+            break;
+        case LONGSHM:
+            pos += 1 + sizeof(long) / sizeof(int) + (sizeof(long) % sizeof(int) != 0);
+            break;
+        case DOUBLESHM:
+            pos += 1 + sizeof(double) / sizeof(int) + (sizeof(double) % sizeof(int) != 0);
+            break;
+        default:
+            pos += 2;
+            break;
+        }
+    }
+    return 1;
+}
+
+coShmPtr *ShmObjectCopier::copy_array(const int *src)
+{
+    int type = src[0];
+    int length = src[1];
+    shmSizeType size = coShmSlabAlloc::allocSize(type, length);
+    coShmPtr *shm_ptr = datamgr->shm_alloc(type, length);
+    int *dest = (int *)shm_ptr->getPtr();
+
+    switch (type)
+    {
+    case STRINGSHMARRAY:
+        // pointers are filled in below, type and length are already set
+        for (int i = 0; i < length; i++)
+        {
+            dest[2 + 2 * i] = 0;
+            dest[3 + 2 * i] = 0;
+            if (src[2 + 2 * i] == 0)
+                continue;
+            coShmPtr *str = copy_item(src[2 + 2 * i], src[3 + 2 * i]);
+            dest[2 + 2 * i] = str->get_shm_seq_no();
+            dest[3 + 2 * i] = str->get_offset();
+            delete str;
+        }
+        break;
+    case SHMPTRARRAY:
+        // shm_alloc cleared all entries, the first 0 entry ends the list
+        for (int i = 0; i < length && src[2 + 2 * i] != 0; i++)
+        {
+            coShmPtr *obj = copy_item(src[2 + 2 * i], src[3 + 2 * i]);
+            dest[2 + 2 * i] = obj->get_shm_seq_no();
+            dest[3 + 2 * i] = obj->get_offset();
+            delete obj;
+        }
+        break;
+    default:
+        memcpy(dest, src, size);
+        bytes += size;
+        break;
+    }
+    return shm_ptr;
+}
+
+coShmPtr *ShmObjectCopier::copy_object(const int *src, int length)
+{
+    // same size as allocated by Packer::read_header
+    int no_of_els = src[6];
+    coShmPtr *shm_ptr = datamgr->shm_alloc(CHARSHMARRAY, coDoHeader::getHeaderSize() + no_of_els * SIZE_PER_TYPE_ENTRY);
+    int *dest = (int *)shm_ptr->getPtr();
+    memcpy(dest, src, length * sizeof(int));
+    dest[1] = length * sizeof(int);
+    bytes += length * sizeof(int);
+
+    for (int pos = 11; pos < length;)
+    {
+        switch (src[pos])
+        {
+        case SHMPTR:
+        {
+            coShmPtr *sub = copy_item(src[pos + 1], src[pos + 2]);
+            dest[pos + 1] = sub->get_shm_seq_no();
+            dest[pos + 2] = sub->get_offset();
+            delete sub;
+            pos += 3;
+            break;
+        }
+        case COVISE_NULLPTR:
+            pos += 3;
+            break;
+        case LONGSHM:
+            pos += 1 + sizeof(long) / sizeof(int) + (sizeof(long) % sizeof(int) != 0);
+            break;
+        case DOUBLESHM:
+            pos += 1 + sizeof(double) / sizeof(int) + (sizeof(double) % sizeof(int) != 0);
+            break;
+        default:
+            pos += 2;
+            break;
+        }
+    }
+    return shm_ptr;
+}
+
+coShmPtr *ShmObjectCopier::copy_item(int seq_no, shmSizeType offset)
+{
+    const int *src = get_source(seq_no, offset, 2 * sizeof(int));
+    switch (src[0])
+    {
+    case CHARSHMARRAY:
+    case SHORTSHMARRAY:
+    case INTSHMARRAY:
+    case LONGSHMARRAY:
+    case FLOATSHMARRAY:
+    case DOUBLESHMARRAY:
+    case STRINGSHMARRAY:
+    case SHMPTRARRAY:
+        return copy_array(src);
+    default: // presumably complete data object
+        return copy_object(src, object_length(src, seq_no, offset));
+    }
+}
+
+coShmPtr *ShmObjectCopier::copy(int seq_no, shmSizeType offset, char **tmp_name)
+{
+    if (!check_item(seq_no, offset, 0))
+        return NULL;
+
+    coShmPtr *shm_ptr = copy_item(seq_no, offset);
+    int *iptr = (int *)shm_ptr->getPtr();
+    coShmArray *name = new coShmArray(iptr[12], iptr[13]);
+    char *name_ptr = (char *)name->getDataPtr();
+    *tmp_name = new char[strlen(name_ptr) + 1];
+    strcpy(*tmp_name, name_ptr);
+    delete name;
+    return shm_ptr;
+}
+
+// answer ASK_FOR_LOCAL_OBJECT: position of the object and our segments
+void DataManagerProcess::ask_for_local_object(Message *msg)
+{
+    ObjectEntry *oe = get_local_object(msg->data);
+    if (oe && (oe->type == rngbuf_type || !ShmConfig::useLocalTransfer()))
+    {
+        // let the receiver take the packed object instead
+        ask_for_object(msg);
+        return;
+    }
+    msg->delete_data();
+
+    if (!oe)
+    {
+        msg->data = NULL;
+        msg->length = 0;
+        msg->type = COVISE_MESSAGE_OBJECT_NOT_FOUND;
+        msg->conn->send_msg(msg);
+        return;
+    }
+
+    //   +--------+--------+-------+------+------+------+------+----
+    //   + seq_no | offset | nsegs | key1 | len1 | key2 | len2 | ...
+    //   +--------+--------+-------+------+------+------+------+----
+    int *idata = new int[3 + 2 * MAX_NO_SHM];
+    idata[0] = oe->shm_seq_no;
+    idata[1] = oe->offset;
+    shm->get_shmlist((char *)&idata[2]);
+    msg->type = COVISE_MESSAGE_LOCAL_OBJECT_FOLLOWS;
+    msg->data = (char *)idata;
+    msg->length = (3 + 2 * idata[2]) * sizeof(int);
+    msg->conn->send_msg(msg);
+    delete[] idata;
+    msg->data = NULL;
+
+    // a destroy on our side has to wait for the receiver's MSG_OK, which
+    // it sends only after the copy has been finished
+    if (oe->get_access_right(msg->conn) != ACC_REMOTE_DATA_MANAGER)
+        oe->add_access(msg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
+}
+
+// 1: object copied or received, 0: not found, -1: use ASK_FOR_OBJECT
+int DataManagerProcess::get_local_copy(char *name, DMEntry *dme, ObjectEntry **oe)
+{
+    int covise_msg_type_arr[3];
+    Message *msg = new Message(COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT, (int)strlen(name) + 1, name, MSG_NOCOPY);
+    dme->conn->send_msg(msg);
+    msg->data = NULL;
+    delete msg;
+
+    covise_msg_type_arr[0] = COVISE_MESSAGE_LOCAL_OBJECT_FOLLOWS;
+    covise_msg_type_arr[1] = COVISE_MESSAGE_OBJECT_FOLLOWS;
+    covise_msg_type_arr[2] = COVISE_MESSAGE_OBJECT_NOT_FOUND;
+    msg = wait_for_msg(covise_msg_type_arr, 3, dme->conn);
+
+    int retval = 0;
+    switch (msg->type)
+    {
+    case COVISE_MESSAGE_LOCAL_OBJECT_FOLLOWS:
+    {
+        int *idata = (int *)msg->data;
+        coShmPtr *shm_ptr = NULL;
+        char *tmp_name = NULL;
+        if (!dme->foreign_shm)
+            dme->foreign_shm = new ForeignSharedMemory;
+        if (dme->foreign_shm->attach_list(&idata[2]))
+        {
+            ShmObjectCopier copier(dme->foreign_shm, this);
+            shm_ptr = copier.copy(idata[0], (shmSizeType)idata[1], &tmp_name);
+            if (shm_ptr)
+                print_comment(__LINE__, __FILE__, "copied %s from local data manager: %ld bytes", tmp_name, copier.get_bytes_copied());
+        }
+        if (shm_ptr)
+        {
+            *oe = new ObjectEntry(tmp_name, shm_ptr->shm_seq_no, shm_ptr->offset, dme->conn, dme);
+            delete[] tmp_name;
+            delete shm_ptr;
+            retval = 1;
+        }
+        else
+        {
+            print_comment(__LINE__, __FILE__, "cannot map segments of data manager on %s, using ASK_FOR_OBJECT", dme->get_hostname());
+            dme->local_copy = 0;
+            dme->foreign_shm->detach_all();
+            retval = -1;
+        }
+        break;
+    }
+    case COVISE_MESSAGE_OBJECT_FOLLOWS:
+    {
+        Message *data_msg = new Message;
+        dme->recv_data_msg(data_msg);
+        *oe = create_object_from_msg(data_msg, dme);
+        delete data_msg;
+        retval = 1;
+        break;
+    }
+    default:
+        break;
+    }
+    msg->delete_data();
+    delete msg;
+    return retval;
+}
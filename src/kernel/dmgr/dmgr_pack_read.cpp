@@ -68,12 +68,48 @@ always IEEE is enforced. This leads to the ugly #ifdef constructs.
 
 #define SET_CHUNK 20
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
 using namespace covise;
 
+#ifdef BYTESWAP
+static const bool host_little_endian = true;
+#else
+static const bool host_little_endian = false;
+#endif
+
+// copy n 32 bit words from the receive buffer to shm,
+// reversing the byte order of each word if requested
+static void copy_words(int *dst, const int *src, int n, bool swap)
+{
+    if (!swap)
+    {
+        memcpy(dst, src, n * sizeof(int));
+        return;
+    }
+    int i = 0;
+#if defined(__SSSE3__)
+    const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_shuffle_epi8(v, mask));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        unsigned int w = (unsigned int)src[i];
+        dst[i] = (int)((w >> 24) | ((w >> 8) & 0xff00) | ((w << 8) & 0xff0000) | (w << 24));
+    }
+}
+
 Packer::Packer(Message *m, DataManagerProcess *dm)
 {
     shm_obj_ptr = 0L;
     convert = m->conn->convert_to;
+    native_arrays = false;
     buffer = new PackBuffer(dm, m);
     number_of_data_elements = 0;
     datamgr = dm;
@@ -633,7 +669,7 @@ int Packer::read_short_array()
     return 1;
 }
 
-int Packer::read_int_array()
+int Packer::read_int_array(int little_endian)
 {
     int bytes_needed, rest, length;
     char *tmp_shm_obj_ptr;
@@ -665,6 +701,8 @@ int Packer::read_int_array()
     else
 #endif
         rest = length * SIZEOF_IEEE_INT;
+    // network byte order unless tagged by the sender
+    bool swap = (little_endian != 0) != host_little_endian;
     while (rest > 0) // there is still something to receive
     {
         bytes_needed = rest;
@@ -681,8 +719,7 @@ int Packer::read_int_array()
 #endif
         else
 #endif
-            memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
-        swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
+            copy_words((int *)tmp_shm_obj_ptr, (const int *)tmp_char_ptr, bytes_needed / sizeof(int), swap);
         rest -= bytes_needed;
         tmp_shm_obj_ptr += bytes_needed;
     }
@@ -745,7 +782,7 @@ int Packer::read_long_array()
     return 1;
 }
 
-int Packer::read_float_array()
+int Packer::read_float_array(int little_endian)
 {
     int bytes_needed, rest, length;
     char *tmp_shm_obj_ptr;
@@ -777,6 +814,8 @@ int Packer::read_float_array()
     else
 #endif
         rest = length * SIZEOF_IEEE_FLOAT;
+    // network byte order unless tagged by the sender
+    bool swap = (little_endian != 0) != host_little_endian;
     while (rest > 0) // there is still something to receive
     {
         bytes_needed = rest;
@@ -793,8 +832,7 @@ int Packer::read_float_array()
 #endif
         else
 #endif
-            memcpy(tmp_shm_obj_ptr, tmp_char_ptr, bytes_needed);
-        swap_bytes((unsigned int *)tmp_shm_obj_ptr, bytes_needed / sizeof(int));
+            copy_words((int *)tmp_shm_obj_ptr, (const int *)tmp_char_ptr, bytes_needed / sizeof(int), swap);
         rest -= bytes_needed;
         tmp_shm_obj_ptr += bytes_needed;
     }
@@ -951,6 +989,12 @@ int Packer::read_shm_pointer()
     case FLOATSHMARRAY:
         read_float_array();
         break;
+    case INTSHMARRAY | PACK_LITTLE_ENDIAN:
+        read_int_array(1);
+        break;
+    case FLOATSHMARRAY | PACK_LITTLE_ENDIAN:
+        read_float_array(1);
+        break;
     case DOUBLESHMARRAY:
         read_double_array();
         break;
@@ -77,6 +77,7 @@ Packer::Packer(Message *m, int s, int o)
     shm_obj_ptr = (int *)shmptr->getPtr();
     delete shmptr;
     convert = m->conn->convert_to;
+    native_arrays = bulk_arrays && m->conn->accepts_native_arrays();
     buffer = new PackBuffer(m);
     number_of_data_elements = 0;
 }
@@ -87,7 +88,21 @@ inline
     void
     PackBuffer::send()
 {
-    if (intbuffer_ptr != 0)
+    if (num_segments > 0)
+    {
+        // data written directly from shm: buffered ints since the last
+        // direct write form the tail of the message
+        add_segment(&intbuffer[buffer_start], (intbuffer_ptr - buffer_start) * sizeof(int));
+        msg->length = 0;
+        for (int i = 0; i < num_segments; i++)
+            msg->length += (int)segments[i].length;
+        print_comment(__LINE__, __FILE__, "msg->length: %d (%d parts)", msg->length, num_segments);
+        conn->send_msg_parts(msg->type, segments, num_segments);
+        num_segments = 0;
+        buffer_start = 0;
+        direct_bytes = 0;
+    }
+    else if (intbuffer_ptr != 0)
     {
         msg->length = intbuffer_ptr * sizeof(int);
         print_comment(__LINE__, __FILE__, "msg->length: %d", msg->length);
@@ -146,6 +161,40 @@ inline
 #endif
 }
 
+void PackBuffer::add_segment(const void *data, int n)
+{
+    if (n <= 0)
+        return;
+    segments[num_segments].data = data;
+    segments[num_segments].length = n;
+    num_segments++;
+}
+
+void PackBuffer::write_direct(const char *data, int n)
+{
+    static const char padding[SIZEOF_ALIGNMENT] = { 0 };
+
+    while (n > 0)
+    {
+        // keep room for buffered ints, chunk, padding and the tail
+        if (num_segments + 4 > IOVEC_MAX_LENGTH || direct_bytes >= PACK_DIRECT_MAX_SIZE)
+        {
+            send();
+            intbuffer_ptr = 0;
+        }
+        add_segment(&intbuffer[buffer_start], (intbuffer_ptr - buffer_start) * sizeof(int));
+        int chunk = n < PACK_DIRECT_MAX_SIZE ? n : PACK_DIRECT_MAX_SIZE;
+        add_segment(data, chunk);
+        // the receiver expects array data padded to SIZEOF_ALIGNMENT
+        if (chunk % SIZEOF_ALIGNMENT)
+            add_segment(padding, SIZEOF_ALIGNMENT - chunk % SIZEOF_ALIGNMENT);
+        buffer_start = intbuffer_ptr;
+        direct_bytes += chunk;
+        data += chunk;
+        n -= chunk;
+    }
+}
+
 char *PackBuffer::get_ptr_for_n_bytes(int &n) // always aligned
 {
     int tmp_ptr;
@@ -473,6 +522,10 @@ int Packer::write_int_array()
 #endif
     if (*shm_obj_ptr == INTSHMARRAY) // *shm_obj_ptr == type
     {
+#ifndef CRAY
+        if (native_arrays)
+            return write_bulk_array(INTSHMARRAY);
+#endif
         buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip INTSHMARRAY
     }
@@ -573,6 +626,10 @@ int Packer::write_float_array()
 #endif
     if (*shm_obj_ptr == FLOATSHMARRAY) // *shm_obj_ptr == type
     {
+#ifndef CRAY
+        if (native_arrays)
+            return write_bulk_array(FLOATSHMARRAY);
+#endif
         buffer->write_int(*shm_obj_ptr);
         shm_obj_ptr++; // skip FLOATSHMARRAY
     }
@@ -622,6 +679,38 @@ int Packer::write_float_array()
     return 1;
 }
 
+// int and float arrays in the byte order of this host: large arrays are
+// handed to writev directly from shm, the receiver swaps if necessary
+int Packer::write_bulk_array(int type)
+{
+    int length = shm_obj_ptr[1];
+    int rest = length * SIZEOF_IEEE_INT;
+    const char *data = (const char *)(shm_obj_ptr + 2);
+
+#ifdef BYTESWAP
+    buffer->write_int(type | PACK_LITTLE_ENDIAN);
+#else
+    buffer->write_int(type);
+#endif
+    buffer->write_int(length);
+    shm_obj_ptr += 2 + length;
+
+    if (rest >= IOVEC_MIN_SIZE)
+    {
+        buffer->write_direct(data, rest);
+        return 1;
+    }
+    while (rest > 0) // small arrays are cheaper to copy
+    {
+        int bytes_needed = rest;
+        char *tmp_char_ptr = buffer->get_ptr_for_n_bytes(bytes_needed);
+        memcpy(tmp_char_ptr, data, bytes_needed);
+        rest -= bytes_needed;
+        data += bytes_needed;
+    }
+    return 1;
+}
+
 int Packer::write_double_array()
 {
     int bytes_needed, rest;
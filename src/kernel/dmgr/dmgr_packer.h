@@ -34,6 +34,12 @@ const int OBJECT_BUFFER_SIZE = 50000 * SIZEOF_ALIGNMENT;
 const int IOVEC_MAX_LENGTH = 16;
 #endif
 
+// largest shm chunk handed to writev per message; big arrays are split
+const int PACK_DIRECT_MAX_SIZE = 16 * 1024 * 1024;
+// or'ed into the type of INTSHMARRAY/FLOATSHMARRAY entries that are sent
+// in little endian byte order instead of the network byte order
+const int PACK_LITTLE_ENDIAN = 0x100;
+
 // the following computes the size of a type entry for a data object
 // usually: TYPE + Data (for char, short, int, etc.) or
 //          TYPE + SHM_SEQ_NO + OFFSET (for shmptr, arrays, etc.)
@@ -57,6 +63,12 @@ private:
     Message *msg; // message that will be sent
     Connection *conn; // connection through which the message will be sent
     DataManagerProcess *datamgr; // to allow shm_alloc
+    IoBuffer segments[IOVEC_MAX_LENGTH]; // parts of next message if writing directly
+    int num_segments;
+    int buffer_start; // first int in buffer not yet added to segments
+    int direct_bytes; // shm data referenced by segments
+    void add_segment(const void *data, int n);
+
 public:
     //initialize for receive
     PackBuffer(DataManagerProcess *dm, Message *m)
@@ -71,6 +83,9 @@ public:
         buffer_size = msg->length;
         intbuffer_size = msg->length / sizeof(int);
         intbuffer_ptr = 0;
+        num_segments = 0;
+        buffer_start = 0;
+        direct_bytes = 0;
     };
     PackBuffer(Message *m) // initialize for send
     {
@@ -83,6 +98,9 @@ public:
         buffer_size = OBJECT_BUFFER_SIZE;
         intbuffer_size = OBJECT_BUFFER_SIZE / sizeof(int);
         intbuffer_ptr = 0;
+        num_segments = 0;
+        buffer_start = 0;
+        direct_bytes = 0;
     };
     ~PackBuffer()
     {
@@ -94,6 +112,9 @@ public:
     char *get_ptr_for_n_bytes(int &n); // returns pointer to buffer and
     // sets n to length of available space (always aligned to SIZEOF_ALIGNMENT)
     void write_int(int i);
+    // send n bytes of shared memory without copying them into the buffer,
+    // data has to stay unchanged until the next send()
+    void write_direct(const char *data, int n);
     void read_int(int &i);
     void put_back_int();
     char *get_current_pointer_for_n_bytes(int &n);
@@ -112,6 +133,8 @@ class DMGREXPORT Packer
 #ifndef CRAY
     static int iovcovise_arr[IOVEC_MAX_LENGTH];
 #endif
+    static bool bulk_arrays; // int/float arrays in native byte order
+    bool native_arrays; // bulk_arrays and the receiver has announced to understand them
     int get_buffer_ptr(int);
     int write_object();
     int write_header();
@@ -128,6 +151,7 @@ class DMGREXPORT Packer
     int write_int_array();
     int write_long_array();
     int write_float_array();
+    int write_bulk_array(int type);
     int write_double_array();
     int write_shm_string_array();
     int write_shm_pointer_array();
@@ -149,9 +173,9 @@ class DMGREXPORT Packer
     int read_double();
     int read_char_array();
     int read_short_array();
-    int read_int_array();
+    int read_int_array(int little_endian = 0);
     int read_long_array();
-    int read_float_array();
+    int read_float_array(int little_endian = 0);
     int read_double_array();
     int read_shm_string_array();
     int read_shm_pointer_array();
@@ -176,6 +200,43 @@ public:
         return read_object(tmp_name);
     };
     void flush();
+    // select bulk transfer of int/float arrays (default) or the
+    // element wise conversion to network byte order - the latter is
+    // always used for receivers not announcing DF_NATIVE_ARRAYS
+    static void set_bulk_arrays(bool on)
+    {
+        bulk_arrays = on;
+    }
+};
+
+// deep copy of an object from the mapped segments of a data manager on the
+// same host into the own shared memory - same layout as the result of
+// Packer::unpack, but without packing, conversion and socket transfer
+class DMGREXPORT ShmObjectCopier
+{
+    const ForeignSharedMemory *source;
+    DataManagerProcess *datamgr;
+    long bytes; // payload copied so far
+    const int *get_source(int seq_no, shmSizeType offset, shmSizeType len);
+    int object_length(const int *src, int seq_no, shmSizeType offset);
+    int check_item(int seq_no, shmSizeType offset, int depth);
+    coShmPtr *copy_item(int seq_no, shmSizeType offset);
+    coShmPtr *copy_object(const int *src, int length);
+    coShmPtr *copy_array(const int *src);
+
+public:
+    ShmObjectCopier(const ForeignSharedMemory *s, DataManagerProcess *dm)
+        : source(s)
+        , datamgr(dm)
+        , bytes(0)
+    {
+    }
+    // NULL if the source object is not completely accessible
+    coShmPtr *copy(int seq_no, shmSizeType offset, char **tmp_name);
+    long get_bytes_copied() const
+    {
+        return bytes;
+    }
 };
 }
 #endif
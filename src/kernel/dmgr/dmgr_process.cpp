@@ -25,6 +25,12 @@
 #include <net/covise_host.h>
 
 #include "dmgr_packer.h"
+#include <shm/covise_shmslab.h>
+#include <shm/covise_shmdir.h>
+#include <util/coTrace.h>
+
+#include <set>
+#include <utility>
 
 #undef DEBUG
 
@@ -151,7 +157,8 @@ void DataManagerProcess::ask_for_object(Message *msg)
 #endif
         //      covise_time->mark(__LINE__, "object will be packed now");
         oe->pack_and_send_object(msg, this);
-        oe->add_access(msg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
+        if (oe->get_access_right(msg->conn) != ACC_REMOTE_DATA_MANAGER)
+            oe->add_access(msg->conn, ACC_REMOTE_DATA_MANAGER, ACC_READ_ONLY);
 #ifdef DEBUG
 //	print_comment(__LINE__, __FILE__, "vor dm_ptr->send_data_msg");
 #endif
@@ -197,15 +204,16 @@ void DataManagerProcess::exch_trf_msg(Message *msg)
 Message *DataManagerProcess::wait_for_msg(int covise_msg_type, Connection *conn = 0)
 {
     Message *msg;
-    int covise_msg_type_arr[3];
+    int covise_msg_type_arr[4];
 
     covise_msg_type_arr[0] = covise_msg_type;
     covise_msg_type_arr[1] = COVISE_MESSAGE_ASK_FOR_OBJECT;
     covise_msg_type_arr[2] = COVISE_MESSAGE_HAS_OBJECT_CHANGED;
+    covise_msg_type_arr[3] = COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT;
 
     while (1)
     {
-        msg = Process::wait_for_msg(covise_msg_type_arr, 3, conn);
+        msg = Process::wait_for_msg(covise_msg_type_arr, 4, conn);
         switch (msg->type)
         {
         case COVISE_MESSAGE_ASK_FOR_OBJECT:
@@ -213,6 +221,11 @@ Message *DataManagerProcess::wait_for_msg(int covise_msg_type, Connection *conn
             msg->delete_data();
             delete msg;
             break;
+        case COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT:
+            ask_for_local_object(msg);
+            msg->delete_data();
+            delete msg;
+            break;
         case COVISE_MESSAGE_HAS_OBJECT_CHANGED:
             has_object_changed(msg);
             msg->delete_data();
@@ -234,7 +247,7 @@ Message *DataManagerProcess::wait_for_msg(int *covise_msg_type, int no,
 {
 
     Message *msg;
-    int *covise_msg_type_arr = new int[no + 2];
+    int *covise_msg_type_arr = new int[no + 3];
     int i;
 #ifdef DEBUG
     char tmp_str[255];
@@ -244,10 +257,11 @@ Message *DataManagerProcess::wait_for_msg(int *covise_msg_type, int no,
         covise_msg_type_arr[i] = covise_msg_type[i];
     covise_msg_type_arr[i++] = COVISE_MESSAGE_ASK_FOR_OBJECT;
     covise_msg_type_arr[i++] = COVISE_MESSAGE_HAS_OBJECT_CHANGED;
+    covise_msg_type_arr[i++] = COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT;
 
     while (1)
     {
-        msg = Process::wait_for_msg(covise_msg_type_arr, no + 2, (Connection *)NULL);
+        msg = Process::wait_for_msg(covise_msg_type_arr, no + 3, (Connection *)NULL);
         switch (msg->type)
         {
         case COVISE_MESSAGE_ASK_FOR_OBJECT:
@@ -255,6 +269,11 @@ Message *DataManagerProcess::wait_for_msg(int *covise_msg_type, int no,
             msg->delete_data();
             delete msg;
             break;
+        case COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT:
+            ask_for_local_object(msg);
+            msg->delete_data();
+            delete msg;
+            break;
         case COVISE_MESSAGE_HAS_OBJECT_CHANGED:
             has_object_changed(msg);
             msg->delete_data();
@@ -398,6 +417,8 @@ DataManagerProcess::DataManagerProcess(char *name, int id, int *key)
     msg_queue = new List<Message>();
     init_object_id();
     this_process = dmgr_process = this;
+    if (coTrace::enabled())
+        coTrace::setProcessName(std::string("crb@") + host->getAddress());
 #ifdef COVISE_Signals
     // Initialization of signal handlers
     sig_handler.addSignal(SIGBUS, (void *)dmgr_signal_handler, NULL);
@@ -806,111 +827,25 @@ coShmPtr *DataManagerProcess::shm_alloc(int type, shmSizeType msize)
 #ifdef DEBUG
     char tmpstr[255];
 #endif
-    int i;
-
-    /// Collect size in this variable:
 
-    shmSizeType size = sizeof(int); // all shm vars start with type
-
-    //
-    switch (type)
+    // size layout is shared with the application side slab allocator
+    shmSizeType size = coShmSlabAlloc::allocSize(type, msize);
+    if (size == 0)
     {
-    case FLOATSHM:
-        size += sizeof(float);
-        break;
-    case DOUBLESHM:
-        size += sizeof(double);
-        break;
-    case CHARSHM:
-        size += sizeof(char);
-        break;
-    case SHORTSHM:
-        size += sizeof(short);
-        break;
-    case LONGSHM:
-        size += sizeof(long);
-        break;
-    case INTSHM:
-        size += sizeof(int);
-        break;
-    case FLOATSHMARRAY:
-        size += msize * sizeof(float) + 2 * sizeof(int);
-        break;
-    case DOUBLESHMARRAY:
-        size += msize * sizeof(double) + 2 * sizeof(int);
-        break;
-
-    // All these add 2 ints: one for length and one for safety value.
-    // the additional third int is for alignment whwnwver this may be doubtful
-    case STRINGSHMARRAY:
-        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
-        break;
-    case CHARSHMARRAY:
-        size += msize * sizeof(char) + 3 * sizeof(int);
-        break;
-    case SHORTSHMARRAY:
-        size += msize * sizeof(short) + 3 * sizeof(int);
-        break;
-    case LONGSHMARRAY:
-        size += msize * sizeof(long) + 3 * sizeof(int);
-        break;
-    case INTSHMARRAY:
-        size += msize * sizeof(int) + 2 * sizeof(int);
-        break;
-    case SHMPTRARRAY:
-        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
-        break;
-    default:
         print_comment(__LINE__, __FILE__, "unkown type %d for shm_alloc\ncannot provide memory\n", type);
-        break;
-    };
-
-    // only ose aligned memory sizes
-    int alignRest = size % SIZEOF_ALIGNMENT;
-    if (alignRest)
-        size += (SIZEOF_ALIGNMENT - alignRest);
-
-    // size in 'ints'
-    int intSize = size / sizeof(int);
+        size = coShmSlabAlloc::allocSize(INTSHM, 0);
+    }
 
     // allocate memory
     chptr = shm->malloc(size);
 
-    // int pointer to our memory
-    int *iptr = (int *)chptr->getPtr();
-
-    // type info
-    iptr[0] = type;
-
-    // other info special to type
-    switch (type)
-    {
-    // fill memory with NULL
-    case SHMPTRARRAY:
-        iptr[1] = (int)msize;
-        unsigned int ui;
-        for (ui = 2; ui < (2 * msize) + 2; ui++)
-        {
-            iptr[ui] = 0;
-        }
-        iptr[intSize - 1] = type;
-        break;
-
-    case FLOATSHMARRAY:
-    case DOUBLESHMARRAY:
-    case STRINGSHMARRAY:
-    case CHARSHMARRAY:
-    case SHORTSHMARRAY:
-    case LONGSHMARRAY:
-    case INTSHMARRAY:
-        iptr[1] = (int)msize;
+    // type info and other info special to type
+    coShmSlabAlloc::initItem(chptr->getPtr(), type, msize, size);
 #ifdef FILL_SHM
-        for (i = 2; i < intSize; i++)
-            iptr[i] = EMPTY_VALUE;
+    int *iptr = (int *)chptr->getPtr();
+    for (int i = 2; i < size / sizeof(int) - 1; i++)
+        iptr[i] = EMPTY_VALUE;
 #endif
-        iptr[intSize - 1] = type;
-        break;
-    };
 #ifdef DEBUG
     sprintf(tmpstr, "DataManagerProcess::shm_alloc size: %d of type %d", size, type);
     print_comment(__LINE__, __FILE__, tmpstr, 8);
@@ -982,7 +917,7 @@ int DataManagerProcess::add_object(char *n, int otype, int no, int o, Connection
     // environment
 
     //    if(get_object(n, conn) == NULL)
-    return objects->insert_node(oe);
+    return insert_object(oe);
 }
 
 void DataManagerProcess::init_object_id()
@@ -1118,14 +1053,30 @@ int DataManagerProcess::add_object(char *n, int no, int o, Connection *conn)
     // environment
 
     if (get_object(n, conn) == NULL)
-        return objects->insert_node(oe);
+        return insert_object(oe);
     else
         return 0;
 }
 
 int DataManagerProcess::add_object(ObjectEntry *oe)
 {
-    return objects->insert_node(oe);
+    return insert_object(oe);
+}
+
+int DataManagerProcess::insert_object(ObjectEntry *oe)
+{
+    int retval = objects->insert_node(oe);
+    coShmDirectory *dir = shm ? shm->get_directory() : NULL;
+    if (retval && dir)
+        dir->insert(oe->name, oe->shm_seq_no, oe->offset, oe->type);
+    return retval;
+}
+
+void DataManagerProcess::unlist_object(const char *n)
+{
+    coShmDirectory *dir = shm ? shm->get_directory() : NULL;
+    if (dir)
+        dir->remove(n);
 }
 
 int DataManagerProcess::delete_object(char *n)
@@ -1139,6 +1090,7 @@ int DataManagerProcess::delete_object(char *n)
     sprintf(tmp_str, "Removing object %s from list", n);
     print_comment(__LINE__, __FILE__, tmp_str, 4);
 #endif
+    unlist_object(n);
     int retval = (objects->remove_node(oe) != NULL);
     delete oe;
 #ifdef DEBUG
@@ -1157,6 +1109,7 @@ int DataManagerProcess::delete_object(char *n)
 int DataManagerProcess::DTM_new_desk(void)
 {
 
+    // new_desk also clears the object directory
     if (objects)
         objects->empty_tree();
     if (shm)
@@ -1258,6 +1211,7 @@ int DataManagerProcess::destroy_object(char *n, Connection *c)
                     }
                 }
             }
+            unlist_object(oe->name);
 #ifndef DEBUG
             objects->remove_node(oe);
 #else
@@ -1307,6 +1261,7 @@ int DataManagerProcess::destroy_object(char *n, Connection *c)
                 }
             }
         }
+        unlist_object(oe->name);
 #ifdef DEBUG
         sprintf(tmp_str, "Removing object %s from list", oe->name);
         print_comment(__LINE__, __FILE__, tmp_str, 4);
@@ -1333,6 +1288,104 @@ int DataManagerProcess::destroy_object(char *n, Connection *c)
     }
 }
 
+// shared memory used by the object tree below (seq_no, offset), same
+// traversal as ShmObjectCopier::check_item; items referenced more than once
+// (e.g. a grid shared by the elements of a set) are counted once
+static long object_bytes(coShmAlloc *shm, int seq_no, shmSizeType offset, int depth,
+                         std::set<std::pair<int, shmSizeType> > &seen)
+{
+    if (seq_no == 0 || depth > 1000 || !seen.insert(std::make_pair(seq_no, offset)).second)
+        return 0;
+    const int *src = (const int *)((char *)shm->get_pointer(seq_no) + offset);
+
+    int length = src[1];
+    long bytes = 0;
+    switch (src[0])
+    {
+    case CHARSHMARRAY:
+    case SHORTSHMARRAY:
+    case INTSHMARRAY:
+    case LONGSHMARRAY:
+    case FLOATSHMARRAY:
+    case DOUBLESHMARRAY:
+        return (long)coShmSlabAlloc::allocSize(src[0], length);
+    case STRINGSHMARRAY:
+        bytes = (long)coShmSlabAlloc::allocSize(src[0], length);
+        for (int i = 0; i < length; i++)
+        {
+            if (src[2 + 2 * i] != 0)
+                bytes += object_bytes(shm, src[2 + 2 * i], src[3 + 2 * i], depth + 1, seen);
+        }
+        return bytes;
+    case SHMPTRARRAY:
+        bytes = (long)coShmSlabAlloc::allocSize(src[0], length);
+        for (int i = 0; i < length && src[2 + 2 * i] != 0; i++)
+            bytes += object_bytes(shm, src[2 + 2 * i], src[3 + 2 * i], depth + 1, seen);
+        return bytes;
+    }
+
+    // data object: header and elements, as allocated by Packer::read_header
+    int no_of_els = src[6];
+    if (no_of_els < 0)
+        return 0;
+    bytes = (long)coShmSlabAlloc::allocSize(CHARSHMARRAY, coDoHeader::getHeaderSize() + no_of_els * SIZE_PER_TYPE_ENTRY);
+    int len = coDoHeader::getIntHeaderSize();
+    for (int i = 0; i < no_of_els; i++)
+    {
+        switch (src[len])
+        {
+        case LONGSHM:
+            len += 1 + sizeof(long) / sizeof(int) + (sizeof(long) % sizeof(int) != 0);
+            break;
+        case DOUBLESHM:
+            len += 1 + sizeof(double) / sizeof(int) + (sizeof(double) % sizeof(int) != 0);
+            break;
+        case SHMPTR:
+        case COVISE_NULLPTR:
+            len += 1 + (1 + sizeof(shmSizeType) / sizeof(int));
+            break;
+        default:
+            len += 2;
+            break;
+        }
+    }
+    for (int pos = 11; pos < len;)
+    {
+        switch (src[pos])
+        {
+        case SHMPTR:
+            bytes += object_bytes(shm, src[pos + 1], src[pos + 2], depth + 1, seen);
+            pos += 3;
+            break;
+        case COVISE_NULLPTR:
+            pos += 3;
+            break;
+        case LONGSHM:
+            pos += 1 + sizeof(long) / sizeof(int) + (sizeof(long) % sizeof(int) != 0);
+            break;
+        case DOUBLESHM:
+            pos += 1 + sizeof(double) / sizeof(int) + (sizeof(double) % sizeof(int) != 0);
+            break;
+        default:
+            pos += 2;
+            break;
+        }
+    }
+    return bytes;
+}
+
+long DataManagerProcess::get_object_size(char *n)
+{
+    ObjectEntry *tmpoe = new ObjectEntry(n);
+    ObjectEntry *oe = objects->search_node(tmpoe, COVISE_EQUAL);
+    delete tmpoe;
+    if (!oe)
+        return -1;
+
+    std::set<std::pair<int, shmSizeType> > seen;
+    return object_bytes(shm, oe->shm_seq_no, oe->offset, 0, seen);
+}
+
 int DataManagerProcess::shm_free(coShmPtr *ptr)
 {
     return shm_free(ptr->get_shm_seq_no(), ptr->get_offset());
@@ -1508,6 +1561,7 @@ int DataManagerProcess::shm_free(int shm_seq_no, int offset)
     sprintf(tmp_str, "Removing object %s from list", obj_name);
     print_comment(__LINE__, __FILE__, tmp_str, 4);
 #endif
+    unlist_object(obj_name);
     if (objects->remove_node_compare(tmpoe))
     {
 #ifdef DEBUG
@@ -1673,6 +1727,19 @@ ObjectEntry *DataManagerProcess::get_object(char *n)
         int found = 0;
         while (!found && (dme = data_mgrs->next()))
         {
+            if (dme->local_copy != 0 && ShmConfig::useLocalTransfer()
+                && strcmp(dme->get_hostname(), host->getAddress()) == 0)
+            {
+                int retval = get_local_copy(tmp_name, dme, &oe);
+                if (retval == 1)
+                {
+                    add_object(oe);
+                    found = 1;
+                }
+                if (retval >= 0)
+                    continue;
+            }
+            coTraceSpan span("transfer", tmp_name);
             len = strlen(tmp_name) + 1;
             Message *msg = new Message(COVISE_MESSAGE_ASK_FOR_OBJECT, (int)len, tmp_name);
             tmp_str_ptr = new char[100];
@@ -1715,6 +1782,7 @@ ObjectEntry *DataManagerProcess::get_object(char *n)
             }
             delete msg;
         }
+        coTrace::flush();
     }
     else
     {
@@ -2062,13 +2130,17 @@ void ObjectEntry::pack_and_send_object(Message *msg, DataManagerProcess *)
 
     //    covise_time->mark(__LINE__, "vor pack_object = new Packer");
 
-    pack_object = new Packer(msg, shm_seq_no, offset);
+    {
+        coTraceSpan span("pack", name);
+        pack_object = new Packer(msg, shm_seq_no, offset);
 
-    pack_object->pack();
+        pack_object->pack();
 
-    pack_object->flush();
+        pack_object->flush();
 
-    delete pack_object;
+        delete pack_object;
+    }
+    coTrace::flush();
 
 //    covise_time->mark(__LINE__, "packed object sent");
 
@@ -2117,10 +2189,17 @@ DMEntry::DMEntry(int i, char *h, Connection *c)
     conn = c;
     data_conn = c;
     transfermgr = 0;
+    local_copy = -1;
+    foreign_shm = NULL;
     //    objects = new AVLTree<ObjectEntry>();
     objects = new AVLTree<ObjectEntry>(ObjectEntry_compare, "objects");
 }
 
+DMEntry::~DMEntry()
+{
+    delete foreign_shm;
+}
+
 const char *DMEntry::get_hostname()
 {
     if (host)
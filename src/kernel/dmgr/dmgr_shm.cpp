@@ -6,6 +6,8 @@
  * License: LGPL 2+ */
 
 #include "dmgr.h"
+#include <shm/covise_shmslab.h>
+#include <shm/covise_shmdir.h>
 #define AVL_EXTERN extern
 #include "dmgr_mem_avltrees.h"
 #undef AVL_EXTERN
@@ -18,10 +20,12 @@ using namespace covise;
 
 coShmAlloc::coShmAlloc(int *key, DataManagerProcess *d)
     : ShmAccess(key)
+    , slabs(NULL)
+    , use_slabs(true)
+    , directory(NULL)
 {
     dmgrproc = d;
-    MemChunk *mnode = new_memchunk(shm->get_seq_no(),
-                                   shm->get_pointer(shm->get_seq_no()), ShmConfig::getMallocSize());
+    MemChunk *mnode = first_chunk(shm->get_seq_no(), ShmConfig::getMallocSize());
 
     used_list = new AddressOrderedTree();
 
@@ -34,7 +38,51 @@ coShmAlloc::coShmAlloc(int *key, DataManagerProcess *d)
 #endif
 }
 
+// the control block of the small block allocator and the object directory
+// occupy the start of the first segment, where application processes expect them
+MemChunk *coShmAlloc::first_chunk(int seq_no, shmSizeType size)
+{
+    char *address = (char *)shm->get_pointer(seq_no);
+    if (seq_no != 1)
+        return new_memchunk(seq_no, address, size);
+
+    shmSizeType control = coShmSlabAlloc::controlSize();
+    slabs = coShmSlabAlloc::create(address, ShmConfig::useSlabs());
+    if (!slabs->isEnabled())
+        slabs = NULL;
+    int numSlots = ShmConfig::getObjectDirectorySlots();
+    directory = coShmDirectory::create(address + control, numSlots, ShmConfig::useObjectDirectory());
+    if (!directory->isEnabled())
+        directory = NULL;
+    control += coShmDirectory::controlSize(numSlots);
+    return new_memchunk(seq_no, address + control, size - control);
+}
+
 coShmPtr *coShmAlloc::malloc(shmSizeType size)
+{
+    if (size % SIZEOF_ALIGNMENT != 0)
+        size += (SIZEOF_ALIGNMENT - (size % SIZEOF_ALIGNMENT));
+
+    int cls = (slabs && use_slabs) ? coShmSlabAlloc::sizeClass(size) : -1;
+    if (cls >= 0)
+    {
+        int seq_no = 0;
+        shmSizeType offset = 0;
+        if (!slabs->pop(cls, &seq_no, &offset))
+        {
+            coShmPtr *slab = tree_malloc(coShmSlabAlloc::SLAB_SIZE);
+            if (!slabs->addSlab(cls, slab->get_shm_seq_no(), slab->get_offset()))
+                free(slab->get_shm_seq_no(), slab->get_offset()); // slab table full
+            delete slab;
+        }
+        if (seq_no != 0 || slabs->pop(cls, &seq_no, &offset))
+            return new coShmPtr(seq_no, offset);
+    }
+
+    return tree_malloc(size);
+}
+
+coShmPtr *coShmAlloc::tree_malloc(shmSizeType size)
 {
     int msg_data[2];
     int tmp_key = 0;
@@ -44,8 +92,6 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
     MemChunk *new_used_node;
     Message *msg;
 
-    if (size % SIZEOF_ALIGNMENT != 0)
-        size += (SIZEOF_ALIGNMENT - (size % SIZEOF_ALIGNMENT));
 #ifdef DEBUG
     sprintf(tmp_str, "malloc size: %d", size);
     print_comment(__LINE__, __FILE__, tmp_str);
@@ -84,7 +130,8 @@ coShmPtr *coShmAlloc::malloc(shmSizeType size)
         msg_data[1] = new_size;
         msg = new Message(COVISE_MESSAGE_NEW_SDS, 2 * sizeof(int), (char *)&msg_data[0]);
         print_comment(__LINE__, __FILE__, "dmgrproc->send_to_all_connections");
-        dmgrproc->send_to_all_connections(msg);
+        if (dmgrproc)
+            dmgrproc->send_to_all_connections(msg);
         free_node = free_size_list->get_chunk(size);
     }
     free_list->remove_chunk(free_node);
@@ -115,6 +162,9 @@ void coShmAlloc::free(int shm_seq_no, shmSizeType offset)
     MemChunk *next_chunk, *used_node, s_node;
     static int garbage_count = 0;
 
+    if (slabs && slabs->release(shm_seq_no, offset))
+        return;
+
     s_node.set(shm_seq_no, shm_ptr, 0);
     used_node = used_list->remove_chunk(&s_node);
     if (used_node == 0L)
@@ -175,7 +225,7 @@ void coShmAlloc::new_desk(void)
             seq_no = p_shm->get_seq_no();
             size = p_shm->get_size();
             size -= 2 * (sizeof(int));
-            mnode = new_memchunk(seq_no, p_shm->get_pointer(seq_no), size);
+            mnode = first_chunk(seq_no, size);
             free_list->insert_chunk(mnode);
             free_size_list->insert_chunk(mnode);
         }
@@ -6,6 +6,7 @@
  * License: LGPL 2+ */
 
 #include "dmgr.h"
+#include "dmgr_packer.h"
 
 using namespace covise;
 
@@ -13,3 +14,4 @@ AddressOrderedTree *coShmAlloc::used_list = 0L;
 AddressOrderedTree *coShmAlloc::free_list = 0L;
 SizeOrderedTree *coShmAlloc::free_size_list = 0L;
 int DataManagerProcess::max_t = 0;
+bool Packer::bulk_arrays = true;
@@ -9,6 +9,9 @@
 #include <covise/covise.h>
 #include <covise/covise_global.h>
 #include <covise/covise_appproc.h>
+#include <shm/covise_shmslab.h>
+#include <shm/covise_shmdir.h>
+#include <util/coTrace.h>
 #include "coDoData.h"
 #include "coDoGeometry.h"
 #include "coDoUniformGrid.h"
@@ -57,41 +60,66 @@ static int current_free;
 namespace covise
 {
 
-static coShmArray *getShmArray(const char *name)
+// look up an object in the directory the data manager keeps in shared
+// memory, ask the data manager if it is not found there
+static bool findObject(const char *name, int *shm_seq_no, shmSizeType *offset)
 {
-    if (!name)
-    {
-        print_comment(__LINE__, __FILE__, "tried getShmArray with name == NULL");
-        return NULL;
-    }
-
-    if (!ApplicationProcess::approc)
-        return NULL;
-
+    // segments are announced by NEW_SDS, which may not have been processed yet
     int len = (int)strlen(name) + 1;
     char *tmpptr = new char[len];
     strcpy(tmpptr, name);
+
+    coShmDirectory *dir = coShmDirectory::the();
+    if (dir && dir->lookup(name, shm_seq_no, offset)
+        && *shm_seq_no <= SharedMemory::num_attached())
+    {
+        // no answer needed, but the data manager has to know the reader,
+        // e.g. to send NEW_PART_AVAILABLE to it
+        Message accessed(COVISE_MESSAGE_OBJECT_ACCESSED, len, tmpptr, MSG_NOCOPY);
+        ApplicationProcess::approc->send_data_msg(&accessed);
+        accessed.data = NULL;
+        delete[] tmpptr;
+        return true;
+    }
+
     Message *msg = new Message(COVISE_MESSAGE_GET_OBJECT, len, tmpptr, MSG_NOCOPY);
     ApplicationProcess::approc->exch_data_msg(msg, 2, COVISE_MESSAGE_OBJECT_FOUND, COVISE_MESSAGE_OBJECT_NOT_FOUND);
     delete[] tmpptr;
 
-    coShmArray *shmarr = NULL;
+    bool found = false;
     // this is a local message, so no conversion is necessary
     if (msg->type == COVISE_MESSAGE_OBJECT_FOUND)
     {
-        shmarr = new coShmArray(*(int *)msg->data,
-                                *(shmSizeType *)(&msg->data[sizeof(int)]));
+        *shm_seq_no = *(int *)msg->data;
+        *offset = *(shmSizeType *)(&msg->data[sizeof(int)]);
 #ifdef DEBUG
-        print_comment(__LINE__, __FILE__, "shmarr: %d %d",
-                      *(int *)msg->data,
-                      *(shmSizeType *)(&msg->data[sizeof(int)]));
+        print_comment(__LINE__, __FILE__, "shmarr: %d %d", *shm_seq_no, *offset);
 #endif
-        delete[] msg -> data;
-        msg->data = NULL;
+        found = true;
     } // else we probably have a socket closed message and should quit.
+    delete[] msg -> data;
+    msg->data = NULL;
     delete msg;
 
-    return shmarr;
+    return found;
+}
+
+static coShmArray *getShmArray(const char *name)
+{
+    if (!name)
+    {
+        print_comment(__LINE__, __FILE__, "tried getShmArray with name == NULL");
+        return NULL;
+    }
+
+    if (!ApplicationProcess::approc)
+        return NULL;
+
+    int shm_seq_no = 0;
+    shmSizeType offset = 0;
+    if (!findObject(name, &shm_seq_no, &offset))
+        return NULL;
+    return new coShmArray(shm_seq_no, offset);
 }
 }
 
@@ -562,6 +590,7 @@ void _Insight_set_option(char *, char *);
 
 int coDistributedObject::store_shared_dl(int count, covise_data_list *dl)
 {
+    coTraceSpan span("shm", "store");
     int i;
     data_type *dt;
     long *ct;
@@ -1257,6 +1286,27 @@ char *coDistributedObject::calcTypeString(int tno)
     return tmp_name;
 }
 
+// Attribute arrays are small: take them from the size class slabs in
+// shared memory and only ask the data manager if that is not possible.
+static void exchangeMallocList(ShmMessage *shmmsg, data_type *dt, long *ct, int no)
+{
+    coShmSlabAlloc *slabs = coShmSlabAlloc::the();
+    if (slabs)
+    {
+        char *cdata = new char[no * (sizeof(int) + sizeof(shmSizeType))];
+        if (slabs->mallocList(dt, ct, no, (int *)cdata))
+        {
+            shmmsg->delete_data();
+            shmmsg->data = cdata;
+            shmmsg->length = no * (sizeof(int) + sizeof(shmSizeType));
+            shmmsg->type = COVISE_MESSAGE_MALLOC_LIST_OK;
+            return;
+        }
+        delete[] cdata;
+    }
+    ApplicationProcess::approc->exch_data_msg(shmmsg, 2, COVISE_MESSAGE_MALLOC_LIST_OK, COVISE_MESSAGE_MALLOC_FAILED);
+}
+
 void coDistributedObject::addAttribute(const char *attr_name, const char *attr_val)
 {
     int attr_len, sn, shmfree[8];
@@ -1295,7 +1345,7 @@ void coDistributedObject::addAttribute(const char *attr_name, const char *attr_v
     ct[1] = attr_len;
     dt[1] = CHARSHMARRAY;
     shmmsg = new ShmMessage(dt, ct, 2);
-    ApplicationProcess::approc->exch_data_msg(shmmsg, 2, COVISE_MESSAGE_MALLOC_LIST_OK, COVISE_MESSAGE_MALLOC_FAILED);
+    exchangeMallocList(shmmsg, dt, ct, 2);
     if (shmmsg->type != COVISE_MESSAGE_MALLOC_LIST_OK)
     {
         print_comment(__LINE__, __FILE__, "error in addAttribute for distributed object %s", name);
@@ -1396,7 +1446,7 @@ void coDistributedObject::addAttributes(int no, const char *const *attr_name,
         dt[i + 1] = CHARSHMARRAY;
     }
     shmmsg = new ShmMessage(dt, ct, no + 1);
-    ApplicationProcess::approc->exch_data_msg(shmmsg, 2, COVISE_MESSAGE_MALLOC_LIST_OK, COVISE_MESSAGE_MALLOC_FAILED);
+    exchangeMallocList(shmmsg, dt, ct, no + 1);
     if (shmmsg->type != COVISE_MESSAGE_MALLOC_LIST_OK)
     {
         print_comment(__LINE__, __FILE__, "error in addAttribute for distributed object %s", name);
@@ -1739,7 +1789,6 @@ void coDistributedObject::copyAllAttributes(const coDistributedObject *src)
 }
 
 //// Common function for all read-Constructors
-// copies getShmArray() for performance reasons...
 void coDistributedObject::getObjectFromShm()
 {
     if (!name)
@@ -1747,37 +1796,15 @@ void coDistributedObject::getObjectFromShm()
         new_ok = 0;
         return;
     }
-    Message *msg;
-    int len;
-    char *tmpptr;
-
-    len = (int)strlen(name) + 1;
-    tmpptr = new char[len];
-    strcpy(tmpptr, name);
-    msg = new Message(COVISE_MESSAGE_GET_OBJECT, len, tmpptr, MSG_NOCOPY);
-    ApplicationProcess::approc->exch_data_msg(msg, 2, COVISE_MESSAGE_OBJECT_FOUND, COVISE_MESSAGE_OBJECT_NOT_FOUND);
-    delete[] tmpptr;
-    // this is a local message, so no conversion is necessary
-    if (msg->type == COVISE_MESSAGE_OBJECT_FOUND)
+    int shm_seq_no = 0;
+    shmSizeType offset = 0;
+    if (!findObject(name, &shm_seq_no, &offset))
     {
-        char *cPtr = (char *)msg->data;
-        shmarr = new coShmArray(*(int *)cPtr, *(shmSizeType *)(cPtr+sizeof(int)));
-        header = (coDoHeader *)shmarr->getPtr();
-#ifdef DEBUG
-        print_comment(__LINE__, __FILE__, "shmarr: %d %d", iPtr[0], iPtr[1]);
-#endif
-        delete[] msg -> data;
-        msg->data = NULL;
-        delete msg;
-    }
-    else
-    {
-        delete[] msg -> data;
-        msg->data = NULL;
-        delete msg;
         new_ok = 0;
         return;
     }
+    shmarr = new coShmArray(shm_seq_no, offset);
+    header = (coDoHeader *)shmarr->getPtr();
 
     /// Virtual function call: calls class-specific routine
     if (rebuildFromShm() == 0)
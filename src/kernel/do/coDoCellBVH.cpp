@@ -0,0 +1,523 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coDoCellBVH.h"
+#include <vector>
+#include <algorithm>
+
+using namespace covise;
+
+coDoCellBVH::coDoCellBVH(const coObjInfo &info)
+    : coDistributedObject(info, "CELBVH")
+{
+    if (info.getName())
+    {
+        if (getShmArray() != 0)
+        {
+            if (rebuildFromShm() == 0)
+            {
+                print_comment(__LINE__, __FILE__, "rebuildFromShm == 0");
+            }
+        }
+        else
+        {
+            print_comment(__LINE__, __FILE__, "object %s doesn't exist", info.getName());
+            new_ok = 0;
+        }
+    }
+}
+
+coDoCellBVH::coDoCellBVH(const coObjInfo &info, coShmArray *arr)
+    : coDistributedObject(info, "CELBVH")
+{
+    if (createFromShm(arr) == 0)
+    {
+        print_comment(__LINE__, __FILE__, "createFromShm == 0");
+        new_ok = 0;
+    }
+}
+
+coDoCellBVH::coDoCellBVH(const coObjInfo &info, int numNodes, int numCells)
+    : coDistributedObject(info, "CELBVH")
+{
+    storeShm(numNodes, numCells);
+}
+
+coDoCellBVH::coDoCellBVH(const coObjInfo &info, int nelem, int nconn, int ncoord,
+                         const int *el, const int *conn,
+                         const float *x_c, const float *y_c, const float *z_c,
+                         int leaf_size)
+    : coDistributedObject(info, "CELBVH")
+{
+    (void)ncoord;
+    build(nelem, nconn, el, conn, x_c, y_c, z_c, leaf_size);
+}
+
+coDoCellBVH::~coDoCellBVH()
+{
+}
+
+coDistributedObject *coDoCellBVH::virtualCtor(coShmArray *arr)
+{
+    coDistributedObject *ret;
+    ret = new coDoCellBVH(coObjInfo(), arr);
+    return ret;
+}
+
+int coDoCellBVH::storeShm(int numNodes, int numCells)
+{
+    nodeBounds.set_length(6 * numNodes);
+    nodeFirst.set_length(numNodes);
+    nodeCount.set_length(numNodes);
+    cellList.set_length(numCells);
+    cellBBoxes.set_length(6 * numCells);
+
+    covise_data_list dl[] = {
+        { FLOATSHMARRAY, &nodeBounds },
+        { INTSHMARRAY, &nodeFirst },
+        { INTSHMARRAY, &nodeCount },
+        { INTSHMARRAY, &cellList },
+        { FLOATSHMARRAY, &cellBBoxes }
+    };
+    new_ok = store_shared_dl(SHM_OBJ, dl) != 0;
+    return new_ok;
+}
+
+int coDoCellBVH::rebuildFromShm()
+{
+    if (shmarr == NULL)
+    {
+        cerr << "called rebuildFromShm without shmarray\n";
+        print_exit(__LINE__, __FILE__, 1);
+    }
+
+    covise_data_list dl[] = {
+        { FLOATSHMARRAY, &nodeBounds },
+        { INTSHMARRAY, &nodeFirst },
+        { INTSHMARRAY, &nodeCount },
+        { INTSHMARRAY, &cellList },
+        { FLOATSHMARRAY, &cellBBoxes }
+    };
+    return restore_shared_dl(SHM_OBJ, dl);
+}
+
+int coDoCellBVH::getObjInfo(int no, coDoInfo **il) const
+{
+    if (no == SHM_OBJ)
+    {
+        (*il)[0].description = "Node bounds";
+        (*il)[1].description = "First child or cell of nodes";
+        (*il)[2].description = "Number of cells of nodes";
+        (*il)[3].description = "Cell list";
+        (*il)[4].description = "Cell bounding boxes";
+        return SHM_OBJ;
+    }
+    else
+    {
+        print_error(__LINE__, __FILE__, "number wrong for object info");
+        return 0;
+    }
+}
+
+coDoCellBVH *coDoCellBVH::cloneObject(const coObjInfo &newinfo) const
+{
+    coDoCellBVH *ret = new coDoCellBVH(newinfo, getNumNodes(), getNumCells());
+    if (!ret->objectOk())
+        return ret;
+    float *nb, *cb, *new_nb, *new_cb;
+    int *nf, *nc, *cl, *new_nf, *new_nc, *new_cl;
+    getAddresses(&nb, &nf, &nc, &cl, &cb);
+    ret->getAddresses(&new_nb, &new_nf, &new_nc, &new_cl, &new_cb);
+    int numNodes = getNumNodes(), numCells = getNumCells();
+    memcpy(new_nb, nb, 6 * numNodes * sizeof(float));
+    memcpy(new_nf, nf, numNodes * sizeof(int));
+    memcpy(new_nc, nc, numNodes * sizeof(int));
+    memcpy(new_cl, cl, numCells * sizeof(int));
+    memcpy(new_cb, cb, 6 * numCells * sizeof(float));
+    return ret;
+}
+
+void coDoCellBVH::getAddresses(float **node_bounds, int **node_first, int **node_count,
+                               int **cell_list, float **cell_bboxes) const
+{
+    *node_bounds = (float *)nodeBounds.getDataPtr();
+    *node_first = (int *)nodeFirst.getDataPtr();
+    *node_count = (int *)nodeCount.getDataPtr();
+    *cell_list = (int *)cellList.getDataPtr();
+    *cell_bboxes = (float *)cellBBoxes.getDataPtr();
+}
+
+void coDoCellBVH::getGridBBox(float *bbox) const
+{
+    int numNodes = getNumNodes();
+    const float *nb = (const float *)nodeBounds.getDataPtr();
+    for (int k = 0; k < 6; k++)
+        bbox[k] = numNodes > 0 ? nb[k * numNodes] : 0.f;
+}
+
+int coDoCellBVH::IsInBBox(int cell, int no_e, const float *point) const
+{
+    if (cell >= 0 && cell < no_e && cell < getNumCells())
+    {
+        const float *cb = (const float *)cellBBoxes.getDataPtr() + 6 * cell;
+        if (point[0] < cb[0] || point[0] > cb[3])
+            return 0;
+        if (point[1] < cb[1] || point[1] > cb[4])
+            return 0;
+        if (point[2] < cb[2] || point[2] > cb[5])
+            return 0;
+        return 1;
+    }
+    return 0;
+}
+
+namespace
+{
+// range of the cell list still to be split into a subtree
+struct BuildItem
+{
+    int node;
+    int begin;
+    int end;
+    int depth;
+};
+
+// half the surface of a box
+inline float halfArea(const float *box)
+{
+    float dx = box[3] - box[0], dy = box[4] - box[1], dz = box[5] - box[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+inline void emptyBox(float *box)
+{
+    box[0] = box[1] = box[2] = FLT_MAX;
+    box[3] = box[4] = box[5] = -FLT_MAX;
+}
+
+inline void growBox(float *box, const float *other)
+{
+    for (int k = 0; k < 3; k++)
+    {
+        box[k] = std::min(box[k], other[k]);
+        box[k + 3] = std::max(box[k + 3], other[k + 3]);
+    }
+}
+
+// partition by the bin of the cell centres along an axis
+struct BelowSplit
+{
+    const float *centres;
+    int axis;
+    float origin;
+    float scale;
+    int split;
+
+    bool operator()(int cell) const
+    {
+        int bin = (int)((centres[3 * cell + axis] - origin) * scale);
+        return std::min(bin, (int)coDoCellBVH::NUM_BINS - 1) < split;
+    }
+};
+}
+
+// top-down construction with the surface area heuristic evaluated on
+// NUM_BINS bins per axis, the tree is built on the heap and then copied
+// into shared memory
+void coDoCellBVH::build(int nelem, int nconn, const int *el, const int *conn,
+                        const float *x_c, const float *y_c, const float *z_c, int leaf_size)
+{
+    if (leaf_size < 1)
+        leaf_size = 1;
+
+    std::vector<float> bboxes(6 * nelem);
+    std::vector<float> centres(3 * nelem);
+    std::vector<int> cells(nelem);
+    for (int i = 0; i < nelem; i++)
+    {
+        int begin = el[i];
+        int end = (i < nelem - 1) ? el[i + 1] : nconn;
+        float *box = &bboxes[6 * i];
+        emptyBox(box);
+        for (int v = begin; v < end; v++)
+        {
+            int point = conn[v];
+            float p[6] = { x_c[point], y_c[point], z_c[point], x_c[point], y_c[point], z_c[point] };
+            growBox(box, p);
+        }
+        if (begin >= end)
+            memset(box, 0, 6 * sizeof(float));
+        for (int k = 0; k < 3; k++)
+            centres[3 * i + k] = 0.5f * (box[k] + box[k + 3]);
+        cells[i] = i;
+    }
+
+    std::vector<float> bounds[6];
+    std::vector<int> first, count;
+    for (int k = 0; k < 6; k++)
+        bounds[k].push_back(0.f);
+    first.push_back(0);
+    count.push_back(0);
+
+    std::vector<BuildItem> todo;
+    if (nelem > 0)
+    {
+        BuildItem root = { 0, 0, nelem, 0 };
+        todo.push_back(root);
+    }
+    while (!todo.empty())
+    {
+        BuildItem item = todo.back();
+        todo.pop_back();
+
+        float box[6], centreBox[6];
+        emptyBox(box);
+        emptyBox(centreBox);
+        for (int i = item.begin; i < item.end; i++)
+        {
+            growBox(box, &bboxes[6 * cells[i]]);
+            const float *c = &centres[3 * cells[i]];
+            float p[6] = { c[0], c[1], c[2], c[0], c[1], c[2] };
+            growBox(centreBox, p);
+        }
+        for (int k = 0; k < 6; k++)
+            bounds[k][item.node] = box[k];
+
+        int n = item.end - item.begin;
+        int mid = item.begin;
+        if (n > leaf_size && item.depth < MAX_DEPTH)
+        {
+            // cost of a split is the number of cells times the area of their box
+            float bestCost = FLT_MAX;
+            int bestAxis = -1, bestSplit = 0;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float extent = centreBox[axis + 3] - centreBox[axis];
+                if (extent <= 0.f)
+                    continue;
+                float scale = NUM_BINS / extent;
+                int binCount[NUM_BINS];
+                float binBox[NUM_BINS][6];
+                for (int b = 0; b < NUM_BINS; b++)
+                {
+                    binCount[b] = 0;
+                    emptyBox(binBox[b]);
+                }
+                for (int i = item.begin; i < item.end; i++)
+                {
+                    int cell = cells[i];
+                    int b = std::min((int)((centres[3 * cell + axis] - centreBox[axis]) * scale), (int)NUM_BINS - 1);
+                    binCount[b]++;
+                    growBox(binBox[b], &bboxes[6 * cell]);
+                }
+                float rightArea[NUM_BINS];
+                int rightCount[NUM_BINS];
+                float acc[6];
+                emptyBox(acc);
+                for (int b = NUM_BINS - 1, num = 0; b > 0; b--)
+                {
+                    growBox(acc, binBox[b]);
+                    num += binCount[b];
+                    rightArea[b] = num > 0 ? halfArea(acc) : 0.f;
+                    rightCount[b] = num;
+                }
+                emptyBox(acc);
+                for (int b = 1, num = 0; b < NUM_BINS; b++)
+                {
+                    growBox(acc, binBox[b - 1]);
+                    num += binCount[b - 1];
+                    if (num == 0 || rightCount[b] == 0)
+                        continue;
+                    float cost = num * halfArea(acc) + rightCount[b] * rightArea[b];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = b;
+                    }
+                }
+            }
+            if (bestAxis >= 0)
+            {
+                BelowSplit below;
+                below.centres = &centres[0];
+                below.axis = bestAxis;
+                below.origin = centreBox[bestAxis];
+                below.scale = NUM_BINS / (centreBox[bestAxis + 3] - centreBox[bestAxis]);
+                below.split = bestSplit;
+                mid = (int)(std::partition(cells.begin() + item.begin, cells.begin() + item.end, below) - cells.begin());
+            }
+            else
+            {
+                // all cell centres coincide
+                mid = item.begin + n / 2;
+            }
+        }
+
+        if (mid <= item.begin || mid >= item.end)
+        {
+            first[item.node] = item.begin;
+            count[item.node] = n;
+        }
+        else
+        {
+            int child = (int)first.size();
+            for (int k = 0; k < 6; k++)
+                bounds[k].resize(child + 2);
+            first.resize(child + 2);
+            count.resize(child + 2);
+            first[item.node] = child;
+            count[item.node] = 0;
+            BuildItem right = { child + 1, mid, item.end, item.depth + 1 };
+            BuildItem left = { child, item.begin, mid, item.depth + 1 };
+            todo.push_back(right);
+            todo.push_back(left);
+        }
+    }
+
+    int numNodes = nelem > 0 ? (int)first.size() : 0;
+    if (!storeShm(numNodes, nelem))
+        return;
+
+    float *nb, *cb;
+    int *nf, *nc, *cl;
+    getAddresses(&nb, &nf, &nc, &cl, &cb);
+    for (int k = 0; k < 6 && numNodes > 0; k++)
+        memcpy(nb + k * numNodes, &bounds[k][0], numNodes * sizeof(float));
+    if (numNodes > 0)
+    {
+        memcpy(nf, &first[0], numNodes * sizeof(int));
+        memcpy(nc, &count[0], numNodes * sizeof(int));
+    }
+    if (nelem > 0)
+    {
+        memcpy(cl, &cells[0], nelem * sizeof(int));
+        memcpy(cb, &bboxes[0], 6 * nelem * sizeof(float));
+    }
+}
+
+int coDoCellBVH::searchLeaf(int node, const float *point, int skip, CellTest test, void *data) const
+{
+    const int *nf = (const int *)nodeFirst.getDataPtr();
+    const int *nc = (const int *)nodeCount.getDataPtr();
+    const int *cl = (const int *)cellList.getDataPtr();
+    const float *cbb = (const float *)cellBBoxes.getDataPtr();
+    for (int i = nf[node], end = nf[node] + nc[node]; i < end; i++)
+    {
+        int cell = cl[i];
+        const float *cb = cbb + 6 * cell;
+        if (cell != skip
+            && point[0] >= cb[0] && point[0] <= cb[3]
+            && point[1] >= cb[1] && point[1] <= cb[4]
+            && point[2] >= cb[2] && point[2] <= cb[5]
+            && test(data, cell, point))
+        {
+            return cell;
+        }
+    }
+    return -1;
+}
+
+int coDoCellBVH::search(const float *point, int skip, CellTest test, void *data, int *leaf) const
+{
+    int numNodes = getNumNodes();
+    if (numNodes == 0)
+        return -1;
+    const float *nb = (const float *)nodeBounds.getDataPtr();
+    const float *minX = nb, *minY = nb + numNodes, *minZ = nb + 2 * numNodes;
+    const float *maxX = nb + 3 * numNodes, *maxY = nb + 4 * numNodes, *maxZ = nb + 5 * numNodes;
+    const int *nf = (const int *)nodeFirst.getDataPtr();
+    const int *nc = (const int *)nodeCount.getDataPtr();
+
+    if (point[0] < minX[0] || point[0] > maxX[0]
+        || point[1] < minY[0] || point[1] > maxY[0]
+        || point[2] < minZ[0] || point[2] > maxZ[0])
+    {
+        return -1;
+    }
+
+    // at most one sibling per level is waiting
+    int stack[MAX_DEPTH + 2];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        int node = stack[--size];
+        if (nc[node] > 0)
+        {
+            if (node == skip)
+                continue;
+            int cell = searchLeaf(node, point, -1, test, data);
+            if (cell >= 0)
+            {
+                *leaf = node;
+                return cell;
+            }
+            continue;
+        }
+        // both children are next to each other in every plane
+        int c = nf[node];
+        if (point[0] >= minX[c + 1] && point[0] <= maxX[c + 1]
+            && point[1] >= minY[c + 1] && point[1] <= maxY[c + 1]
+            && point[2] >= minZ[c + 1] && point[2] <= maxZ[c + 1])
+        {
+            stack[size++] = c + 1;
+        }
+        if (point[0] >= minX[c] && point[0] <= maxX[c]
+            && point[1] >= minY[c] && point[1] <= maxY[c]
+            && point[2] >= minZ[c] && point[2] <= maxZ[c])
+        {
+            stack[size++] = c;
+        }
+    }
+    return -1;
+}
+
+int coDoCellBVH::locate(const float *point, int hint, CellTest test, void *data) const
+{
+    int numCells = getNumCells();
+    if (hint >= 0 && IsInBBox(hint, numCells, point) && test(data, hint, point))
+        return hint;
+    int leaf = -1;
+    return search(point, -1, test, data, &leaf);
+}
+
+int coDoCellBVH::locate(int no_p, const float *points, int *cells, CellTest test, void *data) const
+{
+    int numCells = getNumCells();
+    int prevCell = -1, prevLeaf = -1;
+    int found = 0;
+    for (int i = 0; i < no_p; i++)
+    {
+        const float *point = points + 3 * i;
+        int hint = cells[i] >= 0 ? cells[i] : prevCell;
+        int cell = -1;
+        if (hint >= 0 && IsInBBox(hint, numCells, point) && test(data, hint, point))
+        {
+            cell = hint;
+        }
+        else
+        {
+            if (prevLeaf >= 0)
+                cell = searchLeaf(prevLeaf, point, hint, test, data);
+            if (cell < 0)
+            {
+                int leaf = -1;
+                cell = search(point, prevLeaf, test, data, &leaf);
+                if (cell >= 0)
+                    prevLeaf = leaf;
+            }
+        }
+        cells[i] = cell;
+        if (cell >= 0)
+        {
+            prevCell = cell;
+            found++;
+        }
+    }
+    return found;
+}
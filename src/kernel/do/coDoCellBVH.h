@@ -0,0 +1,142 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CO_DO_CELL_BVH_H
+#define CO_DO_CELL_BVH_H
+
+#include "coDistributedObject.h"
+
+/***********************************************************************\
+ **                                                                     **
+ **   Bounding volume hierarchy for cell location                       **
+ **                                                                     **
+ **   Description  : Binary tree of axis aligned boxes over the cells   **
+ **                  of an unstructured grid, an alternative to         **
+ **                  coDoOctTree. The tree is stored flat: the bounds   **
+ **                  of all nodes as six planes (all minimum x, all     **
+ **                  minimum y, ... maximum z), the two children of a   **
+ **                  node next to each other, and every cell exactly    **
+ **                  once in the cell list. Point location walks these  **
+ **                  arrays directly, without building lists of         **
+ **                  candidate cells.                                   **
+ **                                                                     **
+ **   Classes      : coDoCellBVH                                        **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+class DOEXPORT coDoCellBVH : public coDistributedObject
+{
+    friend class coDoInitializer;
+    static coDistributedObject *virtualCtor(coShmArray *arr);
+
+public:
+    enum
+    {
+        SHM_OBJ = 5, // number of shared-memory objects
+        LEAF_SIZE = 4, // maximum number of cells in a leaf
+        NUM_BINS = 16, // bins per axis for the surface area heuristic
+        MAX_DEPTH = 60 // deeper nodes are made leaves
+    };
+
+    // return true if point lies in cell, data is handed through from locate
+    typedef bool (*CellTest)(void *data, int cell, const float *point);
+
+    coDoCellBVH(const coObjInfo &info);
+    coDoCellBVH(const coObjInfo &info, coShmArray *arr);
+
+    /** Constructor allocating an empty tree, e.g. for deserialization
+       * @param info object name
+       * @param numNodes number of tree nodes
+       * @param numCells number of grid cells
+       */
+    coDoCellBVH(const coObjInfo &info, int numNodes, int numCells);
+
+    /** Constructor building the tree for a grid
+       * @param info object name
+       * @param nelem number of elements in the grid
+       * @param nconn length of the grid connectivity list
+       * @param ncoord number of points in the grid
+       * @param el array with "pointers" to the connectivity list for each element
+       * @param conn connectivity list
+       * @param x_c X coordinates of the grid points
+       * @param y_c Y coordinates of the grid points
+       * @param z_c Z coordinates of the grid points
+       * @param leaf_size maximum number of cells in a leaf
+       */
+    coDoCellBVH(const coObjInfo &info, int nelem, int nconn, int ncoord,
+                const int *el, const int *conn,
+                const float *x_c, const float *y_c, const float *z_c,
+                int leaf_size = LEAF_SIZE);
+
+    virtual ~coDoCellBVH();
+
+    /** IsInBBox: returns 1 if a point is in the bounding box of a cell
+       * @param cell integer cell identifier
+       * @param no_e number of cells
+       * @param point array to 3 point coordinates
+       * @return 1 if the point is in the bounding box of the cell, 0 otherwise
+       */
+    int IsInBBox(int cell, int no_e, const float *point) const;
+
+    /** locate: find the cell containing a point
+       * @param point array to 3 point coordinates
+       * @param hint cell tried first, -1 if unknown
+       * @param test decides for candidate cells whether they contain the point
+       * @param data passed to test
+       * @return cell for which test succeeded, -1 if there is none
+       */
+    int locate(const float *point, int hint, CellTest test, void *data) const;
+
+    /** locate: find the cells containing many points. Successive points are
+       * expected to lie close to each other: the cell and the leaf found for
+       * the previous point are tried before searching the tree.
+       * @param no_p number of points
+       * @param points 3 coordinates per point
+       * @param cells on entry cells tried first (-1 if unknown), on return
+       *              the cells containing the points (-1 if not found)
+       * @param test decides for candidate cells whether they contain a point
+       * @param data passed to test
+       * @return number of points found in a cell
+       */
+    int locate(int no_p, const float *points, int *cells, CellTest test, void *data) const;
+
+    int getNumNodes() const
+    {
+        return nodeCount.get_length();
+    }
+    int getNumCells() const
+    {
+        return cellList.get_length();
+    }
+    void getGridBBox(float *bbox) const;
+    void getAddresses(float **node_bounds, int **node_first, int **node_count,
+                      int **cell_list, float **cell_bboxes) const;
+
+protected:
+    int rebuildFromShm();
+    int getObjInfo(int, coDoInfo **) const;
+    coDoCellBVH *cloneObject(const coObjInfo &newinfo) const;
+
+private:
+    int storeShm(int numNodes, int numCells);
+    void build(int nelem, int nconn, const int *el, const int *conn,
+               const float *x_c, const float *y_c, const float *z_c, int leaf_size);
+    // search the tree, skipping leaf skip, return cell and its leaf
+    int search(const float *point, int skip, CellTest test, void *data, int *leaf) const;
+    int searchLeaf(int node, const float *point, int skip, CellTest test, void *data) const;
+
+    coFloatShmArray nodeBounds; // 6 planes of getNumNodes() floats
+    coIntShmArray nodeFirst; // inner node: first child, leaf: first entry in cellList
+    coIntShmArray nodeCount; // inner node: 0, leaf: number of cells
+    coIntShmArray cellList; // cells ordered by leaves
+    coFloatShmArray cellBBoxes; // xmin, ymin, zmin, xmax, ymax, zmax per cell
+};
+}
+#endif
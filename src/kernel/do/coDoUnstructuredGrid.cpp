@@ -7,8 +7,16 @@
 
 #include "coDoUnstructuredGrid.h"
 #include "coDoOctTree.h"
+#include "coDoCellBVH.h"
 #include "covise_gridmethods.h"
 
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 // in this list the TYPE_... definitions in covise_unstrgrd.h can be
 // used to return the number of vertices for this kind of element
 namespace covise
@@ -28,6 +36,14 @@ int UnstructuredGrid_Num_Nodes[20] = {
 
 using namespace covise;
 
+// surname for oct-trees made on demand: MakeOctTree prefixes the grid
+// name, process and counter keep trees of other modules and grids apart
+static void octTreeSurname(char *surname)
+{
+    static int creationCounter = 0;
+    sprintf(surname, "auto_%d_%d", (int)getpid(), creationCounter++);
+}
+
 /**
 removed from header:
 
@@ -115,6 +131,7 @@ coDoUnstructuredGrid::~coDoUnstructuredGrid()
 coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info, coShmArray *arr)
     : coDoGrid(info)
     , oct_tree(NULL)
+    , cell_bvh(NULL)
     , lnl(NULL)
     , lnli(NULL)
 {
@@ -132,6 +149,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
                                            float *zc)
     : coDoGrid(info)
     , oct_tree(NULL)
+    , cell_bvh(NULL)
     , hastypes(0)
     , hasneighbors(0)
     , lnl(NULL)
@@ -207,6 +225,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
                                            float *zc, int *tl)
     : coDoGrid(info)
     , oct_tree(NULL)
+    , cell_bvh(NULL)
     , lnl(NULL)
     , lnli(NULL)
 {
@@ -281,6 +300,7 @@ coDoUnstructuredGrid::coDoUnstructuredGrid(const coObjInfo &info,
                                            int nelem, int nconn, int ncoord, int ht)
     : coDoGrid(info)
     , oct_tree(NULL)
+    , cell_bvh(NULL)
     , lnl(NULL)
     , lnli(NULL)
 {
@@ -929,15 +949,41 @@ int coDoUnstructuredGrid::setSizes(int numElem, int numConn, int numCoord)
     return 0;
 }
 
+namespace
+{
+// arguments of testACell for the cell tests of coDoCellBVH::locate
+struct CellTestData
+{
+    const coDoUnstructuredGrid *grid;
+    float *v_interp;
+    int no_arrays;
+    int array_dim;
+    float tolerance;
+    const float *const *velo;
+};
+}
+
+bool coDoUnstructuredGrid::cellTest(void *data, int cell, const float *point)
+{
+    CellTestData *d = (CellTestData *)data;
+    return d->grid->testACell(d->v_interp, point, cell, d->no_arrays, d->array_dim,
+                              d->tolerance, d->velo) == 0;
+}
+
 int coDoUnstructuredGrid::getCell(const float *point, float tolerance)
 {
+    if (cell_bvh)
+    {
+        float v_interp[3];
+        CellTestData data = { this, v_interp, 0, 0, tolerance, NULL };
+        return cell_bvh->locate(point, -1, cellTest, &data);
+    }
     coDoOctTree *cast_oct_tree = (coDoOctTree *)(oct_tree);
     if (cast_oct_tree == NULL)
     {
-        char *objName = getName();
-        char *newName = new char[strlen(objName) + 100];
-        sprintf(newName, "%s_octTree_%d", objName, rand());
-        MakeOctTree(newName);
+        char surname[64];
+        octTreeSurname(surname);
+        MakeOctTree(surname);
         cast_oct_tree = (coDoOctTree *)(oct_tree);
     }
     const int *cell_list = cast_oct_tree->search(point);
@@ -962,6 +1008,15 @@ int coDoUnstructuredGrid::interpolateField(float *v_interp, const float *point,
                                            int *cell, int no_arrays, int array_dim, float tolerance,
                                            const float *const *velo) const
 {
+    if (cell_bvh)
+    {
+        CellTestData data = { this, v_interp, no_arrays, array_dim, tolerance, velo };
+        int found = cell_bvh->locate(point, *cell, cellTest, &data);
+        if (found < 0)
+            return -1;
+        *cell = found;
+        return 0;
+    }
     const coDoOctTree *cast_oct_tree = (const coDoOctTree *)(oct_tree);
     if (*cell >= 0 && *cell < numelem && cast_oct_tree->IsInBBox(*cell, numelem, point)
         && testACell(v_interp, point, *cell, no_arrays, array_dim, tolerance,
@@ -993,6 +1048,38 @@ int coDoUnstructuredGrid::interpolateField(float *v_interp, const float *point,
     return -1;
 }
 
+int coDoUnstructuredGrid::getCells(int no_p, const float *points, int *cells, float tolerance) const
+{
+    float v_interp[3];
+    if (cell_bvh)
+    {
+        CellTestData data = { this, v_interp, 0, 0, tolerance, NULL };
+        return cell_bvh->locate(no_p, points, cells, cellTest, &data);
+    }
+    if (oct_tree == NULL)
+    {
+        char surname[64];
+        octTreeSurname(surname);
+        MakeOctTree(surname);
+    }
+    int found = 0, prev = -1;
+    for (int i = 0; i < no_p; i++)
+    {
+        if (cells[i] < 0)
+            cells[i] = prev;
+        if (interpolateField(v_interp, points + 3 * i, &cells[i], 0, 0, tolerance, NULL) == 0)
+        {
+            prev = cells[i];
+            found++;
+        }
+        else
+        {
+            cells[i] = -1;
+        }
+    }
+    return found;
+}
+
 int coDoUnstructuredGrid::mapScalarField(float *v_interp, const float *point,
                                          int *cell, int no_arrays, int array_dim,
                                          const float *const *velo)
@@ -1856,11 +1943,14 @@ const coDoOctTree *coDoUnstructuredGrid::GetOctTree(const coDistributedObject *r
     if (reuseOct)
     {
         oct_tree = reuseOct;
+        cell_bvh = reuseOct->isType("CELBVH") ? (const coDoCellBVH *)reuseOct : NULL;
     }
     else if (OctTreeSurname)
     {
         MakeOctTree(OctTreeSurname);
     }
+    if (cell_bvh)
+        return NULL;
     return (coDoOctTree *)(oct_tree);
 }
 
@@ -56,6 +56,7 @@ namespace covise
 DOEXPORT extern int UnstructuredGrid_Num_Nodes[20];
 
 class coDoOctTree;
+class coDoCellBVH;
 
 class DOEXPORT coDoUnstructuredGrid : public coDoGrid
 {
@@ -80,10 +81,13 @@ private:
     coIntShmArray neighborlist; // neighborlist list (length numneighbor)
     coIntShmArray neighborindex; // neighborindex list (length numcoord)
     mutable const coDistributedObject *oct_tree;
+    mutable const coDoCellBVH *cell_bvh; // oct_tree if it is a coDoCellBVH
 
     int testACell(float *v_interp, const float *point,
                   int cell, int no_arrays, int array_dim,
                   float tolerance, const float *const *velo) const;
+    // coDoCellBVH::CellTest calling testACell
+    static bool cellTest(void *data, int cell, const float *point);
     /*
             bool IsInBBox(int cell,const float *point);
             void BBoxForElement(float *cell_bbox,int elem);
@@ -110,6 +114,7 @@ public:
     coDoUnstructuredGrid(const coObjInfo &info)
         : coDoGrid(info)
         , oct_tree(NULL)
+        , cell_bvh(NULL)
         , lnl(0)
         , lnli(0)
     {
@@ -257,6 +262,14 @@ public:
     // searchCell in OctTree (create OctTree if not available)
     int getCell(const float *point, float tolerance);
 
+    // find the cells of no_p points (3 coordinates each) at once, cells
+    // holds the cells to try first (-1 if unknown) and returns the cells
+    // found (-1 if none), successive points should be close to each other.
+    // Uses the coDoCellBVH given to GetOctTree, or else the oct-tree.
+    // Returns the number of points found.
+    int getCells(int no_p, const float *points, int *cells, float tolerance) const;
+
+    // reuseOctTree may also be a coDoCellBVH, NULL is returned in this case
     const coDoOctTree *GetOctTree(const coDistributedObject *reuseOctTree,
                                   const char *OctTreeSurname) const;
 
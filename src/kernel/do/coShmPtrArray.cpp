@@ -7,6 +7,7 @@
 
 #include <covise/covise.h>
 #include <shm/covise_shm.h>
+#include <shm/covise_shmslab.h>
 #include <covise/covise_process.h>
 #include <covise/covise_appproc.h>
 #include <covise/covise_msg.h>
@@ -134,10 +135,23 @@ int coShmPtrArray::grow(ApplicationProcess *a, int s)
 
     //    print_comment(__LINE__, __FILE__, "growing coShmPtrArray");
     //    print();
-    shmmsg = new ShmMessage(SHMPTRARRAY, length + s);
-    a->exch_data_msg(shmmsg, 2, COVISE_MESSAGE_MALLOC_OK, COVISE_MESSAGE_MALLOC_FAILED);
-    shm_seq_no = *(int *)&shmmsg->data[0];
-    offset = *(int *)&shmmsg->data[sizeof(int)];
+    // small pointer arrays come directly from the shared memory slabs
+    coShmSlabAlloc *slabs = coShmSlabAlloc::the();
+    data_type dt = SHMPTRARRAY;
+    long count = length + s;
+    int idata[2];
+    if (slabs && slabs->mallocList(&dt, &count, 1, idata))
+    {
+        shm_seq_no = idata[0];
+        offset = *(shmSizeType *)&idata[1];
+    }
+    else
+    {
+        shmmsg = new ShmMessage(SHMPTRARRAY, length + s);
+        a->exch_data_msg(shmmsg, 2, COVISE_MESSAGE_MALLOC_OK, COVISE_MESSAGE_MALLOC_FAILED);
+        shm_seq_no = *(int *)&shmmsg->data[0];
+        offset = *(int *)&shmmsg->data[sizeof(int)];
+    }
     tmparr = new coShmArray(shm_seq_no, offset);
     iptr_new = (int *)tmparr->getPtr();
     iptr_old = (int *)getPtr();
@@ -514,8 +514,12 @@ grid_methods::interpolateInHexa(float *v_interp, const float *point,
     b += b;
     g -= 0.5;
     g += g;
-    // prepare array velos as required by interpElem
-    float *velos = new float[no_arrays * array_dim * 8];
+    // prepare array velos as required by interpElem,
+    // avoid the heap for the usual case of up to 8 components
+    float velos_buf[8 * 8];
+    float *velos = velos_buf;
+    if (no_arrays * array_dim > 8)
+        velos = new float[no_arrays * array_dim * 8];
     int array_num, comp_num;
     const float *velo_array_num;
 
@@ -531,7 +535,8 @@ grid_methods::interpolateInHexa(float *v_interp, const float *point,
         }
     }
     interpElem(fem_c, v_interp, no_arrays * array_dim, velos);
-    delete[] velos;
+    if (velos != velos_buf)
+        delete[] velos;
     return status;
 }
 
@@ -578,7 +583,7 @@ grid_methods::interpolateVInHexa(float *v_interp, const float *point,
     g -= 0.5;
     g += g;
     // prepare array velos as required by interpElem
-    float *velos = new float[24];
+    float velos[24];
     const float *velo_0 = velo[0];
     const float *velo_1 = velo[1];
     const float *velo_2 = velo[2];
@@ -634,7 +639,6 @@ grid_methods::interpolateVInHexa(float *v_interp, const float *point,
     velos[base + 2] = velo_2[coord];
 
     interpElem(fem_c, v_interp, 3, velos);
-    delete[] velos;
     return status;
 }
 
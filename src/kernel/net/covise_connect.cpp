@@ -39,6 +39,7 @@ typedef SSL_METHOD *CONST_SSL_METHOD_P;
 #else
 #include <unistd.h>
 #include <sys/socket.h>
+#include <poll.h>
 #endif
 
 #include "covise_connect.h"
@@ -46,15 +47,34 @@ typedef SSL_METHOD *CONST_SSL_METHOD_P;
 #include "covise_socket.h"
 #include "tokenbuffer.h"
 #include <util/coErr.h>
+#include <util/coWristWatch.h>
 #include <config/CoviseConfig.h>
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <vector>
+#include <zlib.h>
+#ifdef HAVE_SNAPPY
+#include <snappy.h>
+#endif
+
+#ifdef CO_CONNECTIONLIST_EPOLL
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#endif
 
 using namespace std;
 using namespace covise;
 
 static const int SIZEOF_IEEE_INT = 4;
 
+// batching connections holding messages: all of them are flushed before
+// any connection of the process blocks, as the peer might be waiting for
+// one of those messages before it answers
+static std::vector<Connection *> pendingBatches;
+static std::mutex batchingMutex;
+
 /***********************************************************************\ 
  **                                                                     **
  **   Connection  classes Routines                 Version: 1.1         **
@@ -103,6 +123,113 @@ static const int SIZEOF_IEEE_INT = 4;
 SSL_CTX *SSLConnection::mCTX = NULL;
 #endif
 
+// payload compression settings from System.Network, e.g.
+// <Network compression="zlib" compressionThreshold="65536" compressionLevel="1" statistics="on" />
+struct CompressionConfig
+{
+    int codec;
+    int threshold;
+    int level;
+    bool statistics;
+
+    CompressionConfig()
+    {
+        std::string name = coCoviseConfig::getEntry("compression", "System.Network", "none");
+        codec = Connection::COMPRESS_NONE;
+        if (name == "zlib")
+            codec = Connection::COMPRESS_ZLIB;
+        else if (name == "snappy")
+            codec = Connection::COMPRESS_SNAPPY;
+        else if (name != "none" && name != "off")
+        {
+            LOGWARNING("unknown System.Network compression codec %s", name.c_str());
+        }
+        if (codec && !(Connection::available_codecs() & (1 << (codec - 1))))
+        {
+            LOGWARNING("compression codec %s not available", name.c_str());
+            codec = Connection::COMPRESS_NONE;
+        }
+        threshold = coCoviseConfig::getInt("compressionThreshold", "System.Network", 65536);
+        level = coCoviseConfig::getInt("compressionLevel", "System.Network", 1);
+        statistics = coCoviseConfig::isOn("statistics", "System.Network", false);
+    }
+};
+
+static const CompressionConfig &compressionConfig()
+{
+    static CompressionConfig config;
+    return config;
+}
+
+// payloads with less gain are sent uncompressed
+static bool worth_sending(size_t compressed, size_t length)
+{
+    return compressed < length - length / 8;
+}
+
+// compress the concatenation of parts into out, which has room for
+// max_compressed_length(codec, length) bytes - returns compressed size or 0
+static size_t compress_parts(int codec, int level, const IoBuffer *parts, int nparts, size_t length, char *out, size_t out_size)
+{
+    if (codec == Connection::COMPRESS_ZLIB)
+    {
+        z_stream strm;
+        memset(&strm, 0, sizeof(strm));
+        if (deflateInit(&strm, level) != Z_OK)
+            return 0;
+        strm.next_out = (Bytef *)out;
+        strm.avail_out = (uInt)out_size;
+        int ret = Z_OK;
+        for (int i = 0; i < nparts && ret == Z_OK; i++)
+        {
+            if (parts[i].length == 0)
+                continue;
+            strm.next_in = (Bytef *)parts[i].data;
+            strm.avail_in = (uInt)parts[i].length;
+            ret = deflate(&strm, Z_NO_FLUSH);
+            if (strm.avail_in != 0)
+                ret = Z_BUF_ERROR;
+        }
+        if (ret == Z_OK)
+            ret = deflate(&strm, Z_FINISH);
+        size_t compressed = strm.total_out;
+        deflateEnd(&strm);
+        return ret == Z_STREAM_END ? compressed : 0;
+    }
+#ifdef HAVE_SNAPPY
+    if (codec == Connection::COMPRESS_SNAPPY)
+    {
+        size_t compressed = 0;
+        if (nparts == 1)
+        {
+            snappy::RawCompress((const char *)parts[0].data, length, out, &compressed);
+            return compressed;
+        }
+        char *input = new char[length];
+        size_t pos = 0;
+        for (int i = 0; i < nparts; i++)
+        {
+            memcpy(&input[pos], parts[i].data, parts[i].length);
+            pos += parts[i].length;
+        }
+        snappy::RawCompress(input, length, out, &compressed);
+        delete[] input;
+        return compressed;
+    }
+#endif
+    return 0;
+}
+
+static size_t max_compressed_length(int codec, size_t length)
+{
+#ifdef HAVE_SNAPPY
+    if (codec == Connection::COMPRESS_SNAPPY)
+        return snappy::MaxCompressedLength(length);
+#endif
+    (void)codec;
+    return compressBound((uLong)length);
+}
+
 int Connection::get_id()
 {
     //cerr << "sock == " << sock << " id: " << sock->get_id() << endl;
@@ -124,6 +251,8 @@ Connection::Connection()
     peer_id_ = 0;
     peer_type_ = Message::UNDEFINED; // prepare connection (for subclasses)
     header_int = new int[4 * SIZEOF_IEEE_INT];
+    init_batch();
+    init_compression();
 };
 
 Connection::Connection(int sfd)
@@ -144,15 +273,162 @@ Connection::Connection(int sfd)
     peer_id_ = 0;
     peer_type_ = Message::UNDEFINED; // initialiaze connection with existing socket
     header_int = new int[4 * SIZEOF_IEEE_INT];
+    bytes_to_process = 0;
+    convert_to = DF_NONE;
+    sender_id = 0;
+    init_batch();
+    init_compression();
 };
 
 Connection::~Connection() // close connection (for subclasses)
 {
+    set_batching(false);
+    if (compressionConfig().statistics && (stats.messages_sent > 0 || stats.messages_received > 0))
+        print_stats();
+    delete[] batch_buf;
     delete[] read_buf;
     delete[] header_int;
     delete sock;
 }
 
+void Connection::init_batch()
+{
+    batch_buf = NULL;
+    batch_len = 0;
+    batch_queued = false;
+    reset_stats();
+}
+
+void Connection::reset_stats()
+{
+    stats.messages_sent = 0;
+    stats.bytes_sent = 0;
+    stats.write_calls = 0;
+    stats.messages_batched = 0;
+    stats.messages_received = 0;
+    stats.bytes_received = 0;
+    stats.messages_compressed = 0;
+    stats.bytes_uncompressed = 0;
+    stats.bytes_compressed = 0;
+    stats.compress_seconds = 0.0;
+    stats.transfer_bytes = 0;
+    stats.transfer_seconds = 0.0;
+}
+
+void Connection::print_stats()
+{
+    LOGINFO("connection %d: sent %ld messages, %ld bytes in %ld writes, received %ld messages, %ld bytes",
+            sender_id, stats.messages_sent, stats.bytes_sent, stats.write_calls,
+            stats.messages_received, stats.bytes_received);
+    if (stats.transfer_seconds > 0.0)
+    {
+        LOGINFO("connection %d: large messages written with %.1f MB/s",
+                sender_id, stats.transfer_bytes / stats.transfer_seconds / 1048576.0);
+    }
+    if (stats.messages_compressed > 0)
+    {
+        LOGINFO("connection %d: compressed %ld messages from %ld to %ld bytes (%.1f %%), %.3f s (de)compressing",
+                sender_id, stats.messages_compressed, stats.bytes_uncompressed, stats.bytes_compressed,
+                100.0 * stats.bytes_compressed / stats.bytes_uncompressed, stats.compress_seconds);
+    }
+}
+
+void Connection::init_compression()
+{
+    compress_codec = COMPRESS_NONE;
+    compress_threshold = compressionConfig().threshold;
+    peer_codecs = 0;
+    peer_native_arrays = false;
+}
+
+int Connection::available_codecs()
+{
+#ifdef CRAY
+    return 0;
+#else
+    int codecs = 1 << (COMPRESS_ZLIB - 1);
+#ifdef HAVE_SNAPPY
+    codecs |= 1 << (COMPRESS_SNAPPY - 1);
+#endif
+    return codecs;
+#endif
+}
+
+char Connection::local_dataformat()
+{
+    return (char)(df_local_machine | (available_codecs() << DF_COMPRESS_SHIFT) | DF_NATIVE_ARRAYS);
+}
+
+void Connection::set_dataformat(char dataformat)
+{
+    // peers not knowing about compression send the plain data format
+    if ((dataformat & DF_FORMAT_MASK) != df_local_machine)
+        if (df_local_machine != DF_IEEE)
+            convert_to = DF_IEEE;
+    peer_codecs = ((unsigned char)dataformat >> DF_COMPRESS_SHIFT) & available_codecs();
+    peer_native_arrays = (dataformat & DF_NATIVE_ARRAYS) != 0;
+    set_compression(compressionConfig().codec, compressionConfig().threshold);
+}
+
+bool Connection::set_compression(int codec, int threshold)
+{
+    compress_threshold = threshold;
+    if (codec != COMPRESS_NONE && !(peer_codecs & (1 << (codec - 1))))
+    {
+        compress_codec = COMPRESS_NONE;
+        return false;
+    }
+    compress_codec = codec;
+    return true;
+}
+
+void Connection::set_batching(bool on)
+{
+    if (on && !batch_buf)
+    {
+        batch_buf = new char[WRITE_BUFFER_SIZE];
+        batch_len = 0;
+    }
+    else if (!on && batch_buf)
+    {
+        flush_batch();
+        delete[] batch_buf;
+        batch_buf = NULL;
+        if (batch_queued)
+        {
+            std::lock_guard<std::mutex> lock(batchingMutex);
+            pendingBatches.erase(std::remove(pendingBatches.begin(), pendingBatches.end(), this),
+                                 pendingBatches.end());
+            batch_queued = false;
+        }
+    }
+}
+
+void Connection::flush_all_batches()
+{
+    std::vector<Connection *> pending;
+    {
+        std::lock_guard<std::mutex> lock(batchingMutex);
+        if (pendingBatches.empty())
+            return;
+        pending.swap(pendingBatches);
+        for (size_t i = 0; i < pending.size(); i++)
+            pending[i]->batch_queued = false;
+    }
+    for (size_t i = 0; i < pending.size(); i++)
+        pending[i]->flush_batch();
+}
+
+int Connection::flush_batch()
+{
+    if (batch_len == 0 || !sock)
+        return 0;
+    int len = batch_len;
+    batch_len = 0;
+    stats.write_calls++;
+    return sock->write(batch_buf, len);
+}
+
 // give socket id
 int Connection::get_id(void (*remove_func)(int))
 {
@@ -276,10 +552,9 @@ ClientConnection::ClientConnection(Host *h, int p, int id, int
         sock = NULL;
         return; // connection failed
     }
-    if (dataformat != df_local_machine)
-        if (df_local_machine != DF_IEEE)
-            convert_to = DF_IEEE;
-    if (sock->write(&df_local_machine, 1) == COVISE_SOCKET_INVALID)
+    set_dataformat(dataformat);
+    char local_format = local_dataformat();
+    if (sock->write(&local_format, 1) == COVISE_SOCKET_INVALID)
     {
         LOGERROR("invalid socket in new ClientConnection");
     }
@@ -327,7 +602,7 @@ void SimpleClientConnection::get_dataformat()
    {
       std::cerr << "Local-Format is not IEEE. Format: "<< dataformat << std::endl;
    } */
-    if (dataformat != df_local_machine)
+    if ((dataformat & DF_FORMAT_MASK) != df_local_machine)
         if (df_local_machine != DF_IEEE)
             convert_to = DF_IEEE;
 }
@@ -490,6 +765,7 @@ void Connection::close()
 {
     if (sock)
     {
+        flush_batch();
         LOGINFO("close port %d", sock->get_port());
         if (remove_socket)
         {
@@ -514,18 +790,20 @@ void Connection::set_hostid(int id)
 
 int ServerConnection::acceptOne()
 {
-    char dataformat;
+    char dataformat = df_local_machine;
 
     if (!sock)
     {
         LOGERROR("no socket in ServerConnection::accept");
         return -1;
     }
+    flush_all_batches(); // the peer might be started by one of them
     if (sock->acceptOnly() < 0)
     {
         return -1;
     }
-    if (sock->write(&df_local_machine, 1) != 1)
+    char local_format = local_dataformat();
+    if (sock->write(&local_format, 1) != 1)
     {
         LOGERROR("invalid socket in ServerConnection::accept");
         return -1;
@@ -538,9 +816,7 @@ int ServerConnection::acceptOne()
         if (retries < 50)
             sleep(1);
     }
-    if (dataformat != df_local_machine)
-        if (df_local_machine != DF_IEEE)
-            convert_to = DF_IEEE;
+    set_dataformat(dataformat);
 
 #ifdef SHOWMSG
     LOGINFO("convert: %d", convert_to);
@@ -551,6 +827,7 @@ int ServerConnection::acceptOne()
 
 int ServerConnection::acceptOne(int wait)
 {
+    flush_all_batches(); // the peer might be started by one of them
     if (sock->acceptOnly(wait) != 0)
         return -1;
     get_dataformat();
@@ -622,9 +899,10 @@ SimpleServerConnection *ServerConnection::spawnSimpleConnection()
 
 void ServerConnection::get_dataformat()
 {
-    char dataformat;
+    char dataformat = df_local_machine;
 
-    if (sock->write(&df_local_machine, 1) != 1)
+    char local_format = local_dataformat();
+    if (sock->write(&local_format, 1) != 1)
     {
         LOGERROR("invalid socket in ServerConnection::accept");
         return;
@@ -653,9 +931,7 @@ void ServerConnection::get_dataformat()
    {
       std::cerr << "Local-Format is not IEEE. Format: "<< dataformat << std::endl;
    }*/
-    if (dataformat != df_local_machine)
-        if (df_local_machine != DF_IEEE)
-            convert_to = DF_IEEE;
+    set_dataformat(dataformat);
 }
 
 void Connection::set_peer(int id, int type)
@@ -679,6 +955,7 @@ int Connection::receive(void *buf, unsigned nbyte)
     int retval;
     if (!sock)
         return 0;
+    flush_all_batches();
     retval = sock->Read(buf, nbyte);
 
     return retval;
@@ -688,46 +965,30 @@ int Connection::send(const void *buf, unsigned nbyte)
 {
     if (!sock)
         return 0;
+    // raw bytes must not overtake batched messages
+    if (flush_batch() == COVISE_SOCKET_INVALID)
+        return COVISE_SOCKET_INVALID;
     return sock->write(buf, nbyte);
 }
 
 int Connection::send_msg_fast(const Message *msg)
 {
-    int bytes_written = 0;
-    int offset = 0;
-
     //Compose COVISE header
     header_int[0] = sender_id;
     header_int[1] = send_type;
     header_int[2] = msg->type;
     header_int[3] = msg->length;
 
-    int ret = sock->write(header_int, 4 * SIZEOF_IEEE_INT);
-    if (ret < 0)
-    {
-        return ret;
-    }
-
-    bytes_written += ret;
-
-    while (offset < msg->length)
-    {
-        if (msg->length - offset < WRITE_BUFFER_SIZE)
-        {
-            ret = sock->write((void *)&(msg->data[offset]), msg->length - offset);
-        }
-        else
-        {
-            ret = sock->write((void *)&(msg->data[offset]), WRITE_BUFFER_SIZE);
-        }
-        if (ret < 0)
-        {
-            return ret;
-        }
-        bytes_written += ret;
-        offset += ret;
-    }
-    return bytes_written;
+    // header and data with one system call
+    IoBuffer parts[2];
+    parts[0].data = header_int;
+    parts[0].length = 4 * SIZEOF_IEEE_INT;
+    parts[1].data = msg->data;
+    parts[1].length = msg->length;
+    flush_batch();
+    stats.messages_sent++;
+    stats.bytes_sent += 4 * SIZEOF_IEEE_INT + msg->length;
+    return write_message(parts, msg->length > 0 ? 2 : 1, 4 * SIZEOF_IEEE_INT + msg->length);
 }
 
 int Connection::send_msg(const Message *msg)
@@ -741,6 +1002,15 @@ int Connection::send_msg(const Message *msg)
 #ifdef SHOWMSG
     LOGINFO("send: s: %d st: %d mt: %s l: %d", sender_id, send_type, covise_msg_types_array[msg->type], msg->length);
 #endif
+    if (compress_codec != COMPRESS_NONE && msg->length > 0 && msg->length >= compress_threshold && msg->type >= 0)
+    {
+        IoBuffer part;
+        part.data = msg->data;
+        part.length = msg->length;
+        retval = send_compressed(msg->type, &part, 1, msg->length);
+        if (retval != 0)
+            return retval;
+    }
 #ifdef CRAY
     int tmp_buf[4];
     tmp_buf[0] = sender_id;
@@ -762,6 +1032,56 @@ int Connection::send_msg(const Message *msg)
     swap_bytes((unsigned int *)write_buf_int, 4);
 #endif
 
+    stats.messages_sent++;
+    stats.bytes_sent += 4 * SIZEOF_IEEE_INT + msg->length;
+#ifndef CRAY
+    if (batch_buf && msg->length <= BATCH_MAX_MESSAGE_SIZE)
+    {
+        if (batch_len + 4 * SIZEOF_IEEE_INT + msg->length > WRITE_BUFFER_SIZE)
+        {
+            if (flush_batch() == COVISE_SOCKET_INVALID)
+                return COVISE_SOCKET_INVALID;
+        }
+        if (!batch_queued)
+        {
+            std::lock_guard<std::mutex> lock(batchingMutex);
+            pendingBatches.push_back(this);
+            batch_queued = true;
+        }
+        memcpy(&batch_buf[batch_len], write_buf, 4 * SIZEOF_IEEE_INT);
+        if (msg->length > 0)
+            memcpy(&batch_buf[batch_len + 4 * SIZEOF_IEEE_INT], msg->data, msg->length);
+        batch_len += 4 * SIZEOF_IEEE_INT + msg->length;
+        stats.messages_batched++;
+        return 4 * SIZEOF_IEEE_INT + msg->length;
+    }
+    if (batch_len > 0 || msg->length >= WRITE_BUFFER_SIZE - 4 * SIZEOF_IEEE_INT)
+    {
+        // pending batch, header and large data with one system call
+        IoBuffer parts[3];
+        int nparts = 0;
+        int batched = batch_len;
+        if (batched > 0)
+        {
+            parts[nparts].data = batch_buf;
+            parts[nparts++].length = batched;
+            batch_len = 0;
+        }
+        parts[nparts].data = write_buf;
+        parts[nparts++].length = 4 * SIZEOF_IEEE_INT;
+        if (msg->length > 0)
+        {
+            parts[nparts].data = msg->data;
+            parts[nparts++].length = msg->length;
+        }
+        retval = write_message(parts, nparts, batched + 4 * SIZEOF_IEEE_INT + msg->length);
+        if (retval < 0)
+            return retval;
+        return retval - batched;
+    }
+#endif
+
+    stats.write_calls++;
     if (msg->length == 0)
         retval = sock->write(write_buf, 4 * SIZEOF_IEEE_INT);
     else
@@ -811,6 +1131,189 @@ int Connection::send_msg(const Message *msg)
     return retval;
 }
 
+#if defined(CRAY) || defined(HAVE_OPENSSL)
+// fallback for connections that cannot write the parts directly
+static int send_msg_copied(Connection *conn, int type, const IoBuffer *parts, int nparts)
+{
+    size_t length = 0;
+    for (int i = 0; i < nparts; i++)
+        length += parts[i].length;
+
+    Message msg(type, (int)length, new char[length], MSG_NOCOPY);
+    length = 0;
+    for (int i = 0; i < nparts; i++)
+    {
+        memcpy(&msg.data[length], parts[i].data, parts[i].length);
+        length += parts[i].length;
+    }
+    int retval = conn->send_msg(&msg);
+    msg.delete_data();
+    return retval;
+}
+#endif
+
+int Connection::send_msg_parts(int type, const IoBuffer *parts, int nparts)
+{
+    if (!sock)
+        return 0;
+
+    size_t length = 0;
+    for (int i = 0; i < nparts; i++)
+        length += parts[i].length;
+
+#ifdef CRAY
+    return send_msg_copied(this, type, parts, nparts);
+#else
+    if (compress_codec != COMPRESS_NONE && length > 0 && length >= (size_t)compress_threshold && type >= 0)
+    {
+        int retval = send_compressed(type, parts, nparts, length);
+        if (retval != 0)
+            return retval;
+    }
+
+    int header[4];
+    header[0] = sender_id;
+    header[1] = send_type;
+    header[2] = type;
+    header[3] = (int)length;
+    swap_bytes((unsigned int *)header, 4);
+
+    IoBuffer *iov = new IoBuffer[nparts + 1];
+    iov[0].data = header;
+    iov[0].length = 4 * SIZEOF_IEEE_INT;
+    for (int i = 0; i < nparts; i++)
+        iov[i + 1] = parts[i];
+    flush_batch();
+    stats.messages_sent++;
+    stats.bytes_sent += 4 * SIZEOF_IEEE_INT + length;
+    int retval = write_message(iov, nparts + 1, 4 * SIZEOF_IEEE_INT + length);
+    delete[] iov;
+    return retval;
+#endif
+}
+
+int Connection::write_message(const IoBuffer *parts, int nparts, size_t length)
+{
+    stats.write_calls++;
+    if (length < WRITE_BUFFER_SIZE)
+        return sock->writev(parts, nparts);
+
+    coWristWatch watch;
+    int retval = sock->writev(parts, nparts);
+    if (retval > 0)
+    {
+        stats.transfer_bytes += retval;
+        stats.transfer_seconds += watch.elapsed();
+    }
+    return retval;
+}
+
+// returns 0 without sending anything if the payload does not compress well
+int Connection::send_compressed(int type, const IoBuffer *parts, int nparts, size_t length)
+{
+#ifdef CRAY
+    (void)type;
+    (void)parts;
+    (void)nparts;
+    (void)length;
+    return 0;
+#else
+    coWristWatch watch;
+    size_t bound = max_compressed_length(compress_codec, length);
+    char *buf = new char[2 * SIZEOF_IEEE_INT + bound];
+    size_t compressed = compress_parts(compress_codec, compressionConfig().level, parts, nparts, length,
+                                       &buf[2 * SIZEOF_IEEE_INT], bound);
+    stats.compress_seconds += watch.elapsed();
+    if (compressed == 0 || !worth_sending(compressed, length))
+    {
+        delete[] buf;
+        return 0;
+    }
+
+    // payload starts with codec and uncompressed length
+    int *prefix = (int *)buf;
+    prefix[0] = compress_codec;
+    prefix[1] = (int)length;
+    swap_bytes((unsigned int *)prefix, 2);
+
+    int header[4];
+    header[0] = sender_id;
+    header[1] = send_type;
+    header[2] = type | MSG_COMPRESSED;
+    header[3] = (int)(2 * SIZEOF_IEEE_INT + compressed);
+    swap_bytes((unsigned int *)header, 4);
+
+    IoBuffer iov[2];
+    iov[0].data = header;
+    iov[0].length = 4 * SIZEOF_IEEE_INT;
+    iov[1].data = buf;
+    iov[1].length = 2 * SIZEOF_IEEE_INT + compressed;
+    flush_batch();
+    stats.messages_sent++;
+    stats.bytes_sent += 6 * SIZEOF_IEEE_INT + compressed;
+    stats.messages_compressed++;
+    stats.bytes_uncompressed += length;
+    stats.bytes_compressed += 2 * SIZEOF_IEEE_INT + compressed;
+    int retval = write_message(iov, 2, 6 * SIZEOF_IEEE_INT + compressed);
+    delete[] buf;
+    return retval;
+#endif
+}
+
+int Connection::uncompress_msg(Message *msg)
+{
+    msg->type &= ~MSG_COMPRESSED;
+
+    bool ok = false;
+    char *data = NULL;
+    int length = 0;
+    if (msg->data && msg->length >= 2 * SIZEOF_IEEE_INT)
+    {
+        int prefix[2];
+        memcpy(prefix, msg->data, 2 * SIZEOF_IEEE_INT);
+        swap_bytes((unsigned int *)prefix, 2);
+        length = prefix[1];
+        const char *src = &msg->data[2 * SIZEOF_IEEE_INT];
+        size_t src_length = msg->length - 2 * SIZEOF_IEEE_INT;
+        if (length >= 0)
+        {
+            coWristWatch watch;
+            // same 16 byte alignment as for uncompressed messages
+            data = new char[length + ((length % 16 != 0) * (16 - length % 16))];
+            if (prefix[0] == COMPRESS_ZLIB)
+            {
+                uLongf dest_length = length;
+                ok = uncompress((Bytef *)data, &dest_length, (const Bytef *)src, (uLong)src_length) == Z_OK
+                     && dest_length == (uLongf)length;
+            }
+#ifdef HAVE_SNAPPY
+            else if (prefix[0] == COMPRESS_SNAPPY)
+            {
+                size_t dest_length = 0;
+                ok = snappy::GetUncompressedLength(src, src_length, &dest_length)
+                     && dest_length == (size_t)length
+                     && snappy::RawUncompress(src, src_length, data);
+            }
+#endif
+            stats.compress_seconds += watch.elapsed();
+        }
+    }
+
+    delete[] msg->data;
+    if (!ok)
+    {
+        LOGERROR("cannot decompress message of type %d", msg->type);
+        delete[] data;
+        msg->data = NULL;
+        msg->length = 0;
+        msg->type = Message::EMPTY;
+        return 0;
+    }
+    msg->data = data;
+    msg->length = length;
+    return length;
+}
+
 int Connection::recv_msg_fast(Message *msg)
 {
     //Init values
@@ -821,6 +1324,8 @@ int Connection::recv_msg_fast(Message *msg)
     //Store size of existing buffer in Message
     int existing_buffer_len = msg->length;
 
+    flush_all_batches();
+
     //Read header
     read_bytes = sock->read(header_int, 4 * SIZEOF_IEEE_INT);
     if (read_bytes < 0)
@@ -871,6 +1376,14 @@ int Connection::recv_msg_fast(Message *msg)
 }
 
 int Connection::recv_msg(Message *msg)
+{
+    int retval = recv_raw_msg(msg);
+    if (msg->type > 0 && (msg->type & MSG_COMPRESSED))
+        retval = uncompress_msg(msg);
+    return retval;
+}
+
+int Connection::recv_raw_msg(Message *msg)
 {
     int bytes_read, bytes_to_read, tmp_read;
     char *read_buf_ptr;
@@ -892,6 +1405,7 @@ int Connection::recv_msg(Message *msg)
 
     if (!sock)
         return 0;
+    flush_all_batches(); // the peer might answer one of them
 
     ///  aw: this looks like stdin/stdout sending
     if (send_type == Message::STDINOUT)
@@ -988,6 +1502,8 @@ int Connection::recv_msg(Message *msg)
         LOGINFO(tmp_str);
 #endif
 
+        stats.messages_received++;
+        stats.bytes_received += 4 * SIZEOF_IEEE_INT + msg->length;
         bytes_to_process -= 4 * SIZEOF_IEEE_INT;
 #ifdef SHOWMSG
         LOGINFO("bytes_to_process %d bytes, msg->length %d", bytes_to_process, msg->length);
@@ -1128,10 +1644,12 @@ int Connection::check_for_input(float time)
 {
     if (has_message())
         return 1;
+    flush_all_batches();
 
     int i = 0;
     do
     {
+#ifdef WIN32
         struct timeval timeout;
         timeout.tv_sec = (int)time;
         timeout.tv_usec = (int)((time - timeout.tv_sec) * 1000000);
@@ -1144,9 +1662,14 @@ int Connection::check_for_input(float time)
         FD_SET(sock->get_id(), &fdread);
 
         i = select(sock->get_id() + 1, &fdread, NULL, NULL, &timeout);
-#ifdef WIN32
     } while (i == -1 && (WSAGetLastError() == WSAEINTR || WSAGetLastError() == WSAEINPROGRESS));
 #else
+        // poll is not limited to descriptors below FD_SETSIZE
+        struct pollfd pfd;
+        pfd.fd = sock->get_id();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        i = poll(&pfd, 1, (int)(time * 1000.f));
     } while (i == -1 && errno == EINTR);
 #endif
 
@@ -1162,17 +1685,97 @@ int Connection::check_for_input(float time)
     return 0;
 }
 
+#ifdef CO_CONNECTIONLIST_EPOLL
+enum
+{
+    READY_QUEUED = 1, // connection is in the ready queue
+    READY_HANGUP = 2 // peer closed or error: report until removed
+};
+
+static const int MAX_EPOLL_EVENTS = 64;
+
+void ConnectionList::init_epoll()
+{
+    numfds = 0;
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0)
+        coPerror("ConnectionList: epoll_create1 failed");
+}
+
+// the listening socket stays level triggered, as only one connection
+// is accepted per wakeup
+void ConnectionList::watch(Connection *c, bool edge)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    if (edge)
+        ev.events |= EPOLLET;
+    ev.data.ptr = c;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, c->get_id(), &ev) == 0)
+    {
+        numfds++;
+    }
+    else
+    {
+        LOGINFO("ConnectionList: epoll_ctl failed: %s\n", Socket::coStrerror(Socket::getErrno()));
+    }
+}
+
+void ConnectionList::queue_ready(Connection *c, bool hangup)
+{
+    int &state = readyState[c];
+    if (hangup)
+        state |= READY_HANGUP;
+    if (!(state & READY_QUEUED))
+    {
+        state |= READY_QUEUED;
+        ready.push_back(c);
+    }
+}
+
+// round robin over the ready queue: a connection is dropped from the
+// queue once it has neither buffered nor unread input, new data will
+// trigger another edge
+Connection *ConnectionList::next_ready()
+{
+    while (!ready.empty())
+    {
+        Connection *c = ready.front();
+        ready.pop_front();
+        int &state = readyState[c];
+        if (!(state & READY_HANGUP) && !c->has_message())
+        {
+            int avail = 0;
+            if (ioctl(c->get_id(), FIONREAD, &avail) < 0 || avail <= 0)
+            {
+                state &= ~READY_QUEUED;
+                continue;
+            }
+        }
+        ready.push_back(c);
+        return c;
+    }
+    return NULL;
+}
+#endif
+
 ConnectionList::ConnectionList()
 {
     connlist = new List<Connection>;
     open_sock = 0;
+    batching = false;
     maxfd = 0;
     FD_ZERO(&fdvar);
+#ifdef CO_CONNECTIONLIST_EPOLL
+    init_epoll();
+#endif
 }
 
 ConnectionList::ConnectionList(ServerConnection *o_s)
 {
     connlist = new List<Connection>;
+    batching = false;
     FD_ZERO(&fdvar); // the field for the select call is initiallized
     open_sock = o_s;
     if (open_sock->listen() < 0)
@@ -1181,7 +1784,12 @@ ConnectionList::ConnectionList(ServerConnection *o_s)
     }
     int id = open_sock->get_id();
     maxfd = id;
+#ifdef CO_CONNECTIONLIST_EPOLL
+    init_epoll();
+    watch(open_sock, false);
+#else
     FD_SET(id, &fdvar);
+#endif
     return;
 }
 
@@ -1210,6 +1818,10 @@ ConnectionList::~ConnectionList()
         delete ptr;
     }
     delete connlist;
+#ifdef CO_CONNECTIONLIST_EPOLL
+    if (epfd >= 0)
+        ::close(epfd);
+#endif
     return;
 }
 
@@ -1230,16 +1842,26 @@ void ConnectionList::add_open_conn(ServerConnection *c)
     }
     if (c->get_id() > maxfd)
         maxfd = c->get_id();
+#ifdef CO_CONNECTIONLIST_EPOLL
+    watch(c, false);
+#else
     FD_SET(c->get_id(), &fdvar);
+#endif
     return;
 }
 
 void ConnectionList::add(Connection *c) // add a connection and update the
 { //c->print();
     connlist->add(c); // field for the select call
+    if (batching)
+        c->set_batching(true);
     if (c->get_id() > maxfd)
         maxfd = c->get_id();
+#ifdef CO_CONNECTIONLIST_EPOLL
+    watch(c, true);
+#else
     FD_SET(c->get_id(), &fdvar);
+#endif
     return;
 }
 
@@ -1248,11 +1870,24 @@ void ConnectionList::remove(Connection *c) // remove a connection and update
     if (!c)
         return;
     connlist->remove(c); // the field for the select call
+#ifdef CO_CONNECTIONLIST_EPOLL
+    struct epoll_event ev; // ignored, but must not be NULL for old kernels
+    if (c->get_id() >= 0 && epoll_ctl(epfd, EPOLL_CTL_DEL, c->get_id(), &ev) == 0)
+        numfds--;
+    std::map<Connection *, int>::iterator it = readyState.find(c);
+    if (it != readyState.end())
+    {
+        if (it->second & READY_QUEUED)
+            ready.erase(std::find(ready.begin(), ready.end(), c));
+        readyState.erase(it);
+    }
+#else
     FD_CLR(c->get_id(), &fdvar);
+#endif
 }
 
 // aw 04/2000: Check whether PPID==1 or no sockets left: prevent hanging
-static void checkPPIDandFD(fd_set &actSet, int maxfd)
+static void checkPPIDandFD(int numFD)
 {
 #ifndef _WIN32
     if (getppid() == 1)
@@ -1263,11 +1898,6 @@ static void checkPPIDandFD(fd_set &actSet, int maxfd)
     }
 #endif
 
-    int numFD = 0;
-    for (int j = 0; j <= maxfd; j++)
-        if (FD_ISSET(j, &actSet))
-            numFD++;
-
     if (numFD == 0)
     {
         std::cerr << "Process " << getpid()
@@ -1276,6 +1906,21 @@ static void checkPPIDandFD(fd_set &actSet, int maxfd)
     }
 }
 
+void ConnectionList::set_batching(bool on)
+{
+    batching = on;
+    connlist->reset();
+    while (Connection *ptr = connlist->next())
+        ptr->set_batching(on);
+}
+
+void ConnectionList::flush_batches()
+{
+    connlist->reset();
+    while (Connection *ptr = connlist->next())
+        ptr->flush_batch();
+}
+
 /// Wait for input infinitely - replaced by loop with timeouts
 /// - check every 10 sec against hang aw 04/2000
 Connection *ConnectionList::wait_for_input()
@@ -1287,14 +1932,81 @@ Connection *ConnectionList::wait_for_input()
     return found;
 }
 
+#ifdef CO_CONNECTIONLIST_EPOLL
+// return a connection from the ready queue or wait up to time seconds for
+// new input, a pending connection on the listening socket is accepted
+Connection *ConnectionList::wait_ready(float time, bool *accepted)
+{
+    if (Connection *ptr = next_ready())
+        return ptr;
+
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int n;
+    do
+    {
+        n = epoll_wait(epfd, events, MAX_EPOLL_EVENTS, (int)(time * 1000.f));
+    } while (n == -1 && errno == EINTR);
+
+    if (n < 0)
+    {
+        LOGINFO("epoll_wait failed: %s\n", Socket::coStrerror(Socket::getErrno()));
+        coPerror("epoll_wait failed");
+        return NULL;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        Connection *ptr = (Connection *)events[i].data.ptr;
+        if (ptr == open_sock)
+            *accepted = true;
+        else
+            queue_ready(ptr, (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+    }
+    if (*accepted)
+    {
+        // as with select, the new connection is not reported as input
+        this->add(open_sock->spawn_connection());
+        return NULL;
+    }
+    return next_ready();
+}
+#endif
+
 Connection *ConnectionList::check_for_input(float time)
 {
+#ifdef CO_CONNECTIONLIST_EPOLL
+    // drain input that has already been announced before waiting again
+    bool accepted = false;
+    if (Connection *ptr = wait_ready(0.f, &accepted))
+        return ptr;
+    if (accepted)
+        return NULL;
+
+    // messages read ahead by recv_msg on connections outside the ready
+    // queue are not announced by epoll - only search for them before blocking
+    connlist->reset();
+    while (Connection *ptr = connlist->next())
+    {
+        if (batching)
+            ptr->flush_batch();
+        if (ptr->has_message())
+            return ptr;
+    }
+
+    Connection *found = time > 0.f ? wait_ready(time, &accepted) : NULL;
+
+    // nothing? this might be a hanger ... better check it!
+    if (!found && !accepted && connlist->count() > 0)
+        checkPPIDandFD(numfds);
+    return found;
+#else
     int numconn = 0;
     // if we already have a pending message, we return it
     connlist->reset();
     while (Connection *ptr = connlist->next())
     {
         ++numconn;
+        if (batching)
+            ptr->flush_batch();
         if (ptr->has_message())
             return ptr;
     }
@@ -1328,7 +2040,13 @@ Connection *ConnectionList::check_for_input(float time)
 
     // nothing? this might be a hanger ... better check it!
     if (i <= 0 && numconn > 0)
-        checkPPIDandFD(fdvar, maxfd);
+    {
+        int numFD = 0;
+        for (int j = 0; j <= maxfd; j++)
+            if (FD_ISSET(j, &fdvar))
+                numFD++;
+        checkPPIDandFD(numFD);
+    }
 
     // find the connection that has the read attempt
     if (i > 0)
@@ -1361,6 +2079,7 @@ Connection *ConnectionList::check_for_input(float time)
         coPerror("select failed");
     }
     return NULL;
+#endif
 }
 
 #ifdef HAVE_OPENSSL
@@ -1544,6 +2263,11 @@ int SSLConnection::recv_msg(Message *msg)
 /**
  * @Desc: SSL compatible send_msg function. Doesn't support Cray.
  */
+int SSLConnection::send_msg_parts(int type, const IoBuffer *parts, int nparts)
+{
+    return send_msg_copied(this, type, parts, nparts);
+}
+
 int SSLConnection::send_msg(const Message *msg)
 {
     if (IsClosed())
@@ -22,6 +22,13 @@
 #include <util/covise_list.h>
 #include "message.h"
 
+#include <deque>
+#include <map>
+
+#ifdef __linux__
+#define CO_CONNECTIONLIST_EPOLL
+#endif
+
 typedef struct ssl_st SSL;
 typedef struct ssl_ctx_st SSL_CTX;
 typedef struct ssl_method_st SSL_METHOD;
@@ -74,6 +81,10 @@ class SSLSocket;
 #define WRITE_BUFFER_SIZE 64000
 #endif
 #define READ_BUFFER_SIZE WRITE_BUFFER_SIZE
+// messages up to this size are collected by batching connections
+#define BATCH_MAX_MESSAGE_SIZE 4096
+// set in the message type of the header for compressed payloads
+#define MSG_COMPRESSED 0x40000000
 
 /***********************************************************************\ 
  **                                                                     **
@@ -112,6 +123,30 @@ class SSLSocket;
  **                                                                     **
 \***********************************************************************/
 
+// one part of a message sent with scatter-gather I/O
+struct IoBuffer
+{
+    const void *data;
+    size_t length;
+};
+
+// traffic sent through one connection
+struct ConnectionStats
+{
+    long messages_sent;
+    long bytes_sent; // including message headers
+    long write_calls; // socket writes, a flushed batch counts once
+    long messages_batched; // messages delayed in the batch queue
+    long messages_received;
+    long bytes_received; // including message headers, before decompression
+    long messages_compressed; // messages sent with a compressed payload
+    long bytes_uncompressed; // their payload before compression
+    long bytes_compressed; // their payload after compression
+    double compress_seconds; // time spent compressing and decompressing
+    long transfer_bytes; // bytes written with messages larger than WRITE_BUFFER_SIZE
+    double transfer_seconds; // time spent writing them
+};
+
 class NETEXPORT Connection
 {
 protected:
@@ -132,8 +167,34 @@ protected:
     void (*remove_socket)(int);
     int get_id();
     int *header_int;
+    char *batch_buf; // small messages not yet written, NULL if not batching
+    int batch_len;
+    bool batch_queued; // in the list of batches flushed by flush_all_batches
+    ConnectionStats stats;
+    int compress_codec; // codec for sending, COMPRESS_NONE if disabled
+    int compress_threshold; // minimum payload size for compression
+    int peer_codecs; // codecs the peer can decompress, bit (1 << (codec - 1))
+    bool peer_native_arrays; // peer announced DF_NATIVE_ARRAYS
+    void init_batch();
+    void init_compression();
+    // data format byte (plus capabilities) sent when connecting
+    static char local_dataformat();
+    // evaluate the data format byte received when connecting
+    void set_dataformat(char dataformat);
+    int recv_raw_msg(Message *msg);
+    // write a complete message, timing large ones for the statistics
+    int write_message(const IoBuffer *parts, int nparts, size_t length);
+    int send_compressed(int type, const IoBuffer *parts, int nparts, size_t length);
+    int uncompress_msg(Message *msg);
 
 public:
+    enum
+    {
+        COMPRESS_NONE = 0,
+        COMPRESS_ZLIB = 1, // slower, for wide area links
+        COMPRESS_SNAPPY = 2 // fast, only if built with snappy
+    };
+
     char convert_to; // to what format do we need to convert data?
     Connection();
     Connection(int sfd);
@@ -159,6 +220,42 @@ public:
     virtual int recv_msg_fast(Message *msg); // high-performace receive Message
     virtual int send_msg(const Message *msg); // send Message
     virtual int send_msg_fast(const Message *msg); // high-performance send Message
+    // send one message of the given type whose data is the concatenation of
+    // parts, without copying them into a contiguous buffer first
+    virtual int send_msg_parts(int type, const IoBuffer *parts, int nparts);
+    // collect small messages and write them with one system call when
+    // flushed, when full and before any connection of the process receives,
+    // waits for input or accepts - meant for processes handling all their
+    // connections in one thread
+    void set_batching(bool on);
+    bool is_batching() const
+    {
+        return batch_buf != NULL;
+    }
+    int flush_batch(); // write collected messages
+    static void flush_all_batches(); // write collected messages of all connections
+    const ConnectionStats &get_stats() const
+    {
+        return stats;
+    }
+    void reset_stats();
+    void print_stats(); // log traffic and compression ratio
+    // compress message payloads of at least threshold bytes with codec,
+    // initially set from System.Network in covise.config - disabled if the
+    // peer did not announce the codec when connecting
+    bool set_compression(int codec, int threshold);
+    int get_compression() const
+    {
+        return compress_codec;
+    }
+    // codecs this process is able to decompress
+    static int available_codecs();
+    // peer reads int/float arrays of objects in the byte order of this host,
+    // false for peers not announcing it when connecting
+    bool accepts_native_arrays() const
+    {
+        return peer_native_arrays;
+    }
     int check_for_input(float time = 0.0); // issue select call and return TRUE if there is an event or 0L otherwise
     int get_port() // give port number
     {
@@ -315,6 +412,20 @@ class NETEXPORT ConnectionList // list connections in a way that select can be u
     fd_set fdvar; // field for select call
     int maxfd; // maximum socket id
     ServerConnection *open_sock; // socket for listening
+    bool batching; // batch messages of all connections
+#ifdef CO_CONNECTIONLIST_EPOLL
+    // edge triggered epoll: connections are queued when data arrives and
+    // stay in the ready queue until their input is drained
+    int epfd; // epoll instance
+    int numfds; // sockets registered with epfd
+    std::deque<Connection *> ready; // connections with pending input
+    std::map<Connection *, int> readyState; // READY_* flags per connection
+    void init_epoll();
+    void watch(Connection *c, bool edge);
+    void queue_ready(Connection *c, bool hangup);
+    Connection *next_ready();
+    Connection *wait_ready(float time, bool *accepted);
+#endif
 public:
     ConnectionList(); // constructor
     ConnectionList(ServerConnection *); // constructor (listens always at port)
@@ -332,6 +443,10 @@ public:
     // issue select call and return a
     Connection *check_for_input(float time = 0.0);
     // connection if there is an event or 0L otherwise
+    // batch small messages of all connections, they are flushed
+    // whenever check_for_input runs out of input
+    void set_batching(bool on);
+    void flush_batches();
     void reset() //
     {
         connlist->reset();
@@ -366,6 +481,7 @@ public:
     int send(const void *buf, unsigned nbyte); // send into socket
     int recv_msg(Message *msg); // receive Message
     int send_msg(const Message *msg); // send Message
+    int send_msg_parts(int type, const IoBuffer *parts, int nparts); // copies parts
     const char *readLine(); // Read line
     int get_id(void (*remove_func)(int));
     int get_id();
@@ -32,6 +32,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef CRAY
@@ -869,6 +870,78 @@ int Socket::write(const void *buf, unsigned nbyte)
     return no_of_bytes;
 }
 
+int Socket::write_parts(const IoBuffer *bufs, int count)
+{
+    int written = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const char *data = (const char *)bufs[i].data;
+        size_t rest = bufs[i].length;
+        while (rest > 0)
+        {
+            int ret = write(data, (unsigned)rest);
+            if (ret < 0)
+                return ret;
+            data += ret;
+            rest -= ret;
+            written += ret;
+        }
+    }
+    return written;
+}
+
+int Socket::writev(const IoBuffer *bufs, int count)
+{
+#ifdef _WIN32
+    return write_parts(bufs, count);
+#else
+    const int MAX_IOV = 64;
+    struct iovec iov[MAX_IOV];
+    int written = 0;
+    int first = 0; // first part not completely written
+    size_t done = 0; // bytes of that part already written
+    char tmp_str[255];
+
+    while (first < count)
+    {
+        int n = 0;
+        for (int i = first; i < count && n < MAX_IOV; i++, n++)
+        {
+            iov[n].iov_base = (char *)bufs[i].data + (i == first ? done : 0);
+            iov[n].iov_len = bufs[i].length - (i == first ? done : 0);
+        }
+
+        ssize_t no_of_bytes;
+        do
+        {
+            errno = 0;
+            no_of_bytes = ::writev(sock_id, iov, n);
+        } while ((no_of_bytes < 0) && ((errno == EAGAIN) || (errno == EINTR)));
+        if (no_of_bytes < 0)
+        {
+            if (errno == EPIPE || errno == ECONNRESET)
+                return COVISE_SOCKET_INVALID;
+            sprintf(tmp_str, "Socket writev error = %d: %s", errno, coStrerror(errno));
+            LOGERROR(tmp_str);
+            fprintf(stderr, "error writing on socket to %s:%d: %s\n", host->getAddress(), port, coStrerror(getErrno()));
+            return COVISE_SOCKET_INVALID;
+        }
+        written += (int)no_of_bytes;
+
+        // skip completely written parts, partial writes continue within a part
+        size_t rest = no_of_bytes;
+        while (first < count && rest >= bufs[first].length - done)
+        {
+            rest -= bufs[first].length - done;
+            done = 0;
+            first++;
+        }
+        done += rest;
+    }
+    return written;
+#endif
+}
+
 #ifdef CRAY
 struct iosw wrstat;
 
@@ -97,6 +97,11 @@ class Host;
 const char DF_NONE = 0;
 const char DF_IEEE = 1;
 const char DF_CRAY = 2;
+// decompression capabilities, or'ed to the data format when connecting
+const char DF_FORMAT_MASK = 0x0f;
+const char DF_COMPRESS_SHIFT = 4;
+// int/float arrays of objects may be sent in the byte order of the sender
+const char DF_NATIVE_ARRAYS = 0x40;
 const int COVISE_SOCKET_INVALID = -2;
 
 #if defined(CRAY) && !defined(_WIN32)
@@ -176,6 +181,8 @@ public:
     int setNonBlocking(bool on);
     //int read_non_blocking(void *buf, unsigned nbyte);
     virtual int write(const void *buf, unsigned nbyte);
+    // write all parts, gathered into as few system calls as possible
+    virtual int writev(const IoBuffer *bufs, int count);
 #ifdef CRAY
     int writea(const void *buf, unsigned nbyte);
 #endif
@@ -207,6 +214,10 @@ public:
     };
 #endif
     static const char *coStrerror(int err);
+
+protected:
+    // writev for sockets that cannot pass their buffers to the system directly
+    int write_parts(const IoBuffer *bufs, int count);
 };
 
 #ifdef HAVE_OPENSSL
@@ -225,6 +236,10 @@ public:
     //int accept(SSLSocket* sock);
 
     int write(const void *buf, unsigned int nbyte);
+    int writev(const IoBuffer *bufs, int count)
+    {
+        return write_parts(bufs, count);
+    }
     int connect(sockaddr_in addr /*, int retries, double timeout*/);
 
     SSLServerConnection *spawnConnection(SSLConnection::PasswordCallback *cb, void *userData);
@@ -246,6 +261,10 @@ public:
     ~UDPSocket();
     int read(void *buf, unsigned nbyte);
     int write(const void *buf, unsigned nbyte);
+    int writev(const IoBuffer *bufs, int count)
+    {
+        return write_parts(bufs, count);
+    }
 };
 
 #ifdef HAVEMULTICAST
@@ -258,6 +277,10 @@ public:
     ~MulticastSocket();
     int read(void *buf, unsigned nbyte);
     int write(const void *buf, unsigned nbyte);
+    int writev(const IoBuffer *bufs, int count)
+    {
+        return write_parts(bufs, count);
+    }
     int get_ttl()
     {
         return ttl;
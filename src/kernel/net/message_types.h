@@ -198,7 +198,11 @@ enum covise_msg_type
     COVISE_MESSAGE_CRB_EXEC_MEMCHECK, // 131
     COVISE_MESSAGE_SSLDAEMON, // 132
     COVISE_MESSAGE_VISENSO_UI, // 133
-    COVISE_MESSAGE_LAST_DUMMY_MESSAGE // 134
+    COVISE_MESSAGE_ASK_FOR_LOCAL_OBJECT, // 134
+    COVISE_MESSAGE_LOCAL_OBJECT_FOLLOWS, // 135
+    COVISE_MESSAGE_CTRL_OBJECT_SIZE, // 136
+    COVISE_MESSAGE_OBJECT_ACCESSED, // 137
+    COVISE_MESSAGE_LAST_DUMMY_MESSAGE // 138
 };
 
 #ifdef DEFINE_MSG_TYPES
@@ -337,6 +341,10 @@ NETEXPORT const char *covise_msg_types_array[] = {
     "CRB_EXEC_MEMCHECK", // 131
     "SSLDAEMON", // 132
     "VISENSO_UI", // 133
+    "ASK_FOR_LOCAL_OBJECT", // 134
+    "LOCAL_OBJECT_FOLLOWS", // 135
+    "CTRL_OBJECT_SIZE", // 136
+    "OBJECT_ACCESSED", // 137
     "GIVE_ME_A_NAME",
     "GIVE_ME_A_NAME",
     "GIVE_ME_A_NAME",
@@ -8,6 +8,7 @@
 #include <covise/covise.h>
 #include <util/unixcompat.h>
 #include "covise_shm.h"
+#include "covise_shmdir.h"
 #include <config/CoviseConfig.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -115,6 +116,26 @@ size_t ShmConfig::getMallocSize()
     return the()->minSegSize;
 }
 
+bool ShmConfig::useSlabs()
+{
+    return the()->slabs;
+}
+
+bool ShmConfig::useLocalTransfer()
+{
+    return the()->localTransfer;
+}
+
+bool ShmConfig::useObjectDirectory()
+{
+    return the()->objectDirectory;
+}
+
+int ShmConfig::getObjectDirectorySlots()
+{
+    return the()->objectDirectorySlots;
+}
+
 ShmConfig::ShmConfig()
 {
 // set minimal allocation sizes in bytes
@@ -128,6 +149,14 @@ ShmConfig::ShmConfig()
     {
         minSegSize = minSegSizeConfig;
     }
+    slabs = coCoviseConfig::isOn("System.ShmSlabs", true);
+    localTransfer = coCoviseConfig::isOn("System.LocalObjectTransfer", true);
+    objectDirectory = coCoviseConfig::isOn("System.ShmDirectory", true);
+    // the directory lives at the start of the first segment, keep it well below its size
+    int slots = coCoviseConfig::getInt("slots", "System.ShmDirectory", coShmDirectory::DEFAULT_SLOTS);
+    objectDirectorySlots = 1024;
+    while (objectDirectorySlots < slots && objectDirectorySlots < (1 << 18))
+        objectDirectorySlots *= 2;
 
 #ifdef SHARED_MEMORY
     bool haveShmConfig = false;
@@ -860,6 +889,136 @@ void SharedMemory::get_shmlist(int *ptr)
     ptr[0] = i / 2;
 }
 
+ForeignSharedMemory::ForeignSharedMemory()
+{
+    num = 0;
+    keys = new int[MAX_NO_SHM];
+    sizes = new shmSizeType[MAX_NO_SHM];
+    data = new char *[MAX_NO_SHM];
+    for (int i = 0; i < MAX_NO_SHM; i++)
+    {
+        keys[i] = 0;
+        sizes[i] = 0;
+        data[i] = NULL;
+    }
+}
+
+ForeignSharedMemory::~ForeignSharedMemory()
+{
+    detach_all();
+    delete[] keys;
+    delete[] sizes;
+    delete[] data;
+}
+
+void ForeignSharedMemory::unmap(int i)
+{
+    if (!data[i])
+        return;
+#ifdef SHARED_MEMORY
+#ifdef SYSV_SHMEM
+    if (!use_posix)
+        shmdt(data[i]);
+#endif
+#if defined(POSIX_SHMEM)
+    if (use_posix)
+        munmap(data[i], sizes[i] + 2 * sizeof(int));
+#endif
+#else
+    UnmapViewOfFile(data[i]);
+#endif
+    data[i] = NULL;
+}
+
+void ForeignSharedMemory::detach_all()
+{
+    for (int i = 0; i < num; i++)
+        unmap(i);
+    num = 0;
+}
+
+bool ForeignSharedMemory::attach(int seq_no, int key, shmSizeType size)
+{
+    if (seq_no < 1 || seq_no > MAX_NO_SHM)
+        return false;
+    int i = seq_no - 1;
+    if (data[i] && keys[i] == key && sizes[i] == size)
+        return true;
+    unmap(i);
+
+    char *ptr = NULL;
+    size_t len = size + 2 * sizeof(int); // seq_nr and key
+#ifdef SHARED_MEMORY
+#ifdef SYSV_SHMEM
+    if (!use_posix)
+    {
+        int id = shmget(key, len, 0);
+        if (id < 0)
+            return false;
+        ptr = (char *)shmat(id, NULL, SHM_RDONLY);
+        if (ptr == (char *)-1)
+            return false;
+    }
+#endif
+#if defined(POSIX_SHMEM)
+    if (use_posix)
+    {
+        char tmp_str[255];
+        sprintf(tmp_str, "/covise_shm_%0x", key);
+        int fd = shm_open(tmp_str, O_RDONLY, 0);
+        if (fd == -1)
+            return false;
+        ptr = (char *)mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED)
+            return false;
+    }
+#endif
+#else
+    std::stringstream str;
+    str << "Local\\covise_shm_" << key;
+    HANDLE filemap = OpenFileMapping(FILE_MAP_READ, FALSE, str.str().c_str());
+    if (!filemap)
+        return false;
+    ptr = (char *)MapViewOfFile(filemap, FILE_MAP_READ, 0, 0, len);
+    CloseHandle(filemap);
+    if (!ptr)
+        return false;
+#endif
+
+    keys[i] = key;
+    sizes[i] = size;
+    data[i] = ptr;
+    if (seq_no > num)
+        num = seq_no;
+    // same key on another host or a recycled key: header does not match
+    if (((int *)ptr)[0] != seq_no || ((int *)ptr)[1] != key)
+    {
+        unmap(i);
+        return false;
+    }
+    return true;
+}
+
+bool ForeignSharedMemory::attach_list(const int *shmlist)
+{
+    for (int i = 0; i < shmlist[0]; i++)
+    {
+        if (!attach(i + 1, shmlist[1 + 2 * i], (shmSizeType)shmlist[2 + 2 * i]))
+            return false;
+    }
+    return true;
+}
+
+const void *ForeignSharedMemory::get_pointer(int seq_no, shmSizeType offset, shmSizeType len) const
+{
+    if (seq_no < 1 || seq_no > num || !data[seq_no - 1])
+        return NULL;
+    if (offset > sizes[seq_no - 1] || len > sizes[seq_no - 1] - offset)
+        return NULL;
+    return &data[seq_no - 1][2 * sizeof(int) + offset];
+}
+
 void *Malloc_tmp::large_new(long size)
 {
 #if defined(CRAY) || defined(_WIN32) || defined(_SX)
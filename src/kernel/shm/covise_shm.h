@@ -285,6 +285,29 @@ public:
         return global_seq_no;
     }
 };
+// read-only view of the segments of another data manager on the same host,
+// these are not registered with shmlist/shm_array and failures are reported
+// instead of waiting for the segment to appear
+class SHMEXPORT ForeignSharedMemory
+{
+    int num;
+    int *keys;
+    shmSizeType *sizes;
+    char **data;
+    void unmap(int i);
+
+public:
+    ForeignSharedMemory();
+    ~ForeignSharedMemory();
+    // map segment seq_no (1-based) with usable size; checks the segment header
+    bool attach(int seq_no, int key, shmSizeType size);
+    // attach all segments of a list as returned by SharedMemory::get_shmlist
+    bool attach_list(const int *shmlist);
+    void detach_all();
+    // NULL if seq_no/offset are outside of the mapped segments
+    const void *get_pointer(int seq_no, shmSizeType offset, shmSizeType len = 0) const;
+};
+
 // minimal allocation size for SHM segments - 64 MB
 
 class SHMEXPORT ShmConfig
@@ -293,11 +316,24 @@ private:
     ShmConfig();
     ~ShmConfig();
     size_t minSegSize;
+    bool slabs;
+    bool localTransfer;
+    bool objectDirectory;
+    int objectDirectorySlots;
     static ShmConfig *theShmConfig;
 
 public:
     static ShmConfig *the();
     static size_t getMallocSize();
+    // serve small blocks from size class slabs (System.ShmSlabs)
+    static bool useSlabs();
+    // copy objects between data managers on the same host directly from
+    // the sender's segments (System.LocalObjectTransfer)
+    static bool useLocalTransfer();
+    // let modules look up object names in shared memory (System.ShmDirectory)
+    static bool useObjectDirectory();
+    // number of entries of this directory, a power of two (System.ShmDirectory "slots")
+    static int getObjectDirectorySlots();
 };
 
 const int MAX_NO_SHM = 1000;
@@ -0,0 +1,365 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include <covise/covise.h>
+#include "covise_shmdir.h"
+#include "covise_shmslab.h"
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+using namespace covise;
+
+namespace covise
+{
+
+// marks the directory as initialized by a data manager
+static const int DIR_MAGIC = 0x4f444952;
+// hash values of unused slots, real hashes are mapped above
+static const unsigned DIR_EMPTY = 0;
+static const unsigned DIR_TOMBSTONE = 1;
+// a reader gives up on a slot which is rewritten all the time
+static const int DIR_MAX_RETRIES = 100;
+
+struct coShmDirSlot
+{
+    // odd while the data manager changes the slot
+    std::atomic<unsigned> seq;
+    std::atomic<unsigned> hash;
+    int shm_seq_no;
+    shmSizeType offset;
+    int type;
+    unsigned version;
+    char name[coShmDirectory::MAX_NAME_LEN + 1];
+};
+
+// lives in segment 1 behind the slab control block and is shared by all processes
+struct coShmDirControl
+{
+    int magic;
+    int enabled;
+    int numSlots;
+    std::atomic<unsigned> generation;
+    std::atomic<int> numEntries;
+    std::atomic<int> numTombstones;
+    // followed by numSlots coShmDirSlot
+};
+
+static shmSizeType aligned(shmSizeType size)
+{
+    if (size % SIZEOF_ALIGNMENT)
+        size += SIZEOF_ALIGNMENT - size % SIZEOF_ALIGNMENT;
+    return size;
+}
+
+static coShmDirSlot *slotsOf(coShmDirControl *c)
+{
+    return (coShmDirSlot *)((char *)c + aligned(sizeof(coShmDirControl)));
+}
+
+// inserting stops at this fill level (entries and tombstones)
+static int maxFill(int numSlots)
+{
+    return numSlots / 4 * 3;
+}
+
+// tombstones are only dropped when they free this many slots, so that rehashing is rare
+static int minTombstones(int numSlots)
+{
+    return numSlots / 8;
+}
+}
+
+coShmDirectory *coShmDirectory::theDirectory = NULL;
+
+coShmDirectory::coShmDirectory(coShmDirControl *c)
+    : control(c)
+    , slots(slotsOf(c))
+    , mask(c->numSlots - 1)
+{
+}
+
+coShmDirectory::~coShmDirectory()
+{
+}
+
+shmSizeType coShmDirectory::controlSize(int numSlots)
+{
+    return aligned(aligned(sizeof(coShmDirControl)) + numSlots * sizeof(coShmDirSlot));
+}
+
+coShmDirectory *coShmDirectory::the()
+{
+    if (theDirectory)
+        return theDirectory->isEnabled() ? theDirectory : NULL;
+
+    SharedMemory *shm = get_shared_memory();
+    if (!shm || SharedMemory::num_attached() < 1)
+        return NULL;
+
+    coShmDirControl *c = (coShmDirControl *)((char *)shm->get_pointer(1) + coShmSlabAlloc::controlSize());
+    if (c->magic != DIR_MAGIC || c->numSlots <= 0 || (c->numSlots & (c->numSlots - 1)))
+        return NULL;
+    theDirectory = new coShmDirectory(c);
+    return theDirectory->isEnabled() ? theDirectory : NULL;
+}
+
+coShmDirectory *coShmDirectory::create(void *address, int numSlots, bool enabled)
+{
+    coShmDirControl *c = (coShmDirControl *)address;
+    if (!theDirectory || theDirectory->control != c)
+    {
+        c = new (address) coShmDirControl;
+        c->numSlots = numSlots;
+        c->generation.store(0);
+        coShmDirSlot *slots = slotsOf(c);
+        for (int i = 0; i < numSlots; i++)
+        {
+            new (&slots[i]) coShmDirSlot;
+            slots[i].seq.store(0);
+            slots[i].hash.store(DIR_EMPTY);
+        }
+    }
+    c->magic = DIR_MAGIC;
+    c->enabled = enabled ? 1 : 0;
+    if (!theDirectory)
+        theDirectory = new coShmDirectory(c);
+    theDirectory->control = c;
+    theDirectory->slots = slotsOf(c);
+    theDirectory->mask = c->numSlots - 1;
+    theDirectory->clear();
+    return theDirectory;
+}
+
+bool coShmDirectory::isEnabled() const
+{
+    return control->enabled != 0;
+}
+
+int coShmDirectory::numSlots() const
+{
+    return mask + 1;
+}
+
+unsigned coShmDirectory::hash(const char *name, size_t *len)
+{
+    // FNV-1a
+    unsigned h = 2166136261u;
+    const char *p = name;
+    for (; *p; p++)
+    {
+        h ^= (unsigned char)*p;
+        h *= 16777619u;
+    }
+    *len = p - name;
+    if (h <= DIR_TOMBSTONE)
+        h += 2;
+    return h;
+}
+
+bool coShmDirectory::lookup(const char *name, int *shm_seq_no, shmSizeType *offset, int *type, unsigned *version) const
+{
+    size_t len = 0;
+    unsigned h = hash(name, &len);
+    if (len > MAX_NAME_LEN)
+        return false;
+
+    for (unsigned i = 0; i <= mask; i++)
+    {
+        const coShmDirSlot &slot = slots[(h + i) & mask];
+        for (int retry = 0;; retry++)
+        {
+            if (retry >= DIR_MAX_RETRIES)
+                return false;
+            unsigned seq = slot.seq.load(std::memory_order_acquire);
+            if (seq & 1)
+                continue;
+
+            unsigned slotHash = slot.hash.load(std::memory_order_relaxed);
+            int no = slot.shm_seq_no;
+            shmSizeType off = slot.offset;
+            int t = slot.type;
+            unsigned v = slot.version;
+            bool match = slotHash == h && strncmp(slot.name, name, MAX_NAME_LEN + 1) == 0;
+
+            // the copy is only valid if the slot has not been changed meanwhile
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq)
+                continue;
+
+            if (slotHash == DIR_EMPTY)
+                return false;
+            if (!match)
+                break;
+            *shm_seq_no = no;
+            *offset = off;
+            if (type)
+                *type = t;
+            if (version)
+                *version = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+int coShmDirectory::find(const char *name, unsigned h) const
+{
+    for (unsigned i = 0; i <= mask; i++)
+    {
+        int s = (h + i) & mask;
+        const coShmDirSlot &slot = slots[s];
+        unsigned slotHash = slot.hash.load(std::memory_order_relaxed);
+        if (slotHash == DIR_EMPTY)
+            return -1;
+        if (slotHash == h && strcmp(slot.name, name) == 0)
+            return s;
+    }
+    return -1;
+}
+
+void coShmDirectory::writeSlot(int s, unsigned h, const char *name, size_t len, int shm_seq_no, shmSizeType offset, int type)
+{
+    coShmDirSlot &slot = slots[s];
+    unsigned seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.hash.store(h, std::memory_order_relaxed);
+    if (name)
+    {
+        slot.shm_seq_no = shm_seq_no;
+        slot.offset = offset;
+        slot.type = type;
+        slot.version = control->generation.fetch_add(1, std::memory_order_relaxed) + 1;
+        memcpy(slot.name, name, len + 1);
+    }
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool coShmDirectory::insert(const char *name, int shm_seq_no, shmSizeType offset, int type)
+{
+    if (!isEnabled() || !name)
+        return false;
+    size_t len = 0;
+    unsigned h = hash(name, &len);
+    if (len > MAX_NAME_LEN)
+        return false;
+
+    int s = find(name, h);
+    if (s < 0)
+    {
+        int fill = maxFill(numSlots());
+        if (control->numEntries + control->numTombstones >= fill)
+        {
+            if (control->numTombstones < minTombstones(numSlots()))
+                return false;
+            rehash();
+            if (control->numEntries >= fill)
+                return false;
+        }
+
+        // name is not entered, so the first reusable slot will do
+        for (unsigned i = 0; i <= mask; i++)
+        {
+            s = (h + i) & mask;
+            unsigned slotHash = slots[s].hash.load(std::memory_order_relaxed);
+            if (slotHash == DIR_TOMBSTONE)
+                control->numTombstones--;
+            if (slotHash <= DIR_TOMBSTONE)
+                break;
+        }
+        control->numEntries++;
+    }
+    writeSlot(s, h, name, len, shm_seq_no, offset, type);
+    return true;
+}
+
+bool coShmDirectory::remove(const char *name)
+{
+    if (!isEnabled() || !name)
+        return false;
+    size_t len = 0;
+    unsigned h = hash(name, &len);
+    if (len > MAX_NAME_LEN)
+        return false;
+    int s = find(name, h);
+    if (s < 0)
+        return false;
+    control->numEntries--;
+
+    // a slot in front of an empty one ends no probe sequence
+    int next = (s + 1) & mask;
+    if (slots[next].hash.load(std::memory_order_relaxed) != DIR_EMPTY)
+    {
+        writeSlot(s, DIR_TOMBSTONE, NULL, 0, 0, 0, 0);
+        control->numTombstones++;
+        return true;
+    }
+    writeSlot(s, DIR_EMPTY, NULL, 0, 0, 0, 0);
+    for (int prev = (s - 1) & mask;
+         slots[prev].hash.load(std::memory_order_relaxed) == DIR_TOMBSTONE;
+         prev = (prev - 1) & mask)
+    {
+        writeSlot(prev, DIR_EMPTY, NULL, 0, 0, 0, 0);
+        control->numTombstones--;
+    }
+    return true;
+}
+
+void coShmDirectory::clear()
+{
+    for (int s = 0; s <= (int)mask; s++)
+    {
+        if (slots[s].hash.load(std::memory_order_relaxed) != DIR_EMPTY)
+            writeSlot(s, DIR_EMPTY, NULL, 0, 0, 0, 0);
+    }
+    control->numEntries.store(0);
+    control->numTombstones.store(0);
+}
+
+void coShmDirectory::rehash()
+{
+    // readers may miss entries meanwhile and ask the data manager instead
+    struct Entry
+    {
+        std::string name;
+        int shm_seq_no;
+        shmSizeType offset;
+        int type;
+    };
+    std::vector<Entry> live;
+    live.reserve(control->numEntries);
+    for (int s = 0; s <= (int)mask; s++)
+    {
+        const coShmDirSlot &slot = slots[s];
+        if (slot.hash.load(std::memory_order_relaxed) > DIR_TOMBSTONE)
+        {
+            Entry e;
+            e.name = slot.name;
+            e.shm_seq_no = slot.shm_seq_no;
+            e.offset = slot.offset;
+            e.type = slot.type;
+            live.push_back(e);
+        }
+    }
+    clear();
+    for (size_t i = 0; i < live.size(); i++)
+        insert(live[i].name.c_str(), live[i].shm_seq_no, live[i].offset, live[i].type);
+}
+
+long coShmDirectory::numEntries() const
+{
+    return control->numEntries.load(std::memory_order_relaxed);
+}
+
+long coShmDirectory::numTombstones() const
+{
+    return control->numTombstones.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,94 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COVISE_SHMDIR_H
+#define COVISE_SHMDIR_H
+
+#include "covise_shm.h"
+
+/***********************************************************************\
+ **                                                                     **
+ **   Object directory in shared memory                                 **
+ **                                                                     **
+ **   Description  : Hash table of object name -> (shm_seq_no, offset,  **
+ **                  type, version) with open addressing, placed in     **
+ **                  segment 1 behind the control block of the small    **
+ **                  block allocator. It is written by the data manager **
+ **                  only, whenever it inserts or removes an object,    **
+ **                  and read lock-free by application processes: each  **
+ **                  slot is guarded by a sequence counter, a reader    **
+ **                  retries while the counter is odd or has changed.   **
+ **                  A lookup which fails for whatever reason (name too **
+ **                  long, directory full, object on a remote host)     **
+ **                  falls back to the GET_OBJECT message. The number   **
+ **                  of slots is System.ShmDirectory "slots".           **
+ **                                                                     **
+ **   Classes      : coShmDirectory                                     **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+struct coShmDirControl;
+struct coShmDirSlot;
+
+class SHMEXPORT coShmDirectory
+{
+public:
+    enum
+    {
+        DEFAULT_SLOTS = 32768,
+        MAX_NAME_LEN = 103 // longer names are only known to the data manager
+    };
+
+    // bytes to reserve for a directory of numSlots (power of two) entries, behind the slab control block
+    static shmSizeType controlSize(int numSlots);
+
+    // application side: directory of the attached segment 1,
+    // NULL if the data manager does not provide it
+    static coShmDirectory *the();
+
+    // data manager side: (re-)initialize the directory of numSlots entries at address
+    static coShmDirectory *create(void *address, int numSlots, bool enabled);
+
+    bool isEnabled() const;
+
+    // application side: false if name is unknown to the directory
+    bool lookup(const char *name, int *shm_seq_no, shmSizeType *offset,
+                int *type = NULL, unsigned *version = NULL) const;
+
+    // data manager side: false if the object could not be entered
+    bool insert(const char *name, int shm_seq_no, shmSizeType offset, int type);
+    // data manager side: false if name was not entered
+    bool remove(const char *name);
+    // data manager side: forget all entries (new desk)
+    void clear();
+    // data manager side: re-enter live entries, dropping the tombstones
+    void rehash();
+
+    int numSlots() const;
+
+    // statistics
+    long numEntries() const;
+    long numTombstones() const;
+
+private:
+    coShmDirectory(coShmDirControl *c);
+    ~coShmDirectory();
+    static unsigned hash(const char *name, size_t *len);
+    // slot of name or -1, dmgr only
+    int find(const char *name, unsigned h) const;
+    void writeSlot(int slot, unsigned h, const char *name, size_t len, int shm_seq_no, shmSizeType offset, int type);
+
+    coShmDirControl *control;
+    coShmDirSlot *slots; // behind control
+    unsigned mask; // number of slots - 1
+    static coShmDirectory *theDirectory;
+};
+}
+#endif
@@ -0,0 +1,374 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include <covise/covise.h>
+#include "covise_shmslab.h"
+
+#include <atomic>
+#include <new>
+#include <stdint.h>
+
+using namespace covise;
+
+namespace covise
+{
+
+// marks the control block as initialized by a data manager
+static const int SLAB_MAGIC = 0x534c4142;
+// first int of a block sitting on a free list (instead of a type)
+static const int SLAB_FREE_MARK = 0x7e5ab1f0;
+// blocks per slab are addressed with the lower bits of a block number
+static const int SLAB_BLOCK_BITS = 12;
+
+static const shmSizeType slabClassSize[coShmSlabAlloc::NUM_CLASSES] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096
+};
+
+struct coShmSlabEntry
+{
+    int shm_seq_no;
+    shmSizeType offset;
+    int cls;
+};
+
+// lives at the start of segment 1 and is shared by all processes
+struct coShmSlabControl
+{
+    int magic;
+    int enabled;
+    // (tag << 32) | (block number + 1), 0 for an empty list
+    std::atomic<uint64_t> heads[coShmSlabAlloc::NUM_CLASSES];
+    std::atomic<int> numSlabs;
+    std::atomic<long> fastAllocs;
+    coShmSlabEntry slabs[coShmSlabAlloc::MAX_SLABS];
+};
+}
+
+coShmSlabAlloc *coShmSlabAlloc::theSlabs = NULL;
+
+coShmSlabAlloc::coShmSlabAlloc(coShmSlabControl *c)
+    : control(c)
+{
+}
+
+coShmSlabAlloc::~coShmSlabAlloc()
+{
+}
+
+shmSizeType coShmSlabAlloc::controlSize()
+{
+    shmSizeType size = sizeof(coShmSlabControl);
+    if (size % SIZEOF_ALIGNMENT)
+        size += SIZEOF_ALIGNMENT - size % SIZEOF_ALIGNMENT;
+    return size;
+}
+
+coShmSlabAlloc *coShmSlabAlloc::the()
+{
+    if (theSlabs)
+        return theSlabs->isEnabled() ? theSlabs : NULL;
+
+    SharedMemory *shm = get_shared_memory();
+    if (!shm || SharedMemory::num_attached() < 1)
+        return NULL;
+
+    coShmSlabControl *c = (coShmSlabControl *)shm->get_pointer(1);
+    if (c->magic != SLAB_MAGIC)
+        return NULL;
+    theSlabs = new coShmSlabAlloc(c);
+    return theSlabs->isEnabled() ? theSlabs : NULL;
+}
+
+coShmSlabAlloc *coShmSlabAlloc::create(void *address, bool enabled)
+{
+    coShmSlabControl *c = new (address) coShmSlabControl;
+    c->magic = SLAB_MAGIC;
+    c->enabled = enabled ? 1 : 0;
+    if (!theSlabs)
+        theSlabs = new coShmSlabAlloc(c);
+    theSlabs->control = c;
+    theSlabs->reset();
+    return theSlabs;
+}
+
+bool coShmSlabAlloc::isEnabled() const
+{
+    return control->enabled != 0;
+}
+
+int coShmSlabAlloc::sizeClass(shmSizeType size)
+{
+    if (size > MAX_BLOCK_SIZE)
+        return -1;
+    for (int cls = 0; cls < NUM_CLASSES; cls++)
+    {
+        if (size <= slabClassSize[cls])
+            return cls;
+    }
+    return -1;
+}
+
+shmSizeType coShmSlabAlloc::classSize(int cls)
+{
+    return slabClassSize[cls];
+}
+
+shmSizeType coShmSlabAlloc::allocSize(int type, shmSizeType msize)
+{
+    shmSizeType size = sizeof(int); // all shm vars start with type
+
+    switch (type)
+    {
+    case FLOATSHM:
+        size += sizeof(float);
+        break;
+    case DOUBLESHM:
+        size += sizeof(double);
+        break;
+    case CHARSHM:
+        size += sizeof(char);
+        break;
+    case SHORTSHM:
+        size += sizeof(short);
+        break;
+    case LONGSHM:
+        size += sizeof(long);
+        break;
+    case INTSHM:
+        size += sizeof(int);
+        break;
+    case FLOATSHMARRAY:
+        size += msize * sizeof(float) + 2 * sizeof(int);
+        break;
+    case DOUBLESHMARRAY:
+        size += msize * sizeof(double) + 2 * sizeof(int);
+        break;
+
+    // All these add 2 ints: one for length and one for safety value.
+    // the additional third int is for alignment whwnwver this may be doubtful
+    case STRINGSHMARRAY:
+        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+        break;
+    case CHARSHMARRAY:
+        size += msize * sizeof(char) + 3 * sizeof(int);
+        break;
+    case SHORTSHMARRAY:
+        size += msize * sizeof(short) + 3 * sizeof(int);
+        break;
+    case LONGSHMARRAY:
+        size += msize * sizeof(long) + 3 * sizeof(int);
+        break;
+    case INTSHMARRAY:
+        size += msize * sizeof(int) + 2 * sizeof(int);
+        break;
+    case SHMPTRARRAY:
+        size += msize * 2 * sizeof(int) + 2 * sizeof(int);
+        break;
+    default:
+        return 0;
+    };
+
+    // only use aligned memory sizes
+    int alignRest = size % SIZEOF_ALIGNMENT;
+    if (alignRest)
+        size += (SIZEOF_ALIGNMENT - alignRest);
+    return size;
+}
+
+void coShmSlabAlloc::initItem(void *ptr, int type, shmSizeType msize, shmSizeType size)
+{
+    int *iptr = (int *)ptr;
+    int intSize = size / sizeof(int);
+
+    iptr[0] = type;
+    switch (type)
+    {
+    // fill memory with NULL
+    case SHMPTRARRAY:
+        iptr[1] = (int)msize;
+        for (unsigned int ui = 2; ui < (2 * msize) + 2; ui++)
+        {
+            iptr[ui] = 0;
+        }
+        iptr[intSize - 1] = type;
+        break;
+
+    case FLOATSHMARRAY:
+    case DOUBLESHMARRAY:
+    case STRINGSHMARRAY:
+    case CHARSHMARRAY:
+    case SHORTSHMARRAY:
+    case LONGSHMARRAY:
+    case INTSHMARRAY:
+        iptr[1] = (int)msize;
+        iptr[intSize - 1] = type;
+        break;
+    };
+}
+
+char *coShmSlabAlloc::blockAddress(unsigned block, int *shm_seq_no, shmSizeType *offset)
+{
+    const coShmSlabEntry &slab = control->slabs[block >> SLAB_BLOCK_BITS];
+    *shm_seq_no = slab.shm_seq_no;
+    *offset = slab.offset + (block & ((1 << SLAB_BLOCK_BITS) - 1)) * slabClassSize[slab.cls];
+    return (char *)get_shared_memory()->get_pointer(*shm_seq_no) + *offset;
+}
+
+void coShmSlabAlloc::push(unsigned block)
+{
+    int seq_no;
+    shmSizeType offset;
+    int *iptr = (int *)blockAddress(block, &seq_no, &offset);
+    std::atomic<uint64_t> &head = control->heads[control->slabs[block >> SLAB_BLOCK_BITS].cls];
+
+    iptr[0] = SLAB_FREE_MARK;
+    uint64_t old = head.load(std::memory_order_relaxed);
+    uint64_t top = 0;
+    do
+    {
+        iptr[1] = (int)(old & 0xffffffff);
+        top = (((old >> 32) + 1) << 32) | (uint64_t)(block + 1);
+    } while (!head.compare_exchange_weak(old, top, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool coShmSlabAlloc::popBlock(int cls, unsigned *block)
+{
+    std::atomic<uint64_t> &head = control->heads[cls];
+    uint64_t old = head.load(std::memory_order_acquire);
+    for (;;)
+    {
+        unsigned top = (unsigned)(old & 0xffffffff);
+        if (top == 0)
+            return false;
+
+        // segments are announced by NEW_SDS, which may not have been
+        // processed yet - leave such blocks to the message path
+        const coShmSlabEntry &slab = control->slabs[(top - 1) >> SLAB_BLOCK_BITS];
+        if (slab.shm_seq_no > SharedMemory::num_attached())
+            return false;
+
+        int seq_no;
+        shmSizeType offset;
+        volatile int *iptr = (volatile int *)blockAddress(top - 1, &seq_no, &offset);
+        uint64_t next = (((old >> 32) + 1) << 32) | (uint64_t)(unsigned)iptr[1];
+        if (head.compare_exchange_weak(old, next, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            *block = top - 1;
+            return true;
+        }
+    }
+}
+
+bool coShmSlabAlloc::pop(int cls, int *shm_seq_no, shmSizeType *offset)
+{
+    unsigned block = 0;
+    if (!popBlock(cls, &block))
+        return false;
+    int *iptr = (int *)blockAddress(block, shm_seq_no, offset);
+    iptr[0] = NONE;
+    return true;
+}
+
+bool coShmSlabAlloc::mallocList(const data_type *dt, const long *count, int no, int *result)
+{
+    unsigned *blocks = new unsigned[no];
+    int got = 0;
+    for (; got < no; got++)
+    {
+        shmSizeType size = allocSize((int)dt[got], (shmSizeType)count[got]);
+        int cls = size ? sizeClass(size) : -1;
+        if (cls < 0 || !popBlock(cls, &blocks[got]))
+            break;
+    }
+    if (got < no)
+    {
+        while (got > 0)
+            push(blocks[--got]);
+        delete[] blocks;
+        return false;
+    }
+
+    for (int i = 0; i < no; i++)
+    {
+        int seq_no;
+        shmSizeType offset;
+        char *ptr = blockAddress(blocks[i], &seq_no, &offset);
+        initItem(ptr, (int)dt[i], (shmSizeType)count[i], allocSize((int)dt[i], (shmSizeType)count[i]));
+        result[2 * i] = seq_no;
+        *(shmSizeType *)(&result[2 * i + 1]) = offset;
+    }
+    control->fastAllocs.fetch_add(no, std::memory_order_relaxed);
+    delete[] blocks;
+    return true;
+}
+
+bool coShmSlabAlloc::addSlab(int cls, int shm_seq_no, shmSizeType offset)
+{
+    int slab = control->numSlabs.load(std::memory_order_relaxed);
+    if (slab >= MAX_SLABS)
+        return false;
+
+    control->slabs[slab].shm_seq_no = shm_seq_no;
+    control->slabs[slab].offset = offset;
+    control->slabs[slab].cls = cls;
+    control->numSlabs.store(slab + 1, std::memory_order_release);
+    slabIndex[std::make_pair(shm_seq_no, offset)] = slab;
+
+    // push in reverse order, so that blocks are handed out by ascending address
+    unsigned num = SLAB_SIZE / slabClassSize[cls];
+    for (unsigned i = num; i > 0; i--)
+        push(((unsigned)slab << SLAB_BLOCK_BITS) | (i - 1));
+    return true;
+}
+
+bool coShmSlabAlloc::release(int shm_seq_no, shmSizeType offset)
+{
+    if (slabIndex.empty())
+        return false;
+
+    std::map<std::pair<int, shmSizeType>, int>::iterator it = slabIndex.upper_bound(std::make_pair(shm_seq_no, offset));
+    if (it == slabIndex.begin())
+        return false;
+    --it;
+    if (it->first.first != shm_seq_no || offset - it->first.second >= (shmSizeType)SLAB_SIZE)
+        return false;
+
+    int slab = it->second;
+    shmSizeType rel = offset - it->first.second;
+    shmSizeType bsize = slabClassSize[control->slabs[slab].cls];
+    if (rel % bsize || rel / bsize >= SLAB_SIZE / bsize)
+    {
+        print_comment(__LINE__, __FILE__, "coShmSlabAlloc::release: misaligned block %d/%u", shm_seq_no, offset);
+        return true;
+    }
+
+    int *iptr = (int *)((char *)get_shared_memory()->get_pointer(shm_seq_no) + offset);
+    if (iptr[0] == SLAB_FREE_MARK)
+        return true; // already free, like unknown chunks in the trees
+
+    push(((unsigned)slab << SLAB_BLOCK_BITS) | (rel / bsize));
+    return true;
+}
+
+void coShmSlabAlloc::reset()
+{
+    for (int cls = 0; cls < NUM_CLASSES; cls++)
+        control->heads[cls].store(0);
+    control->numSlabs.store(0);
+    control->fastAllocs.store(0);
+    slabIndex.clear();
+}
+
+long coShmSlabAlloc::numSlabs() const
+{
+    return control->numSlabs.load(std::memory_order_relaxed);
+}
+
+long coShmSlabAlloc::fastAllocs() const
+{
+    return control->fastAllocs.load(std::memory_order_relaxed);
+}
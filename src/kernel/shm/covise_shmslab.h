@@ -0,0 +1,104 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COVISE_SHMSLAB_H
+#define COVISE_SHMSLAB_H
+
+#include "covise_shm.h"
+#include <map>
+#include <utility>
+
+/***********************************************************************\
+ **                                                                     **
+ **   Size class allocator for small shared memory blocks               **
+ **                                                                     **
+ **   Description  : The data manager carves fixed size slabs out of    **
+ **                  its address ordered trees and threads the blocks   **
+ **                  of each slab into a lock-free free list per size   **
+ **                  class. List heads and slab table are kept in a     **
+ **                  control block at the start of the first shared     **
+ **                  memory segment, so application processes can pop  **
+ **                  small blocks directly instead of sending a         **
+ **                  SHM_MALLOC(_LIST) message to the data manager.     **
+ **                  Blocks are returned by the data manager only       **
+ **                  (SHM_FREE), large blocks still use the trees.      **
+ **                                                                     **
+ **   Classes      : coShmSlabAlloc                                     **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+struct coShmSlabControl;
+
+class SHMEXPORT coShmSlabAlloc
+{
+public:
+    enum
+    {
+        NUM_CLASSES = 16,
+        MAX_BLOCK_SIZE = 4096, // larger requests go to the AVL trees
+        SLAB_SIZE = 65536, // bytes carved from the trees per slab
+        MAX_SLABS = 16384 // capacity of the slab table in the control block
+    };
+
+    // bytes to reserve for the control block at the start of segment 1
+    static shmSizeType controlSize();
+
+    // application side: control block of the attached segment 1,
+    // NULL if the data manager does not provide small block slabs
+    static coShmSlabAlloc *the();
+
+    // data manager side: (re-)initialize control block at address
+    static coShmSlabAlloc *create(void *address, bool enabled);
+
+    // size class for an aligned block size, -1 if too large
+    static int sizeClass(shmSizeType size);
+    static shmSizeType classSize(int cls);
+
+    // bytes required for shm_alloc(type, msize), 0 for unknown types
+    static shmSizeType allocSize(int type, shmSizeType msize);
+    // write type, length and trailing marker as expected by the dmgr
+    static void initItem(void *ptr, int type, shmSizeType msize, shmSizeType size);
+
+    bool isEnabled() const;
+
+    // pop a block of size class cls - fails if the list is empty or the
+    // block lives in a segment that has not been attached yet
+    bool pop(int cls, int *shm_seq_no, shmSizeType *offset);
+
+    // application side replacement for a SHM_MALLOC_LIST exchange:
+    // result receives (shm_seq_no, offset) per entry, nothing is kept
+    // allocated if any entry cannot be served from the slabs
+    bool mallocList(const data_type *dt, const long *count, int no, int *result);
+
+    // data manager side: register a new slab and push all its blocks
+    bool addSlab(int cls, int shm_seq_no, shmSizeType offset);
+    // data manager side: give back a block, false if not slab memory
+    bool release(int shm_seq_no, shmSizeType offset);
+    // data manager side: forget all slabs (new desk)
+    void reset();
+
+    // statistics
+    long numSlabs() const;
+    long fastAllocs() const;
+
+private:
+    coShmSlabAlloc(coShmSlabControl *c);
+    ~coShmSlabAlloc();
+    void push(unsigned block);
+    bool popBlock(int cls, unsigned *block);
+    char *blockAddress(unsigned block, int *shm_seq_no, shmSizeType *offset);
+
+    coShmSlabControl *control;
+    // slab start (shm_seq_no, offset) -> index into slab table, dmgr only
+    std::map<std::pair<int, shmSizeType>, int> slabIndex;
+    static coShmSlabAlloc *theSlabs;
+};
+}
+#endif
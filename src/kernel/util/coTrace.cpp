@@ -0,0 +1,211 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include "coTrace.h"
+#include "coFileUtil.h"
+#include "unixcompat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace covise;
+
+namespace
+{
+
+// formatted events waiting for flush()
+struct TraceBuffer
+{
+    std::mutex mutex;
+    std::vector<std::string> events;
+    std::string dir;
+    std::string processName;
+    int numFragments;
+    int pid;
+
+    TraceBuffer()
+        : numFragments(0)
+        , pid(getpid())
+    {
+        if (const char *d = getenv("COVISE_TRACE"))
+            dir = d;
+    }
+
+    ~TraceBuffer()
+    {
+        write();
+    }
+
+    // write events to a new fragment file, called with mutex locked
+    void write()
+    {
+        if (dir.empty() || events.empty())
+            return;
+        // written under a temporary name and renamed when complete,
+        // so that merge() never reads or removes a fragment still being written
+        std::stringstream str;
+        str << dir << "/" << pid << "-" << coTrace::now() << "-" << numFragments++;
+        std::string partial = str.str() + ".part";
+        std::string fragment = str.str() + ".trace";
+        FILE *fp = fopen(partial.c_str(), "w");
+        if (!fp)
+            return;
+        fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"%s\"}}\n",
+                pid, processName.empty() ? "process" : processName.c_str());
+        for (size_t i = 0; i < events.size(); i++)
+            fprintf(fp, "%s\n", events[i].c_str());
+        if (fclose(fp) != 0 || rename(partial.c_str(), fragment.c_str()) != 0)
+        {
+            remove(partial.c_str());
+            return;
+        }
+        events.clear();
+    }
+};
+
+TraceBuffer &buffer()
+{
+    static TraceBuffer b;
+    return b;
+}
+
+std::string escape(const std::string &s)
+{
+    std::string e;
+    e.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        char c = s[i];
+        if (c == '"' || c == '\\')
+        {
+            e += '\\';
+            e += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            e += ' ';
+        }
+        else
+        {
+            e += c;
+        }
+    }
+    return e;
+}
+}
+
+bool coTrace::s_enabled = getenv("COVISE_TRACE") != NULL && *getenv("COVISE_TRACE") != '\0';
+
+void coTrace::setProcessName(const std::string &name)
+{
+    if (!s_enabled)
+        return;
+    TraceBuffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.processName = escape(name);
+}
+
+long long coTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void coTrace::record(const char *cat, const std::string &name, long long begin, long long end)
+{
+    if (!s_enabled)
+        return;
+    TraceBuffer &b = buffer();
+    unsigned tid = (unsigned)(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0x7fffffff);
+    // names are not limited in length, a truncated event would break the JSON
+    std::stringstream event;
+    event << "{\"name\":\"" << escape(name) << "\",\"cat\":\"" << escape(cat) << "\",\"ph\":\"X\",\"ts\":" << begin
+          << ",\"dur\":" << end - begin << ",\"pid\":" << b.pid << ",\"tid\":" << tid << "}";
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.events.push_back(event.str());
+}
+
+void coTrace::flush()
+{
+    if (!s_enabled)
+        return;
+    TraceBuffer &b = buffer();
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.write();
+}
+
+int coTrace::merge(const std::string &prefix)
+{
+    if (!s_enabled)
+        return -1;
+    flush();
+
+    TraceBuffer &b = buffer();
+    coDirectory *dir = coDirectory::open(b.dir.c_str());
+    if (!dir)
+        return -1;
+
+    // pid and counter keep merges within the same second and of several controllers apart
+    static int numMerges = 0;
+    time_t t = time(NULL);
+    char stamp[64];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&t));
+    std::stringstream str;
+    str << b.dir << "/" << prefix << "-" << stamp << "-" << b.pid << "-" << numMerges++ << ".json";
+    std::string filename = str.str();
+    FILE *out = fopen(filename.c_str(), "w");
+    if (!out)
+    {
+        dir->close();
+        delete dir;
+        return -1;
+    }
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    int numEvents = 0;
+    for (int i = 0; i < dir->count(); i++)
+    {
+        if (!coDirectory::match(dir->name(i), "*.trace"))
+            continue;
+        std::string fragment = b.dir + "/" + dir->name(i);
+        std::ifstream in(fragment.c_str());
+        if (!in)
+            continue;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r'))
+                line.erase(line.size() - 1);
+            if (line.empty())
+                continue;
+            fprintf(out, "%s%s", numEvents ? ",\n" : "", line.c_str());
+            ++numEvents;
+        }
+        in.close();
+        remove(fragment.c_str());
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    dir->close();
+    delete dir;
+    return numEvents;
+}
@@ -0,0 +1,101 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef COVISE_TRACE_H
+#define COVISE_TRACE_H
+
+#include "coExport.h"
+#include <string>
+
+/***********************************************************************\
+ **                                                                     **
+ **   Execution tracing                                                 **
+ **                                                                     **
+ **   Description  : If the environment variable COVISE_TRACE names a   **
+ **                  directory, every process records spans (module     **
+ **                  start, compute, object creation, packing, transfer,**
+ **                  rendering) in memory and writes them to a new      **
+ **                  fragment file in this directory on flush(). At the **
+ **                  end of an execution the controller merges all      **
+ **                  complete fragments into one file in the Chrome     **
+ **                  trace event format, which can be loaded into       **
+ **                  chrome://tracing or Perfetto. Spans flushed later  **
+ **                  go into the next merge. Without COVISE_TRACE a     **
+ **                  span costs a test of a static flag.                **
+ **                                                                     **
+ **   Classes      : coTrace, coTraceSpan                               **
+ **                                                                     **
+\***********************************************************************/
+
+namespace covise
+{
+
+class UTILEXPORT coTrace
+{
+public:
+    /// true if COVISE_TRACE is set
+    static bool enabled()
+    {
+        return s_enabled;
+    }
+
+    /// name of this process in the trace, e.g. "Tracer_1@host"
+    static void setProcessName(const std::string &name);
+
+    /// microseconds since the epoch, comparable between processes
+    static long long now();
+
+    /// record a span of category cat from begin to end (see now())
+    static void record(const char *cat, const std::string &name, long long begin, long long end);
+
+    /// write the recorded spans to a new fragment file of this process
+    static void flush();
+
+    /** merge all complete fragment files into one trace file and remove them
+       * @param prefix   the trace file is COVISE_TRACE/prefix-<time>-<pid>-<n>.json
+       * @return         number of spans written, -1 on failure
+       */
+    static int merge(const std::string &prefix);
+
+private:
+    static bool s_enabled;
+};
+
+/// records the time from construction to destruction as one span
+class UTILEXPORT coTraceSpan
+{
+public:
+    coTraceSpan(const char *cat, const std::string &name)
+        : m_begin(coTrace::enabled() ? coTrace::now() : 0)
+        , m_cat(cat)
+        , m_name(coTrace::enabled() ? name : std::string())
+    {
+    }
+
+    coTraceSpan(const char *cat, const char *name)
+        : m_begin(coTrace::enabled() ? coTrace::now() : 0)
+        , m_cat(cat)
+        , m_name(coTrace::enabled() && name ? name : "")
+    {
+    }
+
+    ~coTraceSpan()
+    {
+        if (m_begin)
+            coTrace::record(m_cat, m_name, m_begin, coTrace::now());
+    }
+
+private:
+    long long m_begin;
+    const char *m_cat;
+    std::string m_name;
+
+    coTraceSpan(const coTraceSpan &);
+    void operator=(const coTraceSpan &);
+};
+}
+#endif
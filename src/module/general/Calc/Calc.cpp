@@ -27,6 +27,10 @@
 #include "Calc.h"
 #include <do/coDoData.h>
 #include <do/coDoUnstructuredGrid.h>
+#include <config/CoviseConfig.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace covise;
 
@@ -39,6 +43,28 @@ enum Types
     VEKTOR
 };
 
+// number of elements evaluated at once by the compiled expression
+const int CALC_CHUNK = 1024;
+
+// where the values of a register come from
+enum Sources
+{
+    SRC_S1,
+    SRC_S2,
+    SRC_V1,
+    SRC_V2,
+    SRC_CONST,
+    SRC_TEMP
+};
+
+// errors detected while evaluating, combined over all chunks
+enum EvalErrors
+{
+    ERR_DIV_ZERO = 1, // vector divided by zero
+    ERR_DIV_ZERO_SKA = 2, // scalar divided by zero, result is 0
+    ERR_LOG_NEG = 4
+};
+
 //  Set legal operations
 int pLegal[(MAX_OPERATIONS + MAX_FUNKT) * 12] =
     //  plus  minus    mal   get.   hoch  wurz.  v.pr.    sin    cos    tan    log    exp    neg   vlen  comp1  comp2  comp3    max    min   atan
@@ -293,17 +319,11 @@ CCalc::CCalc()
     , head_eval(NULL)
     , end_eval(NULL)
     , item_eval(NULL)
-    , pVektor_1(NULL)
-    , pVektor_2(NULL)
-    , pEinh_Vektor(NULL)
     , pMan_Vektor(NULL)
     , Count_Man_Vektors(0)
-    , pSkalar_1(NULL)
-    , pSkalar_2(NULL)
     , Array_Len(0)
     , Vek_Len(0)
-    , Result_Vektor(NULL)
-    , Result_Skalar(0.f)
+    , Result_Reg(-1)
 {
 }
 
@@ -321,8 +341,6 @@ int CCalc::Compute(Calc *module, char *Expression)
 {
     char *String;
     int TempVektors = 0; // number of intermediate results with type VEKTOR
-    int Array_Count = 0; // counter for data-array
-    float *pIntermed = NULL; // Pointer to beginning of intermediate results-section
     int Anz_Man_Vekt = 0; // number of manual vectors
 
     const coDistributedObject *v_obj_1, *v_obj_2, *s_obj_1, *s_obj_2;
@@ -471,12 +489,6 @@ int CCalc::Compute(Calc *module, char *Expression)
         return coModule::FAIL;
     }
 
-    minmax = 0; // switch for message: max/min value in scalars/vectors
-
-    pVektor_1 = new float[Vek_Len];
-    pVektor_2 = new float[Vek_Len];
-    pEinh_Vektor = new float[Vek_Len];
-
     Expression = LowerCase(Expression);
     strcpy(Ausdruck, Expression);
 
@@ -492,9 +504,6 @@ int CCalc::Compute(Calc *module, char *Expression)
     {
         //in case of an error free memory before return
         DeleteItemList();
-        delete[](pVektor_1);
-        delete[](pVektor_2);
-        delete[](pEinh_Vektor);
         delete[](String);
         delete[](dtype_s1);
         delete[](dtype_s2);
@@ -512,9 +521,6 @@ int CCalc::Compute(Calc *module, char *Expression)
         //in case of an error free memory before return
         DeleteItemList();
         DeletePostfixList();
-        delete[](pVektor_1);
-        delete[](pVektor_2);
-        delete[](pEinh_Vektor);
         delete[](pMan_Vektor);
         delete[](String);
         delete[](dtype_s1);
@@ -530,9 +536,6 @@ int CCalc::Compute(Calc *module, char *Expression)
         //in case of an error free memory before return
         DeleteItemList();
         DeletePostfixList();
-        delete[](pVektor_1);
-        delete[](pVektor_2);
-        delete[](pEinh_Vektor);
         delete[](pMan_Vektor);
         delete[](String);
         delete[](dtype_s1);
@@ -542,8 +545,18 @@ int CCalc::Compute(Calc *module, char *Expression)
         return coSimpleModule::FAIL;
     }
 
-    // get memory for intermediate results
-    pIntermed = (float *)new float[(TempVektors + 1) * Vek_Len];
+    // translate postfix expression into a program working on whole chunks
+    if (!Compile(module))
+    {
+        //in case of an error free memory before return
+        FreeMemory();
+        delete[](String);
+        delete[](dtype_s1);
+        delete[](dtype_s2);
+        delete[](dtype_v1);
+        delete[](dtype_v2);
+        return coSimpleModule::FAIL;
+    }
 
     //	get output data object names and create objects
     switch (Result_Type)
@@ -586,67 +599,16 @@ int CCalc::Compute(Calc *module, char *Expression)
     }
 
     //evaluate array
-
-    for (Array_Count = 0; Array_Count < Array_Len; Array_Count++)
+    if (!Run(module))
     {
-        Result_Vektor = pIntermed;
-        if (u1_in != NULL) // vector-input 1 connected
-        {
-            pVektor_1[0] = u1_in[Array_Count];
-            pVektor_1[1] = v1_in[Array_Count];
-            if (Vek_Len == 3)
-                pVektor_1[2] = w1_in[Array_Count];
-        }
-
-        if (u2_in != NULL) // vector-input 2 connected
-        {
-            pVektor_2[0] = u2_in[Array_Count];
-            pVektor_2[1] = v2_in[Array_Count];
-            if (Vek_Len == 3)
-                pVektor_2[2] = w2_in[Array_Count];
-        }
-
-        if (s1_in != NULL)
-            pSkalar_1 = &s1_in[Array_Count];
-        if (s2_in != NULL)
-            pSkalar_2 = &s2_in[Array_Count];
-
-        //evaluation of expression
-        if (!Evaluate(module, &Result_Type, &Result_Vektor, &Result_Skalar))
-        {
-            //in case of an error free memory before return
-            DeleteItemList();
-            DeletePostfixList();
-
-            delete[](pVektor_1);
-            delete[](pVektor_2);
-            delete[](pEinh_Vektor);
-            delete[](pMan_Vektor);
-            delete[](String);
-            delete[](pIntermed);
-            delete[](dtype_s1);
-            delete[](dtype_s2);
-            delete[](dtype_v1);
-            delete[](dtype_v2);
-            return coSimpleModule::FAIL;
-        }
-
-        //write result into output object
-        switch (Result_Type)
-        {
-        case VEKTOR:
-            u_out[Array_Count] = Result_Vektor[0];
-            v_out[Array_Count] = Result_Vektor[1];
-            if (Vek_Len == 3)
-                w_out[Array_Count] = Result_Vektor[2];
-            break;
-
-        case SKALAR:
-            s_out[Array_Count] = Result_Skalar;
-            break;
-        }
-        if (Array_Count == 0)
-            minmax = 1; //in case of max/min: send message
+        //in case of an error free memory before return
+        FreeMemory();
+        delete[](String);
+        delete[](dtype_s1);
+        delete[](dtype_s2);
+        delete[](dtype_v1);
+        delete[](dtype_v2);
+        return coSimpleModule::FAIL;
     }
 
     //FOR TESTING *********************************************************
@@ -684,7 +646,6 @@ int CCalc::Compute(Calc *module, char *Expression)
     //free memory
     FreeMemory();
     delete[](String);
-    delete[](pIntermed);
     delete[](dtype_s1);
     delete[](dtype_s2);
     delete[](dtype_v1);
@@ -953,10 +914,8 @@ void CCalc::FreeMemory()
     DeleteItemList(); //free memory needed for item-list
     DeletePostfixList(); //free memory needed for postfix-list
 
-    delete[](pVektor_1);
-    delete[](pVektor_2);
-    delete[](pEinh_Vektor);
     delete[](pMan_Vektor);
+    pMan_Vektor = NULL;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1606,659 +1565,501 @@ int CCalc::GetResultType(Calc *module, int *Result_Type, int *TempVek)
 
 //////////////////////////////////////////////////////////////////////////////
 //                                                                          //
-// Evaluate: evaluate postfix-expression                                    //
+// Compile: translate postfix-expression into a list of operations on       //
+//          registers, each operation is done for a whole chunk of data     //
 //                                                                          //
 //////////////////////////////////////////////////////////////////////////////
 
-int CCalc::Evaluate(Calc *module, int *Result_Type, float **Vektor_Res,
-                    float *Result_Skalar)
+int CCalc::Compile(Calc *module)
 {
-    int CountPostfix = 0;
-    bool Done = false;
-    int Op_Type_1 = 0, Op_Type_2 = 0;
-    int Legal = 0;
+    std::vector<int> Stack;
     int Operation = 0;
-    float Temp = 0.0f;
-    float *TempVektor_1 = NULL;
-    float *TempVektor_2 = NULL;
-    float *pVektor = NULL;
-    float Operand_1, Operand_2 = 0.f;
-    int Temp_V_Len_1 = 0;
-    int Temp_V_Len_2 = 0;
-    int Type_Res;
-    float Skalar_Res = 0;
-    int x = 0;
-    int Man_Vek = 0;
-#ifdef DEBUGMODE
-    char buf[400];
-    char value[100];
-#endif
+    int Type_Res = TOKEN;
 
-    Stackinit_Eval();
+    Program.clear();
+    Registers.clear();
+    Result_Reg = -1;
 
-    while (Done != true)
+    for (int CountPostfix = 0; pListPostfix[CountPostfix].Priority != EOL; CountPostfix++)
     {
-        switch (pListPostfix[CountPostfix].Priority)
+        const LIST &Item = pListPostfix[CountPostfix];
+        CALC_REG Reg;
+        Reg.Type = Item.Type;
+        Reg.Source = SRC_CONST;
+        Reg.Value[0] = Reg.Value[1] = Reg.Value[2] = 0.f;
+
+        if (Item.Priority == 0) // operand
         {
-        case 0: // operand: push onto stack
-            //scalar
-            if (pListPostfix[CountPostfix].Type == SKALAR)
+            if (Item.Type == SKALAR)
             {
-                if (!strcmp(pListPostfix[CountPostfix].Item, SKALAR_1))
-                {
-                    if (pSkalar_1)
-                        Temp = *pSkalar_1;
-                    else
-                        Temp = 0.f;
-                }
-                if (!strcmp(pListPostfix[CountPostfix].Item, SKALAR_2))
+                if (!strcmp(Item.Item, SKALAR_1))
                 {
-                    if (pSkalar_2)
-                        Temp = *pSkalar_2;
-                    else
-                        Temp = 0.f;
+                    if (s1_in)
+                        Reg.Source = SRC_S1;
                 }
-                if (strcmp(pListPostfix[CountPostfix].Item, SKALAR_1) != 0)
+                else if (!strcmp(Item.Item, SKALAR_2))
                 {
-                    if (strcmp(pListPostfix[CountPostfix].Item, SKALAR_2) != 0)
-                    {
-                        Temp = (float)atof(pListPostfix[CountPostfix].Item);
-                    }
+                    if (s2_in)
+                        Reg.Source = SRC_S2;
                 }
-                Push(Temp, SKALAR, NULL, 0);
-                CountPostfix++;
-                break;
+                else
+                    Reg.Value[0] = (float)atof(Item.Item);
             }
-
-            //vector
-            if (pListPostfix[CountPostfix].Type == VEKTOR)
+            else if (!strcmp(Item.Item, VEKTOR_1))
             {
-                if (!strcmp(pListPostfix[CountPostfix].Item, VEKTOR_1))
-                {
-                    pVektor = pVektor_1;
-                }
-                if (!strcmp(pListPostfix[CountPostfix].Item, VEKTOR_2))
-                {
-                    pVektor = pVektor_2;
-                }
-                if (strstr(pListPostfix[CountPostfix].Item, MANUAL_V))
-                {
-                    Man_Vek = atoi((pListPostfix[CountPostfix].Item) + strlen(MANUAL_V));
-                    pVektor = &pMan_Vektor[Man_Vek * Vek_Len];
-                }
-                if (!strcmp(pListPostfix[CountPostfix].Item, EINHEITS_V))
-                {
-                    pVektor = pEinh_Vektor;
-                    for (x = 0; x < Vek_Len; x++)
-                        pVektor[x] = 1;
-                }
-                Temp = 0;
-                Push(Temp, VEKTOR, pVektor, Vek_Len);
-                CountPostfix++;
-                break;
+                if (u1_in)
+                    Reg.Source = SRC_V1;
+            }
+            else if (!strcmp(Item.Item, VEKTOR_2))
+            {
+                if (u2_in)
+                    Reg.Source = SRC_V2;
             }
+            else if (strstr(Item.Item, MANUAL_V))
+            {
+                int Man_Vek = atoi(Item.Item + strlen(MANUAL_V));
+                for (int c = 0; c < Vek_Len; c++)
+                    Reg.Value[c] = pMan_Vektor[Man_Vek * Vek_Len + c];
+            }
+            else if (!strcmp(Item.Item, EINHEITS_V))
+            {
+                for (int c = 0; c < Vek_Len; c++)
+                    Reg.Value[c] = 1.f;
+            }
+            Stack.push_back((int)Registers.size());
+            Registers.push_back(Reg);
+            continue;
+        }
 
-        case 2: // operator
-        case 3:
-        case 4:
-        case 5:
-            //no function
-            if (pListPostfix[CountPostfix].Priority != 5)
-                Operand_2 = Pop(&Op_Type_2, &TempVektor_2, &Temp_V_Len_2);
+        // operator or function (priority 5)
+        CALC_OP Op;
+        Op.Token = Item.Token;
+        Op.Src_2 = -1;
+        if (Item.Priority != 5)
+        {
+            if (Stack.empty())
+            {
+                module->sendError("ERROR: non legal operation in expression");
+                return (0);
+            }
+            Op.Src_2 = Stack.back();
+            Stack.pop_back();
+        }
+        if (Stack.empty())
+        {
+            module->sendError("ERROR: non legal operation in expression");
+            return (0);
+        }
+        Op.Src_1 = Stack.back();
+        Stack.pop_back();
 
-            else
-                Op_Type_2 = false;
+        if (!CheckOp(Registers[Op.Src_1].Type, Op.Src_2 >= 0 ? Registers[Op.Src_2].Type : false,
+                     Op.Token, &Operation, &Type_Res))
+        {
+            module->sendError("ERROR: non legal operation in expression");
+            return (0);
+        }
+        Op.Operation = Operation;
+        Reg.Type = Type_Res;
 
-            Operand_1 = Pop(&Op_Type_1, &TempVektor_1, &Temp_V_Len_1);
-            Legal = CheckOp(Op_Type_1, Op_Type_2,
-                            pListPostfix[CountPostfix].Token, &Operation, &Type_Res);
+        if (Op.Token == MAX || Op.Token == MIN)
+        {
+            // global maximum/minimum of an input: the same for all elements
+            int Legal = 0;
+            Reg.Value[0] = Reduce(Op.Token, CountPostfix > 0 ? pListPostfix[CountPostfix - 1].Item : "", &Legal);
             if (!Legal)
             {
-                module->sendError("ERROR: non legal operation in expression");
+                if (Op.Token == MAX)
+                    module->sendError("ERROR: max() can only be used with s1, s2, v1 or v2");
+                else
+                    module->sendError("ERROR: min() can only be used with s1, s2, v1 or v2");
                 return (0);
             }
-
-            if (!PerformOperation(module, Operand_1, Operand_2, TempVektor_1,
-                                  TempVektor_2, Vek_Len, Operation, pListPostfix[CountPostfix].Token,
-                                  pListPostfix[CountPostfix - 1].Item, &Type_Res, &Skalar_Res, Vektor_Res))
+        }
+        else
+        {
+            if (Op.Token == VEK_PROD && Vek_Len != 3)
+            {
+                module->sendError("ERROR: `Kreuzprodukt` only in R3");
                 return (0);
+            }
+            Reg.Source = SRC_TEMP;
+            Op.Dest = (int)Registers.size();
+            Program.push_back(Op);
+        }
+        Stack.push_back((int)Registers.size());
+        Registers.push_back(Reg);
+    }
 
-            Push(Skalar_Res, Type_Res, *Vektor_Res, Vek_Len);
-            if (Type_Res == VEKTOR)
-                (*Vektor_Res) = (*Vektor_Res) + Vek_Len;
-            CountPostfix++;
-            break;
+    if (Stack.size() != 1)
+    {
+        module->sendError("ERROR: non legal operation in expression");
+        return (0);
+    }
+    Result_Reg = Stack.back();
+    return (1);
+}
 
-        case EOL: // end of list: result is on stack
-            (*Vektor_Res) = (*Vektor_Res) - Vek_Len;
-            *Result_Type = Type_Res;
-            *Result_Skalar = Skalar_Res;
-            delete (item_eval);
-            Done = true;
-            break;
-        }
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Reduce: maximum/minimum value of a scalar input or maximum/minimum       //
+//         length of a vector input                                         //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+float CCalc::Reduce(int Token, const char *input, int *Legal)
+{
+    const float *s = NULL;
+    const float *u = NULL, *v = NULL, *w = NULL;
+    float puffer = 0.f;
+    float length;
+
+    *Legal = 1;
+    if (!strcmp(input, SKALAR_1))
+        s = s1_in;
+    else if (!strcmp(input, SKALAR_2))
+        s = s2_in;
+    else if (!strcmp(input, VEKTOR_1))
+    {
+        u = u1_in;
+        v = v1_in;
+        w = w1_in;
+    }
+    else if (!strcmp(input, VEKTOR_2))
+    {
+        u = u2_in;
+        v = v2_in;
+        w = w2_in;
+    }
+    else
+    {
+        *Legal = 0;
+        return (0.f);
     }
 
-#ifdef DEBUGMODE
-    if (Array_Len == 1)
+    for (int Count = 0; Count < Array_Len; Count++)
     {
-        switch (Type_Res)
+        if (s)
+            length = s[Count];
+        else if (u)
+            length = sqrt((u[Count] * u[Count]) + (v[Count] * v[Count]) + (w[Count] * w[Count]));
+        else
+            break; // input not connected
+
+        // maximum is never below 0, minimum starts with the first element
+        if (Count == 0 && Token == MIN)
+            puffer = length;
+        if (Token == MAX ? length > puffer : length < puffer)
+            puffer = length;
+    }
+    return (puffer);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//                                                                          //
+// Run: evaluate compiled expression for all elements, chunk by chunk       //
+//                                                                          //
+//////////////////////////////////////////////////////////////////////////////
+
+int CCalc::Run(Calc *module)
+{
+    const int NumRegs = (int)Registers.size();
+    int Errors = 0;
+
+    static int numThreads = -1;
+    if (numThreads < 0)
+        numThreads = coCoviseConfig::getInt("Module.Calc.Threads", 0);
+#ifdef _OPENMP
+    int threads = numThreads > 0 ? numThreads : omp_get_max_threads();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads) if (Array_Len > CALC_CHUNK)
+#endif
+    {
+        // every register holds CALC_CHUNK values per vector component,
+        // inputs point directly into the data objects
+        std::vector<float> Buffer((size_t)NumRegs * 3 * CALC_CHUNK);
+        std::vector<float *> Reg((size_t)NumRegs * 3);
+        int ThreadErrors = 0;
+
+        for (int r = 0; r < NumRegs; r++)
         {
-        case SKALAR:
-            strcpy(buf, "Result (scalar): ");
-            sprintf(value, "%f", Skalar_Res);
-            strcat(buf, value);
-            module->sendInfo(buf);
-            break;
+            for (int c = 0; c < 3; c++)
+                Reg[r * 3 + c] = &Buffer[((size_t)r * 3 + c) * CALC_CHUNK];
+            if (Registers[r].Source == SRC_CONST)
+            {
+                for (int c = 0; c < 3; c++)
+                    std::fill(Reg[r * 3 + c], Reg[r * 3 + c] + CALC_CHUNK, Registers[r].Value[c]);
+            }
+        }
 
-        case VEKTOR:
-            strcpy(buf, "Result (vector): [");
-            sprintf(value, "%f,%f,%f]", ((*Vektor_Res)[0]), ((*Vektor_Res)[1]), ((*Vektor_Res)[2]));
-            strcat(buf, value);
-            module->sendInfo(buf);
-            break;
+        int NumChunks = (Array_Len + CALC_CHUNK - 1) / CALC_CHUNK;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int Chunk = 0; Chunk < NumChunks; Chunk++)
+        {
+            int Begin = Chunk * CALC_CHUNK;
+            int n = std::min(CALC_CHUNK, Array_Len - Begin);
+
+            for (int r = 0; r < NumRegs; r++)
+            {
+                float **In = &Reg[r * 3];
+                switch (Registers[r].Source)
+                {
+                case SRC_S1:
+                    In[0] = s1_in + Begin;
+                    break;
+                case SRC_S2:
+                    In[0] = s2_in + Begin;
+                    break;
+                case SRC_V1:
+                    In[0] = u1_in + Begin;
+                    In[1] = v1_in + Begin;
+                    In[2] = w1_in + Begin;
+                    break;
+                case SRC_V2:
+                    In[0] = u2_in + Begin;
+                    In[1] = v2_in + Begin;
+                    In[2] = w2_in + Begin;
+                    break;
+                }
+            }
+
+            for (size_t i = 0; i < Program.size(); i++)
+                Execute(Program[i], &Reg[0], n, &ThreadErrors);
+
+            //write result into output object
+            float **Res = &Reg[Result_Reg * 3];
+            switch (Result_Type)
+            {
+            case VEKTOR:
+                memcpy(u_out + Begin, Res[0], n * sizeof(float));
+                memcpy(v_out + Begin, Res[1], n * sizeof(float));
+                if (Vek_Len == 3)
+                    memcpy(w_out + Begin, Res[2], n * sizeof(float));
+                break;
+
+            case SKALAR:
+                memcpy(s_out + Begin, Res[0], n * sizeof(float));
+                break;
+            }
         }
-    }
+
+        if (ThreadErrors)
+        {
+#ifdef _OPENMP
+#pragma omp atomic
 #endif
+            Errors |= ThreadErrors;
+        }
+    }
 
-    Stack_Eval_Free();
+    if (Errors & ERR_DIV_ZERO)
+    {
+        module->sendError("ERROR: division by zero");
+        return (0);
+    }
+    if (Errors & ERR_LOG_NEG)
+    {
+        module->sendError("ERROR: log on negativ operand");
+        return (0);
+    }
+    if (Errors & ERR_DIV_ZERO_SKA)
+        module->sendWarning("ERROR: division by zero");
     return (1);
 }
 
 //////////////////////////////////////////////////////////////////////////////
 //                                                                          //
-// PerformOperation: perform one operation                                  //
+// Execute: perform one operation for n elements                            //
 //                                                                          //
 //////////////////////////////////////////////////////////////////////////////
 
-int CCalc::PerformOperation(Calc *module, float Op_1, float Op_2, float *V_1, float *V_2,
-                            int V_Len, int Operation, int Token,
-                            char *input, int *Type_Res,
-                            float *S_Res, float **V_Res)
+void CCalc::Execute(const CALC_OP &Op, float **Reg, int n, int *Errors)
 {
-    int Count = 0;
-    int Count_max_min = 0;
-    float puffer;
-    float length;
-#ifdef DEBUGMODE
-    char buf[400];
-    char value[100];
-    char pos[20];
-    int position = 0;
-#endif
-
-    switch (Operation)
+    float **R = Reg + Op.Dest * 3;
+    float **A = Reg + Op.Src_1 * 3;
+    float **B = Op.Src_2 >= 0 ? Reg + Op.Src_2 * 3 : NULL;
+    float *r = R[0];
+    const float *a = A[0];
+    const float *b = B ? B[0] : NULL;
+    int zero = 0;
+    int i, c;
+
+    switch (Op.Operation)
     {
     case VEK_VEK:
-        switch (Token)
+        switch (Op.Token)
         {
         case PLUS:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                (*V_Res)[Count] = V_1[Count] + V_2[Count];
-            }
-            *Type_Res = VEKTOR;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = A[c][i] + B[c][i];
             break;
 
         case MINUS:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                (*V_Res)[Count] = V_1[Count] - V_2[Count];
-            }
-            *Type_Res = VEKTOR;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = A[c][i] - B[c][i];
             break;
 
         case MAL:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                *S_Res = (*S_Res) + (V_1[Count] * V_2[Count]);
-            }
-            *Type_Res = SKALAR;
+            for (i = 0; i < n; i++)
+                r[i] = A[0][i] * B[0][i] + A[1][i] * B[1][i] + A[2][i] * B[2][i];
             break;
 
         case VEK_PROD:
-            if (V_Len != 3)
+            for (i = 0; i < n; i++)
             {
-                module->sendError("ERROR: `Kreuzprodukt` only in R3");
-                return (0);
+                R[0][i] = A[1][i] * B[2][i] - A[2][i] * B[1][i];
+                R[1][i] = A[2][i] * B[0][i] - A[0][i] * B[2][i];
+                R[2][i] = A[0][i] * B[1][i] - A[1][i] * B[0][i];
             }
-            (*V_Res)[0] = V_1[1] * V_2[2] - V_1[2] * V_2[1];
-            (*V_Res)[1] = V_1[2] * V_2[0] - V_1[0] * V_2[2];
-            (*V_Res)[2] = V_1[0] * V_2[1] - V_1[1] * V_2[0];
-            *Type_Res = VEKTOR;
             break;
         }
         break;
 
     case VEK_SKA:
-        switch (Token)
+        switch (Op.Token)
         {
         case MAL:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                (*V_Res)[Count] = V_1[Count] * Op_2;
-            }
-            *Type_Res = VEKTOR;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = A[c][i] * b[i];
             break;
 
         case GETEILT:
-            if (Op_2)
-            {
-                for (Count = 0; Count < V_Len; Count++)
-                {
-                    (*V_Res)[Count] = V_1[Count] / Op_2;
-                }
-            }
-            else
-            {
-                module->sendError("ERROR: division by zero");
-                return (0);
-            }
-            *Type_Res = VEKTOR;
+            for (i = 0; i < n; i++)
+                zero |= (b[i] == 0.f);
+            if (zero)
+                *Errors |= ERR_DIV_ZERO;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = A[c][i] / b[i];
             break;
         }
         break;
 
     case SKA_VEK:
-        switch (Token)
+        switch (Op.Token)
         {
         case MAL:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                (*V_Res)[Count] = V_2[Count] * Op_1;
-            }
-            *Type_Res = VEKTOR;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = B[c][i] * a[i];
             break;
         }
         break;
 
     case SKA_SKA:
-        switch (Token)
+        switch (Op.Token)
         {
         case PLUS:
-            *S_Res = Op_1 + Op_2;
+            for (i = 0; i < n; i++)
+                r[i] = a[i] + b[i];
             break;
 
         case MINUS:
-            *S_Res = Op_1 - Op_2;
+            for (i = 0; i < n; i++)
+                r[i] = a[i] - b[i];
             break;
 
         case MAL:
-            *S_Res = Op_1 * Op_2;
+            for (i = 0; i < n; i++)
+                r[i] = a[i] * b[i];
             break;
 
         case GETEILT:
-            if (Op_2)
-                *S_Res = Op_1 / Op_2;
-            else
+            for (i = 0; i < n; i++)
             {
-                module->sendWarning("ERROR: division by zero");
-                //return(0);
-                *S_Res = 0.;
+                zero |= (b[i] == 0.f);
+                r[i] = b[i] != 0.f ? a[i] / b[i] : 0.f;
             }
+            if (zero)
+                *Errors |= ERR_DIV_ZERO_SKA;
             break;
 
         case HOCH:
-            *S_Res = pow(Op_1, Op_2);
+            for (i = 0; i < n; i++)
+                r[i] = pow(a[i], b[i]);
             break;
 
         case WURZEL:
-            *S_Res = pow(Op_1, 1 / Op_2);
+            for (i = 0; i < n; i++)
+                r[i] = pow(a[i], 1 / b[i]);
             break;
         }
-        *Type_Res = SKALAR;
         break;
 
     case VEK:
-        switch (Token)
+        switch (Op.Token)
         {
         case NEG:
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                (*V_Res)[Count] = (-1) * V_1[Count];
-            }
-            *Type_Res = VEKTOR;
+            for (c = 0; c < 3; c++)
+                for (i = 0; i < n; i++)
+                    R[c][i] = (-1) * A[c][i];
             break;
 
         case VLEN:
-            *S_Res = 0;
-            for (Count = 0; Count < V_Len; Count++)
-            {
-                *S_Res = *S_Res + (V_1[Count] * V_1[Count]);
-            }
-            *S_Res = sqrt(*S_Res);
-            *Type_Res = SKALAR;
+            for (i = 0; i < n; i++)
+                r[i] = sqrt(A[0][i] * A[0][i] + A[1][i] * A[1][i] + A[2][i] * A[2][i]);
             break;
 
         case COMP_1:
-            *S_Res = V_1[0];
-            *Type_Res = SKALAR;
-            break;
-
         case COMP_2:
-            *S_Res = V_1[1];
-            *Type_Res = SKALAR;
-            break;
-
         case COMP_3:
-            *S_Res = V_1[2];
-            *Type_Res = SKALAR;
+            memcpy(r, A[Op.Token - COMP_1], n * sizeof(float));
             break;
-
-        case MAX:
-            if (!strcmp(input, VEKTOR_1))
-            {
-                puffer = 0;
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    length = sqrt((u1_in[Count_max_min] * u1_in[Count_max_min]) + (v1_in[Count_max_min] * v1_in[Count_max_min]) + (w1_in[Count_max_min] * w1_in[Count_max_min]));
-
-                    if (length > puffer)
-                    {
-                        puffer = length;
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-//write message with maximum value
-#ifdef DEBUGMODE
-                if (!minmax)
-                {
-                    strcpy(buf, "maximum length of v1: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-
-            if (!strcmp(input, VEKTOR_2))
-            {
-                puffer = 0;
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    length = sqrt((u2_in[Count_max_min] * u2_in[Count_max_min]) + (v2_in[Count_max_min] * v2_in[Count_max_min]) + (w2_in[Count_max_min] * w2_in[Count_max_min]));
-
-                    if (length > puffer)
-                    {
-                        puffer = length;
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with maximum value
-                if (!minmax)
-                {
-                    strcpy(buf, "maximum length of v2: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-            module->sendError("ERROR: max() can only be used with s1, s2, v1 or v2");
-            return (0);
-
-        case MIN:
-            if (!strcmp(input, VEKTOR_1))
-            {
-                puffer = sqrt((u1_in[0] * u1_in[0]) + (v1_in[0] * v1_in[0]) + (w1_in[0] * w1_in[0]));
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    length = sqrt((u1_in[Count_max_min] * u1_in[Count_max_min]) + (v1_in[Count_max_min] * v1_in[Count_max_min]) + (w1_in[Count_max_min] * w1_in[Count_max_min]));
-
-                    if (length < puffer)
-                    {
-                        puffer = length;
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with minimum value
-                if (!minmax)
-                {
-                    strcpy(buf, "minimum length of v1: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-
-            if (!strcmp(input, VEKTOR_2))
-            {
-                puffer = sqrt((u1_in[0] * u1_in[0]) + (v1_in[0] * v1_in[0]) + (w1_in[0] * w1_in[0]));
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    length = sqrt((u2_in[Count_max_min] * u2_in[Count_max_min]) + (v2_in[Count_max_min] * v2_in[Count_max_min]) + (w2_in[Count_max_min] * w2_in[Count_max_min]));
-
-                    if (length < puffer)
-                    {
-                        puffer = length;
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with minimum value
-                if (!minmax)
-                {
-                    strcpy(buf, "minimum length of v2: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-            module->sendError("ERROR: min() can only be used with s1, s2, v1 or v2");
-            return (0);
         }
         break;
 
     case SKA:
-        switch (Token)
+        switch (Op.Token)
         {
         case SIN:
-            *S_Res = sin(Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = sin(a[i]);
             break;
 
         case COS:
-            *S_Res = cos(Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = cos(a[i]);
             break;
 
         case TAN:
-            *S_Res = tan(Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = tan(a[i]);
             break;
 
         case ATAN:
-            *S_Res = atan(Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = atan(a[i]);
             break;
 
         case LOG:
-            if (Op_1 >= 0)
-                *S_Res = log(Op_1);
-            else
-            {
-                module->sendError("ERROR: log on negativ operand");
-                return (0);
-            }
+            for (i = 0; i < n; i++)
+                zero |= !(a[i] >= 0.f);
+            if (zero)
+                *Errors |= ERR_LOG_NEG;
+            for (i = 0; i < n; i++)
+                r[i] = log(a[i]);
             break;
 
         case EXP:
-            *S_Res = exp(Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = exp(a[i]);
             break;
 
         case NEG:
-            *S_Res = (-Op_1);
+            for (i = 0; i < n; i++)
+                r[i] = (-a[i]);
             break;
-
-        case MAX:
-            if (!strcmp(input, SKALAR_1))
-            {
-                puffer = 0;
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    if (s1_in[Count_max_min] > puffer)
-                    {
-                        puffer = s1_in[Count_max_min];
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with maximum value
-                if (!minmax)
-                {
-                    strcpy(buf, "maximum value of s1: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-
-            if (!strcmp(input, SKALAR_2))
-            {
-                puffer = 0;
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    if (s2_in[Count_max_min] > puffer)
-                    {
-                        puffer = s2_in[Count_max_min];
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with maximum value
-                if (!minmax)
-                {
-                    strcpy(buf, "maximum value of s2: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-            module->sendError("ERROR: max() can only be used with s1, s2, v1 or v2");
-            return (0);
-
-        case MIN:
-            if (!strcmp(input, SKALAR_1))
-            {
-                puffer = s1_in[0];
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    if (s1_in[Count_max_min] < puffer)
-                    {
-                        puffer = s1_in[Count_max_min];
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-#ifdef DEBUGMODE
-                //write message with minimum value
-                if (!minmax)
-                {
-                    strcpy(buf, "minimum value of s1: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-
-            if (!strcmp(input, SKALAR_2))
-            {
-                puffer = s2_in[0];
-                for (Count_max_min = 0; Count_max_min < Array_Len; Count_max_min++)
-                {
-                    if (s2_in[Count_max_min] < puffer)
-                    {
-                        puffer = s2_in[Count_max_min];
-#ifdef DEBUGMODE
-                        position = Count_max_min + 1;
-#endif
-                    }
-                }
-                *S_Res = puffer;
-//write message with minimum value
-#ifdef DEBUGMODE
-                if (!minmax)
-                {
-                    strcpy(buf, "minimum value of s2: ");
-                    sprintf(value, "%f", puffer);
-                    strcat(buf, value);
-                    strcat(buf, " (Pos.: ");
-                    sprintf(pos, "%d", position);
-                    strcat(buf, pos);
-                    strcat(buf, ")");
-                    module->sendInfo(buf);
-                }
-#endif
-                break;
-            }
-            module->sendError("ERROR: min() can only be used with s1, s2, v1 or v2");
-            return (0);
         }
-        *Type_Res = SKALAR;
         break;
     }
-
-    return (1);
 }
-
 //////////////////////////////////////////////////////////////////////////////
 //                                                                          //
 // CheckOp: check if operation is legal                                     //
@@ -99,6 +99,22 @@ typedef struct NODE_EVAL //Stack für Evaluate
     struct NODE_EVAL *next; // Nächster Eintrag im Stack
 } NODE_EVAL;
 
+typedef struct CALC_OP //Befehl des übersetzten Ausdrucks
+{
+    int Operation; // VEK_VEK, VEK_SKA, ...
+    int Token; // PLUS, MINUS, MAL, ...
+    int Dest; // Ergebnisregister
+    int Src_1; // Register des ersten Operanden
+    int Src_2; // Register des zweiten Operanden (-1 bei Funktionen)
+} CALC_OP;
+
+typedef struct CALC_REG //Register des übersetzten Ausdrucks
+{
+    int Type; // VEKTOR oder SKALAR
+    int Source; // Eingang, Konstante oder Zwischenergebnis
+    float Value[3]; // Wert einer Konstanten
+} CALC_REG;
+
 class Calc : public coSimpleModule
 {
     //neu
@@ -165,11 +181,10 @@ private:
     int InfixToPostfix(Calc *module);
 
     int GetResultType(Calc *module, int *Result_Type, int *TempVek);
-    int Evaluate(Calc *module, int *Result_Type, float **Result_Vektor,
-                 float *Result_Skalar);
-    int PerformOperation(Calc *module, float Op_1, float Op_2, float *V_1,
-                         float *V_2, int Vek_Len, int Operation, int Token,
-                         char *input, int *Type_Res, float *S_Res, float **V_Res);
+    int Compile(Calc *module);
+    float Reduce(int Token, const char *input, int *Legal);
+    int Run(Calc *module);
+    static void Execute(const CALC_OP &Op, float **Reg, int n, int *Errors);
     int CheckOp(int Type_1, int Type_2, int Operator, int *Operatio,
                 int *Ergebnis);
 
@@ -200,22 +215,19 @@ private:
     NODE_EVAL *end_eval; // Pointer auf Ende des Stapels     (Evaluate)
     NODE_EVAL *item_eval; // Pointer auf Element des Stapels  (Evaluate)
 
-    float *pVektor_1; //Pointer auf Vektoreingang 1
-    float *pVektor_2; //Pointer auf Vektoreingang 2
-    float *pEinh_Vektor; //Pointer auf Einheitsvektor
     float *pMan_Vektor; //Pointer auf manuell eingegebene Vektoren
     int Count_Man_Vektors; //Zähler für manuell eingegebene Vektoren
 
-    float *pSkalar_1; //Pointer auf Skalareingang 1
-    float *pSkalar_2; //Pointer auf Skalareingang 2
     int Array_Len; //Anz. der Vektoren /Skalare
     int Vek_Len; //Länge des Vektors
 
     int Result_Type; //Typ des Ergebnisses
-    float *Result_Vektor; //Pointer auf Vektorergebnis
-    float Result_Skalar; //Skalarergebnis
 
-    int minmax; //Meldung fuer max/min ausgeben (ja/nein)
+    // compiled expression: evaluated for CALC_CHUNK elements at once,
+    // each register holds a chunk per vector component
+    std::vector<CALC_OP> Program;
+    std::vector<CALC_REG> Registers;
+    int Result_Reg; //Register mit dem Ergebnis
 
     enum Operations
     {
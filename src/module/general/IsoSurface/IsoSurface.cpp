@@ -25,6 +25,7 @@
 
 #include "IsoSurface.h"
 #include <alg/coIsoSurface.h>
+#include <alg/coIsoCellIndex.h>
 #include <alg/coColors.h>
 #include <do/covise_gridmethods.h>
 #include <util/coviseCompat.h>
@@ -1820,10 +1821,15 @@ int IsoSurface::compute(const char *)
             }
             else
             {
+                // repeated isovalues on the same data only visit the cut cells
+                const coIsoCellIndex *cellIndex = NULL;
+                if (!iblank)
+                    cellIndex = coIsoCellIndex::get(grid_in->getName(), i_data_in->getName(),
+                                                    numelem, numcoord, el, cl, tl, i_in);
                 plane = new IsoPlane(numelem, numcoord, DataType, vertexRatio,
                                      el, cl, tl,
                                      x_in, y_in, z_in, s_in, i_in, u_in, v_in, w_in, isovalue,
-                                     (p_DataIn->isConnected() != 0), iblank);
+                                     (p_DataIn->isConnected() != 0), iblank, cellIndex);
                 if (!plane->createIsoPlane())
                 {
                     delete plane;
@@ -8,13 +8,14 @@
 #include "MakeOctTree.h"
 #include <do/coDoOctTree.h>
 #include <do/coDoOctTreeP.h>
+#include <do/coDoCellBVH.h>
 #include <do/coDoUnstructuredGrid.h>
 
 MakeOctTree::MakeOctTree(int argc, char *argv[])
     : coSimpleModule(argc, argv, "Create Octrees for UNSGRDs")
 {
     p_grids_ = addInputPort("inGrid", "UnstructuredGrid|Polygons", "input grid");
-    p_octtrees_ = addOutputPort("outOctTree", "OctTree|OctTreeP", "output octtree");
+    p_octtrees_ = addOutputPort("outOctTree", "OctTree|OctTreeP|CellBVH", "output octtree");
     p_normal_size_ = addInt32Param("normal_size", "normal size of octree population");
     p_normal_size_->setValue(coDoBasisTree::NORMAL_SIZE);
     p_max_no_levels_ = addInt32Param("max_no_levels", "Maximum number of levels in an octree");
@@ -29,6 +30,10 @@ MakeOctTree::MakeOctTree(int argc, char *argv[])
     p_limit_fY_->setValue(INT_MAX);
     p_limit_fZ_ = addInt32Param("limit_fZ", "limit number of division in the Z direction");
     p_limit_fZ_->setValue(INT_MAX);
+    p_cell_bvh_ = addBooleanParam("cell_bvh", "make a bounding volume hierarchy instead of an octree for UNSGRDs");
+    p_cell_bvh_->setValue(0);
+    p_leaf_size_ = addInt32Param("leaf_size", "maximum number of cells in a leaf of the bounding volume hierarchy");
+    p_leaf_size_->setValue(coDoCellBVH::LEAF_SIZE);
 }
 
 MakeOctTree::~MakeOctTree()
@@ -85,6 +90,20 @@ MakeOctTree::compute(const char *)
         float *x_l, *y_l, *z_l;
         unsgrd->getAddresses(&e_l, &c_l, &x_l, &y_l, &z_l);
 
+        if (p_cell_bvh_->getValue())
+        {
+            if (p_leaf_size_->getValue() <= 0)
+            {
+                sendError("leaf_size may not be <= 0");
+                return FAIL;
+            }
+            p_octtrees_->setCurrentObject(new coDoCellBVH(p_octtrees_->getObjName(),
+                                                          nume, numc, nump, e_l, c_l,
+                                                          x_l, y_l, z_l,
+                                                          p_leaf_size_->getValue()));
+            return SUCCESS;
+        }
+
         coDoOctTree *tree = new coDoOctTree(p_octtrees_->getObjName(),
                                             nume, numc, nump, e_l, c_l,
                                             x_l, y_l, z_l
@@ -42,5 +42,7 @@ private:
     coIntScalarParam *p_limit_fX_;
     coIntScalarParam *p_limit_fY_;
     coIntScalarParam *p_limit_fZ_;
+    coBooleanParam *p_cell_bvh_;
+    coIntScalarParam *p_leaf_size_;
 };
 #endif
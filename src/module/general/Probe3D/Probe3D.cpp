@@ -54,7 +54,7 @@ Probe3D::Probe3D(int argc, char *argv[])
     p_grid_->setRequired(0);
     p_gdata_ = addInputPort("gdataIn", "Float", "input grid scalar data.");
     p_gdata_->setRequired(0);
-    p_goctree_ = addInputPort("gOcttreesIn", "OctTree", "input grid octtrees");
+    p_goctree_ = addInputPort("gOcttreesIn", "OctTree|CellBVH", "input grid octtrees");
     p_goctree_->setRequired(0);
     p_poly_ = addInputPort("polyIn", "Polygons", "input polygons");
     p_poly_->setRequired(0);
@@ -905,24 +905,51 @@ Probe3D::gInterpolate(const vector<float> &x,
         vector<float> &time_result = gresults[time];
         const vector<const coDistributedObject *> &grids = grid_tsteps[time];
         const vector<const coDistributedObject *> &field = gdata_tsteps[time];
+        int no_points = x.size();
+        vector<float> coordinates(3 * no_points);
         int point;
-        // loop over points
-        for (point = 0; point < x.size(); ++point)
+        for (point = 0; point < no_points; ++point)
         {
-            float coordinates[3];
-            coordinates[0] = x[point];
-            coordinates[1] = y[point];
-            coordinates[2] = z[point];
-            // loop over grids
-            float result = FLT_MAX;
-            int grid;
-            for (grid = 0; grid < grids.size(); ++grid)
+            coordinates[3 * point] = x[point];
+            coordinates[3 * point + 1] = y[point];
+            coordinates[3 * point + 2] = z[point];
+        }
+        // the first grid a point is found in provides its result
+        time_result.assign(no_points, FLT_MAX);
+        int grid;
+        for (grid = 0; grid < grids.size(); ++grid)
+        {
+            if (no_points > 0 && grids[grid]->isType("UNSGRD") && field[grid]->isType("USTSDT"))
+            {
+                // locate all points at once, neighbouring points
+                // of an area usually lie in the same or adjacent cells
+                coDoUnstructuredGrid *p_uns_grid = (coDoUnstructuredGrid *)(grids[grid]);
+                coDoFloat *p_uns_field = (coDoFloat *)(field[grid]);
+                int nume, numv, numc;
+                p_uns_grid->getGridSize(&nume, &numv, &numc);
+                if (numc != p_uns_field->getNumPoints())
+                    continue;
+                float *u;
+                p_uns_field->getAddress(&u);
+                vector<int> cells(no_points, -1);
+                p_uns_grid->getCells(no_points, &coordinates[0], &cells[0], 2.5e-3f);
+                for (point = 0; point < no_points; ++point)
+                {
+                    // the cell found is tested first
+                    if (time_result[point] == FLT_MAX && cells[point] >= 0
+                        && p_uns_grid->interpolateField(&time_result[point], &coordinates[3 * point],
+                                                        &cells[point], 1, 1, 2.5e-3f, &u) != 0)
+                    {
+                        time_result[point] = FLT_MAX;
+                    }
+                }
+                continue;
+            }
+            for (point = 0; point < no_points; ++point)
             {
-                interpolateForAGrid(coordinates, &result, grids[grid], field[grid]);
-                if (result != FLT_MAX)
-                    break;
+                if (time_result[point] == FLT_MAX)
+                    interpolateForAGrid(&coordinates[3 * point], &time_result[point], grids[grid], field[grid]);
             }
-            time_result.push_back(result);
         }
     }
 }
@@ -20,6 +20,7 @@
 // +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 #include "DataFileGoldBin.h"
+#include <alg/coTaskPool.h>
 #include <util/byteswap.h>
 
 //
@@ -57,179 +58,215 @@ DataFileGoldBin::DataFileGoldBin(const coModule *mod,
     }
 }
 
+DataFileGoldBin::DataFileGoldBin(const DataFileGoldBin &master, const uint64_t &offset)
+    : EnFile(master.module_, master.binType_)
+    , lineCnt_(0)
+    , numVals_(master.numVals_)
+    , indexMap_(NULL)
+    , actPartIndex_(0)
+{
+    className_ = string("DataFileGoldBin");
+    shareMapping(master, offset);
+    partList_ = master.partList_;
+}
+
 void
-DataFileGoldBin::readCells()
+DataFileGoldBin::setMappedReading(const bool &b)
 {
-    if (isOpen_)
+    if (b && !mapped_)
+        mapFile();
+}
+
+EnPart *
+DataFileGoldBin::beginCellPart(int &actPartNr)
+{
+    // part line found   -- we skip it for the moment --
+    // length of "part" +1
+    actPartNr = getInt();
+
+    if (actPartNr > 10000 || actPartNr < 0)
     {
-        // 1 lines decription - ignore it
-        getStr();
-        size_t id(0);
-        int actPartNr;
-        EnPart *actPart(NULL);
-        int eleCnt2d = 0, eleCnt3d = 0;
+        byteSwap_ = !byteSwap_;
+        byteSwap(actPartNr);
+    }
+    EnPart *actPart = findPart(actPartNr);
+    // allocate memory for whole parts
+    if (actPart != NULL)
+    {
+        if (actPart->isActive())
+        {
+            switch (dim_)
+            {
+            case 1:
+                // create mem for 2d/3d data
+                // we allocate one element more in order to have a valid field
+                // even if actPart->numEleRead?? is zero
+                actPart->d2dx_ = new float[actPart->numEleRead2d() + 1];
+                actPart->d2dy_ = NULL;
+                actPart->d2dz_ = NULL;
+                actPart->d3dx_ = new float[actPart->numEleRead3d() + 1];
+                actPart->d3dy_ = NULL;
+                actPart->d3dz_ = NULL;
+                break;
+            case 3:
+                actPart->d2dx_ = new float[actPart->numEleRead2d() + 1];
+                actPart->d2dy_ = new float[actPart->numEleRead2d() + 1];
+                actPart->d2dz_ = new float[actPart->numEleRead2d() + 1];
+                actPart->d3dx_ = new float[actPart->numEleRead3d() + 1];
+                actPart->d3dy_ = new float[actPart->numEleRead3d() + 1];
+                actPart->d3dz_ = new float[actPart->numEleRead3d() + 1];
+                break;
+            }
+            // 			cerr << "DataFileGoldBin::readCells() actPart->d2dx_ " << actPart->d2dx_;
+            // 			cerr << " PART " << actPartNr << endl;
+            // 			cerr << "actPart->d3dx_ " << actPart->d3dx_;
+            // 			cerr << " PART " << actPartNr << endl;
+        }
+        else
+        {
+            actPart->d2dx_ = NULL;
+            actPart->d2dy_ = NULL;
+            actPart->d2dz_ = NULL;
+            actPart->d3dx_ = NULL;
+            actPart->d3dy_ = NULL;
+            actPart->d3dz_ = NULL;
+        }
+    }
+    return actPart;
+}
 
-        while (!feof(in_))
+void
+DataFileGoldBin::readCellElement(EnPart *actPart, const string &line, int &eleCnt2d, int &eleCnt3d)
+{
+    string elementType(strip(line));
+    EnElement elem(elementType);
+    int anzEle(0);
+    // we have a valid ENSIGHT element
+    if (elem.valid())
+    {
+        anzEle = actPart->getElementNum(elementType);
+        //cerr << "DataFileGoldBin::readCells() " << anzEle << " for " << elementType  << endl;
+        EnElement thisEle = actPart->findElement(elementType);
+        vector<int> bl(thisEle.getBlacklist());
+        if (thisEle.getBlacklist().size() != anzEle)
         {
-            string tmp(getStr());
+            //cerr << "DataFileGoldBin::readCells( ) blacklist size problem " << bl.size() << endl;
+        }
 
-            id = tmp.find("part");
-            if (id != string::npos)
+        int i;
+        float *tArr1 = NULL, *tArr2 = NULL, *tArr3 = NULL;
+        switch (dim_)
+        {
+        case 1:
+            tArr1 = new float[anzEle];
+            // scalar data
+            getFloatArr(anzEle, tArr1);
+            if (thisEle.getDim() == EnElement::D2)
             {
-                // part line found   -- we skip it for the moment --
-                // length of "part" +1
-                actPartNr = getInt();
-
-                if (actPartNr > 10000 || actPartNr < 0)
+                for (i = 0; i < anzEle; ++i)
                 {
-                    byteSwap_ = !byteSwap_;
-                    byteSwap(actPartNr);
-                }
-                actPart = NULL;
-                actPart = findPart(actPartNr);
-                // allocate memory for whole parts
-                if (actPart != NULL)
-                {
-                    if (actPart->isActive())
+                    if (bl[i] > 0)
                     {
-                        eleCnt2d = 0;
-                        eleCnt3d = 0;
-                        switch (dim_)
-                        {
-                        case 1:
-                            // create mem for 2d/3d data
-                            // we allocate one element more in order to have a valid field
-                            // even if actPart->numEleRead?? is zero
-                            actPart->d2dx_ = new float[actPart->numEleRead2d() + 1];
-                            actPart->d2dy_ = NULL;
-                            actPart->d2dz_ = NULL;
-                            actPart->d3dx_ = new float[actPart->numEleRead3d() + 1];
-                            actPart->d3dy_ = NULL;
-                            actPart->d3dz_ = NULL;
-                            break;
-                        case 3:
-                            actPart->d2dx_ = new float[actPart->numEleRead2d() + 1];
-                            actPart->d2dy_ = new float[actPart->numEleRead2d() + 1];
-                            actPart->d2dz_ = new float[actPart->numEleRead2d() + 1];
-                            actPart->d3dx_ = new float[actPart->numEleRead3d() + 1];
-                            actPart->d3dy_ = new float[actPart->numEleRead3d() + 1];
-                            actPart->d3dz_ = new float[actPart->numEleRead3d() + 1];
-                            break;
-                        }
-                        // 			cerr << "DataFileGoldBin::readCells() actPart->d2dx_ " << actPart->d2dx_;
-                        // 			cerr << " PART " << actPartNr << endl;
-                        // 			cerr << "actPart->d3dx_ " << actPart->d3dx_;
-                        // 			cerr << " PART " << actPartNr << endl;
+                        actPart->d2dx_[eleCnt2d] = tArr1[i];
+                        ++eleCnt2d;
                     }
-                    else
+                }
+            }
+            else if (thisEle.getDim() == EnElement::D3)
+            {
+                for (i = 0; i < anzEle; ++i)
+                {
+                    if (bl[i] > 0)
                     {
-                        actPart->d2dx_ = NULL;
-                        actPart->d2dy_ = NULL;
-                        actPart->d2dz_ = NULL;
-                        actPart->d3dx_ = NULL;
-                        actPart->d3dy_ = NULL;
-                        actPart->d3dz_ = NULL;
+                        actPart->d3dx_[eleCnt3d] = tArr1[i];
+                        ++eleCnt3d;
                     }
                 }
             }
+            // 			cerr << " EleCnt2d: " << eleCnt2d;
+            // 			cerr << " ACT-PART numEleRead2d " <<  actPart->numEleRead2d();
+            // 			cerr << endl;
 
-            if ((actPart != NULL) && (actPart->isActive()))
+            // 			cerr << " EleCnt3d: " << eleCnt3d;
+            // 			cerr << " ACT-PART numEleRead3d " <<  actPart->numEleRead3d();
+            // 			cerr << endl;
+            delete[] tArr1;
+            break;
+        case 3:
+            tArr1 = new float[anzEle];
+            tArr2 = new float[anzEle];
+            tArr3 = new float[anzEle];
+            // 3-dim vector data
+            getFloatArr(anzEle, tArr1);
+            getFloatArr(anzEle, tArr2);
+            getFloatArr(anzEle, tArr3);
+            if (thisEle.getDim() == EnElement::D2)
             {
-                string elementType(strip(tmp));
-                EnElement elem(elementType);
-                int anzEle(0);
-                // we have a valid ENSIGHT element
-                if (elem.valid())
+                for (i = 0; i < anzEle; ++i)
                 {
-                    anzEle = actPart->getElementNum(elementType);
-                    //cerr << "DataFileGoldBin::readCells() " << anzEle << " for " << elementType  << endl;
-                    EnElement thisEle = actPart->findElement(elementType);
-                    vector<int> bl(thisEle.getBlacklist());
-                    if (thisEle.getBlacklist().size() != anzEle)
+                    if (bl[i] > 0)
                     {
-                        //cerr << "DataFileGoldBin::readCells( ) blacklist size problem " << bl.size() << endl;
+                        actPart->d2dx_[eleCnt2d] = tArr1[i];
+                        actPart->d2dy_[eleCnt2d] = tArr2[i];
+                        actPart->d2dz_[eleCnt2d] = tArr3[i];
+                        ++eleCnt2d;
                     }
-
-                    int i;
-                    float *tArr1 = NULL, *tArr2 = NULL, *tArr3 = NULL;
-                    switch (dim_)
+                }
+            }
+            else if (thisEle.getDim() == EnElement::D3)
+            {
+                for (i = 0; i < anzEle; ++i)
+                {
+                    if (bl[i] > 0)
                     {
-                    case 1:
-                        tArr1 = new float[anzEle];
-                        // scalar data
-                        getFloatArr(anzEle, tArr1);
-                        if (thisEle.getDim() == EnElement::D2)
-                        {
-                            for (i = 0; i < anzEle; ++i)
-                            {
-                                if (bl[i] > 0)
-                                {
-                                    actPart->d2dx_[eleCnt2d] = tArr1[i];
-                                    ++eleCnt2d;
-                                }
-                            }
-                        }
-                        else if (thisEle.getDim() == EnElement::D3)
-                        {
-                            for (i = 0; i < anzEle; ++i)
-                            {
-                                if (bl[i] > 0)
-                                {
-                                    actPart->d3dx_[eleCnt3d] = tArr1[i];
-                                    ++eleCnt3d;
-                                }
-                            }
-                        }
-                        // 			cerr << " EleCnt2d: " << eleCnt2d;
-                        // 			cerr << " ACT-PART numEleRead2d " <<  actPart->numEleRead2d();
-                        // 			cerr << endl;
-
-                        // 			cerr << " EleCnt3d: " << eleCnt3d;
-                        // 			cerr << " ACT-PART numEleRead3d " <<  actPart->numEleRead3d();
-                        // 			cerr << endl;
-                        delete[] tArr1;
-                        break;
-                    case 3:
-                        tArr1 = new float[anzEle];
-                        tArr2 = new float[anzEle];
-                        tArr3 = new float[anzEle];
-                        // 3-dim vector data
-                        getFloatArr(anzEle, tArr1);
-                        getFloatArr(anzEle, tArr2);
-                        getFloatArr(anzEle, tArr3);
-                        if (thisEle.getDim() == EnElement::D2)
-                        {
-                            for (i = 0; i < anzEle; ++i)
-                            {
-                                if (bl[i] > 0)
-                                {
-                                    actPart->d2dx_[eleCnt2d] = tArr1[i];
-                                    actPart->d2dy_[eleCnt2d] = tArr2[i];
-                                    actPart->d2dz_[eleCnt2d] = tArr3[i];
-                                    ++eleCnt2d;
-                                }
-                            }
-                        }
-                        else if (thisEle.getDim() == EnElement::D3)
-                        {
-                            for (i = 0; i < anzEle; ++i)
-                            {
-                                if (bl[i] > 0)
-                                {
-                                    actPart->d3dx_[eleCnt3d] = tArr1[i];
-                                    actPart->d3dy_[eleCnt3d] = tArr2[i];
-                                    actPart->d3dz_[eleCnt3d] = tArr3[i];
-                                    ++eleCnt3d;
-                                }
-                            }
-                        }
-                        delete[] tArr1;
-                        delete[] tArr2;
-                        delete[] tArr3;
-                        break;
+                        actPart->d3dx_[eleCnt3d] = tArr1[i];
+                        actPart->d3dy_[eleCnt3d] = tArr2[i];
+                        actPart->d3dz_[eleCnt3d] = tArr3[i];
+                        ++eleCnt3d;
                     }
-                } // if( elem.valid()
+                }
+            }
+            delete[] tArr1;
+            delete[] tArr2;
+            delete[] tArr3;
+            break;
+        }
+    } // if( elem.valid()
+}
+
+void
+DataFileGoldBin::readCells()
+{
+    if (mapped_)
+    {
+        readMapped(true);
+        return;
+    }
+
+    if (isOpen_)
+    {
+        // 1 lines decription - ignore it
+        getStr();
+        size_t id(0);
+        int actPartNr;
+        EnPart *actPart(NULL);
+        int eleCnt2d = 0, eleCnt3d = 0;
 
+        while (!atEnd())
+        {
+            string tmp(getStr());
+
+            id = tmp.find("part");
+            if (id != string::npos)
+            {
+                actPart = beginCellPart(actPartNr);
+                eleCnt2d = 0;
+                eleCnt3d = 0;
+            }
+
+            if ((actPart != NULL) && (actPart->isActive()))
+            {
+                readCellElement(actPart, tmp, eleCnt2d, eleCnt3d);
             } // if ( actPart->isActive()
             // the part was not read during the geometry sweep
             else
@@ -249,7 +286,7 @@ DataFileGoldBin::readCells()
 
                 int numParts = currPart.getNumEle();
                 // skip data
-                while ((!feof(in_)) && (numParts > 0))
+                while ((!atEnd()) && (numParts > 0))
                 {
                     tmp = getStr();
                     string elementType(strip(tmp));
@@ -280,21 +317,116 @@ DataFileGoldBin::readCells()
     }
 }
 
+void
+DataFileGoldBin::readPartValues()
+{
+    float *arr1 = NULL, *arr2 = NULL, *arr3 = NULL;
+    int numVal(0);
+    size_t id(0);
+
+    // part line found   -- we skip it for the moment --
+    int actPartNr = getInt();
+    if (actPartNr > 10000 || actPartNr < 0)
+    {
+        byteSwap_ = !byteSwap_;
+        byteSwap(actPartNr);
+    }
+    // cerr << "DataFileGoldBin::read( ) part " <<  actPartNr << endl;
+    EnPart *actPart = findPart(actPartNr);
+
+    // allocate memory for whole parts
+    if (actPart != NULL)
+    {
+        numVal = actPart->numCoords();
+        if (actPart->isActive())
+        {
+            switch (dim_)
+            {
+            case 1:
+                //cerr << "DataFileGoldBin::read() allocate 1-dim arr" << endl;
+                arr1 = new float[numVal];
+                // if pointer is not copied sometimes: free data here
+                if (actPart->arr1_ != NULL)
+                    delete[] actPart -> arr1_;
+                actPart->arr1_ = arr1;
+                break;
+            case 3:
+                //cerr << "DataFileGoldBin::read() allocate 3-dim arr" << endl;
+                arr1 = new float[numVal];
+                arr2 = new float[numVal];
+                arr3 = new float[numVal];
+
+                actPart->arr1_ = arr1;
+                actPart->arr2_ = arr2;
+                actPart->arr3_ = arr3;
+                break;
+            }
+        }
+    }
+    else // Actually, actPart should never be NULL since all (even deactivated) parts were added to the partList.
+    {
+        EnPart altPart = findMasterPart(actPartNr);
+        if (altPart.getPartNum() > 0)
+            numVal = altPart.numCoords();
+        else
+            cerr << "DataFileGoldBin::read() part with number " << actPartNr << "was not found in the master-part-list" << endl << "serious ERROR" << endl;
+    }
+
+    string tmp = getStr();
+    id = tmp.find("coordinates");
+    if (id != string::npos)
+    {
+        if ((actPart != NULL) && (actPart->isActive()))
+        {
+            // coordinates -line
+            switch (dim_)
+            {
+            case 1:
+                //cerr << "DataFileGoldBin::read()  reading scalar data" << endl;
+                getFloatArr(numVal, arr1);
+                break;
+            case 3:
+                getFloatArr(numVal, arr1);
+                getFloatArr(numVal, arr2);
+                getFloatArr(numVal, arr3);
+                break;
+            }
+        }
+        else
+        {
+            switch (dim_)
+            {
+            case 1:
+                skipFloat(numVal);
+                break;
+            case 3:
+                skipFloat(numVal);
+                skipFloat(numVal);
+                skipFloat(numVal);
+                break;
+            }
+        }
+    }
+}
+
 //
 // Method
 //
 void
 DataFileGoldBin::read()
 {
+    if (mapped_)
+    {
+        readMapped(false);
+        return;
+    }
+
     if (isOpen_)
     {
         size_t id(0);
-        int actPartNr;
 
-        while (!feof(in_))
+        while (!atEnd())
         {
-            float *arr1 = NULL, *arr2 = NULL, *arr3 = NULL;
-            int numVal;
             string tmp(getStr());
             // we only read the first time step
             if (tmp.find("END TIME STEP") != string::npos)
@@ -305,98 +437,132 @@ DataFileGoldBin::read()
             {
                 tmp = getStr();
             }
-            EnPart *actPart = NULL;
             // we found a part line
             id = tmp.find("part");
             if (id != string::npos)
             {
-                // part line found   -- we skip it for the moment --
-                actPartNr = getInt();
-                if (actPartNr > 10000 || actPartNr < 0)
-                {
-                    byteSwap_ = !byteSwap_;
-                    byteSwap(actPartNr);
-                }
-                // cerr << "DataFileGoldBin::read( ) part " <<  actPartNr << endl;
-                actPart = findPart(actPartNr);
+                readPartValues();
+            }
+        }
+    }
+    //buildParts(true);
+}
 
-                // allocate memory for whole parts
-                if (actPart != NULL)
-                {
-                    numVal = actPart->numCoords();
-                    if (actPart->isActive())
-                    {
-                        switch (dim_)
-                        {
-                        case 1:
-                            //cerr << "DataFileGoldBin::read() allocate 1-dim arr" << endl;
-                            arr1 = new float[numVal];
-                            // if pointer is not copied sometimes: free data here
-                            if (actPart->arr1_ != NULL)
-                                delete[] actPart -> arr1_;
-                            actPart->arr1_ = arr1;
-                            break;
-                        case 3:
-                            //cerr << "DataFileGoldBin::read() allocate 3-dim arr" << endl;
-                            arr1 = new float[numVal];
-                            arr2 = new float[numVal];
-                            arr3 = new float[numVal];
-
-                            actPart->arr1_ = arr1;
-                            actPart->arr2_ = arr2;
-                            actPart->arr3_ = arr3;
-                            break;
-                        }
-                    }
-                }
-                else // Actually, actPart should never be NULL since all (even deactivated) parts were added to the partList.
-                {
-                    EnPart altPart = findMasterPart(actPartNr);
-                    if (altPart.getPartNum() > 0)
-                        numVal = altPart.numCoords();
-                    else
-                        cerr << "DataFileGoldBin::read() part with number " << actPartNr << "was not found in the master-part-list" << endl << "serious ERROR" << endl;
-                }
+// parts decoded concurrently
+struct DataFileGoldBin::PartJob
+{
+    const DataFileGoldBin *master;
+    bool cells;
+    vector<uint64_t> offsets;
+};
 
-                tmp = getStr();
-                id = tmp.find("coordinates");
-                if (id != string::npos)
+void
+DataFileGoldBin::decodeParts(void *data, int begin, int end, int /*thread*/)
+{
+    PartJob *job = static_cast<PartJob *>(data);
+    for (int i = begin; i < end; ++i)
+    {
+        DataFileGoldBin reader(*job->master, job->offsets[i]);
+        // part line
+        reader.getStr();
+        if (!job->cells)
+        {
+            reader.readPartValues();
+            continue;
+        }
+
+        int actPartNr;
+        EnPart *actPart = reader.beginCellPart(actPartNr);
+        if ((actPart == NULL) || !actPart->isActive())
+            continue;
+        int eleCnt2d = 0, eleCnt3d = 0;
+        while (!reader.atEnd())
+        {
+            string tmp(reader.getStr());
+            if (reader.atEnd() || tmp.find("part") != string::npos)
+                break;
+            reader.readCellElement(actPart, tmp, eleCnt2d, eleCnt3d);
+        }
+    }
+}
+
+//
+// read method for mapped files: the parts are found by the part index and
+// decoded concurrently, each into the arrays of its own part
+//
+void
+DataFileGoldBin::readMapped(const bool &cells)
+{
+    if (partList_ == NULL)
+        return;
+
+    // 1 lines decription - ignore it
+    getStr();
+
+    EnPartIndex index;
+    if (!EnPartIndex::lookup(*mapped_, index))
+    {
+        indexParts(index, cells);
+        EnPartIndex::store(*mapped_, index);
+    }
+    byteSwap_ = index.byteSwap_;
+
+    PartJob job;
+    job.master = this;
+    job.cells = cells;
+    for (size_t i = 0; i < index.size(); ++i)
+    {
+        // inactive parts are not read at all
+        EnPart *part = findPart(index.partNum(i));
+        if (part != NULL && part->isActive())
+            job.offsets.push_back(index.offset(i));
+    }
+    coTaskPool::shared()->run(job.offsets.size(), 1, decodeParts, &job);
+}
+
+void
+DataFileGoldBin::indexParts(EnPartIndex &index, const bool &cells)
+{
+    while (!atEnd())
+    {
+        uint64_t offset(tell());
+        string tmp(getStr());
+        if (atEnd() || tmp.find("END TIME STEP") != string::npos)
+            break;
+        if (tmp.find("part") == string::npos)
+            continue;
+        int actPartNr = getInt();
+        if (actPartNr > 10000 || actPartNr < 0)
+        {
+            byteSwap_ = !byteSwap_;
+            byteSwap(actPartNr);
+        }
+        index.add(actPartNr, offset);
+
+        EnPart *actPart = findPart(actPartNr);
+        EnPart currPart(actPart != NULL ? *actPart : findMasterPart(actPartNr));
+        if (!cells)
+        {
+            // coordinates line
+            getStr();
+            for (int d = 0; d < dim_; ++d)
+                skipFloat(currPart.numCoords());
+        }
+        else
+        {
+            for (int numParts = currPart.getNumEle(); numParts > 0 && !atEnd(); numParts--)
+            {
+                string elementType(strip(getStr()));
+                EnElement elem(elementType);
+                if (elem.valid())
                 {
-                    if ((actPart != NULL) && (actPart->isActive()))
-                    {
-                        // coordinates -line
-                        switch (dim_)
-                        {
-                        case 1:
-                            //cerr << "DataFileGoldBin::read()  reading scalar data" << endl;
-                            getFloatArr(numVal, arr1);
-                            break;
-                        case 3:
-                            getFloatArr(numVal, arr1);
-                            getFloatArr(numVal, arr2);
-                            getFloatArr(numVal, arr3);
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        switch (dim_)
-                        {
-                        case 1:
-                            skipFloat(numVal);
-                            break;
-                        case 3:
-                            skipFloat(numVal);
-                            skipFloat(numVal);
-                            skipFloat(numVal);
-                            break;
-                        }
-                    }
+                    for (int d = 0; d < dim_; ++d)
+                        skipFloat(currPart.getElementNum(elementType));
                 }
             }
         }
     }
-    //buildParts(true);
+    index.byteSwap_ = byteSwap_;
 }
 
 //
@@ -39,10 +39,36 @@ public:
 
     void readCells();
 
+    // map the file, read() and readCells() then decode the parts concurrently
+    void setMappedReading(const bool &b);
+
     /// DESTRUCTOR
     ~DataFileGoldBin();
 
 private:
+    // reader for the part at offset of the file mapped by master
+    DataFileGoldBin(const DataFileGoldBin &master, const uint64_t &offset);
+
+    // read the values of the part whose part line has just been read
+    void readPartValues();
+
+    // read the part number following a part line and allocate the
+    // cell data of the part, returns the part or NULL
+    EnPart *beginCellPart(int &partNr);
+
+    // read the cell data of one element type of part
+    void readCellElement(EnPart *actPart, const string &line, int &eleCnt2d, int &eleCnt3d);
+
+    // read all parts from the mapped file
+    void readMapped(const bool &cells);
+
+    // find the offsets of all parts of the mapped file
+    void indexParts(EnPartIndex &index, const bool &cells);
+
+    // decode the parts begin ... end-1 of a PartJob
+    struct PartJob;
+    static void decodeParts(void *data, int begin, int end, int thread);
+
     int lineCnt_; // actual linecount
     int numVals_; // number of values
     int *indexMap_; // may contain indexMap
@@ -142,6 +142,7 @@ EnFile::EnFile(const coModule *mod, const BinType &binType)
     : fileMayBeCorrupt_(false)
     , className_(string("EnFile"))
     , isOpen_(false)
+    , in_(NULL)
     , binType_(binType)
     , byteSwap_(false)
     , partList_(NULL)
@@ -149,6 +150,9 @@ EnFile::EnFile(const coModule *mod, const BinType &binType)
     , activeAlloc_(true)
     , dataByteSwap_(false)
     , module_(mod)
+    , mapPos_(0)
+    , mapEof_(false)
+    , deferredInfo_(NULL)
 {
 }
 
@@ -156,6 +160,7 @@ EnFile::EnFile(const coModule *mod, const string &name, const int &dim, const Bi
     : fileMayBeCorrupt_(false)
     , className_(string("EnFile"))
     , isOpen_(false)
+    , in_(NULL)
     , binType_(binType)
     , byteSwap_(false)
     , partList_(NULL)
@@ -163,6 +168,9 @@ EnFile::EnFile(const coModule *mod, const string &name, const int &dim, const Bi
     , activeAlloc_(true)
     , dataByteSwap_(false)
     , module_(mod)
+    , mapPos_(0)
+    , mapEof_(false)
+    , deferredInfo_(NULL)
     , name_(name)
 {
     if (binType != FBIN && binType != CBIN)
@@ -192,12 +200,16 @@ EnFile::EnFile(const coModule *mod, const string &name, const BinType &binType)
     : fileMayBeCorrupt_(false)
     , className_(string("EnFile"))
     , isOpen_(false)
+    , in_(NULL)
     , binType_(binType)
     , byteSwap_(false)
     , partList_(NULL)
     , dim_(1)
     , activeAlloc_(true)
     , module_(mod)
+    , mapPos_(0)
+    , mapEof_(false)
+    , deferredInfo_(NULL)
     , name_(name)
 {
 
@@ -309,10 +321,117 @@ EnFile::getDataCont() const
 
 EnFile::~EnFile()
 {
-    if (isOpen_)
+    if (isOpen_ && in_)
         fclose(in_);
 }
 
+void
+EnFile::setMappedReading(const bool & /*b*/)
+{
+    // only Ensight Gold binary files are read from memory
+}
+
+bool
+EnFile::mapFile()
+{
+    if (!isOpen_ || !in_ || (binType_ != CBIN && binType_ != FBIN))
+        return false;
+    mapped_ = EnMappedFile::map(name_);
+    if (!mapped_)
+    {
+        cerr << className_ << "::mapFile() could not map " << name_ << " - reading it with stdio" << endl;
+        return false;
+    }
+    mapPos_ = ftell(in_);
+    mapEof_ = false;
+    return true;
+}
+
+void
+EnFile::shareMapping(const EnFile &master, const uint64_t &offset)
+{
+    mapped_ = master.mapped_;
+    mapPos_ = offset;
+    mapEof_ = false;
+    isOpen_ = true;
+    binType_ = master.binType_;
+    byteSwap_ = master.byteSwap_;
+    nodeId_ = master.nodeId_;
+    elementId_ = master.elementId_;
+    dim_ = master.dim_;
+    dataByteSwap_ = master.dataByteSwap_;
+    includePolyeder_ = master.includePolyeder_;
+    name_ = master.name_;
+}
+
+size_t
+EnFile::readRaw(void *buf, const size_t &size, const size_t &n)
+{
+    if (!mapped_)
+        return fread(buf, size, n, in_);
+
+    uint64_t avail(mapped_->size() - mapPos_);
+    uint64_t len(uint64_t(size) * n);
+    if (len > avail)
+    {
+        len = avail;
+        mapEof_ = true;
+    }
+    memcpy(buf, mapped_->data() + mapPos_, len);
+    mapPos_ += len;
+    return size > 0 ? len / size : 0;
+}
+
+void
+EnFile::seekCur(const int64_t &off)
+{
+    if (!mapped_)
+    {
+#ifdef WIN32
+        _fseeki64(in_, off, SEEK_CUR);
+#else
+        fseeko(in_, off, SEEK_CUR);
+#endif
+        return;
+    }
+    if (off < 0 && uint64_t(-off) > mapPos_)
+        mapPos_ = 0;
+    else
+        mapPos_ += off;
+    if (mapPos_ > mapped_->size())
+        mapPos_ = mapped_->size();
+    mapEof_ = false;
+}
+
+uint64_t
+EnFile::tell()
+{
+    if (mapped_)
+        return mapPos_;
+#ifdef WIN32
+    return _ftelli64(in_);
+#else
+    return ftello(in_);
+#endif
+}
+
+bool
+EnFile::atEnd()
+{
+    if (mapped_)
+        return mapEof_;
+    return feof(in_) != 0;
+}
+
+void
+EnFile::info(const string &msg)
+{
+    if (deferredInfo_)
+        deferredInfo_->push_back(msg);
+    else
+        coModule::sendInfo("%s", msg.c_str());
+}
+
 // helper skip n floats or doubles
 void
 EnFile::skipFloat(const int &n)
@@ -321,11 +440,7 @@ EnFile::skipFloat(const int &n)
     { // check for block markers
         int ilen(getIntRaw());
 
-#ifdef WIN32
-        _fseeki64(in_, ilen, SEEK_CUR);
-#else
-        fseek(in_, ilen, SEEK_CUR);
-#endif
+        seekCur(ilen);
 
         int olen(getIntRaw());
         if ((ilen != olen))
@@ -340,11 +455,7 @@ EnFile::skipFloat(const int &n)
     // Read floats up to 4GB
     else
     {
-#ifdef WIN32
-        _fseeki64(in_, n * sizeof(float), SEEK_CUR);
-#else
-        fseek(in_, n * sizeof(float), SEEK_CUR);
-#endif
+        seekCur(int64_t(n) * sizeof(float));
     }
 }
 
@@ -355,11 +466,7 @@ EnFile::skipInt(const int &n)
     if (binType_ == EnFile::FBIN)
     { // check for block markers
         int ilen(getIntRaw());
-#ifdef WIN32
-        _fseeki64(in_, n * 4, SEEK_CUR);
-#else
-        fseek(in_, n * 4, SEEK_CUR);
-#endif
+        seekCur(int64_t(n) * 4);
 
         int olen(getIntRaw());
         if ((ilen != olen) || (ilen != n * 4))
@@ -372,11 +479,7 @@ EnFile::skipInt(const int &n)
     }
     else
     {
-#ifdef WIN32
-        _fseeki64(in_, n * sizeof(int), SEEK_CUR);
-#else
-        fseek(in_, n * sizeof(int), SEEK_CUR);
-#endif
+        seekCur(int64_t(n) * sizeof(int));
     }
 }
 
@@ -393,7 +496,7 @@ EnFile::getStr()
     if (binType_ == EnFile::FBIN)
     {
         int ilen(getIntRaw());
-        if (feof(in_))
+        if (atEnd())
         {
             //end of file reached
             return ret;
@@ -425,8 +528,8 @@ EnFile::getStr()
             cerr << "ERROR: EnFile::getStr(): not a fortran string of length 80" << endl;
             return ret;
         }
-        fread(buf, strLen, 1, in_);
-        if (feof(in_))
+        readRaw(buf, strLen, 1);
+        if (atEnd())
         {
 #ifdef WIN32
             DebugBreak();
@@ -446,10 +549,8 @@ EnFile::getStr()
     }
     else
     {
-        for (int i = 0; i < strLen; ++i)
-        {
-            buf[i] = fgetc(in_);
-        }
+        memset(buf, 0, strLen);
+        readRaw(buf, 1, strLen);
     }
 
     buf[79] = '\0';
@@ -478,7 +579,7 @@ int
 EnFile::getIntRaw()
 {
     int ret = 0;
-    fread(&ret, 4, 1, in_); // read a 4 byte integer
+    readRaw(&ret, 4, 1); // read a 4 byte integer
     if (byteSwap_)
     {
         byteSwap(ret);
@@ -499,7 +600,7 @@ EnFile::getIntArr(const int &n, int *iarr)
             int ilen(getIntRaw());
             getIntArrHelper(n, iarr);
             int olen(getIntRaw());
-            if ((ilen != olen) && (!feof(in_)))
+            if ((ilen != olen) && (!atEnd()))
             {
 #ifdef WIN32
                 DebugBreak();
@@ -541,17 +642,16 @@ EnFile::getIntArrHelper(const int &n, int *iarr)
     ////////////////////////////
 
     const int len(sizeof(int));
-    char *buf = new char[n * len];
+    if (iarr == NULL)
+    {
+        seekCur(int64_t(n) * len);
+        return;
+    }
 
-    fread(buf, len, n, in_);
+    readRaw(iarr, len, n);
 
     if (byteSwap_)
-        byteSwap((uint32_t *)buf, n);
-
-    if (iarr != NULL)
-        memcpy(iarr, buf, n * len);
-
-    delete[] buf;
+        byteSwap((uint32_t *)iarr, n);
     return;
 }
 
@@ -580,7 +680,6 @@ EnFile::getFloatArr(const int &n, float *farr)
         return NULL;
 
     const int len(sizeof(float));
-    char *buf = new char[n * len];
     bool eightBytePerFloat = false;
 
     if (binType_ == EnFile::FBIN)
@@ -589,33 +688,26 @@ EnFile::getFloatArr(const int &n, float *farr)
         int olen;
 
         // we may have obtained double arrays
-        // unfortionately ifstream.read will read only basic types
-        // otherwise we would have saved one memcpy
-        // There may be more elegant soutions for that.
         if (ilen / n == 8)
         {
             eightBytePerFloat = true;
             double *dummyArr = new double[n];
-            delete[] buf;
-            buf = new char[ilen];
-            fread(buf, 8, n, in_);
+            readRaw(dummyArr, 8, n);
             olen = getIntRaw();
             if (byteSwap_)
-                byteSwap((uint64_t *)buf, n);
-            memcpy(dummyArr, buf, ilen);
+                byteSwap((uint64_t *)dummyArr, n);
             cerr << "got 64-bit floats" << endl;
             int i;
-            if (farr != NULL)
-                for (i = 0; i < n; ++i)
-                    farr[i] = (float)dummyArr[i];
+            for (i = 0; i < n; ++i)
+                farr[i] = (float)dummyArr[i];
             delete[] dummyArr;
         }
         else
         {
-            fread(buf, len, n, in_);
+            readRaw(farr, len, n);
             olen = getIntRaw();
         }
-        if ((ilen != olen) && (!feof(in_)))
+        if ((ilen != olen) && (!atEnd()))
         {
 #ifdef WIN32
             DebugBreak();
@@ -625,17 +717,12 @@ EnFile::getFloatArr(const int &n, float *farr)
     }
     else
     {
-        fread(buf, len, n, in_);
+        readRaw(farr, len, n);
     }
 
-    if (!eightBytePerFloat)
-    {
-        if (byteSwap_)
-            byteSwap((uint32_t *)buf, n);
-        if (farr != NULL)
-            memcpy(farr, buf, n * len);
-    }
-    delete[] buf;
+    // floats are read directly into farr
+    if (!eightBytePerFloat && byteSwap_)
+        byteSwap((uint32_t *)farr, n);
     return NULL;
 }
 
@@ -29,6 +29,7 @@
 #include "EnElement.h"
 #include "EnPart.h"
 #include "CaseFile.h"
+#include "EnMappedFile.h"
 
 namespace covise
 {
@@ -165,6 +166,9 @@ public:
 
     void setDataByteSwap(const bool &v);
     void setIncludePolyeder(const bool &b);
+    // read the file from memory and decode its parts concurrently,
+    // only supported by Ensight Gold binary files
+    virtual void setMappedReading(const bool &b);
     virtual coDistributedObject *getDataObject(std::string)
     {
         return NULL;
@@ -203,6 +207,22 @@ protected:
     // send a list of all parts to covise info
     void sendPartsToInfo();
 
+    // map the file, all following reads are served from memory
+    bool mapFile();
+
+    // read from the same mapping as master starting at offset,
+    // used by readers decoding single parts concurrently
+    void shareMapping(const EnFile &master, const uint64_t &offset);
+
+    // fread, fseek(.., SEEK_CUR), ftell and feof on the file or its mapping
+    size_t readRaw(void *buf, const size_t &size, const size_t &n);
+    void seekCur(const int64_t &off);
+    uint64_t tell();
+    bool atEnd();
+
+    // send info to covise, or collect it if decoding concurrently
+    void info(const string &msg);
+
     string className_;
 
     bool isOpen_;
@@ -233,6 +253,13 @@ protected:
     // pointer to module for sending ui messages
     const coModule *module_;
 
+    std::shared_ptr<EnMappedFile> mapped_;
+    uint64_t mapPos_;
+    bool mapEof_;
+
+    // info of a reader decoding concurrently
+    vector<string> *deferredInfo_;
+
 private:
     string name_;
 
@@ -23,6 +23,7 @@
 #include "EnGoldGeoBIN.h"
 #include "GeoFileAsc.h"
 #include <api/coModule.h>
+#include <alg/coTaskPool.h>
 #include <util/byteswap.h>
 
 #include <vector>
@@ -48,7 +49,7 @@ EnGoldGeoBIN::EnGoldGeoBIN(const coModule *mod)
 }
 
 EnGoldGeoBIN::EnGoldGeoBIN(const coModule *mod, const string &name, EnFile::BinType binType)
-    : EnFile(mod, binType)
+    : EnFile(mod, name, binType)
     , lineCnt_(0)
     , numCoords_(0)
     , indexMap_(NULL)
@@ -60,14 +61,7 @@ EnGoldGeoBIN::EnGoldGeoBIN(const coModule *mod, const string &name, EnFile::BinT
 {
     className_ = string("EnGoldGeoBIN");
 
-#ifdef WIN32
-    in_ = fopen(name.c_str(), "rb");
-#else
-    in_ = fopen(name.c_str(), "r");
-#endif
-    if (in_)
-        isOpen_ = true;
-    else
+    if (!isOpen_)
         cerr << className_ << "::EnGoldGeoBIN(..) open NOT successful" << endl;
 
     //byteSwap_ =  machineIsLittleEndian();
@@ -80,12 +74,42 @@ EnGoldGeoBIN::EnGoldGeoBIN(const coModule *mod, const string &name, EnFile::BinT
 #endif
 }
 
+EnGoldGeoBIN::EnGoldGeoBIN(const EnGoldGeoBIN &master, const uint64_t &offset)
+    : EnFile(master.module_, master.binType_)
+    , lineCnt_(0)
+    , numCoords_(0)
+    , indexMap_(NULL)
+    , maxIndex_(0)
+    , lastNc_(0)
+    , globalCoordIndexOffset_(0)
+    , actPartNumber_(0)
+    , currElementIdx_(0)
+    , currCornerIdx_(0)
+    , partFound(false)
+{
+    className_ = string("EnGoldGeoBIN");
+    shareMapping(master, offset);
+}
+
+void
+EnGoldGeoBIN::setMappedReading(const bool &b)
+{
+    if (b && !mapped_)
+        mapFile();
+}
+
 //
 // thats the gereral read method
 //
 void
 EnGoldGeoBIN::read()
 {
+    if (mapped_)
+    {
+        readMapped();
+        return;
+    }
+
     //cerr << className_ << "::read() called" << endl;
     module_->sendInfo("%s", "start reading parts  -  please be patient..");
     // read header
@@ -139,6 +163,110 @@ EnGoldGeoBIN::read()
     return;
 }
 
+// parts decoded concurrently, in the order of the master part list
+struct EnGoldGeoBIN::PartJob
+{
+    const EnGoldGeoBIN *master;
+    vector<uint64_t> offsets;
+    vector<bool> active;
+    vector<PartList> parts;
+    vector<vector<string> > infos;
+};
+
+void
+EnGoldGeoBIN::decodeParts(void *data, int begin, int end, int /*thread*/)
+{
+    PartJob *job = static_cast<PartJob *>(data);
+    for (int i = begin; i < end; ++i)
+    {
+        EnGoldGeoBIN reader(*job->master, job->offsets[i]);
+        reader.partList_ = &job->parts[i];
+        reader.deferredInfo_ = &job->infos[i];
+        if (job->active[i])
+        {
+            EnPart part;
+            reader.readPart(part);
+            reader.readPartConn(part);
+        }
+        else
+        {
+            reader.skipPart();
+        }
+    }
+}
+
+//
+// read method for mapped files: the parts are found by the part index
+// and decoded concurrently
+//
+void
+EnGoldGeoBIN::readMapped()
+{
+    module_->sendInfo("%s", "start reading parts  -  please be patient..");
+    readHeader();
+    readBB();
+
+    EnPartIndex index;
+    if (!EnPartIndex::lookup(*mapped_, index))
+    {
+        indexParts(index);
+        EnPartIndex::store(*mapped_, index);
+    }
+    byteSwap_ = index.byteSwap_;
+
+    PartJob job;
+    job.master = this;
+    int allPartsToRead(0);
+    PartList::iterator it(masterPL_.begin());
+    for (; it != masterPL_.end(); it++)
+    {
+        uint64_t offset;
+        if (!index.find(it->getPartNum(), offset))
+        {
+            cerr << className_ << "::readMapped() part " << it->getPartNum() << " not found in " << mapped_->name() << endl;
+            continue;
+        }
+        job.offsets.push_back(offset);
+        job.active.push_back(it->isActive());
+        if (it->isActive())
+            allPartsToRead++;
+    }
+    job.parts.resize(job.offsets.size());
+    job.infos.resize(job.offsets.size());
+    coTaskPool::shared()->run(job.offsets.size(), 1, decodeParts, &job);
+
+    for (size_t i = 0; i < job.parts.size(); ++i)
+    {
+        for (size_t j = 0; j < job.infos[i].size(); ++j)
+            module_->sendInfo("%s", job.infos[i][j].c_str());
+        if (partList_ != NULL)
+            partList_->insert(partList_->end(), job.parts[i].begin(), job.parts[i].end());
+    }
+
+    char buf[256];
+    sprintf(buf, "done reading parts  %d parts read", allPartsToRead);
+    module_->sendInfo("%s", buf);
+}
+
+void
+EnGoldGeoBIN::indexParts(EnPartIndex &index)
+{
+    // skipPart adds the parts to the part list, we only want their offsets
+    PartList *partList(partList_);
+    partList_ = NULL;
+    partFound = false;
+    while (!atEnd())
+    {
+        uint64_t offset(tell());
+        int partNum(skipPart());
+        if (partNum < 0)
+            break;
+        index.add(partNum, offset);
+    }
+    partList_ = partList;
+    index.byteSwap_ = byteSwap_;
+}
+
 // get Bounding Box section in ENSIGHT GOLD (only)
 int
 EnGoldGeoBIN::readBB()
@@ -157,19 +285,11 @@ EnGoldGeoBIN::readBB()
         {
             if (binType_ == EnFile::FBIN)
             {
-#ifdef WIN32
-                _fseeki64(in_, -88, SEEK_CUR); // 4 + 80 + 4
-#else
-                fseek(in_, -88, SEEK_CUR); // 4 + 80 + 4
-#endif
+                seekCur(-88); // 4 + 80 + 4
             }
             else
             {
-#ifdef WIN32
-                _fseeki64(in_, -80, SEEK_CUR);
-#else
-                fseek(in_, -80, SEEK_CUR);
-#endif
+                seekCur(-80);
             }
         }
     }
@@ -288,7 +408,7 @@ EnGoldGeoBIN::readPart(EnPart &actPart)
             {
                 if (line.find("block") != string::npos)
                 {
-                    module_->sendInfo("%s", "found structured part - not implemented yet -");
+                    info("found structured part - not implemented yet -");
                     return -1;
                 }
 
@@ -321,8 +441,9 @@ EnGoldGeoBIN::readPart(EnPart &actPart)
                 {
                     fprintf(stderr, "Broken Ensight File!!! ignoring index map\n");
                 }
-                else
+                else if (!deferredInfo_)
                 {
+                    // readers of single parts (deferredInfo_ set) do not need the index map
                     for (i = 0; i < nc; ++i)
                     {
                         fillIndexMap(iMap[i], i);
@@ -395,7 +516,7 @@ EnGoldGeoBIN::readPartConn(EnPart &actPart)
     // we don't know a priori how many Ensight elements we can expect here therefore we have to read
     // until we find a new 'part'
     lastNc_ = 0;
-    while ((!feof(in_)) && (!partFound))
+    while ((!atEnd()) && (!partFound))
     {
         string tmp(getStr());
         if (tmp.find("part") != string::npos)
@@ -654,7 +775,7 @@ EnGoldGeoBIN::readPartConn(EnPart &actPart)
         }
 
         sprintf(buf, " -> found %d fully degenerated cells in part %d", degCells, partNo);
-        module_->sendInfo("%s", buf);
+        info(buf);
     }
 
     return ret;
@@ -688,7 +809,7 @@ EnGoldGeoBIN::parseForParts()
 	}
     int cnt = 0;
     bool validElementFound = false;
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp(getStr());
         int actPartNr;
@@ -899,6 +1020,7 @@ EnGoldGeoBIN::skipPart()
     EnPart actPart;
     actPart.activate(false);
 
+    int pn(-1);
     size_t id;
     string line;
     if (!partFound)
@@ -909,7 +1031,7 @@ EnGoldGeoBIN::skipPart()
     {
         // part line found
         // get part number
-        int pn = getInt();
+        pn = getInt();
         if (pn > 10000 || pn < 0)
         {
             byteSwap_ = !byteSwap_;
@@ -948,7 +1070,7 @@ EnGoldGeoBIN::skipPart()
     }
     // scan for element type
 
-    while (!feof(in_))
+    while (!atEnd())
     {
         string tmp(getStr());
 
@@ -962,22 +1084,14 @@ EnGoldGeoBIN::skipPart()
                 partList_->push_back(actPart);
             if (binType_ == EnFile::FBIN)
             {
-#ifdef WIN32
-                _fseeki64(in_, -88L, SEEK_CUR);
-#else
-                fseek(in_, -88L, SEEK_CUR);
-#endif
+                seekCur(-88);
             }
             else
             {
-#ifdef WIN32
-                _fseeki64(in_, -80L, SEEK_CUR);
-#else
-                fseek(in_, -80L, SEEK_CUR);
-#endif
+                seekCur(-80);
             }
             partFound = false; // read part string again next time;
-            return 0;
+            return pn;
         }
 
         string elementType(strip(tmp));
@@ -1020,7 +1134,7 @@ EnGoldGeoBIN::skipPart()
     if (partList_ != NULL)
         partList_->push_back(actPart);
 
-    return 0;
+    return pn;
 }
 
 void
@@ -40,10 +40,26 @@ public:
     // get part info
     void parseForParts();
 
+    // map the file, read() then decodes the parts concurrently
+    void setMappedReading(const bool &b);
+
     /// DESTRUCTOR
     ~EnGoldGeoBIN();
 
 private:
+    // reader for the part at offset of the file mapped by master
+    EnGoldGeoBIN(const EnGoldGeoBIN &master, const uint64_t &offset);
+
+    // read all parts of the master part list from the mapped file
+    void readMapped();
+
+    // find the offsets of all parts of the mapped file
+    void indexParts(EnPartIndex &index);
+
+    // decode the parts begin ... end-1 of a PartJob
+    struct PartJob;
+    static void decodeParts(void *data, int begin, int end, int thread);
+
     int allocateMemory();
 
     // read header
@@ -58,7 +74,7 @@ private:
     // read bounding box (ENSIGHT Gold)
     int readBB();
 
-    // skip part
+    // skip part, returns its part number or -1 if there is none
     int skipPart();
 
     // redundant find a slution must go into base-class
@@ -0,0 +1,163 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// ++ Description:                                                        ++
+// ++             Implementation of class       EnMappedFile              ++
+// ++                                           EnPartIndex               ++
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include "EnMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+EnMappedFile::EnMappedFile()
+    : data_(NULL)
+    , size_(0)
+    , mtime_(0)
+#ifdef _WIN32
+    , mapping_(NULL)
+#endif
+{
+}
+
+EnMappedFile::~EnMappedFile()
+{
+#ifdef _WIN32
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+#else
+    if (data_)
+        munmap(const_cast<char *>(data_), size_);
+#endif
+}
+
+std::shared_ptr<EnMappedFile>
+EnMappedFile::map(const string &name)
+{
+    std::shared_ptr<EnMappedFile> file(new EnMappedFile);
+    file->name_ = name;
+#ifdef _WIN32
+    HANDLE fh = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE)
+        return std::shared_ptr<EnMappedFile>();
+    LARGE_INTEGER size;
+    FILETIME mtime;
+    if (!GetFileSizeEx(fh, &size) || !GetFileTime(fh, NULL, NULL, &mtime) || size.QuadPart == 0)
+    {
+        CloseHandle(fh);
+        return std::shared_ptr<EnMappedFile>();
+    }
+    file->size_ = size.QuadPart;
+    file->mtime_ = (int64_t(mtime.dwHighDateTime) << 32) | mtime.dwLowDateTime;
+    file->mapping_ = CreateFileMapping(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(fh);
+    if (!file->mapping_)
+        return std::shared_ptr<EnMappedFile>();
+    file->data_ = static_cast<const char *>(MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!file->data_)
+        return std::shared_ptr<EnMappedFile>();
+#else
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd == -1)
+        return std::shared_ptr<EnMappedFile>();
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        close(fd);
+        return std::shared_ptr<EnMappedFile>();
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return std::shared_ptr<EnMappedFile>();
+    // parts are decoded concurrently, each reads one section of the file front to back
+    madvise(p, st.st_size, MADV_WILLNEED);
+    file->data_ = static_cast<const char *>(p);
+    file->size_ = st.st_size;
+    file->mtime_ = st.st_mtime;
+#endif
+    return file;
+}
+
+EnPartIndex::EnPartIndex()
+    : byteSwap_(false)
+{
+}
+
+void
+EnPartIndex::add(const int &partNum, const uint64_t &offset)
+{
+    // files with several time steps repeat the parts, only the first time step is read
+    byNumber_.insert(std::make_pair(partNum, parts_.size()));
+    parts_.push_back(std::make_pair(partNum, offset));
+}
+
+bool
+EnPartIndex::find(const int &partNum, uint64_t &offset) const
+{
+    std::map<int, size_t>::const_iterator it(byNumber_.find(partNum));
+    if (it == byNumber_.end())
+        return false;
+    offset = parts_[it->second].second;
+    return true;
+}
+
+namespace
+{
+struct CachedIndex
+{
+    uint64_t size;
+    int64_t mtime;
+    EnPartIndex index;
+};
+
+// all indices of the module, forgotten when they get too many
+std::map<string, CachedIndex> indexCache;
+size_t indexCacheParts = 0;
+const size_t maxIndexCacheParts = 4 * 1024 * 1024;
+}
+
+bool
+EnPartIndex::lookup(const EnMappedFile &file, EnPartIndex &index)
+{
+    std::map<string, CachedIndex>::const_iterator it(indexCache.find(file.name()));
+    if (it == indexCache.end() || it->second.size != file.size() || it->second.mtime != file.mtime())
+        return false;
+    index = it->second.index;
+    return true;
+}
+
+void
+EnPartIndex::store(const EnMappedFile &file, const EnPartIndex &index)
+{
+    std::map<string, CachedIndex>::iterator it(indexCache.find(file.name()));
+    if (it != indexCache.end())
+    {
+        indexCacheParts -= it->second.index.size();
+        indexCache.erase(it);
+    }
+    if (indexCacheParts + index.size() > maxIndexCacheParts)
+    {
+        indexCache.clear();
+        indexCacheParts = 0;
+    }
+    CachedIndex &cached(indexCache[file.name()]);
+    cached.size = file.size();
+    cached.mtime = file.mtime();
+    cached.index = index;
+    indexCacheParts += index.size();
+}
@@ -0,0 +1,114 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+//-*-Mode: C++;-*-
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// CLASS  EnMappedFile
+// CLASS  EnPartIndex
+//
+// Description: read-only memory mapping of an Ensight file and the
+//              offsets of the parts in it
+//
+// +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//
+// Changes:
+//
+
+#ifndef ENMAPPEDFILE_H
+#define ENMAPPEDFILE_H
+
+#include <util/coviseCompat.h>
+
+#include <map>
+#include <memory>
+
+//
+// the whole file mapped into memory, shared by all readers which decode
+// parts of it concurrently
+//
+class EnMappedFile
+{
+public:
+    // returns an empty pointer if the file cannot be mapped
+    static std::shared_ptr<EnMappedFile> map(const string &name);
+
+    ~EnMappedFile();
+
+    const char *data() const
+    {
+        return data_;
+    };
+    uint64_t size() const
+    {
+        return size_;
+    };
+    const string &name() const
+    {
+        return name_;
+    };
+    // modification time, identifies the contents together with the size
+    int64_t mtime() const
+    {
+        return mtime_;
+    };
+
+private:
+    EnMappedFile();
+    EnMappedFile(const EnMappedFile &);
+    const EnMappedFile &operator=(const EnMappedFile &);
+
+    string name_;
+    const char *data_;
+    uint64_t size_;
+    int64_t mtime_;
+#ifdef _WIN32
+    void *mapping_;
+#endif
+};
+
+//
+// byte offsets of the parts (of the "part" line) in an Ensight Gold binary
+// file. Indices are kept for the lifetime of the module, so that reading
+// another variable or reading a timestep again does not rescan the file.
+//
+class EnPartIndex
+{
+public:
+    EnPartIndex();
+
+    void add(const int &partNum, const uint64_t &offset);
+
+    // returns false if there is no such part
+    bool find(const int &partNum, uint64_t &offset) const;
+
+    size_t size() const
+    {
+        return parts_.size();
+    };
+    int partNum(const size_t &i) const
+    {
+        return parts_[i].first;
+    };
+    uint64_t offset(const size_t &i) const
+    {
+        return parts_[i].second;
+    };
+
+    // byte order found while scanning the file
+    bool byteSwap_;
+
+    // fill with the cached index of the file, returns false if it has
+    // not been indexed or has changed since
+    static bool lookup(const EnMappedFile &file, EnPartIndex &index);
+    static void store(const EnMappedFile &file, const EnPartIndex &index);
+
+private:
+    // part number and offset in file order
+    vector<std::pair<int, uint64_t> > parts_;
+    std::map<int, size_t> byNumber_;
+};
+#endif
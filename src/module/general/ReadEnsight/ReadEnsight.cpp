@@ -115,6 +115,9 @@ ReadEnsight::ReadEnsight(int argc, char *argv[])
     includePolyederParam_ = addBooleanParam("include_polyhedra", "include 3D polyhedral cells in grid output");
     // includePolyederParam_->setValue(0);
     includePolyederParam_->setValue(1);
+
+    mappedReadingParam_ = addBooleanParam("mapped_reading", "map EnSight Gold binary files and decode parts concurrently");
+    mappedReadingParam_->setValue(1);
 }
 
 //
@@ -406,6 +409,7 @@ ReadEnsight::readGeometry(const int &portTok2d, const int &portTok3d)
         binType_ = enf->binType();
         enf->setDataByteSwap(dataByteSwapParam_->getValue() == 1);
         enf->setIncludePolyeder(includePolyederParam_->getValue() == 1);
+        enf->setMappedReading(mappedReadingParam_->getValue() == 1);
 
         PartList *pl = new PartList;
         enf->setPartList(pl);
@@ -764,6 +768,7 @@ ReadEnsight::createDataFilePtr(const string &filename,
     {
         enf->setDataByteSwap(dataByteSwapParam_->getValue() == 1);
         enf->setIncludePolyeder(includePolyederParam_->getValue() == 1);
+        enf->setMappedReading(mappedReadingParam_->getValue() == 1);
     }
     return enf;
 }
@@ -147,6 +147,8 @@ private:
 
     coBooleanParam *includePolyederParam_;
 
+    coBooleanParam *mappedReadingParam_;
+
     PartList masterPL_;
 
     coDistributedObject *geoObj_;
@@ -25,6 +25,8 @@
 #include <do/coDoSet.h>
 #include <util/coFileUtil.h>
 #include <util/coRestraint.h>
+#include <util/coWristWatch.h>
+#include <alg/coTaskPool.h>
 
 #include <sstream>
 #include <fstream>
@@ -101,6 +103,10 @@ ReadFOAM::ReadFOAM(int argc, char *argv[]) //Constructor
         boundaryDataChoice.push_back(choice);
     }
 
+    //Number of threads reading processor directories concurrently
+    threadsParam = addInt32Param("num_threads", "processor directories read concurrently, 0: one per core");
+    threadsParam->setValue(0);
+
     particleParam = addBooleanParam("load_particles", "set to false to prevent loading of particle data");
     particleParam->setValue(true);
     for (int i=0; i<num_ports; ++i)
@@ -534,7 +540,10 @@ coDoUnstructuredGrid *ReadFOAM::loadMesh(const std::string &meshdir,
             }
 
             //Create the unstructured grid
-            meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
+            {
+                std::lock_guard<std::mutex> lock(shmMutex);
+                meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
+            }
 
             // get pointers to the first element of the element, vertex and coordinate lists
             meshObj->getAddresses(&el, &cl, &x_coord, &y_coord, &z_coord);
@@ -707,7 +716,10 @@ coDoUnstructuredGrid *ReadFOAM::loadMesh(const std::string &meshdir,
         HeaderInfo pointsH = readFoamHeader(*pointsIn);
         int num_points = pointsH.lines;
 
-        meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            meshObj = new coDoUnstructuredGrid(meshObjName.c_str(), num_elem, num_conn, num_points, 1);
+        }
         // get pointers to the first element of the element, vertex and coordinate lists
         meshObj->getAddresses(&el, &cl, &x_coord, &y_coord, &z_coord);
         // get a pointer to the type list
@@ -790,7 +802,10 @@ coDoPolygons *ReadFOAM::loadPatches(const std::string &meshdir,
             it->second = ni;
             ++ni;
         }
-        polyObj = new coDoPolygons(boundObjName.c_str(), num_points, num_corners, num_polygons);
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            polyObj = new coDoPolygons(boundObjName.c_str(), num_points, num_corners, num_polygons);
+        }
 
         index_t *cornerList, *polygonList;
         float *x_start, *y_start, *z_start;
@@ -854,7 +869,10 @@ coDoPolygons *ReadFOAM::loadPatches(const std::string &meshdir,
         oldBoundary->getAddresses(&oldX_start, &oldY_start, &oldZ_start, &oldCornerList, &oldPolygonList);
         index_t num_corners = oldBoundary->getNumVertices(), num_polygons = oldBoundary->getNumPolygons(), num_points = oldBoundary->getNumPoints();
 
-        polyObj = new coDoPolygons(boundObjName.c_str(), num_points, num_corners, num_polygons);
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            polyObj = new coDoPolygons(boundObjName.c_str(), num_points, num_corners, num_polygons);
+        }
         index_t *cornerList, *polygonList;
         float *x_start, *y_start, *z_start;
         polyObj->getAddresses(&x_start, &y_start, &z_start, &cornerList, &polygonList);
@@ -908,18 +926,25 @@ coDoPoints *ReadFOAM::loadParticles(const std::string &datadir, const std::strin
     coDoPoints *pointObj = NULL;
     if (!objName.empty())
     {
-        pointObj = new coDoPoints(objName.c_str(), num_pos);
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            pointObj = new coDoPoints(objName.c_str(), num_pos);
+        }
         pointObj->getAddresses(&x, &y, &z);
     }
     coDoInt *cellIds = NULL;
     int *cell = NULL;
     if (!cellIdObjName.empty())
     {
-        cellIds = new coDoInt(cellIdObjName, num_pos);
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            cellIds = new coDoInt(cellIdObjName, num_pos);
+        }
         cell = cellIds->getAddress();
     }
     if (!readParticleArray(posH, *posIn, x, y, z, cell, num_pos))
     {
+        std::lock_guard<std::mutex> lock(shmMutex);
         delete pointObj;
         delete cellIds;
         return NULL;
@@ -952,7 +977,11 @@ coDistributedObject *ReadFOAM::loadField(const std::string &timedir,
     if (header.fieldclass == "volVectorField" || header.fieldclass == "vectorField")
     {
         std::cerr << std::time(0) << " Reading VectorField from:          " << timedir.c_str() << "//" << file.c_str() << std::endl;
-        coDoVec3 *vecObj = new coDoVec3(vecObjName.c_str(), numberCells);
+        coDoVec3 *vecObj = NULL;
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            vecObj = new coDoVec3(vecObjName.c_str(), numberCells);
+        }
         float *x, *y, *z;
         vecObj->getAddresses(&x, &y, &z);
         if (header.lines==0)
@@ -973,7 +1002,11 @@ coDistributedObject *ReadFOAM::loadField(const std::string &timedir,
     else if (header.fieldclass == "volScalarField" || header.fieldclass == "scalarField")
     {
         std::cerr << std::time(0) << " Reading ScalarField from:          " << timedir.c_str() << "//" << file.c_str() << std::endl;
-        coDoFloat *vecObj = new coDoFloat(vecObjName.c_str(), numberCells);
+        coDoFloat *vecObj = NULL;
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            vecObj = new coDoFloat(vecObjName.c_str(), numberCells);
+        }
             float *x=vecObj->getAddress();
         if (header.lines==0)
         {
@@ -993,7 +1026,11 @@ coDistributedObject *ReadFOAM::loadField(const std::string &timedir,
     else if (header.fieldclass == "labelField")
     {
         std::cerr << std::time(0) << " Reading labelField from:" << timedir.c_str() << "//" << file.c_str() << std::endl;
-        coDoInt *vecObj = new coDoInt(vecObjName.c_str(), numberCells);
+        coDoInt *vecObj = NULL;
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            vecObj = new coDoInt(vecObjName.c_str(), numberCells);
+        }
         int *d=vecObj->getAddress();
         if (header.lines==0)
         {
@@ -1065,7 +1102,11 @@ coDistributedObject *ReadFOAM::loadBoundaryField(const std::string &timedir,
     {
         std::cerr << std::time(0) << " Reading Boundary ScalarField from: " << timedir.c_str() << "//" << file.c_str() << std::endl;
 
-        coDoFloat *vecObj = new coDoFloat(vecObjName.c_str(), numBoundaryFaces);
+        coDoFloat *vecObj = NULL;
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            vecObj = new coDoFloat(vecObjName.c_str(), numBoundaryFaces);
+        }
         float *x = vecObj->getAddress();
 
         if (header.lines==0)
@@ -1093,7 +1134,11 @@ coDistributedObject *ReadFOAM::loadBoundaryField(const std::string &timedir,
         std::cerr << std::time(0) << " Reading Boundary VectorField from: " << timedir.c_str() << "//" << file.c_str() << std::endl;
 
 
-        coDoVec3 *vecObj = new coDoVec3(vecObjName.c_str(), numBoundaryFaces);
+        coDoVec3 *vecObj = NULL;
+        {
+            std::lock_guard<std::mutex> lock(shmMutex);
+            vecObj = new coDoVec3(vecObjName.c_str(), numBoundaryFaces);
+        }
         float *x, *y, *z;
         vecObj->getAddresses(&x, &y, &z);
 
@@ -1132,6 +1177,272 @@ coDistributedObject *ReadFOAM::loadBoundaryField(const std::string &timedir,
 }
 
 
+// read mesh, boundary and data of processor directory j (or of the case
+// if it is not decomposed) for the timestep of job, might run concurrently
+void ReadFOAM::readBlock(TimestepJob &job, index_t j)
+{
+    BlockObjects &objs = job.blocks[j];
+    objs.port.resize(num_ports);
+    objs.boundPort.resize(num_boundary_data_ports);
+    objs.particlesPort.resize(num_ports);
+    for (int phase = 0; phase < NUM_PHASES; ++phase)
+        objs.seconds[phase] = 0.;
+
+    std::string meshdir = casedir;
+    std::string pointsdir = casedir;
+    std::string datadir = casedir;
+    std::string timedir = job.timedir;
+    std::stringstream sMeshDir;
+    std::stringstream sPointsDir;
+    std::stringstream sDataDir;
+    if (m_case.numblocks > 0)
+    {
+        sMeshDir << "/processor" << j  << "/" << m_case.completeMeshDirs.find(job.time)->second << "/polyMesh";
+        sPointsDir << "/processor" << j  << "/" << timedir << "/polyMesh";
+        sDataDir << "/processor" << j  << "/" << timedir;
+    }
+    else
+    {
+        sMeshDir << "/" << m_case.completeMeshDirs.find(job.time)->second << "/polyMesh";
+        sPointsDir << "/" << timedir << "/polyMesh";
+        sDataDir << "/" << timedir;
+    }
+
+    meshdir += sMeshDir.str();
+    if (m_case.varyingCoords)
+        pointsdir += sPointsDir.str();
+    else
+        pointsdir = meshdir;
+    datadir += sDataDir.str();
+    std::stringstream sm;
+    std::stringstream sb;
+    std::stringstream sd;
+    std::stringstream sp;
+    if (m_case.numblocks > 0)
+    {
+        sm << "_timestep_" << job.timestep << "_processor_" << j;
+        sb << "_timestep_" << job.timestep << "_processor_" << j;
+        sd << "_timestep_" << job.timestep << "_processor_" << j;
+        sp << "_timestep_" << job.timestep << "_processor_" << j;
+    }
+    else
+    {
+        sm << "_timestep_" << job.timestep << "_mesh";
+        sb << "_timestep_" << job.timestep << "_polygon";
+        sd << "_timestep_" << job.timestep << "_data";
+        sp << "_timestep_" << job.timestep << "_data";
+    }
+
+    coWristWatch watch;
+    if ((!m_case.varyingCoords && job.counter==0) || m_case.varyingCoords)
+    {
+        if (meshParam->getValue())
+        {   
+            std::string meshObjName = meshOutPort->getObjName();
+            meshObjName += sm.str();
+            coDoUnstructuredGrid *m = NULL;
+            if (lastmeshdir[j]==meshdir)
+            {
+                m = loadMesh(meshdir, pointsdir, meshObjName, j);
+            }
+            else
+            {
+                m = loadMesh(meshdir, pointsdir, meshObjName);
+                basemeshs[j] = m;
+                lastmeshdir[j]=meshdir;
+            }
+            if (m_case.varyingCoords)
+                addRealtime(m, job.realtime);
+            objs.mesh.push_back(m);
+        }
+        objs.seconds[PHASE_MESH] += watch.elapsed();
+        watch.reset();
+        if (boundaryParam->getValue())
+        {
+            std::string boundObjName = boundaryOutPort->getObjName();
+            boundObjName += sb.str();
+            coDoPolygons *p = NULL;
+
+            if (lastbounddir[j] == meshdir)
+            {
+                p = loadPatches(meshdir, pointsdir, boundObjName, job.selection,j);
+            }
+            else
+            {
+                p = loadPatches(meshdir, pointsdir, boundObjName, job.selection,-1,j);
+                basebounds[j] = p;
+                lastbounddir[j]=meshdir;
+            }
+            if (m_case.varyingCoords)
+                addRealtime(p, job.realtime);
+            objs.boundary.push_back(p);
+        }
+        objs.seconds[PHASE_BOUNDARY] += watch.elapsed();
+        watch.reset();
+    }
+    for (int nPort = 0; nPort < num_ports; ++nPort)
+    {
+
+        index_t portchoice = portChoice[nPort]->getValue();
+        if (portchoice > 0 && portchoice <= m_case.varyingFields.size()+1)
+        {
+            std::string dataFilename = portChoice[nPort]->getLabel(portchoice);
+            if (portchoice == 1)
+            {
+                boost::shared_ptr<std::istream> ownersIn = getStreamForFile(meshdir, "owner");
+                HeaderInfo ownerH = readFoamHeader(*ownersIn);
+                DimensionInfo dim = parseDimensions(ownerH.header);
+                std::string portObjName = outPorts[nPort]->getObjName();
+                portObjName += sd.str();
+
+                coDoFloat *v = NULL;
+                {
+                    std::lock_guard<std::mutex> lock(shmMutex);
+                    v = new coDoFloat(portObjName, dim.cells);
+                }
+                float *processorID = v->getAddress();
+
+                for (int i=0; i<dim.cells; ++i)
+                {
+                    processorID[i] = j;
+                }
+                addRealtime(v, job.realtime);
+                objs.port[nPort].push_back(v);
+            }
+            else
+            {
+                std::string portObjName = outPorts[nPort]->getObjName();
+                portObjName += sd.str();
+
+                coDistributedObject *v = loadField(datadir, dataFilename, portObjName, meshdir);
+                if (v)
+                    addRealtime(v, job.realtime);
+                objs.port[nPort].push_back(v);
+            }
+        }
+    }
+    objs.seconds[PHASE_FIELDS] += watch.elapsed();
+    watch.reset();
+    for (int nPort = 0; nPort < num_boundary_data_ports; ++nPort)
+    {
+        index_t portchoice = boundaryDataChoice[nPort]->getValue();
+        if (portchoice > 0 && portchoice <= m_case.varyingFields.size()+1)
+        {
+            std::string dataFilename = portChoice[nPort]->getLabel(portchoice);
+            if (portchoice == 1)
+            {//ToDo:Replace dim.cells with the correct number of faces
+                coRestraint res;
+                res.add(job.selection.c_str());
+                Boundaries boundaries = loadBoundary(meshdir);
+                int numBoundaryFaces =0;
+                for (std::vector<Boundary>::const_iterator it = boundaries.boundaries.begin();
+                        it != boundaries.boundaries.end();
+                        ++it)
+                {
+                    int boundaryIndex = it->index;
+                    if (res(boundaryIndex) || strcmp(job.selection.c_str(), "all") == 0)
+                    {
+                        numBoundaryFaces+= it->numFaces;
+                    }
+                }
+                std::string portObjName = boundaryDataPorts[nPort]->getObjName();
+                portObjName += sd.str();
+
+                coDoFloat *v = NULL;
+                {
+                    std::lock_guard<std::mutex> lock(shmMutex);
+                    v = new coDoFloat(portObjName, numBoundaryFaces);
+                }
+                float *processorID = v->getAddress();
+
+                for (int i=0; i<numBoundaryFaces; ++i)
+                {
+                    processorID[i] = j;
+                }
+                addRealtime(v, job.realtime);
+                objs.boundPort[nPort].push_back(v);
+            }
+            else
+            {
+                std::string portObjName = boundaryDataPorts[nPort]->getObjName();
+                portObjName += sd.str();
+
+                coDistributedObject *v = loadBoundaryField(datadir, meshdir, dataFilename, portObjName, job.selection);
+                if (v)
+                    addRealtime(v, job.realtime);
+                objs.boundPort[nPort].push_back(v);
+            }
+        }
+    }
+    objs.seconds[PHASE_BOUNDARY_FIELDS] += watch.elapsed();
+    watch.reset();
+
+    // lagrangian/particle data
+    if (m_case.hasParticles)
+    {
+        if (particleParam->getValue() || !job.cellIdPorts.empty())
+        {
+            std::string particleObjName, cellIdObjName;
+            if (particleParam->getValue())
+            {
+                particleObjName = particleOutPort->getObjName();
+                particleObjName += sp.str();
+            }
+            if (!job.cellIdPorts.empty())
+            {
+                cellIdObjName = particleDataPorts[job.cellIdPorts[0]]->getObjName();
+                cellIdObjName += sp.str();
+            }
+            coDistributedObject *cellIds = NULL;
+            coDoPoints *p = loadParticles(datadir, particleObjName, cellIdObjName, &cellIds);
+            if (p)
+            {
+                addRealtime(p, job.realtime);
+                objs.particles.push_back(p);
+            }
+            if (cellIds)
+            {
+                addRealtime(cellIds, job.realtime);
+                for (size_t i=0; i<job.cellIdPorts.size(); ++i)
+                    objs.particlesPort[job.cellIdPorts[i]].push_back(cellIds);
+            }
+        }
+        for (int nPort = 0; nPort < num_ports; ++nPort)
+        {
+            index_t portchoice = particleDataChoice[nPort]->getValue();
+            if (portchoice > 1 && portchoice <= m_case.particleFields.size()+1)
+            {
+                std::string lagdir = datadir + "/lagrangian/" + m_case.lagrangiandir;
+                std::string dataFilename = particleDataChoice[nPort]->getLabel(portchoice);
+                std::string portObjName = particleDataPorts[nPort]->getObjName();
+                portObjName += sp.str();
+
+                coDistributedObject *v = loadField(lagdir, dataFilename, portObjName, meshdir);
+                if (v)
+                    addRealtime(v, job.realtime);
+                objs.particlesPort[nPort].push_back(v);
+            }
+        }
+        objs.seconds[PHASE_PARTICLES] += watch.elapsed();
+    }
+}
+
+void ReadFOAM::readBlocks(void *data, int begin, int end, int thread)
+{
+    (void)thread;
+    TimestepJob *job = (TimestepJob *)data;
+    for (int j = begin; j < end; ++j)
+        job->reader->readBlock(*job, j);
+}
+
+void ReadFOAM::addRealtime(coDistributedObject *obj, const std::string &realtime)
+{
+    if (!obj)
+        return;
+    std::lock_guard<std::mutex> lock(shmMutex);
+    obj->addAttribute("REALTIME", realtime.c_str());
+}
+
 int ReadFOAM::compute(const char *port) //Compute is called when Module is executed
 {
     (void)port;
@@ -1162,7 +1473,13 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
     basemeshs.clear();
     basebounds.clear();
     pointmaps.clear();
+    lastmeshdir.clear();
+    lastbounddir.clear();
+    basemeshs.resize(std::max(1,m_case.numblocks), NULL);
+    basebounds.resize(std::max(1,m_case.numblocks), NULL);
     pointmaps.resize(std::max(1,m_case.numblocks));
+    lastmeshdir.resize(std::max(1,m_case.numblocks));
+    lastbounddir.resize(std::max(1,m_case.numblocks));
 
     std::vector<coDistributedObject *> meshSubSets;
     coDoSet *meshSet=NULL, *meshSubSet=NULL;
@@ -1177,9 +1494,6 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
     std::vector<std::vector<coDistributedObject *> > particlePortSubSets(num_ports);
     coDoSet *particlePortSubSet=NULL;
 
-    std::vector <std::string> lastmeshdir(std::max(1,m_case.numblocks));
-    std::vector <std::string> lastbounddir(std::max(1,m_case.numblocks));
-
     std::vector<size_t> cellIdPorts;
     for (int nPort = 0; nPort < num_ports; ++nPort)
     {
@@ -1190,6 +1504,18 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
         }
     }
 
+    // processor directories are read by a bounded number of threads
+    coTaskPool *pool = NULL;
+    int numThreads = threadsParam->getValue();
+    if (numThreads != 1 && m_case.numblocks > 1)
+        pool = coTaskPool::shared(numThreads);
+    TimestepJob job;
+    job.reader = this;
+    job.cellIdPorts = cellIdPorts;
+    double phaseTime[NUM_PHASES] = { 0., 0., 0., 0., 0. };
+    double readTime = 0., setTime = 0.;
+    coWristWatch computeWatch;
+
     int counter = 0;
     index_t timestep = 0;
     for (std::map<double, std::string>::const_iterator it = m_case.timedirs.begin();
@@ -1217,229 +1543,41 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                     std::vector<std::vector<coDistributedObject *> > tempSetPort(num_ports);
                     std::vector<std::vector<coDistributedObject *> > tempSetBoundPort(num_boundary_data_ports);
                     std::vector<std::vector<coDistributedObject *> > tempSetParticlesPort(num_ports);
-                    for (index_t j = 0;( j < m_case.numblocks || j==0); j++)
-                    { //fill vector:tempSet with all the mesh parts of all processors even if its just one
-                        //std::cerr << " processor" << j;
-                        std::string meshdir = casedir;
-                        std::string pointsdir = casedir;
-                        std::string datadir = casedir;
-                        std::string timedir = it->second;
-                        std::stringstream sMeshDir;
-                        std::stringstream sPointsDir;
-                        std::stringstream sDataDir;
-                        if (m_case.numblocks > 0)
-                        {
-                            sMeshDir << "/processor" << j  << "/" << m_case.completeMeshDirs[it->first] << "/polyMesh";
-                            sPointsDir << "/processor" << j  << "/" << timedir << "/polyMesh";
-                            sDataDir << "/processor" << j  << "/" << timedir;
-                        }
-                        else
-                        {
-                            sMeshDir << "/" << m_case.completeMeshDirs[it->first] << "/polyMesh";
-                            sPointsDir << "/" << timedir << "/polyMesh";
-                            sDataDir << "/" << timedir;
-                        }
-
-                        meshdir += sMeshDir.str();
-                        if (m_case.varyingCoords)
-                            pointsdir += sPointsDir.str();
-                        else
-                            pointsdir = meshdir;
-                        datadir += sDataDir.str();
-                        std::stringstream sm;
-                        std::stringstream sb;
-                        std::stringstream sd;
-                        std::stringstream sp;
-                        if (m_case.numblocks > 0)
-                        {
-                            sm << "_timestep_" << timestep << "_processor_" << j;
-                            sb << "_timestep_" << timestep << "_processor_" << j;
-                            sd << "_timestep_" << timestep << "_processor_" << j;
-                            sp << "_timestep_" << timestep << "_processor_" << j;
-                        }
-                        else
-                        {
-                            sm << "_timestep_" << timestep << "_mesh";
-                            sb << "_timestep_" << timestep << "_polygon";
-                            sd << "_timestep_" << timestep << "_data";
-                            sp << "_timestep_" << timestep << "_data";
-                        }
-
-                        if ((!m_case.varyingCoords && counter==0) || m_case.varyingCoords)
-                        {
-                            if (meshParam->getValue())
-                            {   
-                                std::string meshObjName = meshOutPort->getObjName();
-                                meshObjName += sm.str();
-                                coDoUnstructuredGrid *m = NULL;
-                                if (lastmeshdir[j]==meshdir)
-                                {
-                                    m = loadMesh(meshdir, pointsdir, meshObjName, j);
-                                }
-                                else
-                                {
-                                    m = loadMesh(meshdir, pointsdir, meshObjName);
-                                    basemeshs[j] = m;
-                                    lastmeshdir[j]=meshdir;
-                                }
-                                if (m_case.varyingCoords)
-                                    m->addAttribute("REALTIME", realtime.c_str());
-                                tempSetMesh.push_back(m);
-                            }
-                            if (boundaryParam->getValue())
-                            {
-                                std::string boundObjName = boundaryOutPort->getObjName();
-                                boundObjName += sb.str();
-                                coDoPolygons *p = NULL;
-
-                                if (lastbounddir[j] == meshdir)
-                                {
-                                    p = loadPatches(meshdir, pointsdir, boundObjName, selection,j);
-                                }
-                                else
-                                {
-                                    p = loadPatches(meshdir, pointsdir, boundObjName, selection,-1,j);
-                                    basebounds[j] = p;
-                                    lastbounddir[j]=meshdir;
-                                }
-                                if (m_case.varyingCoords)
-                                    p->addAttribute("REALTIME", realtime.c_str());
-                                tempSetBoundary.push_back(p);
-                            }
-                        }
+                    job.time = it->first;
+                    job.timedir = it->second;
+                    job.realtime = realtime;
+                    job.selection = selection;
+                    job.timestep = timestep;
+                    job.counter = counter;
+                    job.blocks.clear();
+                    job.blocks.resize(std::max(1, m_case.numblocks));
+                    coWristWatch readWatch;
+                    if (pool)
+                        pool->run(job.blocks.size(), 1, readBlocks, &job);
+                    else
+                        readBlocks(&job, 0, job.blocks.size(), 0);
+                    readTime += readWatch.elapsed();
+                    for (size_t j = 0; j < job.blocks.size(); ++j)
+                    { //fill vector:tempSet with all the mesh parts of all processors in processor order
+                        BlockObjects &objs = job.blocks[j];
+                        tempSetMesh.insert(tempSetMesh.end(), objs.mesh.begin(), objs.mesh.end());
+                        tempSetBoundary.insert(tempSetBoundary.end(), objs.boundary.begin(), objs.boundary.end());
+                        tempSetParticles.insert(tempSetParticles.end(), objs.particles.begin(), objs.particles.end());
                         for (int nPort = 0; nPort < num_ports; ++nPort)
                         {
-
-                            index_t portchoice = portChoice[nPort]->getValue();
-                            if (portchoice > 0 && portchoice <= m_case.varyingFields.size()+1)
-                            {
-                                std::string dataFilename = portChoice[nPort]->getLabel(portchoice);
-                                if (portchoice == 1)
-                                {
-                                    boost::shared_ptr<std::istream> ownersIn = getStreamForFile(meshdir, "owner");
-                                    HeaderInfo ownerH = readFoamHeader(*ownersIn);
-                                    DimensionInfo dim = parseDimensions(ownerH.header);
-                                    std::string portObjName = outPorts[nPort]->getObjName();
-                                    portObjName += sd.str();
-
-                                    coDoFloat *v = new coDoFloat(portObjName, dim.cells);
-                                    float *processorID = v->getAddress();
-
-                                    for (int i=0; i<dim.cells; ++i)
-                                    {
-                                        processorID[i] = j;
-                                    }
-                                    v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetPort[nPort].push_back(v);
-                                }
-                                else
-                                {
-                                    std::string portObjName = outPorts[nPort]->getObjName();
-                                    portObjName += sd.str();
-
-                                    coDistributedObject *v = loadField(datadir, dataFilename, portObjName, meshdir);
-                                    if (v)
-                                        v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetPort[nPort].push_back(v);
-                                }
-                            }                           
+                            tempSetPort[nPort].insert(tempSetPort[nPort].end(), objs.port[nPort].begin(), objs.port[nPort].end());
+                            tempSetParticlesPort[nPort].insert(tempSetParticlesPort[nPort].end(), objs.particlesPort[nPort].begin(), objs.particlesPort[nPort].end());
                         }
                         for (int nPort = 0; nPort < num_boundary_data_ports; ++nPort)
                         {
-                            index_t portchoice = boundaryDataChoice[nPort]->getValue();
-                            if (portchoice > 0 && portchoice <= m_case.varyingFields.size()+1)
-                            {
-                                std::string dataFilename = portChoice[nPort]->getLabel(portchoice);
-                                if (portchoice == 1)
-                                {//ToDo:Replace dim.cells with the correct number of faces
-                                    coRestraint res;
-                                    res.add(selection.c_str());
-                                    Boundaries boundaries = loadBoundary(meshdir);
-                                    int numBoundaryFaces =0;
-                                    for (std::vector<Boundary>::const_iterator it = boundaries.boundaries.begin();
-                                            it != boundaries.boundaries.end();
-                                            ++it)
-                                    {
-                                        int boundaryIndex = it->index;
-                                        if (res(boundaryIndex) || strcmp(selection.c_str(), "all") == 0)
-                                        {
-                                            numBoundaryFaces+= it->numFaces;
-                                        }
-                                    }
-                                    std::string portObjName = boundaryDataPorts[nPort]->getObjName();
-                                    portObjName += sd.str();
-
-                                    coDoFloat *v = new coDoFloat(portObjName, numBoundaryFaces);
-                                    float *processorID = v->getAddress();
-
-                                    for (int i=0; i<numBoundaryFaces; ++i)
-                                    {
-                                        processorID[i] = j;
-                                    }
-                                    v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetBoundPort[nPort].push_back(v);
-                                }
-                                else
-                                {
-                                    std::string portObjName = boundaryDataPorts[nPort]->getObjName();
-                                    portObjName += sd.str();
-
-                                    coDistributedObject *v = loadBoundaryField(datadir, meshdir, dataFilename, portObjName, selection);
-                                    if (v)
-                                        v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetBoundPort[nPort].push_back(v);
-                                }
-                            }
+                            tempSetBoundPort[nPort].insert(tempSetBoundPort[nPort].end(), objs.boundPort[nPort].begin(), objs.boundPort[nPort].end());
                         }
-
-                        // lagrangian/particle data
-                        if (m_case.hasParticles)
+                        for (int phase = 0; phase < NUM_PHASES; ++phase)
                         {
-                            if (particleParam->getValue() || !cellIdPorts.empty())
-                            {
-                                std::string particleObjName, cellIdObjName;
-                                if (particleParam->getValue())
-                                {
-                                    particleObjName = particleOutPort->getObjName();
-                                    particleObjName += sp.str();
-                                }
-                                if (!cellIdPorts.empty())
-                                {
-                                    cellIdObjName = particleDataPorts[cellIdPorts[0]]->getObjName();
-                                    cellIdObjName += sp.str();
-                                }
-                                coDistributedObject *cellIds = NULL;
-                                coDoPoints *p = loadParticles(datadir, particleObjName, cellIdObjName, &cellIds);
-                                if (p)
-                                {
-                                    p->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetParticles.push_back(p);
-                                }
-                                if (cellIds)
-                                {
-                                    cellIds->addAttribute("REALTIME", realtime.c_str());
-                                    for (size_t i=0; i<cellIdPorts.size(); ++i)
-                                        tempSetParticlesPort[cellIdPorts[i]].push_back(cellIds);
-                                }
-                            }
-                            for (int nPort = 0; nPort < num_ports; ++nPort)
-                            {
-                                index_t portchoice = particleDataChoice[nPort]->getValue();
-                                if (portchoice > 1 && portchoice <= m_case.particleFields.size()+1)
-                                {
-                                    std::string lagdir = datadir + "/lagrangian/" + m_case.lagrangiandir;
-                                    std::string dataFilename = particleDataChoice[nPort]->getLabel(portchoice);
-                                    std::string portObjName = particleDataPorts[nPort]->getObjName();
-                                    portObjName += sp.str();
-
-                                    coDistributedObject *v = loadField(lagdir, dataFilename, portObjName, meshdir);
-                                    if (v)
-                                        v->addAttribute("REALTIME", realtime.c_str());
-                                    tempSetParticlesPort[nPort].push_back(v);
-                                }
-                            }
+                            phaseTime[phase] += objs.seconds[phase];
                         }
                     }
+                    coWristWatch setWatch;
                     std::stringstream s;
                     s << "_set_timestep" << timestep;
                     if ((!m_case.varyingCoords && counter==0) || m_case.varyingCoords)
@@ -1528,6 +1666,7 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
                             particlePortSubSets[nPort].push_back(particlePortSubSet);
                         }
                     }
+                    setTime += setWatch.elapsed();
                 }
                 ++timestep;
             }
@@ -1616,6 +1755,12 @@ int ReadFOAM::compute(const char *port) //Compute is called when Module is execu
     }
 
 
+    coModule::sendInfo("ReadFOAM timing with %d thread(s): reading %.2f s (mesh %.2f s, boundary %.2f s, fields %.2f s, boundary fields %.2f s, particles %.2f s summed over threads), sets %.2f s, total %.2f s",
+                       pool ? pool->getNumThreads() : 1, readTime,
+                       phaseTime[PHASE_MESH], phaseTime[PHASE_BOUNDARY], phaseTime[PHASE_FIELDS],
+                       phaseTime[PHASE_BOUNDARY_FIELDS], phaseTime[PHASE_PARTICLES],
+                       setTime, computeWatch.elapsed());
+
 coModule::sendInfo("ReadFOAM complete.");
 std::cerr << "ReadFOAM finished." << std::endl;
 
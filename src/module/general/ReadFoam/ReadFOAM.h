@@ -34,6 +34,8 @@
 
 #include "foamtoolbox.h"
 
+#include <mutex>
+
 using namespace covise;
 typedef int index_t;
 
@@ -66,10 +68,45 @@ private:
     std::vector<coChoiceParam *> boundaryDataChoice;
     std::vector<coChoiceParam *> particleDataChoice;
     coStringParam *patchesStringParam;
+    coIntScalarParam *threadsParam;
+
+    // reading the processor directories of a timestep concurrently
+    enum Phase
+    {
+        PHASE_MESH,
+        PHASE_BOUNDARY,
+        PHASE_FIELDS,
+        PHASE_BOUNDARY_FIELDS,
+        PHASE_PARTICLES,
+        NUM_PHASES
+    };
+    // objects read from one processor directory, in the order of the temporary sets
+    struct BlockObjects
+    {
+        std::vector<coDistributedObject *> mesh, boundary, particles;
+        std::vector<std::vector<coDistributedObject *> > port, boundPort, particlesPort;
+        double seconds[NUM_PHASES];
+    };
+    struct TimestepJob
+    {
+        ReadFOAM *reader;
+        double time;
+        std::string timedir, realtime, selection;
+        index_t timestep;
+        int counter;
+        std::vector<size_t> cellIdPorts;
+        std::vector<BlockObjects> blocks;
+    };
+    // creating shm objects talks to the data manager and has to be serialized,
+    // filling them does not
+    std::mutex shmMutex;
 
     //  member functions
     virtual int compute(const char *port);
     bool vectorsAreFilled();
+    void readBlock(TimestepJob &job, index_t block);
+    static void readBlocks(void *data, int begin, int end, int thread);
+    void addRealtime(coDistributedObject *obj, const std::string &realtime);
 
 public:
     ReadFOAM(int argc, char *argv[]); //Constructor
@@ -101,8 +138,11 @@ public:
                                       const std::string &file,
                                       const std::string &vecObjName,
                                       const std::string &selection);
-    std::map<int, coDoUnstructuredGrid *> basemeshs;
-    std::map<int, coDoPolygons *> basebounds;
+    // per processor, sized before reading so that they can be used concurrently
+    std::vector<coDoUnstructuredGrid *> basemeshs;
+    std::vector<coDoPolygons *> basebounds;
     std::vector<std::map<int, int> > pointmaps;
+    std::vector<std::string> lastmeshdir;
+    std::vector<std::string> lastbounddir;
 };
 #endif // READFOAM_H
@@ -29,6 +29,15 @@
 #include <cctype>
 
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
@@ -109,18 +118,178 @@ public:
     std::ifstream *stream;
 };
 
+// whole content of a file in memory: uncompressed files are mapped,
+// compressed files are decompressed in large chunks at once, so that the
+// list readers can parse numbers directly from memory
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    MemoryStreamBuf()
+        : mapped(NULL)
+        , mappedSize(0)
+    {
+    }
+
+    ~MemoryStreamBuf()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(mapped, mappedSize);
+#endif
+    }
+
+    bool map(const std::string &filename)
+    {
+#ifdef _WIN32
+        std::ifstream s(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!s.is_open())
+            return false;
+        s.seekg(0, std::ios_base::end);
+        buffer.resize(s.tellg());
+        s.seekg(0, std::ios_base::beg);
+        if (!buffer.empty() && !s.read(&buffer[0], buffer.size()))
+            return false;
+        setBuffer(buffer.empty() ? NULL : &buffer[0], buffer.size());
+        return true;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == -1)
+        {
+            close(fd);
+            return false;
+        }
+        if (st.st_size > 0)
+        {
+            void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                close(fd);
+                return false;
+            }
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            mapped = static_cast<char *>(p);
+            mappedSize = st.st_size;
+        }
+        close(fd);
+        setBuffer(mapped, mappedSize);
+        return true;
+#endif
+    }
+
+    bool decompress(const std::string &filename)
+    {
+        std::ifstream s(filename.c_str(), std::ios_base::in | std::ios_base::binary);
+        if (!s.is_open())
+            return false;
+        // the gzip trailer holds the uncompressed size modulo 2^32
+        s.seekg(-4, std::ios_base::end);
+        unsigned char isize[4] = { 0, 0, 0, 0 };
+        s.read(reinterpret_cast<char *>(isize), 4);
+        size_t expected = isize[0] | (isize[1] << 8) | (isize[2] << 16) | (size_t(isize[3]) << 24);
+        s.clear();
+        s.seekg(0, std::ios_base::beg);
+
+        bi::filtering_istream fi;
+        fi.push(bi::gzip_decompressor(bi::zlib::default_window_bits, 1 << 20));
+        fi.push(s);
+        const size_t chunk = 1 << 22;
+        buffer.reserve(expected + 1);
+        size_t size = 0;
+        while (fi)
+        {
+            buffer.resize(std::max(buffer.capacity(), size + chunk));
+            fi.read(&buffer[size], buffer.size() - size);
+            size += fi.gcount();
+        }
+        if (fi.bad())
+            return false;
+        buffer.resize(size);
+        setBuffer(buffer.empty() ? NULL : &buffer[0], buffer.size());
+        return true;
+    }
+
+    const char *current() const
+    {
+        return gptr();
+    }
+
+    const char *end() const
+    {
+        return egptr();
+    }
+
+    void advance(const char *p)
+    {
+        setg(eback(), const_cast<char *>(p), egptr());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+    {
+        const char *base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        if (!(which & std::ios_base::in) || base + off < eback() || base + off > egptr())
+            return pos_type(off_type(-1));
+        advance(base + off);
+        return pos_type(gptr() - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+    {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+private:
+    void setBuffer(char *data, size_t size)
+    {
+        setg(data, data, data + size);
+    }
+
+    char *mapped;
+    size_t mappedSize;
+    std::vector<char> buffer;
+};
+
+class MemoryStreamDeleter
+{
+public:
+    MemoryStreamDeleter(MemoryStreamBuf *b)
+        : buf(b)
+    {
+    }
+
+    void operator()(std::istream *s)
+    {
+        delete s;
+        delete buf;
+    }
+
+    MemoryStreamBuf *buf;
+};
+
 boost::shared_ptr<std::istream> getStreamForFile(const std::string &filename)
 {
+    MemoryStreamBuf *buf = new MemoryStreamBuf;
+    bf::path p(filename);
+    bool ok = p.extension().string() == ".gz" ? buf->decompress(filename) : buf->map(filename);
+    if (ok)
+    {
+        std::istream *s = new std::istream(buf);
+        return boost::shared_ptr<std::istream>(s, MemoryStreamDeleter(buf));
+    }
+    delete buf;
 
     std::ifstream *s = new std::ifstream(filename.c_str(), std::ios_base::in | std::ios_base::binary);
     if (!s->is_open())
     {
         std::cerr << "failed to open " << filename << std::endl;
+        delete s;
         return boost::shared_ptr<std::istream>();
     }
 
     bi::filtering_istream *fi = new bi::filtering_istream;
-    bf::path p(filename);
     if (p.extension().string() == ".gz")
     {
         fi->push(bi::gzip_decompressor());
@@ -970,6 +1139,215 @@ struct on_disk<unsigned long>
     } \
     while(false)
 
+// parsing numbers directly from the memory of a MemoryStreamBuf,
+// independent of the locale and without the overhead of istream
+static inline const char *skipSpace(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// everything up to the next separator, e.g. nan or inf, is left to strtod
+static bool parseNumberStrtod(const char *&p, const char *end, double &val)
+{
+    char buf[64];
+    size_t n = 0;
+    while (p + n < end && n < sizeof(buf) - 1 && !isspace(p[n]) && p[n] != ')' && p[n] != ';')
+    {
+        buf[n] = p[n];
+        ++n;
+    }
+    buf[n] = '\0';
+    char *e = NULL;
+    val = strtod(buf, &e);
+    if (e == buf)
+        return false;
+    p += e - buf;
+    return true;
+}
+
+// at most 15 significant digits and a power of ten up to 22 are
+// represented exactly as double, so that one multiplication or division
+// is correctly rounded, anything else is handled by strtod
+static bool parseNumber(const char *&p, const char *end, double &val)
+{
+    const char *s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = *s == '-';
+        ++s;
+    }
+    unsigned long long mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; s < end && *s >= '0' && *s <= '9'; ++s)
+    {
+        any = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*s - '0');
+            if (mantissa)
+                ++digits;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+    if (s < end && *s == '.')
+    {
+        for (++s; s < end && *s >= '0' && *s <= '9'; ++s)
+        {
+            any = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*s - '0');
+                if (mantissa)
+                    ++digits;
+                --exponent;
+            }
+        }
+    }
+    if (!any)
+        return parseNumberStrtod(p, end, val);
+    if (s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char *e = s + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+        {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        if (e < end && *e >= '0' && *e <= '9')
+        {
+            int exp = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; ++e)
+            {
+                if (exp < 10000)
+                    exp = exp * 10 + (*e - '0');
+            }
+            exponent += negativeExponent ? -exp : exp;
+            s = e;
+        }
+    }
+    if (digits > 15 || exponent < -22 || exponent > 22)
+        return parseNumberStrtod(p, end, val);
+
+    val = double(mantissa);
+    if (exponent < 0)
+        val /= exactPowersOfTen[-exponent];
+    else
+        val *= exactPowersOfTen[exponent];
+    if (negative)
+        val = -val;
+    p = s;
+    return true;
+}
+
+static inline bool parseAscii(const char *&p, const char *end, double &val)
+{
+    return parseNumber(p, end, val);
+}
+
+static inline bool parseAscii(const char *&p, const char *end, float &val)
+{
+    double d;
+    if (!parseNumber(p, end, d))
+        return false;
+    val = d;
+    return true;
+}
+
+static inline bool parseAscii(const char *&p, const char *end, int &val)
+{
+    const char *s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = *s == '-';
+        ++s;
+    }
+    if (s == end || *s < '0' || *s > '9')
+        return false;
+    long long v = 0;
+    for (; s < end && *s >= '0' && *s <= '9'; ++s)
+        v = v * 10 + (*s - '0');
+    val = int(negative ? -v : v);
+    p = s;
+    return true;
+}
+
+// no fast path for other types, e.g. index lists
+template <typename T>
+static inline bool parseAscii(const char *&, const char *, T &)
+{
+    return false;
+}
+
+// parse as many elements as possible directly from memory,
+// returns their number, the stream continues after the last of them
+template <typename T>
+size_t readArrayAsciiMemory(std::istream &stream, T *p, const size_t lines)
+{
+    MemoryStreamBuf *buf = dynamic_cast<MemoryStreamBuf *>(stream.rdbuf());
+    if (!buf)
+        return 0;
+    const char *cur = buf->current(), *end = buf->end();
+    size_t i = 0;
+    for (; i < lines; ++i)
+    {
+        cur = skipSpace(cur, end);
+        if (!parseAscii(cur, end, p[i]))
+            break;
+    }
+    buf->advance(cur);
+    return i;
+}
+
+// same for lists of vectors, "(x y z)" per line
+template <typename T>
+size_t readVectorArrayAsciiMemory(std::istream &stream, T *x, T *y, T *z, const size_t lines)
+{
+    MemoryStreamBuf *buf = dynamic_cast<MemoryStreamBuf *>(stream.rdbuf());
+    if (!buf)
+        return 0;
+    const char *cur = buf->current(), *end = buf->end();
+    size_t i = 0;
+    for (; i < lines; ++i)
+    {
+        const char *q = skipSpace(cur, end);
+        if (q == end || *q != '(')
+            break;
+        T vx, vy, vz;
+        q = skipSpace(q + 1, end);
+        if (!parseAscii(q, end, vx))
+            break;
+        q = skipSpace(q, end);
+        if (!parseAscii(q, end, vy))
+            break;
+        q = skipSpace(q, end);
+        if (!parseAscii(q, end, vz))
+            break;
+        q = skipSpace(q, end);
+        if (q == end || *q != ')')
+            break;
+        x[i] = vx;
+        y[i] = vy;
+        z[i] = vz;
+        cur = q + 1;
+    }
+    buf->advance(cur);
+    return i;
+}
+
 
 template <typename T>
 std::istream &operator>>(std::istream &stream, std::vector<T> &vec)
@@ -1031,7 +1409,7 @@ template <typename T>
 bool readVectorArrayAscii(std::istream &stream, T *x, T *y, T *z, const size_t lines)
 {
     expect('\n');
-    for (size_t i = 0; i < lines; ++i)
+    for (size_t i = readVectorArrayAsciiMemory(stream, x, y, z, lines); i < lines; ++i)
     {
         stream.ignore(std::numeric_limits<std::streamsize>::max(), '(');
         stream >> x[i] >> y[i] >> z[i];
@@ -1046,7 +1424,7 @@ template <>
 bool readVectorArrayAscii(std::istream &stream, float *x, float *y, float *z, const size_t lines)
 {
     expect('\n');
-    for (size_t i = 0; i < lines; ++i)
+    for (size_t i = readVectorArrayAsciiMemory(stream, x, y, z, lines); i < lines; ++i)
     {
         stream.ignore(std::numeric_limits<std::streamsize>::max(), '(');
         double vx, vy, vz;
@@ -1120,7 +1498,7 @@ bool readListBinary(std::istream &stream, std::vector<T> &vec)
 template <typename T>
 bool readArrayAscii(std::istream &stream, T *p, const size_t lines)
 {
-    for (size_t i = 0; i < lines; ++i)
+    for (size_t i = readArrayAsciiMemory(stream, p, lines); i < lines; ++i)
     {
         stream >> p[i];
         if (!stream.good())
@@ -1136,7 +1514,7 @@ bool readArrayAscii(std::istream &stream, T *p, const size_t lines)
 template <>
 bool readArrayAscii(std::istream &stream, float *p, const size_t lines)
 {
-    for (size_t i = 0; i < lines; ++i)
+    for (size_t i = readArrayAsciiMemory(stream, p, lines); i < lines; ++i)
     {
         double val;
         stream >> val;
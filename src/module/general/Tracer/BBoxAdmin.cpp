@@ -161,7 +161,7 @@ BBoxAdmin::pload(const coDistributedObject *grid, const coDistributedObject *otr
         delete[] setList;
 #endif
     }
-    else if (grid->isType("UNSGRD") && otree != NULL && otree->isType("OCTREE"))
+    else if (grid->isType("UNSGRD") && otree != NULL && (otree->isType("OCTREE") || otree->isType("CELBVH")))
     {
         // octtree available as input
         const coDoUnstructuredGrid *unsgrd = dynamic_cast<const coDoUnstructuredGrid *>(grid);
@@ -198,9 +198,9 @@ BBoxAdmin::pload(const coDistributedObject *grid, const coDistributedObject *otr
         else
         {
 #ifndef YAC
-            unsgrd->GetOctTree((coDoOctTree *)usedOctTree, NULL);
+            unsgrd->GetOctTree(usedOctTree, NULL);
 #else
-            unsgrd->GetOctTree((coDoOctTree *)usedOctTree, coObjID(), 0);
+            unsgrd->GetOctTree(usedOctTree, coObjID(), 0);
 #endif
             iaOctTrees_.push_back(usedOctTree);
             iaUnsGrids_.push_back(grid);
@@ -267,12 +267,8 @@ BBoxAdmin::getUsedOctTree(const coDistributedObject *grd)
         {
             if (grd->isType("UNSGRD"))
             {
-#ifndef YAC
-                ret = ((const coDoUnstructuredGrid *)iaUnsGrids_[grid])->GetOctTree(NULL, NULL);
-#else
-                //fixme
-                ret = ((const coDoUnstructuredGrid *)iaUnsGrids_[grid])->GetOctTree(NULL, coObjID(), 0);
-#endif
+                // may be a coDoCellBVH, which GetOctTree does not return
+                ret = iaOctTrees_[grid];
             }
             else if (grd->isType("POLYGN"))
             {
@@ -340,7 +336,7 @@ BBoxAdmin::preload(const coDistributedObject *grid, const coDistributedObject *o
         delete[] setList;
 #endif
     }
-    else if (grid->isType("UNSGRD") && otree != NULL && otree->isType("OCTREE"))
+    else if (grid->isType("UNSGRD") && otree != NULL && (otree->isType("OCTREE") || otree->isType("CELBVH")))
     {
         // octtree available as input
         const coDoUnstructuredGrid *unsgrd = dynamic_cast<const coDoUnstructuredGrid *>(grid);
@@ -11,6 +11,7 @@
 #include <do/coDoStructuredGrid.h>
 #include <do/coDoRectilinearGrid.h>
 #include <do/coDoUniformGrid.h>
+#include <alg/coTaskPool.h>
 #include "HTask.h"
 
 // expand a set into a list (out_array)
@@ -238,25 +239,6 @@ HTask::HTask(const coModule *mod,
     fillRealTime();
 }
 
-// maqke the assignation of a PTask for a worker thread
-void
-HTask::assignTask(PTask **pp_task,
-                  int label)
-{
-    // shortly it is serviced
-    ptasks_[serviced_]->set_status(PTask::SERVICED);
-    ptasks_[serviced_]->set_label(label);
-    *pp_task = ptasks_[serviced_++]; // assign and increase serviced_ counter
-}
-
-// Gather results from a PTask
-void
-HTask::gatherPTask(PTask **pp_task)
-{ // a thread has finished a PTask
-    ++no_finished_;
-    *pp_task = 0;
-}
-
 // Solve sequentially all PTasks (used without pthreads)
 void
 HTask::Solve(float epsilon,
@@ -271,6 +253,43 @@ HTask::Solve(float epsilon,
     }
 }
 
+struct SolveJob
+{
+    PTask **ptasks;
+    float epsilon;
+    float epsilon_abs;
+};
+
+static void
+SolvePTasks(void *data, int begin, int end, int thread)
+{
+    SolveJob *job = (SolveJob *)data;
+    for (int i = begin; i < end; ++i)
+    {
+        job->ptasks[i]->set_status(PTask::SERVICED);
+        job->ptasks[i]->set_label(thread);
+        job->ptasks[i]->Solve(job->epsilon, job->epsilon_abs);
+    }
+}
+
+// Solve the PTasks not serviced so far with a pool of threads:
+// every PTask keeps its own results, so they do not depend
+// on which thread did the work
+void
+HTask::Solve(float epsilon,
+             float epsilon_abs,
+             coTaskPool *pool)
+{
+    SolveJob job;
+    job.ptasks = ptasks_ + serviced_;
+    job.epsilon = epsilon;
+    job.epsilon_abs = epsilon_abs;
+    int todo = no_ptasks_ - serviced_;
+    pool->run(todo, 0, SolvePTasks, &job);
+    serviced_ += todo;
+    no_finished_ += todo;
+}
+
 void
 HTask::cleanPTasks()
 {
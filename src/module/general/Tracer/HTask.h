@@ -25,6 +25,10 @@ using namespace covise;
 #include <float.h>
 
 class BBoxAdmin;
+namespace covise
+{
+class coTaskPool;
+}
 
 int ExpandSetList(const coDistributedObject *const *objects, int h_many,
                   std::vector<const coDistributedObject *> &out_array);
@@ -57,6 +61,12 @@ public:
        * @param    eps_abs  absolute error per time step for step control.
        */
     void Solve(float epsilon, float epsilon_abs);
+    /** Solve all PTasks that have not been serviced yet with the threads of pool.
+       * @param    eps      relative error per time step for step control.
+       * @param    eps_abs  absolute error per time step for step control.
+       * @param    pool     work stealing pool.
+       */
+    void Solve(float epsilon, float epsilon_abs, coTaskPool *pool);
     /** Return 1 if all PTasks have been finished, 0 otherwise.
        * @return            all PTasks have been finished or not.
        */
@@ -65,15 +75,6 @@ public:
        * @return            all PTasks have been assigned to a thread.
        */
     int unserviced();
-    /** Assign a task to a thread reading tasks from "port" *pp_task
-       * @retval   pp_task address of pointer to the assigned PTask.
-       * @param    label   thread identification.
-       */
-    void assignTask(PTask **pp_task, int label);
-    /** Do whatever is necessary when a PTask is done.
-       * @retval   pp_task set the pointer to assigned task to zero.
-       */
-    void gatherPTask(PTask **pp_task);
     /** Return 1 if all time steps are done.
        * @return            all time steps are done.
        */
@@ -15,12 +15,11 @@
 #include <util/coviseCompat.h>
 #include <config/CoviseConfig.h>
 #include <util/unixcompat.h>
-#include <pthread.h>
+#include <alg/coTaskPool.h>
 #include "Tracer.h"
 #ifndef _WIN32
 #include <sys/time.h>
 #endif
-// #include "pthread_errors.h"
 //#define _DEBUG_
 //#define _DUBUG_
 //#define _PROFILE_
@@ -49,11 +48,6 @@ Tracer::postInst()
     p_control->hide();
     p_timeNewParticles->hide();
     p_randomOffset->hide();
-// at first only the main thread may modify the list of
-// lazy threads and done threads
-#ifndef CO_hp1020
-    lockMMutex();
-#endif
 }
 
 float epsilon;
@@ -78,228 +72,6 @@ bool randomOffset;
 bool randomStartpoint;
 int no_start_points;
 
-// compute, quit and worker_function for all
-// platforms with the exception of CO_hp1020
-#ifndef CO_hp1020
-// accesses to doneThreads are synchronised by m_mutex
-pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t done = PTHREAD_COND_INITIALIZER;
-
-Fifo<int> doneThreads;
-
-pthread_t *w_thread;
-void *worker_function(void *arg);
-
-// the array w_mutex synchronises accesses to the PTasks
-// referred to by read_task_ below...
-pthread_mutex_t *w_mutex;
-pthread_cond_t *w_go;
-
-void
-Tracer::lockMMutex()
-{
-    // at first only the main thread may modify the list of
-    // lazy threads and done threads
-    int diagnostics = pthread_mutex_lock(&m_mutex);
-    if (diagnostics != 0)
-    {
-        sendWarning("Could not lock the main mutex.");
-    }
-}
-
-void
-Tracer::startThreads()
-{
-    int diagnostics = 0;
-#ifdef _DUBUG_
-    fprintf(stderr, "startThreads ini\n");
-#endif
-    if (crewSize_ > 0)
-    {
-        w_thread = new pthread_t[crewSize_];
-        w_mutex = new pthread_mutex_t[crewSize_];
-        w_go = new pthread_cond_t[crewSize_];
-        int i;
-        // initialise mutexes and cond. vars.
-        for (i = 0; i < crewSize_; ++i)
-        {
-            diagnostics = pthread_mutex_init(&w_mutex[i], NULL);
-            if (diagnostics != 0)
-            {
-                sendWarning("Could not initialise a mutex.");
-            }
-            diagnostics = pthread_cond_init(&w_go[i], NULL);
-            if (diagnostics != 0)
-            {
-                sendWarning("Could not initialise a condition variable.");
-            }
-        }
-#ifdef _DUBUG_
-        fprintf(stderr, "startThreads after dynamic init\n");
-#endif
-        // set up a list of lazy threads; initially all workers are lazy
-        // here it is important that we have used lockMMutex!!!
-        lazyThreads_.clean();
-        for (i = 0; i < crewSize_; ++i)
-        {
-            lazyThreads_.add(i);
-        }
-
-        delete[] read_task_;
-        read_task_ = new PTask *[crewSize_]; // delete in destructor!!!
-#if !defined(__linux__) || defined(__USE_UNIX98)
-        pthread_setconcurrency(crewSize_);
-#endif
-        for (i = 0; i < crewSize_; ++i)
-        {
-            // read_task_[i] is a pointer to a PTask
-            // that is read or written to by the main thread
-            // and the i-th worker thread
-            // synchronised with w_mutex[i], the worker thread reads
-            // from it the task to be done,
-            // and the main thread reads from it the status
-            // of the tasks and possible results that need gathering.
-            // The value of read_task_[i] is only written by the main_thread
-            // and ist access is also synchronised with w_mutex[i].
-            read_task_[i] = new PTask(i);
-            diagnostics = pthread_mutex_lock(&w_mutex[i]);
-            if (diagnostics != 0)
-            {
-                sendWarning("Could not lock a mutex prior to thread creation.");
-            }
-            diagnostics = pthread_create(&w_thread[i], NULL, worker_function, &read_task_[i]);
-            if (diagnostics != 0)
-            {
-                sendWarning("Could not create a worker thread.");
-            }
-
-#ifdef _DUBUG_
-            fprintf(stderr, "before waiting loop\n");
-#endif
-            while (read_task_[i] != NULL)
-            {
-#ifdef _DUBUG_
-                fprintf(stderr, "before waiting\n");
-#endif
-                pthread_cond_wait(&w_go[i], &w_mutex[i]);
-#ifdef _DUBUG_
-                fprintf(stderr, "after waiting\n");
-#endif
-            }
-            // now the worker has got its label
-            // and is waiting for real work
-            diagnostics = pthread_mutex_unlock(&w_mutex[i]);
-            if (diagnostics != 0)
-            {
-                sendWarning("Could not unlock a mutex after thread creation.");
-            }
-        }
-#ifdef _DUBUG_
-        fprintf(stderr, "startThreads ends");
-#endif
-    }
-    else
-    {
-        delete[] read_task_;
-        read_task_ = NULL;
-    }
-}
-
-void Tracer::terminateThreads()
-{
-    int i, diagnostics;
-    for (i = 0; i < crewSize_; ++i)
-    {
-        diagnostics = pthread_cancel(w_thread[i]);
-        if (diagnostics != 0)
-        {
-            sendWarning("Could not cancel a thread.");
-        }
-#ifndef __APPLE__
-        // on Mac OS 10.3 this won't return
-        void *result;
-        diagnostics = pthread_join(w_thread[i], &result);
-        if (diagnostics != 0)
-        {
-            sendWarning("Could not join a thread.");
-        }
-#endif
-    }
-    delete[] w_thread;
-    w_thread = NULL;
-    delete[] w_mutex;
-    w_mutex = NULL;
-    delete[] w_go;
-    w_go = NULL;
-}
-
-void *worker_function(void *arg)
-{
-    PTask **p_read_task = (PTask **)arg;
-    int label = (*p_read_task)->get_label();
-    int diagnostics = 0;
-
-#ifdef _DEBUG_
-    fprintf(stderr, "crew %d\n", label);
-#endif
-    pthread_mutex_lock(&w_mutex[label]);
-#ifdef _DEBUG_
-    fprintf(stderr, "crew %d locked\n", label);
-#endif
-    delete (*p_read_task);
-    *p_read_task = 0;
-    pthread_cond_signal(&w_go[label]);
-#ifdef _DEBUG_
-    fprintf(stderr, "crew %d signalled\n", label);
-#endif
-
-    while (1)
-    {
-        while (!(*p_read_task) || (*p_read_task)->get_status() != PTask::SERVICED)
-        {
-#ifdef _DEBUG_
-            fprintf(stderr, "crew %d goes to sleep on w_mutex\n", label);
-#endif
-            pthread_cond_wait(&w_go[label], &w_mutex[label]);
-#ifdef _DEBUG_
-            fprintf(stderr, "crew %d awakened\n", label);
-#endif
-        }
-#ifdef _DEBUG_
-        fprintf(stderr, "crew %d goes to Solve\n", label);
-#endif
-        // integrate and set status of finished task
-        (*p_read_task)->Solve(epsilon, epsilon_abs);
-#ifdef _DEBUG_
-        fprintf(stderr, "crew %d returns from Solve\n", label);
-#endif
-
-        diagnostics = pthread_mutex_lock(&m_mutex);
-        if (diagnostics != 0)
-        {
-#ifndef YAC
-            Covise::sendWarning("A worker thread could not lock the main mutex.");
-#endif
-        }
-        // sign in the "book" of threads that have finished and signal
-        doneThreads.add(label);
-        pthread_cond_signal(&done);
-        diagnostics = pthread_mutex_unlock(&m_mutex);
-#ifdef _DEBUG_
-        fprintf(stderr, "crew %d has signaled and unlocked m_mutex\n", label);
-#endif
-        if (diagnostics != 0)
-        {
-#ifndef YAC
-            Covise::sendWarning("A worker thread could not lock the main mutex.");
-#endif
-        }
-    }
-    // the thread never gets here
-    return 0;
-}
-#endif
-
 #ifdef _DEBUG_
 void
 printObjStr(coDistributedObject *grid)
@@ -429,11 +201,6 @@ int Tracer::compute(const char *)
 #endif
 
     BBoxAdmin_.setSurname();
-#ifndef CO_hp1020
-    startThreads();
-    int diagnostics = 0;
-    int label;
-#endif
     if (computeGlobals() < 0)
         return FAIL;
     fillWhatOut(); // read output magnitude choice
@@ -475,70 +242,9 @@ int Tracer::compute(const char *)
         {
             if (crewSize_ > 0)
             {
-#ifndef CO_hp1020
-                while (theTask->unserviced() && !lazyThreads_.isEmpty())
-                {
-                    // decide assignation of an unserviced task in theTask.ptasks_
-                    // to a lazy thread
-                    label = lazyThreads_.extract();
-                    diagnostics = pthread_mutex_lock(&w_mutex[label]);
-                    if (diagnostics != 0)
-                    {
-                        sendWarning("Could not lock a mutex prior to assignTask.");
-                    }
-                    // assign task
-                    theTask->assignTask(&read_task_[label], label);
-                    pthread_cond_signal(&w_go[label]);
-                    diagnostics = pthread_mutex_unlock(&w_mutex[label]);
-                    if (diagnostics != 0)
-                    {
-                        sendWarning("Could not unlock a mutex after assignTask.");
-                    }
-                }
-#ifdef _DEBUG_
-                fprintf(stderr, "main: jobs assigned\n");
-#endif
-                // go to sleep until a thread signals
-                while (doneThreads.isEmpty())
-                {
-#ifdef _DEBUG_
-                    fprintf(stderr, "main: wait for workers\n");
-#endif
-                    pthread_cond_wait(&done, &m_mutex);
-#ifdef _DEBUG_
-                    fprintf(stderr, "main: a/some worker/s terminated\n");
-#endif
-                }
-                // add items to list of lazy threads for the threads that
-                // have signaled their having finished a task or their
-                // not being able to continue
-                do
-                {
-                    label = doneThreads.extract();
-                    lazyThreads_.add(label);
-// gather thread results
-#ifdef _DEBUG_
-                    fprintf(stderr, "main: try to gather PTask\n");
-#endif
-                    diagnostics = pthread_mutex_lock(&w_mutex[label]);
-                    if (diagnostics != 0)
-                    {
-                        sendWarning("Could not lock a mutex prior to gatherPTask.");
-                    }
-                    // do not forget to increase theTask.no_finished_ here!!!!!!!
-                    // and make *read_task_[i] = 0, well, this is not necessary,
-                    // as long as the workers have set the status to "finished"
-                    theTask->gatherPTask(&read_task_[label]);
-#ifdef _DEBUG_
-                    fprintf(stderr, "main: PTask gathered\n");
-#endif
-                    diagnostics = pthread_mutex_unlock(&w_mutex[label]);
-                    if (diagnostics != 0)
-                    {
-                        sendWarning("Could not unlock a mutex after gatherPTask.");
-                    }
-                } while (!doneThreads.isEmpty());
-#endif
+                // PTasks of very different length are balanced by work stealing,
+                // their results are gathered in the order of the PTasks
+                theTask->Solve(epsilon, epsilon_abs, coTaskPool::shared(crewSize_));
             }
             else
             {
@@ -566,9 +272,6 @@ int Tracer::compute(const char *)
 #endif
 
     delete theTask;
-#ifndef CO_hp1020
-    terminateThreads();
-#endif
 #if defined(_PROFILE_)
     sendInfo("stop run: %6.3f s", _ww.elapsed());
 #endif
@@ -1104,9 +807,6 @@ Tracer::SampleToGeometry(const coDistributedObject *grid,
 
 Tracer::Tracer(int argc, char **argv)
     : coFunctionModule(argc, argv, "Tracer")
-#ifndef CO_hp1020
-    , read_task_(NULL)
-#endif
 {
     const char *TimeChoices[] = { "forward", "backward", "both" };
     const char *MagnitudeChoices[] = { "mag", "v_x", "v_y", "v_z", "time", "id", "v" };
@@ -1133,7 +833,7 @@ Tracer::Tracer(int argc, char **argv)
     p_velo = addInputPort("dataIn", "Vec3", "input velo.");
     p_ini_points = addInputPort("pointsIn", "Points|UnstructuredGrid|Polygons|TriangleStrips|Lines|Vec3", "input initial points");
     p_ini_points->setRequired(0);
-    p_octtrees = addInputPort("octtreesIn", "OctTree|OctTreeP", "input octtrees");
+    p_octtrees = addInputPort("octtreesIn", "OctTree|OctTreeP|CellBVH", "input octtrees");
     p_octtrees->setRequired(0);
     p_field = addInputPort("fieldIn", "Float",
                            "input mapped field");
@@ -1322,7 +1022,7 @@ Tracer::GoodOctTrees(const coDistributedObject *grid, const coDistributedObject
     }
     else if (grid->isType("UNSGRD"))
     {
-        if (otree->isType("OCTREE"))
+        if (otree->isType("OCTREE") || otree->isType("CELBVH"))
         {
             return true;
         }
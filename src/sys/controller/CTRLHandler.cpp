@@ -16,6 +16,7 @@
 #include <util/unixcompat.h>
 #include <util/covise_version.h>
 #include <util/coTimer.h>
+#include <util/coTrace.h>
 #include <config/CoviseConfig.h>
 #include <config/coConfig.h>
 #include <util/Token.h>
@@ -142,6 +143,7 @@ CTRLHandler::CTRLHandler(int argc, char *argv[])
 {
 
     singleton = this;
+    coTrace::setProcessName("controller");
 
 
 //  prevent "broken pipe" forever
@@ -224,6 +226,9 @@ CTRLHandler::CTRLHandler(int argc, char *argv[])
     // load a network file
     loadNetworkFile();
 
+    // messages to the same module or map editor while handling one message share a write
+    CTRLGlobal::getInstance()->controller->init_batching();
+
     // start Controller main-Loop
     // check for daemons and handler messages
     bool startMainLoop = true;
@@ -262,7 +267,16 @@ CTRLHandler::CTRLHandler(int argc, char *argv[])
 
         if (!m_quitNow && startMainLoop)
         {
-            msg = CTRLGlobal::getInstance()->controller->wait_for_msg();
+            if (!m_cachedFinall.empty())
+            {
+                delete msg;
+                msg = new Message(COVISE_MESSAGE_FINALL, m_cachedFinall.front());
+                m_cachedFinall.pop_front();
+            }
+            else
+            {
+                msg = CTRLGlobal::getInstance()->controller->wait_for_msg();
+            }
         }
 
         handleAndDeleteMsg(msg);
@@ -280,6 +294,15 @@ CTRLHandler *CTRLHandler::instance()
     return singleton;
 }
 
+//!
+//! let a module finish whose output was taken from the result cache
+//!
+void CTRLHandler::finishCached(net_module *mod)
+{
+    // no changed parameters, no objects to save or release
+    m_cachedFinall.push_back(mod->get_name() + "\n" + mod->get_nr() + "\n" + mod->get_host() + "\n0\n0\n0\n");
+}
+
 //!
 //! Handle messages from the different covise parts
 //!
@@ -1307,6 +1330,10 @@ void CTRLHandler::handleFinall(Message *msg, string copyMessageData)
         return;
     }
 
+    // from the start message to the finish message, including the transfer of input objects
+    if (coTrace::enabled() && module->get_start_time())
+        coTrace::record("controller", "execute " + name + "_" + nr + "@" + host, module->get_start_time(), coTrace::now());
+
     module->empty_errlist();
 
     int noOfParameter;
@@ -1369,6 +1396,7 @@ void CTRLHandler::handleFinall(Message *msg, string copyMessageData)
 
     //  check if one level up is a module that has to be run
     int stat = module->get_status();
+    module->finish_result(stat != MODULE_STOP);
     module->set_status(MODULE_IDLE);
     if (!module->is_one_waiting_above(CTRLGlobal::getInstance()->userinterfaceList))
     {
@@ -1394,10 +1422,27 @@ void CTRLHandler::handleFinall(Message *msg, string copyMessageData)
         }
     }
 
+    //  start modules waiting elsewhere in the map, e.g. for a free slot
+    CTRLGlobal::getInstance()->netList->start_ready(CTRLGlobal::getInstance()->userinterfaceList);
+
     // send Finished Message to the MapEditor if no modules are running
     m_numRunning--;
     if (m_numRunning == 0)
     {
+        if (coTrace::enabled())
+        {
+            coTrace::flush();
+            int n = coTrace::merge("covise-trace");
+            if (n > 0)
+            {
+                ostringstream os;
+                os << "Controller\n \n \n wrote " << n << " trace events to " << getenv("COVISE_TRACE");
+                Message *info_msg = new Message(COVISE_MESSAGE_INFO, os.str());
+                CTRLGlobal::getInstance()->userinterfaceList->send_all(info_msg);
+                delete info_msg;
+            }
+        }
+
         if (m_quitAfterExececute)
         {
             m_quitNow = 1;
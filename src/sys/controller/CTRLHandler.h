@@ -53,6 +53,7 @@ public:
                              const string &parameterName, const string &parameterValue);
 
     vector<string> splitString(string text, const string &sep);
+    void finishCached(net_module *mod);
     bool recreate(string buffer, readMode mode);
     void sendMessage();
 
@@ -106,6 +107,9 @@ private:
     typedef std::list<std::pair<std::string, std::string> > slist;
 
     slist siblings;
+
+    // FINALL messages for modules whose output was taken from the result cache
+    std::list<std::string> m_cachedFinall;
 };
 }
 #endif
@@ -7,10 +7,13 @@
 
 
 #include <sys/stat.h>
+#include <set>
+#include <algorithm>
 
 #include <covise/covise.h>
 #include <config/CoviseConfig.h>
 #include <util/coTimer.h>
+#include <util/coTrace.h>
 #include <util/covise_version.h>
 #include <net/covise_connect.h>
 #include <covise/covise_msg.h>
@@ -28,6 +31,7 @@
 #include "control_module.h"
 #include "control_netmod.h"
 #include "control_coviseconfig.h"
+#include "control_resultcache.h"
 
 using namespace covise;
 
@@ -206,6 +210,8 @@ netlink *netlink_list::get(const string &lname, const string &lnr, const string
 //
 //**********************************************************************
 
+map<string, int> net_module::s_runningOnHost;
+
 net_module::net_module()
 {
     status = MODULE_IDLE;
@@ -221,6 +227,7 @@ net_module::net_module()
     datam = NULL;
     mark = false;
     m_errors = 0;
+    m_startTime = 0;
     reset_start_flag();
     numrunning = 0;
     m_alive = 1;
@@ -235,6 +242,9 @@ net_module::~net_module()
     {
         typ = NULL;
     }
+    if (status == MODULE_RUNNING && !is_renderer())
+        s_runningOnHost[host]--;
+    result_cache::instance()->remove(this, false);
     if (interfaces)
     {
         delete interfaces;
@@ -453,27 +463,20 @@ bool net_module::is_one_waiting_above(ui_list *ul) // one level up
 {
     bool found = false;
 
-    interfaces->reset();
-    net_interface *intf;
-    while ((intf = (net_interface *)interfaces->next()) != NULL)
+    // collect first, is_one_running_above walks the interfaces as well
+    vector<net_module *> above;
+    get_modules_above(above);
+    for (size_t i = 0; i < above.size(); i++)
     {
-        if (intf->get_direction() == "input")
+        net_module *mod = above[i];
+        if (mod->get_start_flag())
         {
-            // ist das Interface verbunden ?
-            if (intf->get_conn_state() == true)
+            found = true;
+            mod->reset_start_flag();
+            if (!mod->is_one_running_above(1))
             {
-                obj_from_conn *fr = (intf->get_object())->get_from();
-                net_module *mod = fr->get_mod();
-                if (mod->get_start_flag())
-                {
-                    found = true;
-                    mod->reset_start_flag();
-                    if (!mod->is_one_running_above(1))
-                    {
-                        CTRLHandler::instance()->m_numRunning++;
-                        mod->start_module(ul);
-                    }
-                }
+                CTRLHandler::instance()->m_numRunning++;
+                mod->start_module(ul);
             }
         }
     }
@@ -511,33 +514,24 @@ bool net_module::is_one_running_under(void)
     return false;
 }
 
-bool net_module::is_one_running_above(int first)
+void net_module::get_modules_above(vector<net_module *> &above)
 {
-    net_interface *intfs[1000];
     net_interface *intf;
-    int i = 0;
-
     interfaces->reset();
-    while ((intfs[i] = (net_interface *)interfaces->next()) != NULL)
-        i++;
-
-    i = 0;
-    while ((intf = intfs[i]) != NULL)
+    while ((intf = (net_interface *)interfaces->next()) != NULL)
     {
-        if (intf->get_direction() == "input")
+        if (intf->get_direction() == "input" && intf->get_conn_state() == true)
         {
-            // is the Interface connected ?
-            if (intf->get_conn_state() == true)
-            {
-                if ((intf->get_object())->is_one_running_above())
-                {
-                    return true;
-                }
-            }
+            obj_from_conn *fr = (intf->get_object())->get_from();
+            net_module *mod = fr ? fr->get_mod() : NULL;
+            if (mod && find(above.begin(), above.end(), mod) == above.end())
+                above.push_back(mod);
         }
-        i++;
     }
+}
 
+bool net_module::is_one_running_above(int first)
+{
     if (first == 0)
     {
         if ((get_start_flag()) || (get_status() == MODULE_RUNNING))
@@ -545,9 +539,52 @@ bool net_module::is_one_running_above(int first)
             return true;
         }
     }
+
+    // visit every module above once: the recursive walk was exponential for
+    // branches joining again, and did not terminate for feedback loops, where
+    // this module itself must not keep itself from being started
+    std::set<net_module *> visited;
+    visited.insert(this);
+    vector<net_module *> stack(1, this);
+    while (!stack.empty())
+    {
+        net_module *mod = stack.back();
+        stack.pop_back();
+
+        vector<net_module *> above;
+        mod->get_modules_above(above);
+        for (size_t i = 0; i < above.size(); i++)
+        {
+            if (!visited.insert(above[i]).second)
+                continue;
+            if ((above[i]->get_start_flag()) || (above[i]->get_status() == MODULE_RUNNING))
+                return true;
+            stack.push_back(above[i]);
+        }
+    }
     return false;
 }
 
+void net_module::set_status(int str)
+{
+    if (!is_renderer() && (str == MODULE_RUNNING) != (status == MODULE_RUNNING))
+    {
+        if (str == MODULE_RUNNING)
+            s_runningOnHost[host]++;
+        else
+            s_runningOnHost[host]--;
+    }
+    status = str;
+}
+
+bool net_module::has_free_slot()
+{
+    static int slots = coCoviseConfig::getInt("SlotsPerHost", "System.Controller", 0);
+    if (slots <= 0 || is_renderer())
+        return true;
+    return s_runningOnHost[host] < slots;
+}
+
 bool net_module::delete_old_objs()
 {
     net_interface *intf;
@@ -634,6 +671,9 @@ void net_module::delete_all_objs(int already_dead)
                 (intf->get_object())->del_all_DO(already_dead);
         }
     }
+    result_cache::instance()->remove(this, already_dead >= 0);
+    m_resultKey.clear();
+    m_pendingKey.clear();
 }
 
 bool net_module::is_on_top()
@@ -1123,8 +1163,23 @@ void net_module::start_module(ui_list *ul)
         return;
     }
 
+    if (!has_free_slot())
+    {
+        // started by net_module_list::start_ready when a module has finished
+        set_start_flag();
+        CTRLHandler::instance()->m_numRunning--;
+        return;
+    }
+
     set_status(MODULE_RUNNING);
 
+    // a cached result is finished from the main loop, its span has to start here as well
+    if (coTrace::enabled())
+        m_startTime = coTrace::now();
+
+    if (reuse_result(ul))
+        return;
+
     //delete_all Objects if not saved
     bool ret = delete_old_objs();
     //give new Names to Output_objects
@@ -1162,6 +1217,124 @@ void net_module::start_module(ui_list *ul)
     }
 }
 
+string net_module::get_result_key()
+{
+    ostringstream key;
+    key << name << "\n" << nr << "\n" << host << "\n";
+
+    // names of input objects are unique within a session
+    interfaces->reset();
+    net_interface *tmp_intf;
+    while ((tmp_intf = (net_interface *)interfaces->next()) != NULL)
+    {
+        if (tmp_intf->get_conn_state() != true)
+            continue;
+
+        key << tmp_intf->get_direction() << " " << tmp_intf->get_name() << "\n";
+        if (tmp_intf->get_direction() == "input")
+        {
+            object *obj = tmp_intf->get_object();
+            string obj_name = obj ? obj->get_current_name() : string();
+            if (obj_name.empty())
+                return "";
+            key << obj_name << "\n";
+        }
+    }
+
+    par_in->reset();
+    net_parameter *tmp_para;
+    while ((tmp_para = par_in->next()) != NULL)
+    {
+        key << tmp_para->get_name() << "\n";
+        for (int i = 1; i <= tmp_para->get_count(); i++)
+            key << tmp_para->get_value(i) << "\n";
+    }
+
+    return key.str();
+}
+
+bool net_module::reuse_result(ui_list *ul)
+{
+    result_cache *cache = result_cache::instance();
+    m_pendingKey.clear();
+    if (!cache->is_enabled(name))
+        return false;
+
+    string key = get_result_key();
+    if (key.empty())
+        return false;
+
+    // are the current output objects still there?
+    bool current = (key == m_resultKey);
+    net_interface *tmp_intf;
+    interfaces->reset();
+    while (current && (tmp_intf = (net_interface *)interfaces->next()) != NULL)
+    {
+        if (tmp_intf->get_direction() == "output" && tmp_intf->get_conn_state() == true)
+            current = tmp_intf->get_object()->has_DO();
+    }
+
+    if (!current)
+    {
+        vector<result_cache::output> cached;
+        bool found = cache->take(this, key, cached);
+
+        // keep the current output objects instead of deleting them
+        if (!m_resultKey.empty())
+        {
+            vector<result_cache::output> objs;
+            interfaces->reset();
+            while ((tmp_intf = (net_interface *)interfaces->next()) != NULL)
+            {
+                if (tmp_intf->get_direction() == "output" && tmp_intf->get_conn_state() == true)
+                {
+                    string obj_name = tmp_intf->get_object()->detach_DO();
+                    if (!obj_name.empty())
+                        objs.push_back(result_cache::output(tmp_intf->get_name(), obj_name));
+                }
+            }
+            if (!objs.empty())
+                cache->add(this, m_resultKey, objs);
+            m_resultKey.clear();
+        }
+
+        if (!found)
+        {
+            m_pendingKey = key;
+            return false;
+        }
+
+        for (size_t i = 0; i < cached.size(); i++)
+        {
+            tmp_intf = (net_interface *)interfaces->get(cached[i].first);
+            if (tmp_intf && tmp_intf->get_object())
+                tmp_intf->get_object()->attach_DO(cached[i].second);
+        }
+        m_resultKey = key;
+    }
+
+    string content = get_inparaobj();
+    if (!content.empty())
+    {
+        Message *msg = new Message(COVISE_MESSAGE_START, content);
+        ul->send_all(msg);
+        delete msg;
+    }
+
+    // finished like after running, but from the main loop
+    CTRLHandler::instance()->finishCached(this);
+    return true;
+}
+
+void net_module::finish_result(bool ok)
+{
+    if (m_pendingKey.empty())
+        return;
+    if (ok)
+        m_resultKey = m_pendingKey;
+    m_pendingKey.clear();
+}
+
 int net_module::init(int nodeid, const string &name, const string &instanz, const string &host,
                      int posx, int posy, int copy, enum Start::Flags flags, net_module *mirror_node)
 {
@@ -3552,6 +3725,32 @@ net_module_list::net_module_list()
 {
 }
 
+void net_module_list::start_ready(ui_list *ul)
+{
+    // collect first, starting a module walks this list as well
+    vector<net_module *> waiting;
+    net_module *mod;
+    this->reset();
+    while ((mod = this->next()) != NULL)
+    {
+        if (mod->get_start_flag() && mod->get_status() != MODULE_RUNNING
+            && mod->is_alive() && !mod->is_renderer())
+            waiting.push_back(mod);
+    }
+
+    for (size_t i = 0; i < waiting.size(); i++)
+    {
+        mod = waiting[i];
+        if (!mod->get_start_flag() || mod->get_status() == MODULE_RUNNING)
+            continue;
+        if (mod->is_one_running_above(1) || !mod->has_free_slot())
+            continue;
+        mod->reset_start_flag();
+        CTRLHandler::instance()->m_numRunning++;
+        mod->start_module(ul);
+    }
+}
+
 /// start a CRB for a helper
 int render_module::addHelperCRB(const string &helperHost, const string &host)
 {
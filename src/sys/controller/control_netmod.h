@@ -20,6 +20,8 @@
 #include "control_object.h"
 #include "control_module.h"
 #include <string>
+#include <vector>
+#include <map>
 
 //#ifndef __sgi
 //#include <sys/times.h>
@@ -311,6 +313,15 @@ class net_module
     /// number of errors sent by module
     int m_errors;
 
+    /// time the last start message was sent, see coTrace::now()
+    long long m_startTime;
+
+    /// key of the current output objects, see get_result_key()
+    string m_resultKey;
+
+    /// key of the running execution
+    string m_pendingKey;
+
     /// status of the process associated to the module
     /// 0 - process not running anymore (crashed or in process of deletion)
     int m_alive;
@@ -445,6 +456,9 @@ public:
     /// list of errors sent by module
     vector<string> m_errlist;
 
+    /// number of modules running on each host
+    static map<string, int> s_runningOnHost;
+
     /**
        *  setting the status of the corresponding process
        *  @param  al  0-process terminated  1-process running
@@ -704,10 +718,51 @@ public:
        *   set the status of the module
        *   @param str  the status of the module: MODULE_RUNNING or MODULE_IDLE
        */
-    void set_status(int str)
+    void set_status(int str);
+
+    /**
+       *  check if another module may be started on the host of this module,
+       *  the number of modules running on one host is limited by
+       *  System.Controller.SlotsPerHost (0: no limit)
+       *  @return   true or false
+       */
+    bool has_free_slot();
+
+    /**
+       *  get the modules connected to the input ports of this module
+       *  @param  above   the modules, each of them once
+       */
+    void get_modules_above(vector<net_module *> &above);
+
+    /**
+       *  time the module was started last, for tracing
+       *  @return   microseconds, see coTrace::now()
+       */
+    long long get_start_time() const
     {
-        status = str;
-    };
+        return m_startTime;
+    }
+
+    /**
+       *  identify the output of an execution by module, parameters,
+       *  input objects and connected output ports
+       *  @return   the key, empty if an input object is missing
+       */
+    string get_result_key();
+
+    /**
+       *  take the output for the current parameters and input objects from
+       *  the result cache, the module is finished without running
+       *  @param   ul   the list of user interfaces
+       *  @return   true if the module does not have to run
+       */
+    bool reuse_result(ui_list *ul);
+
+    /**
+       *  remember the key of the output of a finished execution
+       *  @param   ok   false if the module has stopped the pipeline
+       */
+    void finish_result(bool ok);
 
     /**
        *  get the status of the module
@@ -1188,6 +1243,10 @@ public:
 
     void set_to_finish(ui_list *uilist);
 
+    /// start all modules waiting for execution which have no running or
+    /// waiting module above them and a free slot on their host
+    void start_ready(ui_list *ul);
+
     void save_config(const string &filename);
     bool load_config(const string &filename);
     char *openNetFile(const string &filename);
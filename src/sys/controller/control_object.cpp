@@ -653,6 +653,34 @@ void object::new_DO()
     to->new_DO(new_name);
 }
 
+// true if the current data object was created and not yet deleted
+bool object::has_DO()
+{
+    data *tmp_data = dataobj->get_new();
+    return tmp_data != NULL && tmp_data->get_status() != "DEL";
+}
+
+// remove the current data object from the lists without destroying it,
+// returns its name or an empty string
+string object::detach_DO()
+{
+    data *tmp_data = dataobj->get_new();
+    if (tmp_data == NULL || tmp_data->get_save_status() != 0 || tmp_data->get_status() == "DEL")
+        return "";
+
+    string name = tmp_data->get_name();
+    to->del_old_DO(name);
+    dataobj->remove(tmp_data);
+    return name;
+}
+
+// make an existing data object the current one, like new_DO
+void object::attach_DO(const string &name)
+{
+    dataobj->new_data(name);
+    to->new_DO(name);
+}
+
 void object::del_old_DO()
 {
     obj_from_conn *tmp_from = this->get_from();
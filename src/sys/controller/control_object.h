@@ -278,6 +278,9 @@ public:
 
     void new_timestep();
     void new_DO();
+    bool has_DO();
+    string detach_DO();
+    void attach_DO(const string &name);
     void del_old_DO();
     void del_rez_DO();
     void del_all_DO(int already_dead);
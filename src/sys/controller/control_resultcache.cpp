@@ -0,0 +1,150 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include <covise/covise.h>
+#include <config/CoviseConfig.h>
+#include <net/covise_connect.h>
+#include <covise/covise_msg.h>
+
+#include "CTRLHandler.h"
+#include "control_process.h"
+#include "control_object.h"
+#include "control_netmod.h"
+#include "control_resultcache.h"
+
+using namespace covise;
+
+result_cache *result_cache::instance()
+{
+    static result_cache *singleton = NULL;
+    if (!singleton)
+        singleton = new result_cache;
+    return singleton;
+}
+
+result_cache::result_cache()
+{
+    std::istringstream modules(coCoviseConfig::getEntry("modules", "System.Controller.ResultCache", ""));
+    string name;
+    while (modules >> name)
+        m_modules.insert(name);
+    m_budget = (long)coCoviseConfig::getInt("memory", "System.Controller.ResultCache", 1024) * 1024 * 1024;
+}
+
+bool result_cache::is_enabled(const string &name) const
+{
+    return m_modules.find(name) != m_modules.end();
+}
+
+void result_cache::add(net_module *mod, const string &key, const vector<output> &objs)
+{
+    entry e;
+    e.mod = mod;
+    e.key = key;
+    e.objs = objs;
+    e.bytes = 0;
+    for (size_t i = 0; i < objs.size(); i++)
+    {
+        long size = get_size(mod->get_dm(), objs[i].second);
+        if (size > 0)
+            e.bytes += size;
+    }
+
+    m_bytes[mod->get_host()] += e.bytes;
+    m_entries.push_front(e);
+    evict(mod->get_host());
+}
+
+bool result_cache::take(net_module *mod, const string &key, vector<output> &objs)
+{
+    for (std::list<entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->mod == mod && it->key == key)
+        {
+            objs = it->objs;
+            m_bytes[mod->get_host()] -= it->bytes;
+            m_entries.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void result_cache::remove(net_module *mod, bool destroy_objs)
+{
+    for (std::list<entry>::iterator it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (it->mod == mod)
+        {
+            if (destroy_objs)
+                destroy(*it);
+            m_bytes[mod->get_host()] -= it->bytes;
+            it = m_entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void result_cache::evict(const string &host)
+{
+    std::list<entry>::iterator it = m_entries.end();
+    while (m_bytes[host] > m_budget && it != m_entries.begin())
+    {
+        --it;
+        if (it->mod->get_host() != host)
+            continue;
+        destroy(*it);
+        m_bytes[host] -= it->bytes;
+        it = m_entries.erase(it);
+    }
+}
+
+void result_cache::destroy(entry &e)
+{
+    AppModule *dmod = e.mod->get_dm();
+    for (size_t i = 0; i < e.objs.size(); i++)
+    {
+        data tmp_data;
+        tmp_data.set_name(e.objs[i].second);
+        tmp_data.del_data(dmod);
+    }
+}
+
+// ask the data manager of the module for the shared memory used by an object
+long result_cache::get_size(AppModule *dmod, const string &name)
+{
+    Message *msg = new Message(COVISE_MESSAGE_CTRL_OBJECT_SIZE, name);
+    dmod->send_msg(msg);
+    delete msg;
+
+    long size = -1;
+    msg = new Message;
+    dmod->recv_msg(msg);
+    switch (msg->type)
+    {
+    case COVISE_MESSAGE_EMPTY:
+    case COVISE_MESSAGE_CLOSE_SOCKET:
+    case COVISE_MESSAGE_SOCKET_CLOSED:
+        CTRLHandler::instance()->handleClosedMsg(msg);
+        break;
+
+    case COVISE_MESSAGE_MSG_OK:
+        if (msg->data)
+            size = atol(msg->data);
+        break;
+
+    default:
+        break;
+    }
+
+    msg->delete_data();
+    delete msg;
+    return size;
+}
@@ -0,0 +1,97 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CTRL_RESULTCACHE_H
+#define CTRL_RESULTCACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+
+namespace covise
+{
+
+using std::string;
+using std::vector;
+
+class net_module;
+class AppModule;
+
+/************************************************************************/
+/* 									                                          */
+/* 			RESULT_CACHE					                                 */
+/* 									                                          */
+/************************************************************************/
+
+/**
+ *  result_cache class: keeps the output objects of former executions of
+ *  modules in shared memory, so that an execution with the same
+ *  parameters and input objects can take them instead of running again.
+ *
+ *  Caching is enabled for the modules listed in
+ *  System.Controller.ResultCache "modules", e.g.
+ *  <ResultCache modules="ReadEnsight ReadFluent ReadCGNS" memory="4096" />.
+ *  The objects kept for the modules on one host are limited to "memory"
+ *  MB (default 1024), the least recently used results are destroyed first.
+ *  The current results of the modules are not counted.
+ */
+class result_cache
+{
+public:
+    /// output interface and name of an object
+    typedef std::pair<string, string> output;
+
+    static result_cache *instance();
+
+    /// true if results of the module type name are cached
+    bool is_enabled(const string &name) const;
+
+    /**
+       *  keep the objects computed by mod for key
+       *  @param   mod   the module owning the objects
+       *  @param   key   see net_module::get_result_key()
+       *  @param   objs  the objects, they must no longer be referenced by the module
+       */
+    void add(net_module *mod, const string &key, const vector<output> &objs);
+
+    /**
+       *  take the objects computed by mod for key out of the cache
+       *  @return   false if there are none
+       */
+    bool take(net_module *mod, const string &key, vector<output> &objs);
+
+    /**
+       *  forget all results of mod
+       *  @param   destroy_objs   also destroy the objects in shared memory
+       */
+    void remove(net_module *mod, bool destroy_objs);
+
+private:
+    struct entry
+    {
+        net_module *mod;
+        string key;
+        vector<output> objs;
+        long bytes;
+    };
+
+    result_cache();
+
+    /// destroy least recently used results until host is within the budget
+    void evict(const string &host);
+    void destroy(entry &e);
+    long get_size(AppModule *dmod, const string &name);
+
+    std::set<string> m_modules;
+    long m_budget;
+    std::list<entry> m_entries; // most recently used first
+    std::map<string, long> m_bytes; // per host
+};
+}
+#endif
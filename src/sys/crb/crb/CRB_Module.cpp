@@ -111,7 +111,7 @@ void module::set_category(const char *str)
     strcpy(category, str);
 }
 
-void module::start(char *parameter, Start::Flags flags)
+void module::start(char *parameter, Start::Flags flags, modulePool *pool)
 {
     char *argv[100];
     char *tmp = parameter;
@@ -294,6 +294,13 @@ void module::start(char *parameter, Start::Flags flags)
 #endif
 
 #else
+    if (flags == Start::Normal && pool)
+    {
+        std::string library = modulePool::library_for(execpath);
+        if (!library.empty() && pool->start(library.c_str(), execpath, argv))
+            return;
+    }
+
     int pid = fork();
     if (0 == pid)
     {
@@ -505,6 +512,11 @@ moduleList::moduleList()
         coDirectory *dir = coDirectory::open(buf);
         if (dir)
         {
+#ifndef _WIN32
+            std::string host = std::string(buf) + "/moduleHost";
+            if (hostpath.empty() && access(host.c_str(), X_OK) == 0)
+                hostpath = host;
+#endif
             for (int i = 0; i < dir->count(); i++) // skip . and ..
             {
                 if (dir->is_directory(i) && strcmp(dir->name(i), ".") && strcmp(dir->name(i), ".."))
@@ -704,11 +716,24 @@ char *moduleList::get_list_message()
     return (buf.return_data());
 }
 
+void moduleList::startPool()
+{
+    if (hostpath.empty())
+        return;
+    // no module has been built as library
+    std::string libdir = hostpath.substr(0, hostpath.length() - strlen("bin/moduleHost")) + "lib/modules";
+    if (access(libdir.c_str(), R_OK) != 0)
+        return;
+    int size = coCoviseConfig::getInt("size", "System.CRB.ModulePool", 4);
+    if (size > 0)
+        pool.init(hostpath.c_str(), size);
+}
+
 int moduleList::start(char *name, char *category, char *parameter, Start::Flags flags)
 {
     if (find(name, category))
     {
-        current()->start(parameter, flags);
+        current()->start(parameter, flags, &pool);
         return (1);
     }
 
@@ -8,6 +8,8 @@
 #include <covise/covise.h>
 #include <util/DLinkList.h>
 
+#include "CRB_ModulePool.h"
+
 class Start
 {
 public:
@@ -45,7 +47,7 @@ public:
     {
         return (category);
     };
-    void start(char *parameter, Start::Flags flags);
+    void start(char *parameter, Start::Flags flags, modulePool *pool = NULL);
 
 private:
 };
@@ -70,6 +72,9 @@ public:
     // Find an alias for a given module
     void startRenderer(char *name, char *category);
 
+    // Spawn the module hosts for modules built as libraries
+    void startPool();
+
     char *get_list_message(); // You have to delete the returned pointer
 private:
     // search for Modules in Covise_dir/bin/subdir
@@ -78,6 +83,10 @@ private:
     // append module, taking aliases into account
     void appendModule(const char *name, const char *execpath, const char *category);
 
+    // moduleHost executable found next to the modules, empty if there is none
+    std::string hostpath;
+    modulePool pool;
+
     // module aliases
     struct less_than_str
     {
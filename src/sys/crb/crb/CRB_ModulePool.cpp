@@ -0,0 +1,182 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#endif
+
+#include "CRB_ModulePool.h"
+
+modulePool::modulePool()
+    : m_size(0)
+{
+}
+
+modulePool::~modulePool()
+{
+#ifndef _WIN32
+    // the hosts exit when their pipe is closed
+    for (size_t i = 0; i < m_idle.size(); i++)
+        close(m_idle[i]);
+#endif
+}
+
+#ifdef _WIN32
+
+// modules are always started with CreateProcess on Windows
+
+void modulePool::init(const char *, int)
+{
+}
+
+bool modulePool::start(const char *, const char *, char *[])
+{
+    return false;
+}
+
+std::string modulePool::library_for(const char *)
+{
+    return std::string();
+}
+
+int modulePool::spawn()
+{
+    return -1;
+}
+
+#else
+
+void modulePool::init(const char *hostpath, int size)
+{
+    m_hostpath = hostpath;
+    m_size = size;
+    while ((int)m_idle.size() < m_size)
+    {
+        int fd = spawn();
+        if (fd < 0)
+            break;
+        m_idle.push_back(fd);
+    }
+}
+
+int modulePool::spawn()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        fprintf(stderr, "modulePool: pipe failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    int pid = fork();
+    if (0 == pid)
+    {
+        // a waiting host must not keep connections of the CRB open
+        long maxfd = sysconf(_SC_OPEN_MAX);
+        if (maxfd < 0 || maxfd > 1024)
+            maxfd = 1024;
+        for (int fd = 3; fd < maxfd; fd++)
+        {
+            if (fd != fds[0])
+                close(fd);
+        }
+
+        char fdarg[16];
+        snprintf(fdarg, sizeof(fdarg), "%d", fds[0]);
+        execl(m_hostpath.c_str(), "moduleHost", fdarg, (char *)NULL);
+        fprintf(stderr, "executing %s failed: %s\n", m_hostpath.c_str(), strerror(errno));
+        _exit(1);
+    }
+    close(fds[0]);
+    if (-1 == pid)
+    {
+        fprintf(stderr, "modulePool: forking for %s failed: %s\n", m_hostpath.c_str(), strerror(errno));
+        close(fds[1]);
+        return -1;
+    }
+    //Needed to prevent zombies
+    //if childs terminate
+    signal(SIGCHLD, SIG_IGN);
+
+    // neither modules nor other hosts may inherit the pipe, the host would not see its end
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return fds[1];
+}
+
+static bool writeAll(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool modulePool::start(const char *library, const char *execpath, char *argv[])
+{
+    // library, executable and arguments, separated by '\0'
+    std::string cmd;
+    cmd.append(library).push_back('\0');
+    cmd.append(execpath).push_back('\0');
+    for (int i = 0; argv[i]; i++)
+        cmd.append(argv[i]).push_back('\0');
+    uint32_t len = (uint32_t)cmd.size();
+
+    // a host which has died is noticed by a failing write
+    void (*oldHandler)(int) = signal(SIGPIPE, SIG_IGN);
+    bool started = false;
+    for (int tries = 0; !started && tries < m_size && !m_idle.empty(); tries++)
+    {
+        int fd = m_idle.front();
+        m_idle.pop_front();
+        started = writeAll(fd, (const char *)&len, sizeof(len))
+                  && writeAll(fd, cmd.data(), cmd.size());
+        close(fd);
+
+        int newfd = spawn();
+        if (newfd >= 0)
+            m_idle.push_back(newfd);
+    }
+    signal(SIGPIPE, oldHandler);
+    return started;
+}
+
+std::string modulePool::library_for(const char *execpath)
+{
+    // <prefix>/bin/<category>/<name> -> <prefix>/lib/modules/<category>/lib<name>.so
+    std::string exe(execpath);
+    std::string::size_type bin = exe.rfind("/bin/");
+    std::string::size_type slash = exe.rfind('/');
+    if (bin == std::string::npos || slash <= bin + 4)
+        return std::string();
+    std::string lib = exe.substr(0, bin) + "/lib/modules/" + exe.substr(bin + 5, slash - bin - 4) + "lib" + exe.substr(slash + 1) + ".so";
+
+    // do not use a library older than the executable, only the latter might have been rebuilt
+    struct stat libStat, exeStat;
+    if (stat(lib.c_str(), &libStat) != 0 || stat(execpath, &exeStat) != 0)
+        return std::string();
+    if (libStat.st_mtime < exeStat.st_mtime)
+        return std::string();
+    return lib;
+}
+
+#endif
@@ -0,0 +1,63 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef CRB_MODULEPOOL_H
+#define CRB_MODULEPOOL_H
+
+#include <string>
+#include <deque>
+
+/************************************************************************/
+/* 									*/
+/* 			ModulePool 					*/
+/* 									*/
+/************************************************************************/
+
+/**
+ *  modulePool: keeps moduleHost processes waiting, which have loaded the
+ *  COVISE libraries and read the configuration already. A module built
+ *  as library (listed in COVISE_MODULE_LIBRARIES) is started by handing
+ *  it to a waiting host instead of executing it, a new host is spawned
+ *  for the next start right away.
+ *
+ *  The number of hosts is System.CRB.ModulePool "size" (default 4, 0
+ *  disables the pool), e.g. <ModulePool size="8" />.
+ */
+class modulePool
+{
+public:
+    modulePool();
+    ~modulePool();
+
+    /**
+       *  spawn the hosts
+       *  @param   hostpath   path of the moduleHost executable
+       *  @param   size       number of waiting hosts
+       */
+    void init(const char *hostpath, int size);
+
+    /**
+       *  run a module in a waiting host
+       *  @param   library    the module library, see library_for()
+       *  @param   execpath   the module executable, used if the library cannot be loaded
+       *  @param   argv       arguments of the module, NULL terminated
+       *  @return  false if no host took the module
+       */
+    bool start(const char *library, const char *execpath, char *argv[]);
+
+    /// library built for the module executable execpath, empty if there is none
+    static std::string library_for(const char *execpath);
+
+private:
+    /// start a host, returns the write end of its command pipe or -1
+    int spawn();
+
+    std::string m_hostpath;
+    int m_size;
+    std::deque<int> m_idle; // command pipes of the waiting hosts, oldest first
+};
+#endif
@@ -10,6 +10,7 @@
 
 #include <util/unixcompat.h>
 #include <util/coFileUtil.h>
+#include <util/coTrace.h>
 #include <net/covise_host.h>
 
 #ifndef _WIN32
@@ -51,6 +52,7 @@ Host *host;
 
 int main(int argc, char *argv[])
 {
+    long long startTime = coTrace::now();
     covise::setupEnvironment(argc, argv);
 
     Message *msg;
@@ -83,6 +85,9 @@ int main(int argc, char *argv[])
 
     putenv((char *)"CO_MODULE_BACKEND=covise");
 
+    // spawned before connecting, so that the module hosts do not inherit the connections
+    mod.startPool();
+
 #ifdef _WIN32
     WORD wVersionRequested;
     WSADATA wsaData;
@@ -141,6 +146,13 @@ int main(int argc, char *argv[])
     msg->delete_data(); // because datamgr allocated data
     delete msg; // msg->data can be deleted
 
+    // from exec by the controller until the module list has been sent
+    coTrace::record("crb", "CRB process start", startTime, coTrace::now());
+    coTrace::flush();
+
+    // messages to the controller, modules and other data managers while handling one message share a write
+    datamgr->init_batching();
+
     bool localAlloc = false;
     while (1)
     {
@@ -0,0 +1,97 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Generic module process kept ready by the CRB (see CRB_ModulePool.h).
+// The COVISE libraries are loaded and the configuration is read before a
+// module is requested, then the host blocks on its command pipe. A
+// command names the library of a module, its executable and the arguments
+// of the module. The host loads the library and runs the module in this
+// process, if the library cannot be used it executes the module
+// executable instead. The host exits when the CRB closes the pipe.
+//
+// usage: moduleHost <file descriptor of the command pipe>
+
+#include <covise/covise.h>
+#include <config/CoviseConfig.h>
+
+#include <dlfcn.h>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+using namespace covise;
+
+typedef int (*ModuleMain)(int argc, char *argv[]);
+
+static bool readAll(int fd, char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = read(fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "moduleHost: usage: moduleHost <fd>\n");
+        return 1;
+    }
+    int fd = atoi(argv[1]);
+
+    // warm up: parse the configuration files now instead of when the module starts
+    coCoviseConfig::getEntry("System.CRB.ModulePool");
+
+    uint32_t len = 0;
+    if (!readAll(fd, (char *)&len, sizeof(len)) || len == 0)
+        return 0;
+    char *cmd = new char[len + 1];
+    if (!readAll(fd, cmd, len))
+        return 0;
+    cmd[len] = '\0';
+    close(fd);
+
+    // library, executable and arguments, separated by '\0'
+    std::vector<char *> words;
+    for (char *p = cmd; p < cmd + len; p += strlen(p) + 1)
+        words.push_back(p);
+    if (words.size() < 3)
+    {
+        fprintf(stderr, "moduleHost: incomplete command\n");
+        return 1;
+    }
+    char *library = words[0];
+    char *execpath = words[1];
+    std::vector<char *> modArgv(words.begin() + 2, words.end());
+    modArgv.push_back(NULL);
+
+#ifdef __linux__
+    prctl(PR_SET_NAME, modArgv[0], 0, 0, 0);
+#endif
+
+    void *handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+    ModuleMain moduleMain = handle ? (ModuleMain)dlsym(handle, "covise_module_main") : NULL;
+    if (!moduleMain)
+    {
+        fprintf(stderr, "moduleHost: cannot run %s from %s (%s), executing it\n", modArgv[0], library, dlerror());
+        execv(execpath, &modArgv[0]);
+        fprintf(stderr, "moduleHost: executing %s failed: %s\n", execpath, strerror(errno));
+        return 1;
+    }
+
+    return moduleMain((int)modArgv.size() - 1, &modArgv[0]);
+}
@@ -571,6 +571,7 @@ static bool isRegularType(const QString &t)
             << "Text"
             << "OctTree"
             << "OctTreeP"
+            << "CellBVH"
             << "DoubleArr";
     }
 
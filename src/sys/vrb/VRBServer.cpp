@@ -26,6 +26,7 @@
 #include <net/covise_connect.h>
 #include <net/tokenbuffer.h>
 #include <util/unixcompat.h>
+#include <util/coWristWatch.h>
 #include <coTUIFileBrowser/FileSysAccess.h>
 #include <coTUIFileBrowser/NetHelp.h>
 
@@ -130,12 +131,44 @@ void VRBServer::loop()
     }
 }
 
+// registry changes are coalesced over at most this many messages or seconds
+static const int MaxCoalescedMessages = 256;
+static const float MaxCoalesceDelay = 0.01f;
+
+// messages which only change the registry and do not depend on its observers being informed
+static bool isRegistryUpdate(int type)
+{
+    switch (type)
+    {
+    case COVISE_MESSAGE_VRB_REGISTRY_SET_VALUE:
+    case COVISE_MESSAGE_VRB_REGISTRY_CREATE_ENTRY:
+    case COVISE_MESSAGE_VRB_REGISTRY_DELETE_ENTRY:
+    case COVISE_MESSAGE_VRB_REGISTRY_SUBSCRIBE_CLASS:
+    case COVISE_MESSAGE_VRB_REGISTRY_SUBSCRIBE_VARIABLE:
+    case COVISE_MESSAGE_VRB_REGISTRY_UNSUBSCRIBE_CLASS:
+    case COVISE_MESSAGE_VRB_REGISTRY_UNSUBSCRIBE_VARIABLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
 void VRBServer::processMessages()
 {
     Connection *conn;
     Connection *clientConn;
+    int coalesced = 0;
+    coWristWatch sinceFlush;
     while ((conn = connections->check_for_input(0.0001f)))
     {
+        // do not delay observers without bound under sustained input
+        if (coalesced >= MaxCoalescedMessages || (coalesced > 0 && sinceFlush.elapsed() > MaxCoalesceDelay))
+        {
+            registry.flush();
+            coalesced = 0;
+            sinceFlush.reset();
+        }
+
         if (conn == sConn) // connection to server port
         {
             clientConn = sConn->spawn_connection();
@@ -179,6 +212,7 @@ void VRBServer::processMessages()
 
                 if (msg)
                 {
+                    ++coalesced;
                     handleClient(msg);
 #ifdef MB_DEBUG
                     std::cerr << "Left handleClient!" << std::endl;
@@ -202,6 +236,8 @@ void VRBServer::processMessages()
 #endif
         }
     }
+    // inform observers once about all registry changes of this round
+    registry.flush();
 }
 
 void VRBServer::handleClient(Message *msg)
@@ -213,6 +249,10 @@ void VRBServer::handleClient(Message *msg)
     int fd;
     TokenBuffer tb(msg);
 
+    // forwarded messages must not overtake pending registry changes
+    if (!isRegistryUpdate(msg->type))
+        registry.flush();
+
     switch (msg->type)
     {
     case COVISE_MESSAGE_VRB_REQUEST_FILE:
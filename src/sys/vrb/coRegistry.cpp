@@ -6,9 +6,11 @@
  * License: LGPL 2+ */
 
 #include <stdio.h>
+#include <algorithm>
 #include "coRegistry.h"
 #include "VRBClientList.h"
 #include <util/unixcompat.h>
+#include <net/covise_connect.h>
 #include <net/tokenbuffer.h>
 
 using namespace std;
@@ -20,66 +22,34 @@ int dataCaching = 0;
 coRegistry *coRegistry::instance = NULL;
 void observerList::addObserver(int recvID)
 {
-    int i, *newList = new int[numObservers + 1];
-    for (i = 0; i < numObservers; i++)
-        newList[i] = observers[i];
-    delete[] observers;
-    observers = newList;
-    observers[numObservers] = recvID;
-    numObservers++;
+    observers.push_back(recvID);
 }
 
 void observerList::removeObserver(int recvID)
 {
-    int i;
-    for (i = 0; i < numObservers; i++)
-    {
-        if (observers[i] == recvID)
-        {
-            i++;
-            while (i <= numObservers)
-            {
-                observers[i - 1] = observers[i];
-                i++;
-            }
-            numObservers--;
-            break;
-        }
-    }
+    std::vector<int>::iterator it = std::find(observers.begin(), observers.end(), recvID);
+    if (it != observers.end())
+        observers.erase(it);
 }
 
 void observerList::copyObservers(regClass *c)
 {
-    int i;
-    for (i = 0; i < numObservers; i++)
+    for (size_t i = 0; i < observers.size(); i++)
     {
         c->observe(observers[i], NULL);
     }
 }
 
-void observerList::serveObservers(regVar *v)
-{
-    int i;
-    TokenBuffer sb;
-    sb << v->getClass()->getName();
-    sb << v->getClass()->getID();
-    sb << v->getName();
-    sb << v->getValue();
-    for (i = 0; i < numObservers; i++)
-    {
-        clients.sendMessageToID(sb, observers[i], COVISE_MESSAGE_VRB_REGISTRY_ENTRY_CHANGED);
-    }
-}
-
 void observerList::informDeleteObservers(regVar *v)
 {
-    int i;
+    if (observers.empty())
+        return;
     TokenBuffer sb;
     sb << v->getClass()->getName();
     sb << v->getClass()->getID();
     sb << v->getName();
     sb << v->getValue();
-    for (i = 0; i < numObservers; i++)
+    for (size_t i = 0; i < observers.size(); i++)
     {
         clients.sendMessageToID(sb, observers[i], COVISE_MESSAGE_VRB_REGISTRY_ENTRY_DELETED);
     }
@@ -93,10 +63,13 @@ regVar::regVar(regClass *c, const char *n, const char *v, int s)
     strcpy(name, n);
     setValue(v);
     staticVar = s;
+    pendingIndex = -1;
 }
 
 regVar::~regVar()
 {
+    if (pendingIndex >= 0 && coRegistry::instance)
+        coRegistry::instance->cancel(this);
     observers.informDeleteObservers(this);
     getClass()->getOList()->informDeleteObservers(this);
     delete[] name;
@@ -110,6 +83,13 @@ regClass::regClass(const char *n, int ID)
     classID = ID;
 }
 
+regClass::~regClass()
+{
+    for (VarMap::iterator it = vars.begin(); it != vars.end(); ++it)
+        delete it->second;
+    delete[] name;
+}
+
 void regVar::setValue(const char *v)
 {
     delete[] value;
@@ -188,15 +168,7 @@ void coRegistry::setVar(const char *className, int ID, const char *name, const c
     regClass *rc = getClass(className, ID);
     if (!rc)
     {
-        regClass *grc;
-        rc = new regClass(className, ID);
-        append(rc);
-        grc = getClass(className, 0);
-        if (grc)
-        {
-            // we have a generic observer for this class name, copy observers
-            grc->getOList()->copyObservers(rc);
-        }
+        rc = newClass(className, ID);
     }
     regVar *rv = rc->getVar(name);
     if (rv)
@@ -206,10 +178,9 @@ void coRegistry::setVar(const char *className, int ID, const char *name, const c
     else
     {
         rv = new regVar(rc, name, value);
-        rc->append(rv);
+        rc->addVar(rv);
     }
-    rc->getOList()->serveObservers(rv);
-    rv->getOList()->serveObservers(rv);
+    changed(rv);
     rv->updateUIs();
 }
 
@@ -219,23 +190,15 @@ void coRegistry::create(const char *className, int ID, const char *name, int s)
     regClass *rc = getClass(className, ID);
     if (!rc)
     {
-        regClass *grc;
-        rc = new regClass(className, ID);
-        append(rc);
-        grc = getClass(className, 0);
-        if (grc)
-        {
-            // we have a generic observer for this class name, copy observers
-            grc->getOList()->copyObservers(rc);
-        }
+        rc = newClass(className, ID);
     }
     regVar *rv = rc->getVar(name);
     if (!rv)
     {
         rv = new regVar(rc, name, "", s);
-        rc->append(rv);
+        rc->addVar(rv);
     }
-    rc->getOList()->serveObservers(rv);
+    changed(rv);
 }
 
 /// get a boolean Variable
@@ -272,17 +235,11 @@ void coRegistry::deleteEntry(const char *className, int ID, const char *name)
     {
         return;
     }
-    reset();
-    while (current())
+    std::vector<regClass *> found;
+    getClasses(className, ID, found);
+    for (size_t i = 0; i < found.size(); i++)
     {
-        if ((ID == 0) || (current()->getID() == ID))
-        {
-            if (!strcmp(current()->getName(), className))
-            {
-                current()->deleteVar(name);
-            }
-        }
-        next();
+        found[i]->deleteVar(name);
     }
 }
 
@@ -292,14 +249,13 @@ void coRegistry::deleteEntry(int modID)
     {
         return;
     }
-    reset();
-    while (current())
+    for (ClassMap::iterator it = classes.begin(); it != classes.end(); ++it)
     {
-        if (current()->getID() == modID)
+        std::unordered_map<int, regClass *>::iterator c = it->second.byID.find(modID);
+        if (c != it->second.byID.end())
         {
-            current()->deleteAllNonStaticVars();
+            c->second->deleteAllNonStaticVars();
         }
-        next();
     }
 }
 
@@ -309,27 +265,62 @@ regClass *coRegistry::getClass(const char *name, int ID)
     {
         return (NULL);
     }
-    reset();
-    while (current())
+    ClassMap::iterator it = classes.find(name);
+    if (it == classes.end())
     {
-        if ((ID == 0) || (current()->getID() == ID))
-        {
-            if (!strcmp(current()->getName(), name))
-                return (current());
-        }
-        next();
+        return (NULL);
+    }
+    // ID 0: any class of this name, the oldest one
+    if (ID == 0)
+    {
+        return (it->second.classes.front());
+    }
+    std::unordered_map<int, regClass *>::iterator c = it->second.byID.find(ID);
+    if (c == it->second.byID.end())
+    {
+        //cerr << "Class " << name << " not found!\n";
+        return (NULL);
+    }
+    return (c->second);
+}
+
+void coRegistry::getClasses(const char *className, int ID, std::vector<regClass *> &found)
+{
+    if (ID == 0)
+    {
+        ClassMap::iterator it = classes.find(className);
+        if (it != classes.end())
+            found = it->second.classes;
+    }
+    else if (regClass *rc = getClass(className, ID))
+    {
+        found.push_back(rc);
+    }
+}
+
+regClass *coRegistry::newClass(const char *className, int ID, bool copyObservers)
+{
+    regClass *grc = copyObservers ? getClass(className, 0) : NULL;
+    regClass *rc = new regClass(className, ID);
+    classEntry &entry = classes[className];
+    entry.classes.push_back(rc);
+    entry.byID[ID] = rc;
+    if (grc)
+    {
+        // we have a generic observer for this class name, copy observers
+        grc->getOList()->copyObservers(rc);
     }
-    //cerr << "Class " << name << " not found!\n";
-    return (NULL);
+    return rc;
 }
 
 void coRegistry::unObserve(int recvID)
 {
-    reset();
-    while (current())
+    for (ClassMap::iterator it = classes.begin(); it != classes.end(); ++it)
     {
-        current()->unObserve(recvID);
-        next();
+        for (size_t i = 0; i < it->second.classes.size(); i++)
+        {
+            it->second.classes[i]->unObserve(recvID);
+        }
     }
 }
 
@@ -339,28 +330,15 @@ void coRegistry::observe(const char *className, int ID, int recvID, const char *
     {
         return;
     }
-    int foundOne = 0;
-    reset();
-    while (current())
+    std::vector<regClass *> found;
+    getClasses(className, ID, found);
+    for (size_t i = 0; i < found.size(); i++)
     {
-        if ((ID == 0) || (current()->getID() == ID))
-        {
-            if (!strcmp(current()->getName(), className))
-            {
-                current()->observe(recvID, variableName);
-                foundOne = 1;
-            }
-        }
-        next();
+        found[i]->observe(recvID, variableName);
     }
-    if (!foundOne)
+    if (found.empty())
     {
-        regClass *rc = getClass(className, ID);
-        if (!rc)
-        {
-            rc = new regClass(className, ID);
-            append(rc);
-        }
+        regClass *rc = newClass(className, ID, false);
         rc->observe(recvID, variableName);
     }
 }
@@ -371,21 +349,13 @@ void coRegistry::unObserve(const char *className, int ID, int recvID, const char
     {
         return;
     }
-    int foundOne = 0;
-    reset();
-    while (current())
+    std::vector<regClass *> found;
+    getClasses(className, ID, found);
+    for (size_t i = 0; i < found.size(); i++)
     {
-        if ((ID == 0) || (current()->getID() == ID))
-        {
-            if (!strcmp(current()->getName(), className))
-            {
-                current()->unObserve(recvID, variableName);
-                foundOne = 1;
-            }
-        }
-        next();
+        found[i]->unObserve(recvID, variableName);
     }
-    if (!foundOne)
+    if (found.empty())
     {
         if (variableName)
             cerr << "Variable " << variableName << " not found in class " << className << " ID: " << ID << endl;
@@ -394,6 +364,99 @@ void coRegistry::unObserve(const char *className, int ID, int recvID, const char
     }
 }
 
+void coRegistry::changed(regVar *v)
+{
+    if (v->pendingIndex < 0)
+    {
+        v->pendingIndex = (int)pending.size();
+        pending.push_back(v);
+    }
+}
+
+void coRegistry::cancel(regVar *v)
+{
+    pending[v->pendingIndex] = NULL;
+    v->pendingIndex = -1;
+}
+
+void coRegistry::flush()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    // find every client once, VRBClientList::get(int) searches the list
+    std::unordered_map<int, VRBSClient *> byID;
+    clients.reset();
+    while (VRBSClient *cl = clients.current())
+    {
+        byID[cl->getID()] = cl;
+        clients.next();
+    }
+
+    // collect the messages to a client in one write
+    std::vector<Connection *> batching;
+
+    std::vector<regVar *> changedVars;
+    changedVars.swap(pending);
+    for (size_t i = 0; i < changedVars.size(); i++)
+    {
+        if (changedVars[i])
+        {
+            changedVars[i]->pendingIndex = -1;
+        }
+    }
+    std::vector<int> ids;
+    for (size_t i = 0; i < changedVars.size(); i++)
+    {
+        regVar *v = changedVars[i];
+        if (!v)
+        {
+            continue;
+        }
+
+        // observers of the class are usually observers of its variables as well
+        ids.clear();
+        v->getClass()->getOList()->getObservers(ids);
+        v->getOList()->getObservers(ids);
+        if (ids.empty())
+        {
+            continue;
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        TokenBuffer sb;
+        sb << v->getClass()->getName();
+        sb << v->getClass()->getID();
+        sb << v->getName();
+        sb << v->getValue();
+        Message m(sb);
+        m.type = COVISE_MESSAGE_VRB_REGISTRY_ENTRY_CHANGED;
+        for (size_t j = 0; j < ids.size(); j++)
+        {
+            std::unordered_map<int, VRBSClient *>::iterator cl = byID.find(ids[j]);
+            if (cl == byID.end() || !cl->second->conn)
+            {
+                continue;
+            }
+            Connection *conn = cl->second->conn;
+            if (!conn->is_batching())
+            {
+                conn->set_batching(true);
+                batching.push_back(conn);
+            }
+            conn->send_msg(&m);
+        }
+    }
+
+    for (size_t i = 0; i < batching.size(); i++)
+    {
+        batching[i]->set_batching(false);
+    }
+}
+
 void regClass::observe(int recvID, const char *variableName)
 {
     if (variableName)
@@ -402,20 +465,26 @@ void regClass::observe(int recvID, const char *variableName)
         if (!rv)
         {
             rv = new regVar(this, variableName, "coNULL");
-            append(rv);
+            addVar(rv);
         }
         rv->observe(recvID);
     }
     else
     {
         observers.addObserver(recvID);
-        reset();
-        regVar *cv;
-        while ((cv = current()))
+
+        // send the current values in as few writes as possible
+        VRBSClient *cl = clients.get(recvID);
+        Connection *conn = cl ? cl->conn : NULL;
+        bool batch = conn && !conn->is_batching();
+        if (batch)
+            conn->set_batching(true);
+        for (VarMap::iterator it = vars.begin(); it != vars.end(); ++it)
         {
-            cv->observe(recvID);
-            next();
+            it->second->observe(recvID);
         }
+        if (batch)
+            conn->set_batching(false);
     }
 }
 
@@ -432,12 +501,9 @@ void regClass::unObserve(int recvID, const char *variableName)
     else
     {
         observers.removeObserver(recvID);
-        reset();
-        regVar *cv;
-        while ((cv = current()))
+        for (VarMap::iterator it = vars.begin(); it != vars.end(); ++it)
         {
-            cv->unObserve(recvID);
-            next();
+            it->second->unObserve(recvID);
         }
     }
 }
@@ -448,15 +514,18 @@ regVar *regClass::getVar(const char *n)
     {
         return (NULL);
     }
-    reset();
-    while (current())
+    VarMap::iterator it = vars.find(n);
+    if (it == vars.end())
     {
-        if (!strcmp(current()->getName(), n))
-            return (current());
-        next();
+        //cerr << "Var " << n << " not found in Class "<< name <<"!\n";
+        return (NULL);
     }
-    //cerr << "Var " << n << " not found in Class "<< name <<"!\n";
-    return (NULL);
+    return (it->second);
+}
+
+void regClass::addVar(regVar *v)
+{
+    vars[v->getName()] = v;
 }
 
 void regClass::deleteVar(const char *n)
@@ -465,31 +534,30 @@ void regClass::deleteVar(const char *n)
     {
         return;
     }
-    reset();
-    while (current())
+    VarMap::iterator it = vars.find(n);
+    if (it == vars.end())
     {
-        if (!strcmp(current()->getName(), n))
-        {
-            remove();
-            return;
-        }
-        next();
+        cerr << "Var " << n << " not found in Class " << name << "!\n";
+        return;
     }
-    cerr << "Var " << n << " not found in Class " << name << "!\n";
+    regVar *v = it->second;
+    vars.erase(it);
+    delete v;
 }
 
 void regClass::deleteAllNonStaticVars()
 {
-    reset();
-    while (current())
+    for (VarMap::iterator it = vars.begin(); it != vars.end();)
     {
-        if (!(current()->isStatic()))
+        if (!(it->second->isStatic()))
         {
-            remove();
+            regVar *v = it->second;
+            it = vars.erase(it);
+            delete v;
         }
         else
         {
-            next();
+            ++it;
         }
     }
 }
@@ -545,6 +613,12 @@ cb+="\n# End Userinterface Variables\n#\n";
 coRegistry::coRegistry()
 {
     instance = this;
-    setNoDelete();
     regMode = 0;
 }
+
+coRegistry::~coRegistry()
+{
+    // clients deleted later must not access the registry
+    if (instance == this)
+        instance = NULL;
+}
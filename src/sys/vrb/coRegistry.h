@@ -8,7 +8,9 @@
 #ifndef regVar_H
 #define regVar_H
 
-#include <util/coDLList.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 class netModule;
 class coCharBuffer;
@@ -18,24 +20,17 @@ class coRegistry;
 
 class observerList
 {
-    int numObservers;
-    int *observers;
+    std::vector<int> observers;
 
 public:
-    observerList()
-    {
-        numObservers = 0;
-        observers = NULL;
-    };
     void addObserver(int recvID);
     void removeObserver(int recvID);
-    void serveObservers(regVar *v);
     void informDeleteObservers(regVar *v);
     void copyObservers(regClass *v);
-
-    ~observerList()
+    /// append the IDs of the observers to ids
+    void getObservers(std::vector<int> &ids) const
     {
-        delete[] observers;
+        ids.insert(ids.end(), observers.begin(), observers.end());
     };
 };
 
@@ -47,6 +42,8 @@ private:
     regClass *myClass;
     observerList observers;
     int staticVar;
+    int pendingIndex; // position in coRegistry::pending, -1 if observers are up to date
+    friend class coRegistry;
 
 public:
     regVar(regClass *c, const char *n, const char *v, int s = 1);
@@ -99,12 +96,14 @@ public:
     ~regVar();
 };
 
-class regClass : public covise::coDLPtrList<regVar *>
+class regClass
 {
 private:
     char *name;
     int classID;
     observerList observers;
+    typedef std::unordered_map<std::string, regVar *> VarMap;
+    VarMap vars;
 
 public:
     regClass(const char *n, int ID);
@@ -124,6 +123,8 @@ public:
     };
     /// getVariableEntry, returns NULL if not found
     regVar *getVar(const char *name);
+    /// add a Variable, it is deleted with the class
+    void addVar(regVar *v);
     /// get list of Observers
     observerList *getOList()
     {
@@ -137,22 +138,23 @@ public:
        * add this Class to Script
        */
     void saveNetwork(coCharBuffer &cb);
-    ~regClass()
-    {
-        delete[] name;
-    };
+    ~regClass();
 };
 /**
  * List of userinterface Variables
+ * Classes are found by name and ID, Variables by name in hash tables.
+ * Changes are collected and sent to the observers by flush(), once per
+ * Variable, no matter how often it was set since the last flush.
  * @author Uwe Woessner
  * @version 1.0
  */
-class coRegistry : public covise::coDLPtrList<regClass *>
+class coRegistry
 {
 public:
     /// constructor initializes Variables with values from yac.config:regVariables
     int regMode;
     coRegistry();
+    ~coRegistry();
     /// getClassEntry, returns NULL if not found
     regClass *getClass(const char *name, int ID = 0);
     /// set a Value or create new Entry
@@ -175,6 +177,28 @@ public:
        * add Registry to Script
        */
     void saveNetwork(coCharBuffer &cb);
+    /// inform the observers of all Variables changed since the last call
+    void flush();
     static coRegistry *instance;
+
+private:
+    /// create a class, optionally with the observers of the generic class (ID 0)
+    regClass *newClass(const char *className, int ID, bool copyObservers = true);
+    /// collect classes with this name: all of them if ID is 0
+    void getClasses(const char *className, int ID, std::vector<regClass *> &found);
+    /// remember v for the next flush
+    void changed(regVar *v);
+    /// v is deleted, forget it
+    void cancel(regVar *v);
+    friend class regVar;
+
+    struct classEntry
+    {
+        std::vector<regClass *> classes; // in order of creation
+        std::unordered_map<int, regClass *> byID;
+    };
+    typedef std::unordered_map<std::string, classEntry> ClassMap;
+    ClassMap classes;
+    std::vector<regVar *> pending; // changed Variables, NULL if deleted meanwhile
 };
 #endif
@@ -0,0 +1,35 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+// result lines shared by the micro benchmarks: what was measured, how many
+// units were processed, the total time and the throughput (units/s) or the
+// time per unit (ms/unit)
+
+#include <stdio.h>
+
+namespace bench
+{
+
+// e.g. report("lookup", n, "ops", seconds)
+inline void report(const char *what, long n, const char *units, float seconds)
+{
+    printf("%-34s %9ld %s: %8.3f s  %12.0f %s/s\n",
+           what, n, units, seconds, seconds > 0.f ? n / seconds : 0.f, units);
+}
+
+// e.g. reportTimePer("full scan", n, "queries", "query", seconds)
+inline void reportTimePer(const char *what, long n, const char *units, const char *unit, float seconds)
+{
+    printf("%-34s %9ld %s: %8.3f s  %10.3f ms/%s\n",
+           what, n, units, seconds, n > 0 ? seconds * 1000.f / n : 0.f, unit);
+}
+}
+
+#endif
@@ -0,0 +1,223 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Cell location in an unstructured grid mixing hexahedra, prisms and
+// tetrahedra: coDoOctTree vs. the flat bounding volume hierarchy of
+// coDoCellBVH. Both search structures are distributed objects and need
+// shared memory, so this is a module: put it alone into a map and execute
+// it. Build time, memory and located points per second are written to
+// stdout and as info messages, once for points scattered at random over
+// the grid and once for points along short paths, as a tracer produces
+// them.
+//
+// usage: CellLocateBench as module, parameters: nodes per direction,
+//        number of query points
+
+#include <api/coModule.h>
+#include <do/coDoUnstructuredGrid.h>
+#include <do/coDoOctTree.h>
+#include <do/coDoCellBVH.h>
+#include <util/coWristWatch.h>
+#include "../BenchReport.h"
+
+using namespace covise;
+
+// also shown in the map editor
+static void report(const char *what, int n, float seconds)
+{
+    bench::report(what, n, "points", seconds);
+    Covise::sendInfo("%s: %.0f points/s", what, seconds > 0.f ? n / seconds : 0.f);
+}
+
+static void reportBuild(const char *what, float seconds, size_t bytes)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%-28s build %8.3f s  %8.1f MB", what, seconds, bytes / 1048576.);
+    printf("%s\n", buf);
+    Covise::sendInfo("%s", buf);
+}
+
+class CellLocateBench : public coModule
+{
+public:
+    CellLocateBench(int argc, char *argv[]);
+
+private:
+    virtual int compute(const char *port);
+    void makeGrid(int n, const char *name);
+    int locate(const char *what, const coDistributedObject *tree,
+               const std::vector<float> &points, std::vector<int> &cells);
+
+    coOutputPort *p_grid;
+    coIntScalarParam *p_nodes;
+    coIntScalarParam *p_points;
+
+    coDoUnstructuredGrid *grid;
+};
+
+CellLocateBench::CellLocateBench(int argc, char *argv[])
+    : coModule(argc, argv, "Compare cell location with octrees and bounding volume hierarchies")
+    , grid(NULL)
+{
+    p_grid = addOutputPort("GridOut0", "UnstructuredGrid", "grid searched");
+    p_nodes = addInt32Param("nodes", "nodes per direction");
+    p_nodes->setValue(100);
+    p_points = addInt32Param("points", "number of points to locate");
+    p_points->setValue(1000000);
+}
+
+// n^3 nodes on a graded lattice, the blocks between them are one hexahedron,
+// two prisms or five tetrahedra in turn
+void CellLocateBench::makeGrid(int n, const char *name)
+{
+    std::vector<float> x, y, z;
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            for (int k = 0; k < n; k++)
+            {
+                x.push_back(i + 0.3f * sinf(0.7f * i));
+                y.push_back(j + 0.3f * sinf(0.5f * j));
+                z.push_back(k + 0.3f * sinf(0.3f * k));
+            }
+        }
+    }
+    static const int prisms[2][6] = { { 0, 1, 2, 4, 5, 6 }, { 0, 2, 3, 4, 6, 7 } };
+    static const int tetras[5][4] = { { 0, 1, 3, 4 }, { 1, 2, 3, 6 }, { 1, 4, 5, 6 }, { 3, 4, 6, 7 }, { 1, 3, 4, 6 } };
+    std::vector<int> el, cl, tl;
+    for (int i = 0; i < n - 1; i++)
+    {
+        for (int j = 0; j < n - 1; j++)
+        {
+            for (int k = 0; k < n - 1; k++)
+            {
+                int b = (i * n + j) * n + k;
+                int c[8] = { b, b + n * n, b + n * n + n, b + n, b + 1, b + n * n + 1, b + n * n + n + 1, b + n + 1 };
+                switch ((i + j + k) % 3)
+                {
+                case 0:
+                    el.push_back((int)cl.size());
+                    tl.push_back(TYPE_HEXAGON);
+                    cl.insert(cl.end(), c, c + 8);
+                    break;
+                case 1:
+                    for (int p = 0; p < 2; p++)
+                    {
+                        el.push_back((int)cl.size());
+                        tl.push_back(TYPE_PRISM);
+                        for (int v = 0; v < 6; v++)
+                            cl.push_back(c[prisms[p][v]]);
+                    }
+                    break;
+                default:
+                    for (int t = 0; t < 5; t++)
+                    {
+                        el.push_back((int)cl.size());
+                        tl.push_back(TYPE_TETRAHEDER);
+                        for (int v = 0; v < 4; v++)
+                            cl.push_back(c[tetras[t][v]]);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    grid = new coDoUnstructuredGrid(coObjInfo(name), (int)el.size(), (int)cl.size(), (int)x.size(),
+                                    &el[0], &cl[0], &x[0], &y[0], &z[0], &tl[0]);
+}
+
+int CellLocateBench::locate(const char *what, const coDistributedObject *tree,
+                            const std::vector<float> &points, std::vector<int> &cells)
+{
+    int numPoints = (int)points.size() / 3;
+    grid->GetOctTree(tree, NULL);
+    cells.assign(numPoints, -1);
+    coWristWatch watch;
+    int found = grid->getCells(numPoints, &points[0], &cells[0], 1.e-4f);
+    report(what, numPoints, watch.elapsed());
+    return found;
+}
+
+int CellLocateBench::compute(const char *)
+{
+    int n = p_nodes->getValue();
+    int numPoints = p_points->getValue();
+    if (n < 2 || numPoints < 1)
+    {
+        sendError("need at least 2 nodes per direction and 1 point");
+        return FAIL;
+    }
+
+    makeGrid(n, p_grid->getObjName());
+    int numElem, numConn, numCoord;
+    grid->getGridSize(&numElem, &numConn, &numCoord);
+    int *el, *cl;
+    float *x, *y, *z;
+    grid->getAddresses(&el, &cl, &x, &y, &z);
+    printf("%d cells, %d nodes, %d points\n\n", numElem, numCoord, numPoints);
+
+    std::string octName = std::string(p_grid->getObjName()) + "_OctTree";
+    coWristWatch watch;
+    coDoOctTree *octTree = new coDoOctTree(coObjInfo(octName.c_str()), numElem, numConn, numCoord,
+                                           el, cl, x, y, z);
+    float octTime = watch.elapsed();
+    size_t octBytes = sizeof(int) * ((size_t)octTree->getNumCellLists() + octTree->getNumMacroCellLists())
+                      + sizeof(float) * ((size_t)octTree->getNumCellBBoxes() + octTree->getNumGridBBoxes());
+    reportBuild("coDoOctTree", octTime, octBytes);
+
+    std::string bvhName = std::string(p_grid->getObjName()) + "_CellBVH";
+    watch.reset();
+    coDoCellBVH *bvh = new coDoCellBVH(coObjInfo(bvhName.c_str()), numElem, numConn, numCoord,
+                                       el, cl, x, y, z);
+    float bvhTime = watch.elapsed();
+    size_t bvhBytes = sizeof(int) * (2 * (size_t)bvh->getNumNodes() + bvh->getNumCells())
+                      + sizeof(float) * 6 * ((size_t)bvh->getNumNodes() + bvh->getNumCells());
+    reportBuild("coDoCellBVH", bvhTime, bvhBytes);
+
+    // scattered points and points along paths of 100 steps of a tenth cell
+    float extent = (float)(n - 1);
+    srand(4711);
+    std::vector<float> scattered(3 * (size_t)numPoints), paths(3 * (size_t)numPoints);
+    for (int i = 0; i < 3 * numPoints; i++)
+        scattered[i] = extent * rand() / (float)RAND_MAX;
+    float pos[3] = { 0.f, 0.f, 0.f }, dir[3] = { 0.f, 0.f, 0.f };
+    for (int i = 0; i < numPoints; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            if (i % 100 == 0)
+            {
+                pos[k] = extent * rand() / (float)RAND_MAX;
+                dir[k] = 0.2f * rand() / (float)RAND_MAX - 0.1f;
+            }
+            pos[k] = std::min(extent, std::max(0.f, pos[k] + dir[k]));
+            paths[3 * i + k] = pos[k];
+        }
+    }
+
+    std::vector<int> octCells, bvhCells;
+    printf("\n");
+    int octFound = locate("scattered, coDoOctTree", octTree, scattered, octCells);
+    int bvhFound = locate("scattered, coDoCellBVH", bvh, scattered, bvhCells);
+    printf("found %d / %d points\n\n", octFound, bvhFound);
+    octFound = locate("paths, coDoOctTree", octTree, paths, octCells);
+    bvhFound = locate("paths, coDoCellBVH", bvh, paths, bvhCells);
+    printf("found %d / %d points\n", octFound, bvhFound);
+    if (octFound != bvhFound)
+        sendWarning("octree found %d points, BVH %d", octFound, bvhFound);
+
+    octTree->destroy();
+    delete octTree;
+    bvh->destroy();
+    delete bvh;
+    p_grid->setCurrentObject(grid);
+    grid = NULL;
+    return SUCCESS;
+}
+
+MODULE_MAIN(Tools, CellLocateBench)
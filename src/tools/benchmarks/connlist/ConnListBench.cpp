@@ -0,0 +1,175 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Event loop throughput of ConnectionList with many connections: a
+// controller style loop fans a message out to every connection and waits
+// for all replies, the simulated modules are served by a second
+// ConnectionList in a responder thread. Bursts of small messages are sent
+// directly and with batching connections.
+//
+// usage: ConnListBench [number of connections] [rounds] [messages per burst]
+
+#include <net/covise_connect.h>
+#include <net/message.h>
+#include <net/message_types.h>
+#include <util/coWristWatch.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+using namespace covise;
+
+// one end of a socket pair exchanging regular messages
+class PairConnection : public Connection
+{
+public:
+    PairConnection(int sfd, int id)
+        : Connection(sfd)
+    {
+        sender_id = id;
+        send_type = CONTROLLER;
+    }
+};
+
+// 2 descriptors per simulated connection
+static void raiseFileLimit(int numConn)
+{
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+        return;
+    rlim_t wanted = 2 * numConn + 64;
+    if (rl.rlim_cur < wanted)
+    {
+        rl.rlim_cur = (rl.rlim_max == RLIM_INFINITY || rl.rlim_max > wanted) ? wanted : rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+// echo every message until QUIT arrives
+static void respond(ConnectionList *peers)
+{
+    for (;;)
+    {
+        Connection *conn = peers->check_for_input(1.0);
+        if (!conn)
+            continue;
+        Message msg;
+        if (conn->recv_msg(&msg) <= 0)
+            break;
+        if (msg.type == COVISE_MESSAGE_QUIT)
+        {
+            msg.delete_data();
+            break;
+        }
+        msg.type = COVISE_MESSAGE_MSG_OK;
+        conn->send_msg(&msg);
+        msg.delete_data();
+    }
+}
+
+static void run(int numConn, int rounds, int burst, bool batching)
+{
+    ConnectionList *ctrl = new ConnectionList;
+    ConnectionList *peers = new ConnectionList;
+    ctrl->set_batching(batching);
+    peers->set_batching(batching);
+    std::vector<Connection *> conns;
+    for (int i = 0; i < numConn; i++)
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        {
+            perror("ConnListBench: socketpair");
+            numConn = i;
+            break;
+        }
+        Connection *c = new PairConnection(sv[0], 1);
+        ctrl->add(c);
+        conns.push_back(c);
+        peers->add(new PairConnection(sv[1], i + 2));
+    }
+    if (numConn == 0)
+        return;
+
+    std::thread responder(respond, peers);
+
+    char payload[64];
+    memset(payload, 'x', sizeof(payload));
+    float total = 0.f, worst = 0.f;
+    for (int r = 0; r < rounds; r++)
+    {
+        coWristWatch watch;
+        for (int i = 0; i < numConn; i++)
+        {
+            for (int b = 0; b < burst; b++)
+            {
+                Message msg(COVISE_MESSAGE_UI, sizeof(payload), payload, MSG_NOCOPY);
+                conns[i]->send_msg(&msg);
+                msg.data = NULL;
+            }
+        }
+        for (int got = 0; got < numConn * burst;)
+        {
+            Connection *conn = ctrl->check_for_input(1.0);
+            if (!conn)
+                continue;
+            Message reply;
+            conn->recv_msg(&reply);
+            reply.delete_data();
+            got++;
+        }
+        float t = watch.elapsed();
+        total += t;
+        if (t > worst)
+            worst = t;
+    }
+
+    Message quit(COVISE_MESSAGE_QUIT, 0, NULL, MSG_NOCOPY);
+    conns[0]->send_msg(&quit);
+    conns[0]->flush_batch();
+    responder.join();
+
+    long messages = 0, writes = 0;
+    for (int i = 0; i < numConn; i++)
+    {
+        messages += conns[i]->get_stats().messages_sent;
+        writes += conns[i]->get_stats().write_calls;
+    }
+    printf("%-8s %d connections x %d messages, %d rounds: %.3f ms per fan-out (worst %.3f ms), "
+           "%.0f messages/s, %.2f messages per write\n",
+           batching ? "batched" : "direct", numConn, burst, rounds, 1000.f * total / rounds, 1000.f * worst,
+           total > 0.f ? 2.f * numConn * burst * rounds / total : 0.f,
+           writes > 0 ? (double)messages / writes : 0.);
+
+    delete peers;
+    delete ctrl;
+}
+
+int main(int argc, char *argv[])
+{
+    int numConn = 1000;
+    int rounds = 100;
+    int burst = 10;
+    if (argc > 1)
+        numConn = atoi(argv[1]);
+    if (argc > 2)
+        rounds = atoi(argv[2]);
+    if (argc > 3)
+        burst = atoi(argv[3]);
+
+    raiseFileLimit(numConn);
+
+    run(numConn, rounds, 1, false);
+    run(numConn, rounds, burst, false);
+    run(numConn, rounds, burst, true);
+    return 0;
+}
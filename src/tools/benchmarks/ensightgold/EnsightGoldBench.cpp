@@ -0,0 +1,236 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Reading EnSight Gold C binary files as ReadEnsight does: a geometry with
+// many parts of hexahedra, a per vertex and a per cell variable are written
+// to a temporary directory and read through stdio and, for comparison,
+// mapped into memory with the parts decoded concurrently. Every fourth part
+// is deactivated, as by the choose_parts parameter. The second mapped pass
+// uses the part index cached by the first. Both paths have to agree.
+//
+// usage: EnsightGoldBench [parts] [cells per edge of a part] [directory]
+
+#include "EnGoldGeoBIN.h"
+#include "DataFileGoldBin.h"
+
+#include <util/coWristWatch.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace covise;
+
+static void putStr(FILE *fp, const char *str)
+{
+    char buf[80];
+    memset(buf, 0, sizeof(buf));
+    strncpy(buf, str, sizeof(buf) - 1);
+    fwrite(buf, 1, sizeof(buf), fp);
+}
+
+static void putInt(FILE *fp, int i)
+{
+    fwrite(&i, sizeof(i), 1, fp);
+}
+
+static void writeFiles(const std::string &geo, const std::string &scl, const std::string &cell, int numParts, int n)
+{
+    const int nn = n + 1;
+    const int nc = nn * nn * nn;
+    const int ne = n * n * n;
+    std::vector<float> x(nc), y(nc), z(nc), s(nc), c(ne);
+    std::vector<int> conn(8 * ne);
+    int e = 0;
+    for (int k = 0; k < n; k++)
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < n; i++, e++)
+            {
+                int v = 1 + i + nn * (j + nn * k);
+                int corners[8] = { v, v + 1, v + 1 + nn, v + nn, v + nn * nn, v + 1 + nn * nn, v + 1 + nn + nn * nn, v + nn + nn * nn };
+                memcpy(&conn[8 * e], corners, sizeof(corners));
+            }
+
+    FILE *g = fopen(geo.c_str(), "wb");
+    FILE *fs = fopen(scl.c_str(), "wb");
+    FILE *fc = fopen(cell.c_str(), "wb");
+    if (!g || !fs || !fc)
+    {
+        perror("EnsightGoldBench: fopen");
+        exit(1);
+    }
+    putStr(g, "C Binary");
+    putStr(g, "EnsightGoldBench");
+    putStr(g, "geometry");
+    putStr(g, "node id off");
+    putStr(g, "element id off");
+    putStr(fs, "per vertex scalar");
+    putStr(fc, "per element scalar");
+    for (int p = 1; p <= numParts; p++)
+    {
+        for (int v = 0; v < nc; v++)
+        {
+            int i = v % nn, j = (v / nn) % nn, k = v / (nn * nn);
+            x[v] = p * n + i;
+            y[v] = j;
+            z[v] = k;
+            s[v] = p + 0.001f * v;
+        }
+        for (int i = 0; i < ne; i++)
+            c[i] = p - 0.001f * i;
+
+        char desc[80];
+        snprintf(desc, sizeof(desc), "block %d", p);
+        putStr(g, "part");
+        putInt(g, p);
+        putStr(g, desc);
+        putStr(g, "coordinates");
+        putInt(g, nc);
+        fwrite(&x[0], sizeof(float), nc, g);
+        fwrite(&y[0], sizeof(float), nc, g);
+        fwrite(&z[0], sizeof(float), nc, g);
+        putStr(g, "hexa8");
+        putInt(g, ne);
+        fwrite(&conn[0], sizeof(int), conn.size(), g);
+
+        putStr(fs, "part");
+        putInt(fs, p);
+        putStr(fs, "coordinates");
+        fwrite(&s[0], sizeof(float), nc, fs);
+
+        putStr(fc, "part");
+        putInt(fc, p);
+        putStr(fc, "hexa8");
+        fwrite(&c[0], sizeof(float), ne, fc);
+    }
+    fclose(g);
+    fclose(fs);
+    fclose(fc);
+}
+
+// sums over the parts as read, in part list order
+struct Result
+{
+    double coords, conn, vertexData, cellData;
+    size_t parts;
+};
+
+static double sum(const float *a, size_t n)
+{
+    double s = 0.;
+    for (size_t i = 0; i < n; i++)
+        s += a[i] * double(i % 7 + 1);
+    return s;
+}
+
+static double sum(const int *a, size_t n)
+{
+    double s = 0.;
+    for (size_t i = 0; i < n; i++)
+        s += a[i] * double(i % 7 + 1);
+    return s;
+}
+
+static Result readAll(const std::string &geo, const std::string &scl, const std::string &cell,
+                      const PartList &master, bool mapped, int numCoords)
+{
+    Result r;
+    r.coords = r.conn = r.vertexData = r.cellData = 0.;
+    coWristWatch watch;
+
+    PartList pl;
+    EnGoldGeoBIN geoFile(NULL, geo, EnFile::CBIN);
+    geoFile.setMappedReading(mapped);
+    geoFile.setPartList(&pl);
+    geoFile.setMasterPL(master);
+    geoFile.read();
+    float tGeo = watch.elapsed();
+
+    watch.reset();
+    DataFileGoldBin sclFile(NULL, scl, 1, numCoords, EnFile::CBIN);
+    sclFile.setMappedReading(mapped);
+    sclFile.setPartList(&pl);
+    sclFile.setMasterPL(master);
+    sclFile.read();
+    float tScl = watch.elapsed();
+
+    watch.reset();
+    DataFileGoldBin cellFile(NULL, cell, 1, 0, EnFile::CBIN);
+    cellFile.setMappedReading(mapped);
+    cellFile.setPartList(&pl);
+    cellFile.setMasterPL(master);
+    cellFile.readCells();
+    float tCell = watch.elapsed();
+
+    printf("%-8s geometry %8.3f s  per vertex %8.3f s  per cell %8.3f s\n", mapped ? "mapped" : "stdio", tGeo, tScl, tCell);
+
+    r.parts = pl.size();
+    for (size_t i = 0; i < pl.size(); i++)
+    {
+        EnPart &p = pl[i];
+        if (!p.isActive())
+            continue;
+        r.coords += sum(p.x3d_, p.numCoords()) + sum(p.y3d_, p.numCoords()) + sum(p.z3d_, p.numCoords());
+        r.conn += sum(p.cl3d_, p.numConnRead3d()) + sum(p.el3d_, p.numEleRead3d());
+        r.vertexData += sum(p.arr1_, p.numCoords());
+        r.cellData += sum(p.d3dx_, p.numEleRead3d());
+    }
+    return r;
+}
+
+int main(int argc, char *argv[])
+{
+    int numParts = 400;
+    int n = 16;
+    std::string dir("/tmp");
+    if (argc > 1)
+        numParts = atoi(argv[1]);
+    if (argc > 2)
+        n = atoi(argv[2]);
+    if (argc > 3)
+        dir = argv[3];
+    if (numParts < 1 || n < 1)
+        return 1;
+
+    std::string geo(dir + "/EnsightGoldBench.geo");
+    std::string scl(dir + "/EnsightGoldBench.scl");
+    std::string cell(dir + "/EnsightGoldBench.cell");
+    writeFiles(geo, scl, cell, numParts, n);
+    printf("%d parts, %d hexahedra each\n", numParts, n * n * n);
+
+    PartList master;
+    {
+        EnGoldGeoBIN parser(NULL, geo, EnFile::CBIN);
+        parser.setPartList(&master);
+        parser.parseForParts();
+    }
+    for (size_t i = 0; i < master.size(); i += 4)
+        master[i].activate(false);
+    int numCoords = 0;
+    for (size_t i = 0; i < master.size(); i++)
+        numCoords += master[i].numCoords();
+
+    Result ref = readAll(geo, scl, cell, master, false, numCoords);
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        Result r = readAll(geo, scl, cell, master, true, numCoords);
+        if (r.parts != ref.parts || r.coords != ref.coords || r.conn != ref.conn
+            || r.vertexData != ref.vertexData || r.cellData != ref.cellData)
+        {
+            fprintf(stderr, "EnsightGoldBench: mapped reading differs from stdio\n");
+            ok = false;
+        }
+    }
+
+    remove(geo.c_str());
+    remove(scl.c_str());
+    remove(cell.c_str());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Reading the internalField list of OpenFOAM fields as ReadFOAM does:
+// scalar and vector fields in ascii and binary format and a gzipped ascii
+// field are written to a temporary directory and read back through
+// getStreamForFile, which maps or decompresses them into memory, and, for
+// comparison, through a filtering_istream on a std::ifstream as before,
+// which takes the istream path of the list readers. Values read by both paths have to agree.
+//
+// usage: FoamListBench [cells] [directory]
+
+#include "foamtoolbox.h"
+
+#include <util/coWristWatch.h>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace covise;
+
+static void writeHeader(std::ostream &out, const char *format, const char *fieldclass, size_t n)
+{
+    out << "FoamFile\n{\n    version     2.0;\n    format      " << format << ";\n"
+        << "    class       " << fieldclass << ";\n    location    \"0\";\n    object      f;\n}\n"
+        << "dimensions      [0 1 -1 0 0 0 0];\n\n"
+        << "internalField   nonuniform List<" << (strcmp(fieldclass, "volScalarField") ? "vector" : "scalar") << "> \n"
+        << n << "\n(";
+}
+
+static void writeAscii(std::ostream &out, const std::vector<double> &v, int components)
+{
+    writeHeader(out, "ascii", components == 1 ? "volScalarField" : "volVectorField", v.size() / components);
+    out << "\n";
+    char buf[128];
+    for (size_t i = 0; i < v.size(); i += components)
+    {
+        if (components == 1)
+            snprintf(buf, sizeof(buf), "%.10g\n", v[i]);
+        else
+            snprintf(buf, sizeof(buf), "(%.10g %.10g %.10g)\n", v[i], v[i + 1], v[i + 2]);
+        out << buf;
+    }
+    out << ")\n;\n";
+}
+
+static void writeBinary(std::ostream &out, const std::vector<double> &v, int components)
+{
+    writeHeader(out, "binary", components == 1 ? "volScalarField" : "volVectorField", v.size() / components);
+    out.write(reinterpret_cast<const char *>(&v[0]), v.size() * sizeof(double));
+    out << ")\n;\n";
+}
+
+static bool readField(boost::shared_ptr<std::istream> stream, int components, std::vector<scalar_t> &x, std::vector<scalar_t> &y, std::vector<scalar_t> &z)
+{
+    if (!stream)
+        return false;
+    HeaderInfo header = readFoamHeader(*stream);
+    if (!header.valid)
+        return false;
+    x.resize(header.lines);
+    if (components == 1)
+        return readFloatArray(header, *stream, &x[0], header.lines);
+    y.resize(header.lines);
+    z.resize(header.lines);
+    return readFloatVectorArray(header, *stream, &x[0], &y[0], &z[0], header.lines);
+}
+
+static size_t fileSize(const std::string &name)
+{
+    std::ifstream s(name.c_str(), std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+    return s.tellg();
+}
+
+static void bench(const std::string &name, int components)
+{
+    std::vector<scalar_t> x, y, z, rx, ry, rz;
+    coWristWatch watch;
+    bool ok = readField(getStreamForFile(name), components, x, y, z);
+    float mapped = watch.elapsed();
+
+    watch.reset();
+    std::ifstream *s = new std::ifstream(name.c_str(), std::ios_base::in | std::ios_base::binary);
+    boost::iostreams::filtering_istream *fi = new boost::iostreams::filtering_istream;
+    if (name.substr(name.size() - 3) == ".gz")
+        fi->push(boost::iostreams::gzip_decompressor());
+    fi->push(*s);
+    bool refOk = readField(boost::shared_ptr<std::istream>(fi), components, rx, ry, rz);
+    delete s;
+    float stream = watch.elapsed();
+
+    double mb = fileSize(name) / 1048576.;
+    std::string base = name.substr(name.rfind('/') + 1);
+    printf("%-28s %8.1f MB  memory: %7.3f s %8.1f MB/s", base.c_str(), mb, mapped, mapped > 0.f ? mb / mapped : 0.);
+    printf("  istream: %7.3f s %8.1f MB/s  %s", stream, stream > 0.f ? mb / stream : 0., (ok && refOk && x == rx && y == ry && z == rz) ? "equal" : "DIFFERENT");
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    size_t cells = 4000000;
+    std::string dir = "/tmp";
+    if (argc > 1)
+        cells = atol(argv[1]);
+    if (argc > 2)
+        dir = argv[2];
+
+    srand(4711);
+    std::vector<double> scalars(cells), vectors(3 * cells);
+    for (size_t i = 0; i < scalars.size(); i++)
+        scalars[i] = (rand() - RAND_MAX / 2) * 1e-5 / (1 + rand() % 1000);
+    for (size_t i = 0; i < vectors.size(); i++)
+        vectors[i] = (rand() - RAND_MAX / 2) * 1e-3 / (1 + rand() % 1000);
+
+    std::stringstream prefix;
+    prefix << dir << "/FoamListBench-" << getpid() << "-";
+    std::vector<std::string> files;
+    {
+        std::ofstream out((prefix.str() + "p").c_str(), std::ios_base::binary);
+        writeAscii(out, scalars, 1);
+        files.push_back(prefix.str() + "p");
+    }
+    {
+        std::ofstream out((prefix.str() + "U").c_str(), std::ios_base::binary);
+        writeAscii(out, vectors, 3);
+        files.push_back(prefix.str() + "U");
+    }
+    {
+        std::ofstream out((prefix.str() + "pBinary").c_str(), std::ios_base::binary);
+        writeBinary(out, scalars, 1);
+        files.push_back(prefix.str() + "pBinary");
+    }
+    {
+        std::ofstream out((prefix.str() + "UBinary").c_str(), std::ios_base::binary);
+        writeBinary(out, vectors, 3);
+        files.push_back(prefix.str() + "UBinary");
+    }
+    {
+        std::ofstream file((prefix.str() + "p.gz").c_str(), std::ios_base::binary);
+        boost::iostreams::filtering_ostream out;
+        out.push(boost::iostreams::gzip_compressor());
+        out.push(file);
+        writeAscii(out, scalars, 1);
+        files.push_back(prefix.str() + "p.gz");
+    }
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        bench(files[i], files[i].find("U") != std::string::npos ? 3 : 1);
+        unlink(files[i].c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Time per isosurface query on a large unstructured hexahedral grid when
+// sweeping 100 isovalues over the data range: full scan of all cells vs.
+// the span space index of coIsoCellIndex, which is built once and then
+// only yields the cells cut by the surface. Both have to produce the
+// same triangles.
+//
+// usage: IsoSweepBench [nodes per direction] [number of isovalues]
+
+#include <covise/covise.h>
+#include <alg/coIsoSurface.h>
+#include <alg/coIsoCellIndex.h>
+#include <do/coDoUnstructuredGrid.h>
+#include <util/coWristWatch.h>
+#include "../BenchReport.h"
+
+using namespace covise;
+
+// returns number of triangles, -1 on failure
+static int extract(int n_elem, int n_nodes, const int *el, const int *cl, const int *tl,
+                   const float *x, const float *y, const float *z, const float *s, float isovalue,
+                   const coIsoCellIndex *index, std::vector<int> *vertices)
+{
+    IsoPlane plane(n_elem, n_nodes, 1, 20.f, el, cl, tl, x, y, z, s, s, NULL, NULL, NULL, isovalue,
+                   false, NULL, index);
+    if (!plane.createIsoPlane())
+        return -1;
+    if (vertices)
+        vertices->assign(plane.getVerticeList(), plane.getVerticeList() + plane.getNumVertices());
+    return plane.getNumTriangles();
+}
+
+int main(int argc, char *argv[])
+{
+    int n = 160;
+    if (argc > 1)
+        n = atoi(argv[1]);
+    int numQueries = 100;
+    if (argc > 2)
+        numQueries = atoi(argv[2]);
+
+    int n_nodes = n * n * n;
+    int n_elem = (n - 1) * (n - 1) * (n - 1);
+    float *x = new float[n_nodes];
+    float *y = new float[n_nodes];
+    float *z = new float[n_nodes];
+    float *s = new float[n_nodes];
+    float s_min = FLT_MAX, s_max = -FLT_MAX;
+    for (int i = 0, node = 0; i < n; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            for (int k = 0; k < n; k++, node++)
+            {
+                x[node] = (float)i;
+                y[node] = (float)j;
+                z[node] = (float)k;
+                s[node] = sinf(i * 0.05f) * cosf(j * 0.03f) + sinf(k * 0.04f + i * 0.01f);
+                s_min = std::min(s_min, s[node]);
+                s_max = std::max(s_max, s[node]);
+            }
+        }
+    }
+    int *el = new int[n_elem];
+    int *tl = new int[n_elem];
+    int *cl = new int[8 * (size_t)n_elem];
+    for (int i = 0, e = 0; i < n - 1; i++)
+    {
+        for (int j = 0; j < n - 1; j++)
+        {
+            for (int k = 0; k < n - 1; k++, e++)
+            {
+                int b = (i * n + j) * n + k;
+                int c[8] = { b, b + n * n, b + n * n + n, b + n, b + 1, b + n * n + 1, b + n * n + n + 1, b + n + 1 };
+                el[e] = 8 * e;
+                tl[e] = TYPE_HEXAGON;
+                memcpy(cl + 8 * (size_t)e, c, sizeof(c));
+            }
+        }
+    }
+    printf("%d hexahedra, %d nodes, %d isovalues in [%f, %f]\n\n", n_elem, n_nodes, numQueries, s_min, s_max);
+
+    coWristWatch watch;
+    coIsoCellIndex index(n_elem, n_nodes, el, cl, tl, s);
+    bench::reportTimePer("build span space index", 1, "builds", "build", watch.elapsed());
+
+    std::vector<float> isovalues(numQueries);
+    for (int q = 0; q < numQueries; q++)
+        isovalues[q] = s_min + (s_max - s_min) * (q + 0.5f) / numQueries;
+
+    std::vector<int> triangles(numQueries);
+    watch.reset();
+    for (int q = 0; q < numQueries; q++)
+        triangles[q] = extract(n_elem, n_nodes, el, cl, tl, x, y, z, s, isovalues[q], NULL, NULL);
+    bench::reportTimePer("full scan", numQueries, "queries", "query", watch.elapsed());
+
+    watch.reset();
+    int mismatch = 0;
+    long total = 0;
+    for (int q = 0; q < numQueries; q++)
+    {
+        int tri = extract(n_elem, n_nodes, el, cl, tl, x, y, z, s, isovalues[q], &index, NULL);
+        if (tri != triangles[q])
+            mismatch++;
+        total += std::max(tri, 0);
+    }
+    bench::reportTimePer("span space index", numQueries, "queries", "query", watch.elapsed());
+    printf("%.0f triangles per query, %d mismatches\n", (double)total / numQueries, mismatch);
+
+    // spot check: the connectivity has to be identical, not just the size
+    std::vector<int> full, indexed;
+    float iso = isovalues[numQueries / 2];
+    extract(n_elem, n_nodes, el, cl, tl, x, y, z, s, iso, NULL, &full);
+    extract(n_elem, n_nodes, el, cl, tl, x, y, z, s, iso, &index, &indexed);
+    printf("vertex lists at isovalue %f %s\n", iso, full == indexed ? "identical" : "DIFFER");
+
+    delete[] x;
+    delete[] y;
+    delete[] z;
+    delete[] s;
+    delete[] el;
+    delete[] tl;
+    delete[] cl;
+    return mismatch > 0 || full != indexed;
+}
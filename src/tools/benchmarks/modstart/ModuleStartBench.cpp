@@ -0,0 +1,160 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Start latency of modules as for loading a map: the modules are started
+// one after the other, each start waits until the module has read the
+// configuration and reports back. A probe linked to the same libraries as
+// a module is started by fork and exec as the CRB does without a pool,
+// and from its library (libModuleStartProbe.so) by the pre-spawned
+// module hosts of the CRB.
+//
+// usage: ModuleStartBench [modules] [pool size] [moduleHost] [probe library]
+
+#include <config/CoviseConfig.h>
+#include <util/coExport.h>
+#include <util/coWristWatch.h>
+
+#include "CRB_ModulePool.h"
+#include "../BenchReport.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace covise;
+
+// what a module does before it connects: read the configuration, then report
+static int probe(int argc, char *argv[])
+{
+    if (argc < 3)
+        return 1;
+    coCoviseConfig::getEntry("System.CRB.ModulePool");
+    int fd = open(argv[2], O_WRONLY);
+    if (fd < 0)
+        return 1;
+    char c = 1;
+    ssize_t n = write(fd, &c, 1);
+    close(fd);
+    return n == 1 ? 0 : 1;
+}
+
+#ifdef COVISE_MODULE_LIBRARY
+
+extern "C" COEXPORT int covise_module_main(int argc, char *argv[])
+{
+    return probe(argc, argv);
+}
+
+#else
+
+static bool waitForProbe(int fifo)
+{
+    char c;
+    for (;;)
+    {
+        ssize_t n = read(fifo, &c, 1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        return n == 1;
+    }
+}
+
+static void startExec(const char *self, char *argv[])
+{
+    int pid = fork();
+    if (pid == 0)
+    {
+        execv(self, argv);
+        _exit(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && !strcmp(argv[1], "--probe"))
+        return probe(argc, argv);
+
+    int numModules = 50;
+    int poolSize = 4;
+    if (argc > 1)
+        numModules = atoi(argv[1]);
+    if (argc > 2)
+        poolSize = atoi(argv[2]);
+
+    std::string dir(argv[0]);
+    std::string::size_type slash = dir.rfind('/');
+    dir = slash == std::string::npos ? std::string(".") : dir.substr(0, slash);
+    std::string host = argc > 3 ? argv[3] : dir + "/moduleHost";
+    std::string library = argc > 4 ? argv[4] : dir + "/../lib/libModuleStartProbe.so";
+
+    char fifoPath[64];
+    snprintf(fifoPath, sizeof(fifoPath), "/tmp/ModuleStartBench-%d", (int)getpid());
+    if (mkfifo(fifoPath, 0600) != 0)
+    {
+        perror("ModuleStartBench: mkfifo");
+        return 1;
+    }
+    // also open for writing, so that reads block instead of returning end of file
+    int fifo = open(fifoPath, O_RDWR);
+    signal(SIGCHLD, SIG_IGN);
+
+    char self[4096];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    if (len <= 0)
+        strcpy(self, argv[0]);
+    else
+        self[len] = '\0';
+    char *probeArgv[] = { (char *)"ModuleStartProbe", (char *)"--probe", fifoPath, NULL };
+
+    coWristWatch watch;
+    for (int i = 0; i < numModules; i++)
+    {
+        startExec(self, probeArgv);
+        waitForProbe(fifo);
+    }
+    bench::reportTimePer("fork+exec", numModules, "modules", "module", watch.elapsed());
+
+    if (access(host.c_str(), X_OK) != 0 || access(library.c_str(), R_OK) != 0)
+    {
+        fprintf(stderr, "ModuleStartBench: %s or %s not found, no pool measurement\n", host.c_str(), library.c_str());
+    }
+    else
+    {
+        modulePool pool;
+        pool.init(host.c_str(), poolSize);
+        // like a CRB started some time before the map is loaded
+        sleep(2);
+
+        int started = 0;
+        watch.reset();
+        for (int i = 0; i < numModules; i++)
+        {
+            if (!pool.start(library.c_str(), self, probeArgv))
+                startExec(self, probeArgv);
+            else
+                started++;
+            waitForProbe(fifo);
+        }
+        char what[64];
+        snprintf(what, sizeof(what), "pool of %d hosts", poolSize);
+        bench::reportTimePer(what, numModules, "modules", "module", watch.elapsed());
+        if (started < numModules)
+            printf("%d modules started by exec\n", numModules - started);
+    }
+
+    close(fifo);
+    unlink(fifoPath);
+    return 0;
+}
+
+#endif
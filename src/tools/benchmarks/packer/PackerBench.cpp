@@ -0,0 +1,224 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Throughput of packing and unpacking a large unstructured grid as done for
+// the transfer between data managers: element wise conversion to network
+// byte order vs. bulk int/float arrays handed to writev directly from shm.
+// Sender and receiver run in one process and talk through a loopback socket.
+//
+// usage: PackerBench [number of connectivity entries]
+
+#include <covise/covise.h>
+#include <dmgr/dmgr.h>
+#include <dmgr/dmgr_packer.h>
+#include <do/coDistributedObject.h>
+#include <net/covise_connect.h>
+#include <util/coWristWatch.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace covise;
+
+// entries of a coDoUnstructuredGrid:
+// numelem, numconn, numcoord, el, cl, x, y, z, tl, numneighbor, nl, ni
+static const int NUM_ELEMENTS = 12;
+
+static void putInt(int *&p, int value)
+{
+    *p++ = INTSHM;
+    *p++ = value;
+}
+
+static void putPointer(int *&p, coShmPtr *ptr)
+{
+    *p++ = SHMPTR;
+    *p++ = ptr->get_shm_seq_no();
+    *p++ = ptr->get_offset();
+    delete ptr;
+}
+
+static char *arrayData(coShmPtr *ptr)
+{
+    return (char *)((coShmArray *)(void *)ptr)->getDataPtr();
+}
+
+// build the shm representation of an unstructured grid of tetrahedra
+static coShmPtr *createGrid(DataManagerProcess *dm, int numConn)
+{
+    int numElem = numConn / 4;
+    int numCoord = numConn / 5 + 1;
+
+    coShmPtr *el = dm->shm_alloc(INTSHMARRAY, numElem);
+    coShmPtr *cl = dm->shm_alloc(INTSHMARRAY, numConn);
+    coShmPtr *tl = dm->shm_alloc(INTSHMARRAY, numElem);
+    coShmPtr *coord[3];
+    for (int c = 0; c < 3; c++)
+        coord[c] = dm->shm_alloc(FLOATSHMARRAY, numCoord);
+
+    int *elData = (int *)arrayData(el);
+    int *tlData = (int *)arrayData(tl);
+    for (int i = 0; i < numElem; i++)
+    {
+        elData[i] = 4 * i;
+        tlData[i] = 4; // TYPE_TETRAHEDER
+    }
+    unsigned int seed = 4711;
+    int *clData = (int *)arrayData(cl);
+    for (int i = 0; i < numConn; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        clData[i] = (int)(seed % numCoord);
+    }
+    for (int c = 0; c < 3; c++)
+    {
+        float *f = (float *)arrayData(coord[c]);
+        for (int i = 0; i < numCoord; i++)
+            f[i] = (float)((i * (c + 3)) % 1000) * 0.001f;
+    }
+
+    const char *name = "PackerBench_Grid_1";
+    coShmPtr *nameArr = dm->shm_alloc(CHARSHMARRAY, strlen(name) + 1);
+    strcpy(arrayData(nameArr), name);
+
+    coShmPtr *obj = dm->shm_alloc(CHARSHMARRAY, coDoHeader::getHeaderSize() + NUM_ELEMENTS * SIZE_PER_TYPE_ENTRY);
+    int *p = (int *)obj->getPtr();
+    int *start = p;
+    *p++ = coDistributedObject::calcType("UNSGRD");
+    p++; // byte length, set below
+    *p++ = COVISE_OBJECTID;
+    *p++ = 1;
+    *p++ = 1;
+    putInt(p, NUM_ELEMENTS);
+    putInt(p, 1); // version
+    putInt(p, 1); // reference count
+    putPointer(p, nameArr);
+    *p++ = COVISE_NULLPTR; // no attributes
+    *p++ = 0;
+    *p++ = 0;
+
+    putInt(p, numElem);
+    putInt(p, numConn);
+    putInt(p, numCoord);
+    putPointer(p, el);
+    putPointer(p, cl);
+    for (int c = 0; c < 3; c++)
+        putPointer(p, coord[c]);
+    putPointer(p, tl);
+    putInt(p, 0);
+    putPointer(p, dm->shm_alloc(INTSHMARRAY, 0));
+    putPointer(p, dm->shm_alloc(INTSHMARRAY, 0));
+    start[1] = (int)((p - start) * sizeof(int));
+    return obj;
+}
+
+// data of the index-th element of an object (SHMPTR entries only)
+static char *elementData(coShmPtr *obj, int index)
+{
+    int *p = (int *)obj->getPtr() + coDoHeader::getHeaderSize() / sizeof(int);
+    for (int i = 0; i < index; i++)
+        p += (*p == INTSHM) ? 2 : 3;
+    if (*p != SHMPTR)
+        return NULL;
+    coShmPtr ptr(p[1], p[2]);
+    return arrayData(&ptr);
+}
+
+static bool sameData(coShmPtr *a, coShmPtr *b, int index, size_t bytes)
+{
+    char *da = elementData(a, index), *db = elementData(b, index);
+    return da && db && memcmp(da, db, bytes) == 0;
+}
+
+static void run(DataManagerProcess *dm, Connection *sendConn, Connection *recvConn,
+                coShmPtr *grid, int numConn, double megabytes, bool bulk)
+{
+    Packer::set_bulk_arrays(bulk);
+
+    float packSeconds = 0.f;
+    coWristWatch watch;
+    std::thread sender([&]()
+    {
+        coWristWatch packWatch;
+        Message msg;
+        msg.conn = sendConn;
+        msg.type = COVISE_MESSAGE_OBJECT_FOLLOWS;
+        Packer packer(&msg, grid->get_shm_seq_no(), grid->get_offset());
+        packer.pack();
+        packer.flush();
+        packSeconds = packWatch.elapsed();
+    });
+
+    Message *msg = new Message;
+    recvConn->recv_msg(msg);
+    char *name = NULL;
+    coShmPtr *copy = NULL;
+    {
+        Packer unpacker(msg, dm);
+        copy = unpacker.unpack(&name);
+    }
+    float seconds = watch.elapsed();
+    sender.join();
+
+    int numElem = numConn / 4;
+    int numCoord = numConn / 5 + 1;
+    bool ok = copy && sameData(grid, copy, 3, numElem * sizeof(int))
+              && sameData(grid, copy, 4, numConn * sizeof(int))
+              && sameData(grid, copy, 7, numCoord * sizeof(float));
+
+    printf("%-6s pack+send %8.3f s %9.1f MB/s   pack+unpack %8.3f s %9.1f MB/s   %s\n",
+           bulk ? "bulk" : "legacy", packSeconds, megabytes / packSeconds,
+           seconds, megabytes / seconds, ok ? "ok" : "MISMATCH");
+
+    if (copy)
+        dm->shm_free(copy);
+    delete copy;
+    delete[] name;
+    delete msg;
+}
+
+int main(int argc, char *argv[])
+{
+    int numConn = 100000000;
+    if (argc > 1)
+        numConn = atoi(argv[1]);
+
+    int key = 0x20000 + (getpid() & 0xffff) * 64;
+    DataManagerProcess *dm = new DataManagerProcess((char *)"PackerBench", 1, &key);
+
+    coShmPtr *grid = createGrid(dm, numConn);
+    double megabytes = (numConn + 2.0 * (numConn / 4) + 3.0 * (numConn / 5 + 1)) * sizeof(int) / 1e6;
+    printf("unstructured grid: %d connectivity entries, %.1f MB of arrays\n", numConn, megabytes);
+
+    // reserve shm for the received copy up front, so that the receiver does
+    // not attach new segments while the sender is reading
+    coShmPtr *reserve = dm->shm_alloc(CHARSHMARRAY, (shmSizeType)(megabytes * 1e6 * 1.1));
+    dm->shm_free(reserve);
+    delete reserve;
+
+    int port = 0;
+    ServerConnection *server = new ServerConnection(&port, 1, DATAMANAGER);
+    if (!server->is_connected())
+    {
+        fprintf(stderr, "PackerBench: could not open server socket\n");
+        return 1;
+    }
+    server->listen();
+    ClientConnection *client = NULL;
+    std::thread connector([&]()
+    {
+        client = new ClientConnection(NULL, port, 2, DATAMANAGER);
+    });
+    server->acceptOne();
+    connector.join();
+
+    run(dm, client, server, grid, numConn, megabytes, false);
+    run(dm, client, server, grid, numConn, megabytes, true);
+
+    delete client;
+    delete server;
+    return 0;
+}
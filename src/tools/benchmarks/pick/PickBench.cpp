@@ -0,0 +1,200 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Picking in a large scene as coIntersection does: a terrain made of many
+// drawables, each a wavy grid of triangles, is hit by random rays from
+// above. Testing every triangle of the drawables whose bounding boxes are
+// passed, as the unaccelerated intersection visitor does, is compared to the
+// hierarchy over the drawables of a geode and the cached hierarchies over
+// the triangles of each drawable. Both have to find the same nearest hits.
+// The default scene has 50M triangles and needs about 2 GB of memory.
+//
+// usage: PickBench [drawables] [triangles per drawable] [rays] [brute force rays]
+
+#include <coIntersectionBVH.h>
+
+#include <util/coWristWatch.h>
+
+#include <osg/ref_ptr>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace osg;
+using namespace opencover::Private;
+
+struct Drawable
+{
+    std::vector<Vec3> vertices;
+    std::vector<unsigned int> triangles;
+    BoundingBox box;
+    ref_ptr<TriangleBVH> bvh;
+};
+
+static float random01()
+{
+    return rand() / (float)RAND_MAX;
+}
+
+// grid of n x n quads at position (x, y) of the terrain
+static void makeGrid(Drawable &d, int n, float x, float y)
+{
+    const int nn = n + 1;
+    d.vertices.resize(nn * nn);
+    for (int j = 0; j < nn; j++)
+        for (int i = 0; i < nn; i++)
+        {
+            float px = x + i / (float)n, py = y + j / (float)n;
+            Vec3 v(px, py, 0.1f * sinf(7.f * px) * cosf(5.f * py));
+            d.vertices[i + nn * j] = v;
+            d.box.expandBy(v);
+        }
+    d.triangles.reserve(6 * n * n);
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+        {
+            unsigned int v = i + nn * j;
+            unsigned int quad[6] = { v, v + 1, v + 1 + nn, v, v + 1 + nn, v + nn };
+            d.triangles.insert(d.triangles.end(), quad, quad + 6);
+        }
+}
+
+// nearest hit by testing all triangles, as the TriangleFunctor does
+static bool bruteForce(const Drawable &d, const Vec3 &start, const Vec3 &end, float &ratio)
+{
+    bool hit = false;
+    const Vec3 dir = end - start;
+    for (size_t t = 0; t < d.triangles.size(); t += 3)
+    {
+        const Vec3 &v1 = d.vertices[d.triangles[t]];
+        const Vec3 e1 = d.vertices[d.triangles[t + 1]] - v1;
+        const Vec3 e2 = d.vertices[d.triangles[t + 2]] - v1;
+        const Vec3 p = dir ^ e2;
+        const float det = e1 * p;
+        if (det == 0.f)
+            continue;
+        const float inv = 1.f / det;
+        const Vec3 s = start - v1;
+        const float u = (s * p) * inv;
+        if (u < 0.f || u > 1.f)
+            continue;
+        const Vec3 q = s ^ e1;
+        const float v = (dir * q) * inv;
+        if (v < 0.f || u + v > 1.f)
+            continue;
+        const float r = (e2 * q) * inv;
+        if (r >= 0.f && r <= 1.f && (!hit || r < ratio))
+        {
+            ratio = r;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+static bool passes(const BoundingBox &box, const Vec3 &start, const Vec3 &end)
+{
+    const Vec3 dir = end - start;
+    float t0 = 0.f, t1 = 1.f;
+    for (int a = 0; a < 3; a++)
+    {
+        float tn = (box._min[a] - start[a]) / dir[a], tf = (box._max[a] - start[a]) / dir[a];
+        if (tn > tf)
+            std::swap(tn, tf);
+        t0 = std::max(t0, tn);
+        t1 = std::min(t1, tf);
+    }
+    return t0 <= t1;
+}
+
+int main(int argc, char *argv[])
+{
+    int numDrawables = 200;
+    int numTriangles = 250000;
+    int numRays = 10000;
+    int numBruteRays = 4;
+    if (argc > 1)
+        numDrawables = atoi(argv[1]);
+    if (argc > 2)
+        numTriangles = atoi(argv[2]);
+    if (argc > 3)
+        numRays = atoi(argv[3]);
+    if (argc > 4)
+        numBruteRays = atoi(argv[4]);
+    if (numDrawables < 1 || numTriangles < 2 || numRays < 1 || numBruteRays < 0)
+        return 1;
+
+    const int n = std::max(1, (int)sqrtf(numTriangles / 2.f));
+    const int side = (int)ceilf(sqrtf((float)numDrawables));
+    std::vector<Drawable> drawables(numDrawables);
+    std::vector<BoundingBox> boxes(numDrawables);
+    for (int i = 0; i < numDrawables; i++)
+    {
+        makeGrid(drawables[i], n, (float)(i % side), (float)(i / side));
+        boxes[i] = drawables[i].box;
+    }
+    printf("%d drawables, %d triangles each\n", numDrawables, 2 * n * n);
+
+    // rays from above onto the terrain, as with a pointer
+    std::vector<Vec3> starts(numRays), ends(numRays);
+    for (int r = 0; r < numRays; r++)
+    {
+        starts[r] = Vec3(random01() * side, random01() * side, 10.f);
+        ends[r] = starts[r] + Vec3(random01() - 0.5f, random01() - 0.5f, -20.f);
+    }
+
+    // the first pick builds the hierarchies
+    covise::coWristWatch watch;
+    BoxBVH scene(boxes);
+    for (int i = 0; i < numDrawables; i++)
+        drawables[i].bvh = new TriangleBVH(&drawables[i].vertices[0], drawables[i].vertices.size(), drawables[i].triangles);
+    printf("build       %10.3f s\n", watch.elapsed());
+
+    std::vector<float> nearest(numRays, 2.f);
+    watch.reset();
+    std::vector<unsigned int> candidates;
+    for (int r = 0; r < numRays; r++)
+    {
+        candidates.clear();
+        scene.intersect(starts[r], ends[r], candidates);
+        for (size_t c = 0; c < candidates.size(); c++)
+        {
+            TriangleBVH::Hit hit;
+            if (drawables[candidates[c]].bvh->intersect(starts[r], ends[r], hit) && hit.ratio < nearest[r])
+                nearest[r] = hit.ratio;
+        }
+    }
+    double bvhTime = watch.elapsed();
+    printf("hierarchy   %10.3f us/ray\n", bvhTime / numRays * 1e6);
+
+    bool ok = true;
+    if (numBruteRays > 0)
+    {
+        watch.reset();
+        for (int r = 0; r < numBruteRays && r < numRays; r++)
+        {
+            float best = 2.f;
+            for (int i = 0; i < numDrawables; i++)
+            {
+                float ratio;
+                if (passes(drawables[i].box, starts[r], ends[r]) && bruteForce(drawables[i], starts[r], ends[r], ratio) && ratio < best)
+                    best = ratio;
+            }
+            if (fabsf(best - nearest[r]) > 1e-5f)
+            {
+                fprintf(stderr, "PickBench: ray %d: hierarchy hit at %g, brute force at %g\n", r, nearest[r], best);
+                ok = false;
+            }
+        }
+        printf("brute force %10.3f us/ray\n", watch.elapsed() / std::min(numBruteRays, numRays) * 1e6);
+    }
+
+    return ok ? 0 : 1;
+}
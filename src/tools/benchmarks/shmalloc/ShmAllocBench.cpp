@@ -0,0 +1,103 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Allocation throughput of the data manager's shared memory allocator
+// for many small objects: AVL trees only vs. size class slabs, plus the
+// direct slab access used by application processes.
+//
+// usage: ShmAllocBench [max number of objects]
+
+#include <covise/covise.h>
+#include <dmgr/dmgr.h>
+#include <shm/covise_shmslab.h>
+#include <util/coWristWatch.h>
+#include <unistd.h>
+#include "../BenchReport.h"
+
+using namespace covise;
+
+static void benchAllocator(coShmAlloc &alloc, bool slabs, long n, const shmSizeType *sizes)
+{
+    int *seq_no = new int[n];
+    shmSizeType *offset = new shmSizeType[n];
+    alloc.enable_slabs(slabs);
+
+    coWristWatch watch;
+    for (long i = 0; i < n; i++)
+    {
+        coShmPtr *ptr = alloc.malloc(sizes[i]);
+        seq_no[i] = ptr->get_shm_seq_no();
+        offset[i] = ptr->get_offset();
+        delete ptr;
+    }
+    bench::report(slabs ? "malloc (slabs)" : "malloc (trees)", n, "objects", watch.elapsed());
+
+    watch.reset();
+    for (long i = 0; i < n; i++)
+        alloc.free(seq_no[i], offset[i]);
+    bench::report(slabs ? "free (slabs)" : "free (trees)", n, "objects", watch.elapsed());
+
+    delete[] seq_no;
+    delete[] offset;
+}
+
+// attribute style allocations as done by application processes
+static void benchDirect(coShmAlloc &alloc, long n, const shmSizeType *sizes)
+{
+    coShmSlabAlloc *slabs = coShmSlabAlloc::the();
+    if (!slabs)
+    {
+        printf("slabs disabled (System.ShmSlabs)\n");
+        return;
+    }
+
+    // warm up: let the data manager side carve enough slabs
+    alloc.enable_slabs(true);
+    benchAllocator(alloc, true, n, sizes);
+
+    int *result = new int[2 * n];
+    coWristWatch watch;
+    long got = 0;
+    for (; got < n; got++)
+    {
+        data_type dt = CHARSHMARRAY;
+        long count = sizes[got] - 3 * sizeof(int) - sizeof(int);
+        if (!slabs->mallocList(&dt, &count, 1, &result[2 * got]))
+            break;
+    }
+    bench::report("mallocList (application)", got, "objects", watch.elapsed());
+    for (long i = 0; i < got; i++)
+        alloc.free(result[2 * i], *(shmSizeType *)&result[2 * i + 1]);
+    delete[] result;
+}
+
+int main(int argc, char *argv[])
+{
+    long maxObjects = 1000000;
+    if (argc > 1)
+        maxObjects = atol(argv[1]);
+
+    // typical sizes of attributes, names and set element pointer arrays
+    shmSizeType *sizes = new shmSizeType[maxObjects];
+    srand(4711);
+    for (long i = 0; i < maxObjects; i++)
+        sizes[i] = 24 + 8 * (rand() % 62);
+
+    int key = 0x10000 + (getpid() & 0xffff) * 64;
+    coShmAlloc alloc(&key, NULL);
+
+    for (long n = 10000; n <= maxObjects; n *= 10)
+    {
+        benchAllocator(alloc, false, n, sizes);
+        benchAllocator(alloc, true, n, sizes);
+        benchDirect(alloc, n, sizes);
+        printf("\n");
+    }
+
+    delete[] sizes;
+    return 0;
+}
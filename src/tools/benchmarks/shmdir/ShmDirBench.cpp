@@ -0,0 +1,236 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Object lookups as done by modules reading their input objects and the
+// elements of sets: by name in the object directory which the data manager
+// keeps in shared memory, and by a GET_OBJECT / OBJECT_FOUND exchange with
+// a thread standing in for the data manager over a socket pair. Then
+// reader threads look up names while the data manager thread keeps
+// replacing objects, every result is checked for consistency.
+//
+// usage: ShmDirBench [objects] [lookups] [reader threads]
+
+#include <shm/covise_shmdir.h>
+#include <net/covise_connect.h>
+#include <net/message.h>
+#include <net/message_types.h>
+#include <util/coWristWatch.h>
+#include "../BenchReport.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+using namespace covise;
+
+class PairConnection : public Connection
+{
+public:
+    PairConnection(int sfd)
+        : Connection(sfd)
+    {
+        sender_id = 1;
+        send_type = APPLICATIONMODULE;
+    }
+};
+
+// location of object i in generation gen, readers can recompute it from the name
+static void location(int i, int gen, int *shm_seq_no, shmSizeType *offset)
+{
+    *shm_seq_no = 1 + i % 7;
+    *offset = (shmSizeType)i * 4096 + (shmSizeType)gen * 16;
+}
+
+static std::string objectName(int i, int gen)
+{
+    // like the elements of a time step set written by a reader module
+    char buf[64];
+    snprintf(buf, sizeof(buf), "ReadEnsight_1(12)_OUT_01_%d_%d", i, gen);
+    return buf;
+}
+
+static std::atomic<bool> done(false);
+static std::atomic<int> generation(0);
+static std::atomic<long> lookups(0), hits(0), errors(0);
+
+// looks up current and previous generation names, checks what it finds
+static void reader(coShmDirectory *dir, int numObjects, unsigned seed)
+{
+    long n = 0, h = 0, e = 0;
+    while (!done)
+    {
+        int i = rand_r(&seed) % numObjects;
+        int gen = generation.load(std::memory_order_relaxed) - rand_r(&seed) % 2;
+        if (gen < 0)
+            gen = 0;
+        int no, expNo;
+        shmSizeType off, expOff;
+        if (dir->lookup(objectName(i, gen).c_str(), &no, &off))
+        {
+            location(i, gen, &expNo, &expOff);
+            if (no != expNo || off != expOff)
+                e++;
+            h++;
+        }
+        n++;
+    }
+    lookups += n;
+    hits += h;
+    errors += e;
+}
+
+// answers GET_OBJECT like DataManagerProcess::handle_msg
+static void dataManager(Connection *conn, const std::map<std::string, std::pair<int, shmSizeType> > *objects)
+{
+    for (;;)
+    {
+        Message msg;
+        if (conn->recv_msg(&msg) <= 0 || msg.type != COVISE_MESSAGE_GET_OBJECT)
+            break;
+        std::map<std::string, std::pair<int, shmSizeType> >::const_iterator it = objects->find(msg.data);
+        int ia[2] = { 0, 0 };
+        Message reply(COVISE_MESSAGE_OBJECT_NOT_FOUND, 0, NULL, MSG_NOCOPY);
+        if (it != objects->end())
+        {
+            ia[0] = it->second.first;
+            *(shmSizeType *)&ia[1] = it->second.second;
+            reply.type = COVISE_MESSAGE_OBJECT_FOUND;
+            reply.length = sizeof(ia);
+            reply.data = (char *)ia;
+        }
+        conn->send_msg(&reply);
+        reply.data = NULL;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int numObjects = 10000;
+    long numLookups = 1000000;
+    int numReaders = 4;
+    if (argc > 1)
+        numObjects = atoi(argv[1]);
+    if (argc > 2)
+        numLookups = atol(argv[2]);
+    if (argc > 3)
+        numReaders = atoi(argv[3]);
+    if (numObjects < 1 || numLookups < 1 || numReaders < 1)
+        return 1;
+
+    // at most half full, like a directory configured for the number of objects
+    int numSlots = coShmDirectory::DEFAULT_SLOTS;
+    while (numSlots < 2 * numObjects)
+        numSlots *= 2;
+
+    // stands in for segment 1, behind the slab control block
+    std::vector<char> segment(coShmDirectory::controlSize(numSlots) + SIZEOF_ALIGNMENT);
+    void *address = &segment[0] + (SIZEOF_ALIGNMENT - (size_t)&segment[0] % SIZEOF_ALIGNMENT) % SIZEOF_ALIGNMENT;
+    coShmDirectory *dir = coShmDirectory::create(address, numSlots, true);
+
+    std::vector<std::string> names(numObjects);
+    std::map<std::string, std::pair<int, shmSizeType> > objects;
+    coWristWatch watch;
+    int entered = 0;
+    for (int i = 0; i < numObjects; i++)
+    {
+        names[i] = objectName(i, 0);
+        int no;
+        shmSizeType off;
+        location(i, 0, &no, &off);
+        objects[names[i]] = std::make_pair(no, off);
+        entered += dir->insert(names[i].c_str(), no, off, 0);
+    }
+    bench::report("insert", numObjects, "ops", watch.elapsed());
+    if (entered < numObjects)
+        printf("%d objects not entered, directory full\n", numObjects - entered);
+
+    srand(4711);
+    std::vector<int> sequence(numLookups < 1000000 ? numLookups : 1000000);
+    for (size_t i = 0; i < sequence.size(); i++)
+        sequence[i] = rand() % numObjects;
+
+    long found = 0;
+    watch.reset();
+    for (long i = 0; i < numLookups; i++)
+    {
+        int no;
+        shmSizeType off;
+        found += dir->lookup(names[sequence[i % sequence.size()]].c_str(), &no, &off);
+    }
+    bench::report("directory lookup", numLookups, "ops", watch.elapsed());
+    if (found < numLookups && entered == numObjects)
+        printf("%ld lookups failed\n", numLookups - found);
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+    {
+        perror("ShmDirBench: socketpair");
+        return 1;
+    }
+    PairConnection module(sv[0]), dmgr(sv[1]);
+    // wait in read like a module's connection to its data manager instead of spinning
+    fcntl(sv[0], F_SETFL, 0);
+    fcntl(sv[1], F_SETFL, 0);
+    std::thread server(dataManager, &dmgr, &objects);
+    // round trips are slow, fewer of them suffice
+    long numMessages = numLookups / 20 > 0 ? numLookups / 20 : 1;
+    found = 0;
+    watch.reset();
+    for (long i = 0; i < numMessages; i++)
+    {
+        const std::string &name = names[sequence[i % sequence.size()]];
+        Message msg(COVISE_MESSAGE_GET_OBJECT, (int)name.length() + 1, (char *)name.c_str(), MSG_NOCOPY);
+        module.send_msg(&msg);
+        msg.data = NULL;
+        Message reply;
+        module.recv_msg(&reply);
+        found += reply.type == COVISE_MESSAGE_OBJECT_FOUND;
+    }
+    bench::report("GET_OBJECT round trip", numMessages, "ops", watch.elapsed());
+    shutdown(sv[0], SHUT_WR);
+    server.join();
+
+    // the data manager replaces objects (new generation under a new name,
+    // old one removed) while readers look up the current and recent names
+    std::vector<std::thread> readers;
+    for (int r = 0; r < numReaders; r++)
+        readers.push_back(std::thread(reader, dir, numObjects, 17 + r));
+    watch.reset();
+    long replaced = 0;
+    for (int gen = 1; gen <= 20; gen++)
+    {
+        for (int i = 0; i < numObjects; i++)
+        {
+            int no;
+            shmSizeType off;
+            location(i, gen, &no, &off);
+            dir->insert(objectName(i, gen).c_str(), no, off, 0);
+            if (gen >= 2)
+                dir->remove(objectName(i, gen - 2).c_str());
+            replaced++;
+        }
+        generation = gen;
+    }
+    float seconds = watch.elapsed();
+    done = true;
+    for (size_t r = 0; r < readers.size(); r++)
+        readers[r].join();
+    bench::report("replace while reading", replaced, "ops", seconds);
+    char what[64];
+    snprintf(what, sizeof(what), "  %d concurrent readers", numReaders);
+    bench::report(what, lookups, "ops", seconds);
+    printf("%-34s %9ld hits, %ld inconsistent, %ld tombstones\n", "", (long)hits, (long)errors, dir->numTombstones());
+
+    return errors == 0 ? 0 : 1;
+}
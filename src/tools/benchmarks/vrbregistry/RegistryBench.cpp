@@ -0,0 +1,206 @@
+/* This file is part of COVISE.
+
+   You can use it under the terms of the GNU Lesser General Public License
+   version 2.1 or later, see lgpl-2.1.txt.
+
+ * License: LGPL 2+ */
+
+// Load on the VRB registry as in a collaborative session: the variables
+// are spread over classes, every client subscribes to some classes and
+// sets variables, hot variables (e.g. positions) several times per server
+// loop iteration. The registry informs the observers once per iteration
+// (as VRBServer::processMessages does) and, for comparison, after every
+// single update. The clients are socket pairs drained by a thread.
+//
+// usage: RegistryBench [clients] [variables] [classes] [updates per client and round]
+
+#include "coRegistry.h"
+#include "VRBClientList.h"
+#include "../BenchReport.h"
+
+#include <net/covise_connect.h>
+#include <util/coWristWatch.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace covise;
+
+// server end of a client connection
+class PairConnection : public Connection
+{
+public:
+    PairConnection(int sfd)
+        : Connection(sfd)
+    {
+        sender_id = 1;
+        send_type = CONTROLLER;
+    }
+};
+
+static std::atomic<bool> done(false);
+
+// read and discard everything the clients receive
+static void drain(std::vector<int> fds)
+{
+    std::vector<pollfd> pfds(fds.size());
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        pfds[i].fd = fds[i];
+        pfds[i].events = POLLIN;
+    }
+    char buf[65536];
+    while (!done)
+    {
+        if (poll(&pfds[0], pfds.size(), 100) <= 0)
+            continue;
+        for (size_t i = 0; i < pfds.size(); i++)
+        {
+            if (pfds[i].revents & POLLIN)
+            {
+                if (read(pfds[i].fd, buf, sizeof(buf)) <= 0)
+                    pfds[i].fd = -1;
+            }
+        }
+    }
+}
+
+static void reportTraffic(const char *what, const std::vector<Connection *> &conns, long &lastMessages, long &lastWrites)
+{
+    long messages = 0, writes = 0;
+    for (size_t i = 0; i < conns.size(); i++)
+    {
+        messages += conns[i]->get_stats().messages_sent;
+        writes += conns[i]->get_stats().write_calls;
+    }
+    printf("%-34s %9ld messages, %9ld writes\n", what, messages - lastMessages, writes - lastWrites);
+    lastMessages = messages;
+    lastWrites = writes;
+}
+
+int main(int argc, char *argv[])
+{
+    int numClients = 100;
+    int numVars = 100000;
+    int numClasses = 100;
+    int updates = 1000;
+    if (argc > 1)
+        numClients = atoi(argv[1]);
+    if (argc > 2)
+        numVars = atoi(argv[2]);
+    if (argc > 3)
+        numClasses = atoi(argv[3]);
+    if (argc > 4)
+        updates = atoi(argv[4]);
+    if (numClients < 1 || numClasses < 1 || numVars < numClasses)
+        return 1;
+    const int subscriptions = numClasses < 10 ? numClasses : 10;
+    const int rounds = 10;
+
+    coRegistry registry;
+    std::vector<Connection *> conns;
+    std::vector<int> clientFds;
+    std::vector<int> ids;
+    for (int i = 0; i < numClients; i++)
+    {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        {
+            perror("RegistryBench: socketpair");
+            return 1;
+        }
+        Connection *conn = new PairConnection(sv[0]);
+        VRBSClient *cl = new VRBSClient(conn, (QSocketNotifier *)NULL);
+        clients.append(cl);
+        conns.push_back(conn);
+        ids.push_back(cl->getID());
+        clientFds.push_back(sv[1]);
+    }
+    std::thread drainer(drain, clientFds);
+
+    std::vector<std::string> classNames(numClasses), varNames(numVars / numClasses);
+    for (int c = 0; c < numClasses; c++)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "Plugin%d", c);
+        classNames[c] = buf;
+    }
+    for (size_t v = 0; v < varNames.size(); v++)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "state.%u", (unsigned)v);
+        varNames[v] = buf;
+    }
+    long lastMessages = 0, lastWrites = 0;
+
+    coWristWatch watch;
+    for (int c = 0; c < numClasses; c++)
+    {
+        for (size_t v = 0; v < varNames.size(); v++)
+            registry.create(classNames[c].c_str(), 0, varNames[v].c_str(), 1);
+    }
+    registry.flush();
+    bench::report("create", (long)numClasses * varNames.size(), "ops", watch.elapsed());
+
+    watch.reset();
+    for (int i = 0; i < numClients; i++)
+    {
+        for (int s = 0; s < subscriptions; s++)
+            registry.observe(classNames[(i + s * 7) % numClasses].c_str(), 0, ids[i]);
+    }
+    bench::report("subscribe class", (long)numClients * subscriptions, "ops", watch.elapsed());
+    reportTraffic("  initial values", conns, lastMessages, lastWrites);
+
+    // a quarter of the updates go to few hot variables
+    srand(4711);
+    std::vector<std::pair<int, int> > sequence;
+    for (int i = 0; i < numClients * updates; i++)
+    {
+        int c = rand() % numClasses;
+        int v = (i % 4 == 0) ? rand() % 16 : rand() % (int)varNames.size();
+        sequence.push_back(std::make_pair(c, v));
+    }
+
+    // informing the observers after every update is slow, one round is enough
+    for (int coalesce = 1; coalesce >= 0; coalesce--)
+    {
+        char value[32];
+        int n = coalesce ? rounds : 1;
+        watch.reset();
+        for (int r = 0; r < n; r++)
+        {
+            for (size_t i = 0; i < sequence.size(); i++)
+            {
+                snprintf(value, sizeof(value), "%d.%u", r, (unsigned)i);
+                registry.setVar(classNames[sequence[i].first].c_str(), 0, varNames[sequence[i].second].c_str(), value);
+                if (!coalesce)
+                    registry.flush();
+            }
+            registry.flush();
+        }
+        bench::report(coalesce ? "setVar, flush per round" : "setVar, flush per update", (long)n * sequence.size(), "ops", watch.elapsed());
+        reportTraffic("  notifications", conns, lastMessages, lastWrites);
+    }
+
+    watch.reset();
+    long lookups = 0;
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < sequence.size(); i++)
+        {
+            lookups += registry.isTrue(classNames[sequence[i].first].c_str(), 0, varNames[sequence[i].second].c_str()) >= 0;
+        }
+    }
+    bench::report("lookup", lookups, "ops", watch.elapsed());
+
+    done = true;
+    drainer.join();
+    return 0;
+}